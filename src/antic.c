@@ -36,6 +36,7 @@
 #include "memory.h"
 #include "platform.h"
 #include "pokey.h"
+#include "profile.h"
 #include "util.h"
 #if !defined(BASIC) && !defined(CURSES_BASIC)
 #include "input.h"
@@ -47,13 +48,21 @@
 #ifdef NEW_CYCLE_EXACT
 #include "cycle_map.h"
 #endif
+#include "simd.h"
+
+/* Vector renderers for ANTIC modes E and F and GTIA modes 9 and 11 (see
+   draw_2bpp_simd). The screen is written directly, which DIRTYRECT can't
+   allow. */
+#if defined(SIMD_SSE2) && !defined(DIRTYRECT) && !defined(WORDS_BIGENDIAN)
+#define ANTIC_SIMD
+#endif
 
 #define LCHOP 3			/* do not build leftmost 0..3 characters in wide mode */
 #define RCHOP 3			/* do not build rightmost 0..3 characters in wide mode */
 
-int ANTIC_break_ypos = 999;
+THREAD_LOCAL int ANTIC_break_ypos = 999;
 #if !defined(BASIC) && !defined(CURSES_BASIC)
-static int gtia_bug_active = FALSE; /* The GTIA bug mode is active */
+static THREAD_LOCAL int gtia_bug_active = FALSE; /* The GTIA bug mode is active */
 #endif
 #ifdef NEW_CYCLE_EXACT
 static void draw_partial_scanline(int l,int r);
@@ -70,8 +79,9 @@ static UBYTE need_load;
 static int dmactl_bug_chdata;
 #endif /* NEW_CYCLE_EXACT */
 #ifndef NO_SIMPLE_PAL_BLENDING
-int ANTIC_pal_blending = 0;
+THREAD_LOCAL int ANTIC_pal_blending = 0;
 #endif /* NO_SIMPLE_PAL_BLENDING */
+THREAD_LOCAL int ANTIC_no_pixels = FALSE;
 
 /* Video memory access is hidden behind these macros. It allows to track dirty video memory
    to improve video system performance */
@@ -221,20 +231,20 @@ void ANTIC_VideoPutByte(UBYTE *ptr, UBYTE val)
 
 /* ANTIC Registers --------------------------------------------------------- */
 
-UBYTE ANTIC_DMACTL;
-UBYTE ANTIC_CHACTL;
-UWORD ANTIC_dlist;
-UBYTE ANTIC_HSCROL;
-UBYTE ANTIC_VSCROL;
-UBYTE ANTIC_PMBASE;
-UBYTE ANTIC_CHBASE;
-UBYTE ANTIC_NMIEN;
-UBYTE ANTIC_NMIST;
+THREAD_LOCAL UBYTE ANTIC_DMACTL;
+THREAD_LOCAL UBYTE ANTIC_CHACTL;
+THREAD_LOCAL UWORD ANTIC_dlist;
+THREAD_LOCAL UBYTE ANTIC_HSCROL;
+THREAD_LOCAL UBYTE ANTIC_VSCROL;
+THREAD_LOCAL UBYTE ANTIC_PMBASE;
+THREAD_LOCAL UBYTE ANTIC_CHBASE;
+THREAD_LOCAL UBYTE ANTIC_NMIEN;
+THREAD_LOCAL UBYTE ANTIC_NMIST;
 
 /* ANTIC Memory ------------------------------------------------------------ */
 
 #if !defined(BASIC) && !defined(CURSES_BASIC)
-static UBYTE antic_memory[52];
+static THREAD_LOCAL UBYTE antic_memory[52];
 #define ANTIC_margin 4
 /* It's number of bytes in antic_memory, which are never loaded, but may be
    read in wide playfield mode. These bytes are uninitialized, because on
@@ -246,7 +256,7 @@ static UBYTE antic_memory[52];
    This allows special optimisations under certain conditions.
    ------------------------------------------------------------------------ */
 
-static UWORD *scrn_ptr;
+static THREAD_LOCAL UWORD *scrn_ptr;
 #endif /* !defined(BASIC) && !defined(CURSES_BASIC) */
 
 /* Separate access to XE extended memory ----------------------------------- */
@@ -261,7 +271,7 @@ static UWORD *scrn_ptr;
 /* Pointer to 16 KB seen by ANTIC in 0x4000-0x7fff.
    If it's the same what the CPU sees (and what's in MEMORY_mem[0x4000..0x7fff],
    then NULL. */
-const UBYTE *ANTIC_xe_ptr = NULL;
+THREAD_LOCAL const UBYTE *ANTIC_xe_ptr = NULL;
 
 /* ANTIC Timing --------------------------------------------------------------
 
@@ -409,7 +419,7 @@ These are all cases:
 #define SCR_C	28
 #define VSCOF_C	112
 
-unsigned int ANTIC_screenline_cpu_clock = 0;
+THREAD_LOCAL unsigned int ANTIC_screenline_cpu_clock = 0;
 
 #ifdef NEW_CYCLE_EXACT
 #define UPDATE_DMACTL do{if (dmactl_changed) { \
@@ -438,11 +448,11 @@ unsigned int ANTIC_screenline_cpu_clock = 0;
 #define GOEOL CPU_GO(ANTIC_LINE_C); ANTIC_xpos -= ANTIC_LINE_C; ANTIC_screenline_cpu_clock += ANTIC_LINE_C; UPDATE_DMACTL; ANTIC_ypos++; UPDATE_GTIA_BUG
 #define OVERSCREEN_LINE	ANTIC_xpos += ANTIC_DMAR; GOEOL
 
-int ANTIC_xpos = 0;
-int ANTIC_xpos_limit;
-int ANTIC_wsync_halt = FALSE;
+THREAD_LOCAL int ANTIC_xpos = 0;
+THREAD_LOCAL int ANTIC_xpos_limit;
+THREAD_LOCAL int ANTIC_wsync_halt = FALSE;
 
-int ANTIC_ypos;						/* Line number - lines 8..247 are on screen */
+THREAD_LOCAL int ANTIC_ypos;						/* Line number - lines 8..247 are on screen */
 
 /* Timing in first line of modes 2-5
 In these modes ANTIC takes more bytes than cycles. Despite this, it would be
@@ -456,22 +466,22 @@ contains difference between bytes taken and cycles taken plus before_cycles. */
 
 /* Light pen support ------------------------------------------------------- */
 
-static UBYTE PENH;
-static UBYTE PENV;
-UBYTE ANTIC_PENH_input = 0x00;
-UBYTE ANTIC_PENV_input = 0xff;
+static THREAD_LOCAL UBYTE PENH;
+static THREAD_LOCAL UBYTE PENV;
+THREAD_LOCAL UBYTE ANTIC_PENH_input = 0x00;
+THREAD_LOCAL UBYTE ANTIC_PENV_input = 0xff;
 
 #ifndef BASIC
 
 /* Internal ANTIC registers ------------------------------------------------ */
 
-static UWORD screenaddr;		/* Screen Pointer */
-static UBYTE IR;				/* Instruction Register */
-static UBYTE anticmode;			/* Antic mode */
-static UBYTE dctr;				/* Delta Counter */
-static UBYTE lastline;			/* dctr limit */
-static UBYTE need_dl;			/* boolean: fetch DL next line */
-static UBYTE vscrol_off;		/* boolean: displaying line ending VSC */
+static THREAD_LOCAL UWORD screenaddr;		/* Screen Pointer */
+static THREAD_LOCAL UBYTE IR;				/* Instruction Register */
+static THREAD_LOCAL UBYTE anticmode;			/* Antic mode */
+static THREAD_LOCAL UBYTE dctr;				/* Delta Counter */
+static THREAD_LOCAL UBYTE lastline;			/* dctr limit */
+static THREAD_LOCAL UBYTE need_dl;			/* boolean: fetch DL next line */
+static THREAD_LOCAL UBYTE vscrol_off;		/* boolean: displaying line ending VSC */
 
 #endif
 
@@ -485,20 +495,20 @@ static UBYTE vscrol_off;		/* boolean: displaying line ending VSC */
 #define SCROLL0 3				/* modes 2,3,4,5,0xd,0xe,0xf with HSC */
 #define SCROLL1 4				/* modes 6,7,0xa,0xb,0xc with HSC */
 #define SCROLL2 5				/* modes 8,9 with HSC */
-static int md;					/* current mode NORMAL0..SCROLL2 */
+static THREAD_LOCAL int md;					/* current mode NORMAL0..SCROLL2 */
 /* tables for modes NORMAL0..SCROLL2 */
-static int chars_read[6];
-static int chars_displayed[6];
-static int x_min[6];
-static int ch_offset[6];
-static int load_cycles[6];
-static int font_cycles[6];
-static int before_cycles[6];
-static int extra_cycles[6];
+static THREAD_LOCAL int chars_read[6];
+static THREAD_LOCAL int chars_displayed[6];
+static THREAD_LOCAL int x_min[6];
+static THREAD_LOCAL int ch_offset[6];
+static THREAD_LOCAL int load_cycles[6];
+static THREAD_LOCAL int font_cycles[6];
+static THREAD_LOCAL int before_cycles[6];
+static THREAD_LOCAL int extra_cycles[6];
 
 /* border parameters for current display width */
-static int left_border_chars;
-static int right_border_start;
+static THREAD_LOCAL int left_border_chars;
+static THREAD_LOCAL int right_border_start;
 #ifdef NEW_CYCLE_EXACT
 static int left_border_start = LCHOP * 4;
 static int right_border_end = (48 - RCHOP) * 4;
@@ -510,23 +520,39 @@ static int right_border_end = (48 - RCHOP) * 4;
 #endif /* NEW_CYCLE_EXACT */
 
 /* set with CHBASE *and* CHACTL - bits 0..2 set if flip on */
-static UWORD chbase_20;			/* CHBASE for 20 character mode */
+static THREAD_LOCAL UWORD chbase_20;			/* CHBASE for 20 character mode */
 
 /* set with CHACTL */
-static UBYTE invert_mask;
-static int blank_mask;
+static THREAD_LOCAL UBYTE invert_mask;
+static THREAD_LOCAL int blank_mask;
 
 /* A scanline of AN0 and AN1 signals as transmitted from ANTIC to GTIA.
    In every byte, bit 0 is AN0 and bit 1 is AN1 */
-static UBYTE an_scanline[Screen_WIDTH / 2 + 8];
+static THREAD_LOCAL UBYTE an_scanline[Screen_WIDTH / 2 + 8];
+
+/* Offsets into GTIA_pm_scanline are computed from PM_SCANLINE. With
+   MULTI_INSTANCE, gcc may merge the subtraction of the address of the
+   thread-local array into an instruction that the linker can not relax, so
+   the address is taken where the compiler can not see through it. */
+#ifdef MULTI_INSTANCE
+static const UBYTE *pm_scanline(void)
+{
+	const UBYTE *ptr = GTIA_pm_scanline;
+	__asm__("" : "+r" (ptr));
+	return ptr;
+}
+#define PM_SCANLINE pm_scanline()
+#else
+#define PM_SCANLINE GTIA_pm_scanline
+#endif
 
 /* lookup tables */
-static UBYTE blank_lookup[256];
-static UWORD lookup2[256];
-ULONG ANTIC_lookup_gtia9[16];
-ULONG ANTIC_lookup_gtia11[16];
-static UBYTE playfield_lookup[257];
-static UBYTE mode_e_an_lookup[256];
+static THREAD_LOCAL UBYTE blank_lookup[256];
+static THREAD_LOCAL UWORD lookup2[256];
+THREAD_LOCAL ULONG ANTIC_lookup_gtia9[16];
+THREAD_LOCAL ULONG ANTIC_lookup_gtia11[16];
+static THREAD_LOCAL UBYTE playfield_lookup[257];
+static THREAD_LOCAL UBYTE mode_e_an_lookup[256];
 
 /* Colour lookup table
    This single table replaces 4 previously used: cl_word, cur_prior,
@@ -556,7 +582,7 @@ static UBYTE mode_e_an_lookup[256];
    PF3 if (PRIOR & 0x1f) == 0x10, PF0 or PF1 otherwise.
    Additional column 'colls' holds collisions of playfields with PMG. */
 
-UWORD ANTIC_cl[128];
+THREAD_LOCAL UWORD ANTIC_cl[128];
 
 #define C_PM0	0x01
 #define C_PM1	0x02
@@ -616,6 +642,7 @@ UWORD ANTIC_cl[128];
 
 #define INIT_BACKGROUND_6 ULONG background = ANTIC_cl[C_PF2] | (((ULONG) ANTIC_cl[C_PF2]) << 16);
 #define INIT_BACKGROUND_8 ULONG background = ANTIC_lookup_gtia9[0];
+#define BACKGROUND_WORD(colreg) ((UWORD) background)
 #define DRAW_BACKGROUND(colreg) { \
 		WRITE_VIDEO_LONG_UNALIGNED((ULONG *) ptr, background); \
 		WRITE_VIDEO_LONG_UNALIGNED(((ULONG *) ptr) + 1, background); \
@@ -631,6 +658,7 @@ UWORD ANTIC_cl[128];
 
 #define INIT_BACKGROUND_6
 #define INIT_BACKGROUND_8
+#define BACKGROUND_WORD(colreg) ANTIC_cl[colreg]
 #define DRAW_BACKGROUND(colreg) {\
 		WRITE_VIDEO(ptr,     ANTIC_cl[colreg]); \
 		WRITE_VIDEO(ptr + 1, ANTIC_cl[colreg]); \
@@ -675,14 +703,14 @@ UWORD ANTIC_cl[128];
 #define HIRES_LUM_10	0x000f
 #endif
 
-static UWORD hires_lookup_n[128];
-static UWORD hires_lookup_m[128];
+static THREAD_LOCAL UWORD hires_lookup_n[128];
+static THREAD_LOCAL UWORD hires_lookup_m[128];
 #define hires_norm(x)	hires_lookup_n[(x) >> 1]
 #define hires_mask(x)	hires_lookup_m[(x) >> 1]
 
 #ifndef USE_COLOUR_TRANSLATION_TABLE
-int ANTIC_artif_new = FALSE; /* New type of artifacting */
-UWORD ANTIC_hires_lookup_l[128];	/* accessed in gtia.c */
+THREAD_LOCAL int ANTIC_artif_new = FALSE; /* New type of artifacting */
+THREAD_LOCAL UWORD ANTIC_hires_lookup_l[128];	/* accessed in gtia.c */
 #define hires_lum(x)	ANTIC_hires_lookup_l[(x) >> 1]
 #endif
 
@@ -694,21 +722,21 @@ UWORD ANTIC_hires_lookup_l[128];	/* accessed in gtia.c */
 #define PF3PM (*(UBYTE *) &ANTIC_cl[C_PF3 | C_COLLS])
 #define PF_COLLS(x) (((UBYTE *) &ANTIC_cl)[(x) + L_COLLS])
 
-static int singleline;
-int ANTIC_player_dma_enabled;
-int ANTIC_player_gra_enabled;
-int ANTIC_missile_dma_enabled;
-int ANTIC_missile_gra_enabled;
-int ANTIC_player_flickering;
-int ANTIC_missile_flickering;
+static THREAD_LOCAL int singleline;
+THREAD_LOCAL int ANTIC_player_dma_enabled;
+THREAD_LOCAL int ANTIC_player_gra_enabled;
+THREAD_LOCAL int ANTIC_missile_dma_enabled;
+THREAD_LOCAL int ANTIC_missile_gra_enabled;
+THREAD_LOCAL int ANTIC_player_flickering;
+THREAD_LOCAL int ANTIC_missile_flickering;
 
-static UWORD pmbase_s;
-static UWORD pmbase_d;
+static THREAD_LOCAL UWORD pmbase_s;
+static THREAD_LOCAL UWORD pmbase_d;
 
 /* PMG lookup tables */
-static UBYTE pm_lookup_table[20][256];
+static THREAD_LOCAL UBYTE pm_lookup_table[20][256];
 /* current PMG lookup table */
-static const UBYTE *pm_lookup_ptr;
+static THREAD_LOCAL const UBYTE *pm_lookup_ptr;
 
 #define PL_00	0	/* 0x00,0x01,0x02,0x03,0x04,0x06,0x08,0x09,0x0a,0x0b */
 #define PL_05	1	/* 0x05,0x07,0x0c,0x0d,0x0e,0x0f */
@@ -879,32 +907,32 @@ static void pmg_dma(void)
 
 /* Artifacting ------------------------------------------------------------ */
 
-int ANTIC_artif_mode;
+THREAD_LOCAL int ANTIC_artif_mode;
 
-static UWORD art_lookup_new[64];
-static UWORD art_colour1_new;
-static UWORD art_colour2_new;
+static THREAD_LOCAL UWORD art_lookup_new[64];
+static THREAD_LOCAL UWORD art_colour1_new;
+static THREAD_LOCAL UWORD art_colour2_new;
 
-static ULONG art_lookup_normal[256];
-static ULONG art_lookup_reverse[256];
-static ULONG art_bkmask_normal[256];
-static ULONG art_lummask_normal[256];
-static ULONG art_bkmask_reverse[256];
-static ULONG art_lummask_reverse[256];
+static THREAD_LOCAL ULONG art_lookup_normal[256];
+static THREAD_LOCAL ULONG art_lookup_reverse[256];
+static THREAD_LOCAL ULONG art_bkmask_normal[256];
+static THREAD_LOCAL ULONG art_lummask_normal[256];
+static THREAD_LOCAL ULONG art_bkmask_reverse[256];
+static THREAD_LOCAL ULONG art_lummask_reverse[256];
 
-static ULONG *art_curtable = art_lookup_normal;
-static ULONG *art_curbkmask = art_bkmask_normal;
-static ULONG *art_curlummask = art_lummask_normal;
+static THREAD_LOCAL ULONG *art_curtable = NULL;
+static THREAD_LOCAL ULONG *art_curbkmask;
+static THREAD_LOCAL ULONG *art_curlummask;
 
-static UWORD art_normal_colpf1_save;
-static UWORD art_normal_colpf2_save;
-static UWORD art_reverse_colpf1_save;
-static UWORD art_reverse_colpf2_save;
+static THREAD_LOCAL UWORD art_normal_colpf1_save;
+static THREAD_LOCAL UWORD art_normal_colpf2_save;
+static THREAD_LOCAL UWORD art_reverse_colpf1_save;
+static THREAD_LOCAL UWORD art_reverse_colpf2_save;
+static THREAD_LOCAL UWORD *art_colpf1_save;
+static THREAD_LOCAL UWORD *art_colpf2_save;
 
 static void setup_art_colours(void)
 {
-	static UWORD *art_colpf1_save = &art_normal_colpf1_save;
-	static UWORD *art_colpf2_save = &art_normal_colpf2_save;
 	UWORD curlum = ANTIC_cl[C_PF1] & 0x0f0f;
 
 	if (curlum != *art_colpf1_save || ANTIC_cl[C_PF2] != *art_colpf2_save) {
@@ -1172,7 +1200,7 @@ static const UBYTE gtia_10_pm[] =
 
 static void draw_an_gtia9(const ULONG *t_pm_scanline_ptr)
 {
-	int i = ((const UBYTE *) t_pm_scanline_ptr - GTIA_pm_scanline) & ~1;
+	int i = ((const UBYTE *) t_pm_scanline_ptr - PM_SCANLINE) & ~1;
 	while (i < right_border_start) {
 		UWORD *ptr = scrn_ptr + i;
 		int pixel = (an_scanline[i] << 2) + an_scanline[i + 1];
@@ -1214,7 +1242,7 @@ static void draw_an_gtia9(const ULONG *t_pm_scanline_ptr)
 
 static void draw_an_gtia10(const ULONG *t_pm_scanline_ptr)
 {
-	int i = ((const UBYTE *) t_pm_scanline_ptr - GTIA_pm_scanline) | 1;
+	int i = ((const UBYTE *) t_pm_scanline_ptr - PM_SCANLINE) | 1;
 	UWORD lookup_gtia10[16];
 	lookup_gtia10[0] = ANTIC_cl[C_PM0];
 	lookup_gtia10[1] = ANTIC_cl[C_PM1];
@@ -1258,7 +1286,7 @@ static void draw_an_gtia10(const ULONG *t_pm_scanline_ptr)
 
 static void draw_an_gtia11(const ULONG *t_pm_scanline_ptr)
 {
-	int i = ((const UBYTE *) t_pm_scanline_ptr - GTIA_pm_scanline) & ~1;
+	int i = ((const UBYTE *) t_pm_scanline_ptr - PM_SCANLINE) & ~1;
 	while (i < right_border_start) {
 		UWORD *ptr = scrn_ptr + i;
 		int pixel = (an_scanline[i] << 2) + an_scanline[i + 1];
@@ -1307,7 +1335,7 @@ static void draw_an_gtia_bug(const ULONG *t_pm_scanline_ptr)
 	lookup_gtia_bug[1] = ANTIC_cl[C_PF1];
 	lookup_gtia_bug[2] = ANTIC_cl[C_PF2];
 	lookup_gtia_bug[3] = ANTIC_cl[C_PF3];
-	i = ((const UBYTE *) t_pm_scanline_ptr - GTIA_pm_scanline);
+	i = ((const UBYTE *) t_pm_scanline_ptr - PM_SCANLINE);
 	while (i < right_border_start) {
 		UWORD *ptr = scrn_ptr + i;
 		int pixel = an_scanline[i];
@@ -1347,6 +1375,154 @@ static void draw_an_gtia_bug(const ULONG *t_pm_scanline_ptr)
 #define CHAR_LOOP_BEGIN do {
 #define CHAR_LOOP_END } while (--nchars);
 
+#ifdef ANTIC_SIMD
+
+/* Modes E and F show four pixels per byte, each selecting one of four
+   colours. Without players or missiles, draw_2bpp_simd draws four such
+   bytes (16 pixels) at once. data holds the bytes, the first one in the
+   lowest 8 bits. A byte with all pixels 0 is drawn with the "zero" colour,
+   as the scalar renderers then draw the background, which needn't be the
+   same word as colour 0. simd_2bpp_colours sets the colours for the
+   current scanline. The character modes 2 and 4 stay scalar: fetching the
+   font bytes one at a time left them no faster, and sparse text slower. */
+
+/* Number of bytes drawn at once */
+#define SIMD_CHARS 4
+
+typedef struct {
+	__m128i colour0;
+	__m128i bit0;
+	__m128i bit1;
+	__m128i bits;
+	__m128i blank;
+	__m128i zero;
+} simd_2bpp_t;
+
+/* A colour is selected by XOR from the bits of its pixel value:
+   c0 ^ (c1 ^ c0) ^ (c2 ^ c0) ^ (c3 ^ c2 ^ c1 ^ c0) is c3 */
+static inline void simd_2bpp_colours(simd_2bpp_t *colours, UWORD c0, UWORD c1, UWORD c2, UWORD c3, UWORD c_zero)
+{
+	colours->colour0 = _mm_set1_epi16((short) c0);
+	colours->bit0 = _mm_set1_epi16((short) (c1 ^ c0));
+	colours->bit1 = _mm_set1_epi16((short) (c2 ^ c0));
+	colours->bits = _mm_set1_epi16((short) (c3 ^ c2 ^ c1 ^ c0));
+	colours->blank = _mm_set1_epi16((short) (c_zero ^ c0));
+	colours->zero = _mm_set1_epi16((short) c_zero);
+}
+
+/* TRUE if there are no players or missiles in the next SIMD_CHARS bytes */
+static inline int simd_pm_clear(const ULONG *t_pm_scanline_ptr)
+{
+	__m128i pm = _mm_loadu_si128((const __m128i *) t_pm_scanline_ptr);
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(pm, _mm_setzero_si128())) == 0xffff;
+}
+
+/* Spreads the four bytes of data to words, each byte to four words (one
+   per pixel): the first two bytes to lo and the other two to hi */
+static inline void simd_spread(ULONG data, __m128i *lo, __m128i *hi)
+{
+	__m128i d = _mm_unpacklo_epi8(_mm_cvtsi32_si128((int) data), _mm_setzero_si128());
+	d = _mm_unpacklo_epi16(d, d);
+	*lo = _mm_unpacklo_epi32(d, d);
+	*hi = _mm_unpackhi_epi32(d, d);
+}
+
+/* The colours of the pixels of two bytes, spread by simd_spread */
+static inline __m128i simd_2bpp_select(const simd_2bpp_t *colours, __m128i d)
+{
+	const __m128i bit1 = _mm_set_epi16(0x02, 0x08, 0x20, 0x80, 0x02, 0x08, 0x20, 0x80);
+	const __m128i bit0 = _mm_srli_epi16(bit1, 1);
+	__m128i b1 = _mm_cmpeq_epi16(_mm_and_si128(d, bit1), bit1);
+	__m128i b0 = _mm_cmpeq_epi16(_mm_and_si128(d, bit0), bit0);
+	__m128i c = _mm_xor_si128(colours->colour0, _mm_and_si128(b0, colours->bit0));
+	c = _mm_xor_si128(c, _mm_and_si128(b1, colours->bit1));
+	c = _mm_xor_si128(c, _mm_and_si128(_mm_and_si128(b0, b1), colours->bits));
+	return _mm_xor_si128(c, _mm_and_si128(_mm_cmpeq_epi16(d, _mm_setzero_si128()), colours->blank));
+}
+
+static inline void draw_2bpp_simd(const simd_2bpp_t *colours, UWORD *ptr, ULONG data)
+{
+	__m128i lo, hi;
+	if (data == 0) {
+		/* blank areas are the most common case */
+		_mm_storeu_si128((__m128i *) ptr, colours->zero);
+		_mm_storeu_si128((__m128i *) ptr + 1, colours->zero);
+		return;
+	}
+	simd_spread(data, &lo, &hi);
+	_mm_storeu_si128((__m128i *) ptr, simd_2bpp_select(colours, lo));
+	_mm_storeu_si128((__m128i *) ptr + 1, simd_2bpp_select(colours, hi));
+}
+
+/* GTIA modes 9-11 show two pixels per byte, each 4 bits and two words
+   wide. simd_nibbles returns the pixels of the four bytes of data, each
+   in two byte lanes, so one lane per word on the screen. */
+static inline __m128i simd_nibbles(ULONG data)
+{
+	__m128i d = _mm_cvtsi32_si128((int) data);
+	__m128i nibble = _mm_set1_epi8(0x0f);
+	__m128i n = _mm_unpacklo_epi8(_mm_and_si128(_mm_srli_epi16(d, 4), nibble),
+		_mm_and_si128(d, nibble));
+	return _mm_unpacklo_epi8(n, n);
+}
+
+#ifndef USE_COLOUR_TRANSLATION_TABLE
+#define ANTIC_SIMD_GTIA9_11
+
+/* In GTIA 9 the pixels set the luminance of the background colour, in
+   GTIA 11 its hue, so the colours are computed like in setup_gtia9_11
+   instead of looked up. */
+static inline void draw_gtia9_simd(UWORD *ptr, ULONG data)
+{
+	__m128i background = _mm_set1_epi32((int) ANTIC_lookup_gtia9[0]);
+	__m128i n = simd_nibbles(data);
+	_mm_storeu_si128((__m128i *) ptr, _mm_or_si128(background, _mm_unpacklo_epi8(n, n)));
+	_mm_storeu_si128((__m128i *) ptr + 1, _mm_or_si128(background, _mm_unpackhi_epi8(n, n)));
+}
+
+/* Pixels of 0 clear the luminance */
+#define SIMD_GTIA11(n) \
+	_mm_or_si128( \
+		_mm_andnot_si128( \
+			_mm_and_si128(_mm_cmpeq_epi8(n, _mm_setzero_si128()), _mm_set1_epi8(0x0f)), \
+			background), \
+		_mm_slli_epi16(n, 4))
+
+static inline void draw_gtia11_simd(UWORD *ptr, ULONG data)
+{
+	__m128i background = _mm_set1_epi32((int) ANTIC_lookup_gtia9[0]);
+	__m128i n = simd_nibbles(data);
+	__m128i lo = _mm_unpacklo_epi8(n, n);
+	__m128i hi = _mm_unpackhi_epi8(n, n);
+	_mm_storeu_si128((__m128i *) ptr, SIMD_GTIA11(lo));
+	_mm_storeu_si128((__m128i *) ptr + 1, SIMD_GTIA11(hi));
+}
+
+#endif /* USE_COLOUR_TRANSLATION_TABLE */
+
+/* The next SIMD_CHARS bytes of screen data */
+#define SIMD_SCREENDATA (antic_memptr[0] | (antic_memptr[1] << 8) \
+	| (antic_memptr[2] << 16) | ((ULONG) antic_memptr[3] << 24))
+
+/* In GTIA 9 mode E pixels 0, 1, 2 and 3 are drawn like the 4-bit pixels
+   0, 0, 1 and 2 (mode_e_an_lookup), two per 4 bits of data */
+#define SIMD_MODE_E_GTIA9(data) ((data) - (((data) | ((data) >> 1)) & 0x55555555))
+
+/* Runs draw, which draws SIMD_CHARS bytes, at the start of a CHAR_LOOP
+   iteration if there are that many bytes left and no players or
+   missiles on them. The loop condition counts one. */
+#define SIMD_DRAW_CHARS(draw) \
+		if (nchars >= SIMD_CHARS && simd_pm_clear(t_pm_scanline_ptr)) { \
+			draw; \
+			antic_memptr += SIMD_CHARS; \
+			ptr += 4 * SIMD_CHARS; \
+			t_pm_scanline_ptr += SIMD_CHARS; \
+			nchars -= SIMD_CHARS - 1; \
+			continue; \
+		}
+
+#endif /* ANTIC_SIMD */
+
 #define DO_PMG_LORES PF_COLLS(colreg) |= pm_pixel = *c_pm_scanline_ptr++;\
 	WRITE_VIDEO(ptr++, COLOUR(pm_lookup_ptr[pm_pixel] | colreg));
 
@@ -1476,6 +1652,32 @@ static void draw_an_gtia_bug(const ULONG *t_pm_scanline_ptr)
 
 #endif /* PAGED_MEM */
 
+#ifdef ANTIC_SIMD_GTIA9_11
+/* The character data of the next SIMD_CHARS bytes of screen data */
+#ifdef PAGED_MEM
+#define SIMD_CHDATA_ANTIC_2 simd_chdata_antic_2(antic_memptr, t_chbase)
+static inline ULONG simd_chdata_antic_2(const UBYTE *antic_memptr, int t_chbase)
+#else
+#define SIMD_CHDATA_ANTIC_2 simd_chdata_antic_2(antic_memptr, chptr)
+static inline ULONG simd_chdata_antic_2(const UBYTE *antic_memptr, const UBYTE *chptr)
+#endif
+{
+	ULONG data = 0;
+	UBYTE screendata;
+	int chdata;
+#define SIMD_GET_CHDATA(i) \
+	screendata = antic_memptr[i]; \
+	GET_CHDATA_ANTIC_2 \
+	data |= (ULONG) chdata << (8 * i);
+	SIMD_GET_CHDATA(0)
+	SIMD_GET_CHDATA(1)
+	SIMD_GET_CHDATA(2)
+	SIMD_GET_CHDATA(3)
+#undef SIMD_GET_CHDATA
+	return data;
+}
+#endif /* ANTIC_SIMD_GTIA9_11 */
+
 static void draw_antic_2(int nchars, const UBYTE *antic_memptr, UWORD *ptr, const ULONG *t_pm_scanline_ptr)
 {
 	INIT_BACKGROUND_6
@@ -1483,9 +1685,10 @@ static void draw_antic_2(int nchars, const UBYTE *antic_memptr, UWORD *ptr, cons
 	INIT_HIRES
 
 	CHAR_LOOP_BEGIN
-		UBYTE screendata = *antic_memptr++;
+		UBYTE screendata;
 		int chdata;
 
+		screendata = *antic_memptr++;
 		GET_CHDATA_ANTIC_2
 		if (IS_ZERO_ULONG(t_pm_scanline_ptr)) {
 			if (chdata) {
@@ -1612,7 +1815,7 @@ static void draw_antic_2_artif_new(int nchars, const UBYTE *antic_memptr, UWORD
 
 static void prepare_an_antic_2(int nchars, const UBYTE *antic_memptr, const ULONG *t_pm_scanline_ptr)
 {
-	UBYTE *an_ptr = (UBYTE *) t_pm_scanline_ptr + (an_scanline - GTIA_pm_scanline);
+	UBYTE *an_ptr = (UBYTE *) t_pm_scanline_ptr + (an_scanline - PM_SCANLINE);
 #ifdef PAGED_MEM
 	int t_chbase = (dctr ^ chbase_20) & 0xfc07;
 #else
@@ -1644,9 +1847,13 @@ static void draw_antic_2_gtia9(int nchars, const UBYTE *antic_memptr, UWORD *ptr
 	}
 
 	CHAR_LOOP_BEGIN
-		UBYTE screendata = *antic_memptr++;
+		UBYTE screendata;
 		int chdata;
 
+#ifdef ANTIC_SIMD_GTIA9_11
+		SIMD_DRAW_CHARS(draw_gtia9_simd(ptr, SIMD_CHDATA_ANTIC_2))
+#endif
+		screendata = *antic_memptr++;
 		GET_CHDATA_ANTIC_2
 		WRITE_VIDEO_LONG((ULONG *) ptr, ANTIC_lookup_gtia9[chdata >> 4]);
 		WRITE_VIDEO_LONG((ULONG *) ptr + 1, ANTIC_lookup_gtia9[chdata & 0xf]);
@@ -1718,9 +1925,10 @@ static void draw_antic_2_gtia10(int nchars, const UBYTE *antic_memptr, UWORD *pt
 	ptr++;
 	t_pm_scanline_ptr = (const ULONG *) (((const UBYTE *) t_pm_scanline_ptr) + 1);
 	CHAR_LOOP_BEGIN
-		UBYTE screendata = *antic_memptr++;
+		UBYTE screendata;
 		int chdata;
 
+		screendata = *antic_memptr++;
 		GET_CHDATA_ANTIC_2
 		if (IS_ZERO_ULONG(t_pm_scanline_ptr)) {
 			DO_GTIA_BYTE(ptr, lookup_gtia10, chdata)
@@ -1756,9 +1964,13 @@ static void draw_antic_2_gtia11(int nchars, const UBYTE *antic_memptr, UWORD *pt
 	}
 
 	CHAR_LOOP_BEGIN
-		UBYTE screendata = *antic_memptr++;
+		UBYTE screendata;
 		int chdata;
 
+#ifdef ANTIC_SIMD_GTIA9_11
+		SIMD_DRAW_CHARS(draw_gtia11_simd(ptr, SIMD_CHDATA_ANTIC_2))
+#endif
+		screendata = *antic_memptr++;
 		GET_CHDATA_ANTIC_2
 		WRITE_VIDEO_LONG((ULONG *) ptr, ANTIC_lookup_gtia11[chdata >> 4]);
 		WRITE_VIDEO_LONG((ULONG *) ptr + 1, ANTIC_lookup_gtia11[chdata & 0xf]);
@@ -1822,9 +2034,10 @@ static void draw_antic_4(int nchars, const UBYTE *antic_memptr, UWORD *ptr, cons
 	lookup2[0xcf] = lookup2[0x3f] = lookup2[0x1b] = lookup2[0x12] = ANTIC_cl[C_PF3];
 
 	CHAR_LOOP_BEGIN
-		UBYTE screendata = *antic_memptr++;
+		UBYTE screendata;
 		const UWORD *lookup;
 		UBYTE chdata;
+		screendata = *antic_memptr++;
 		if (screendata & 0x80)
 			lookup = lookup2 + 0xf;
 		else
@@ -1864,7 +2077,7 @@ static void draw_antic_4(int nchars, const UBYTE *antic_memptr, UWORD *ptr, cons
 
 static void prepare_an_antic_4(int nchars, const UBYTE *antic_memptr, const ULONG *t_pm_scanline_ptr)
 {
-	UBYTE *an_ptr = (UBYTE *) t_pm_scanline_ptr + (an_scanline - GTIA_pm_scanline);
+	UBYTE *an_ptr = (UBYTE *) t_pm_scanline_ptr + (an_scanline - PM_SCANLINE);
 #ifdef PAGED_MEM
 	UWORD t_chbase = ((anticmode == 4 ? dctr : dctr >> 1) ^ chbase_20) & 0xfc07;
 #else
@@ -1979,7 +2192,7 @@ static void draw_antic_6(int nchars, const UBYTE *antic_memptr, UWORD *ptr, cons
 
 static void prepare_an_antic_6(int nchars, const UBYTE *antic_memptr, const ULONG *t_pm_scanline_ptr)
 {
-	UBYTE *an_ptr = (UBYTE *) t_pm_scanline_ptr + (an_scanline - GTIA_pm_scanline);
+	UBYTE *an_ptr = (UBYTE *) t_pm_scanline_ptr + (an_scanline - PM_SCANLINE);
 #ifdef PAGED_MEM
 	UWORD t_chbase = (anticmode == 6 ? dctr & 7 : dctr >> 1) ^ chbase_20;
 #else
@@ -2050,7 +2263,7 @@ static void draw_antic_8(int nchars, const UBYTE *antic_memptr, UWORD *ptr, cons
 
 static void prepare_an_antic_8(int nchars, const UBYTE *antic_memptr, const ULONG *t_pm_scanline_ptr)
 {
-	UBYTE *an_ptr = (UBYTE *) t_pm_scanline_ptr + (an_scanline - GTIA_pm_scanline);
+	UBYTE *an_ptr = (UBYTE *) t_pm_scanline_ptr + (an_scanline - PM_SCANLINE);
 	CHAR_LOOP_BEGIN
 		UBYTE screendata = *antic_memptr++;
 		int kk = 4;
@@ -2156,7 +2369,7 @@ static void draw_antic_a(int nchars, const UBYTE *antic_memptr, UWORD *ptr, cons
 
 static void prepare_an_antic_a(int nchars, const UBYTE *antic_memptr, const ULONG *t_pm_scanline_ptr)
 {
-	UBYTE *an_ptr = (UBYTE *) t_pm_scanline_ptr + (an_scanline - GTIA_pm_scanline);
+	UBYTE *an_ptr = (UBYTE *) t_pm_scanline_ptr + (an_scanline - PM_SCANLINE);
 	CHAR_LOOP_BEGIN
 		UBYTE screendata = *antic_memptr++;
 		UBYTE data = mode_e_an_lookup[screendata & 0xc0];
@@ -2210,14 +2423,25 @@ static void draw_antic_c(int nchars, const UBYTE *antic_memptr, UWORD *ptr, cons
 
 static void draw_antic_e(int nchars, const UBYTE *antic_memptr, UWORD *ptr, const ULONG *t_pm_scanline_ptr)
 {
+#ifdef ANTIC_SIMD
+	simd_2bpp_t simd;
+#endif
 	INIT_BACKGROUND_8
 	lookup2[0x00] = ANTIC_cl[C_BAK];
 	lookup2[0x40] = lookup2[0x10] = lookup2[0x04] = lookup2[0x01] = ANTIC_cl[C_PF0];
 	lookup2[0x80] = lookup2[0x20] = lookup2[0x08] = lookup2[0x02] = ANTIC_cl[C_PF1];
 	lookup2[0xc0] = lookup2[0x30] = lookup2[0x0c] = lookup2[0x03] = ANTIC_cl[C_PF2];
+#ifdef ANTIC_SIMD
+	simd_2bpp_colours(&simd, lookup2[0x00], lookup2[0x40], lookup2[0x80], lookup2[0xc0],
+		BACKGROUND_WORD(C_BAK));
+#endif
 
 	CHAR_LOOP_BEGIN
-		UBYTE screendata = *antic_memptr++;
+		UBYTE screendata;
+#ifdef ANTIC_SIMD
+		SIMD_DRAW_CHARS(draw_2bpp_simd(&simd, ptr, SIMD_SCREENDATA))
+#endif
+		screendata = *antic_memptr++;
 		if (IS_ZERO_ULONG(t_pm_scanline_ptr)) {
 			if (screendata) {
 				WRITE_VIDEO(ptr++, lookup2[screendata & 0xc0]);
@@ -2247,7 +2471,7 @@ static void draw_antic_e(int nchars, const UBYTE *antic_memptr, UWORD *ptr, cons
 
 static void prepare_an_antic_e(int nchars, const UBYTE *antic_memptr, const ULONG *t_pm_scanline_ptr)
 {
-	UBYTE *an_ptr = (UBYTE *) t_pm_scanline_ptr + (an_scanline - GTIA_pm_scanline);
+	UBYTE *an_ptr = (UBYTE *) t_pm_scanline_ptr + (an_scanline - PM_SCANLINE);
 	CHAR_LOOP_BEGIN
 		UBYTE screendata = *antic_memptr++;
 		*an_ptr++ = mode_e_an_lookup[screendata & 0xc0];
@@ -2275,7 +2499,11 @@ static void draw_antic_e_gtia9(int nchars, const UBYTE *antic_memptr, UWORD *ptr
 	lookup[14] = ANTIC_lookup_gtia9[9];
 	lookup[15] = ANTIC_lookup_gtia9[10];
 	CHAR_LOOP_BEGIN
-		UBYTE screendata = *antic_memptr++;
+		UBYTE screendata;
+#ifdef ANTIC_SIMD_GTIA9_11
+		SIMD_DRAW_CHARS(draw_gtia9_simd(ptr, SIMD_MODE_E_GTIA9(SIMD_SCREENDATA)))
+#endif
+		screendata = *antic_memptr++;
 		WRITE_VIDEO_LONG((ULONG *) ptr, lookup[screendata >> 4]);
 		WRITE_VIDEO_LONG((ULONG *) ptr + 1, lookup[screendata & 0xf]);
 		if (IS_ZERO_ULONG(t_pm_scanline_ptr))
@@ -2321,11 +2549,22 @@ static void draw_antic_e_gtia11 (int nchars, const UBYTE *antic_memptr, UWORD *p
 
 static void draw_antic_f(int nchars, const UBYTE *antic_memptr, UWORD *ptr, const ULONG *t_pm_scanline_ptr)
 {
+#ifdef ANTIC_SIMD
+	simd_2bpp_t simd;
+#endif
 	INIT_BACKGROUND_6
 	INIT_HIRES
+#ifdef ANTIC_SIMD
+	simd_2bpp_colours(&simd, hires_norm(0x00), hires_norm(0x40), hires_norm(0x80), hires_norm(0xc0),
+		BACKGROUND_WORD(C_PF2));
+#endif
 
 	CHAR_LOOP_BEGIN
-		int screendata = *antic_memptr++;
+		int screendata;
+#ifdef ANTIC_SIMD
+		SIMD_DRAW_CHARS(draw_2bpp_simd(&simd, ptr, SIMD_SCREENDATA))
+#endif
+		screendata = *antic_memptr++;
 		if (IS_ZERO_ULONG(t_pm_scanline_ptr)) {
 			if (screendata) {
 				WRITE_VIDEO(ptr++, hires_norm(screendata & 0xc0));
@@ -2393,7 +2632,7 @@ static void draw_antic_f_artif_new(int nchars, const UBYTE *antic_memptr, UWORD
 
 static void prepare_an_antic_f(int nchars, const UBYTE *antic_memptr, const ULONG *t_pm_scanline_ptr)
 {
-	UBYTE *an_ptr = (UBYTE *) t_pm_scanline_ptr + (an_scanline - GTIA_pm_scanline);
+	UBYTE *an_ptr = (UBYTE *) t_pm_scanline_ptr + (an_scanline - PM_SCANLINE);
 	CHAR_LOOP_BEGIN
 		UBYTE screendata = *antic_memptr++;
 		*an_ptr++ = screendata >> 6;
@@ -2411,7 +2650,11 @@ static void draw_antic_f_gtia9(int nchars, const UBYTE *antic_memptr, UWORD *ptr
 		return;
 	}
 	CHAR_LOOP_BEGIN
-		UBYTE screendata = *antic_memptr++;
+		UBYTE screendata;
+#ifdef ANTIC_SIMD_GTIA9_11
+		SIMD_DRAW_CHARS(draw_gtia9_simd(ptr, SIMD_SCREENDATA))
+#endif
+		screendata = *antic_memptr++;
 		WRITE_VIDEO_LONG((ULONG *) ptr, ANTIC_lookup_gtia9[screendata >> 4]);
 		WRITE_VIDEO_LONG((ULONG *) ptr + 1, ANTIC_lookup_gtia9[screendata & 0xf]);
 		if (IS_ZERO_ULONG(t_pm_scanline_ptr))
@@ -2479,7 +2722,8 @@ static void draw_antic_f_gtia10(int nchars, const UBYTE *antic_memptr, UWORD *pt
 	ptr++;
 	t_pm_scanline_ptr = (const ULONG *) (((const UBYTE *) t_pm_scanline_ptr) + 1);
 	CHAR_LOOP_BEGIN
-		UBYTE screendata = *antic_memptr++;
+		UBYTE screendata;
+		screendata = *antic_memptr++;
 		if (IS_ZERO_ULONG(t_pm_scanline_ptr)) {
 			DO_GTIA_BYTE(ptr, lookup_gtia10, screendata)
 			ptr += 4;
@@ -2512,7 +2756,11 @@ static void draw_antic_f_gtia11(int nchars, const UBYTE *antic_memptr, UWORD *pt
 		return;
 	}
 	CHAR_LOOP_BEGIN
-		UBYTE screendata = *antic_memptr++;
+		UBYTE screendata;
+#ifdef ANTIC_SIMD_GTIA9_11
+		SIMD_DRAW_CHARS(draw_gtia11_simd(ptr, SIMD_SCREENDATA))
+#endif
+		screendata = *antic_memptr++;
 		WRITE_VIDEO_LONG((ULONG *) ptr, ANTIC_lookup_gtia11[screendata >> 4]);
 		WRITE_VIDEO_LONG((ULONG *) ptr + 1, ANTIC_lookup_gtia11[screendata & 0xf]);
 		if (IS_ZERO_ULONG(t_pm_scanline_ptr))
@@ -2601,7 +2849,7 @@ static void draw_antic_f_gtia_bug(int nchars, const UBYTE *antic_memptr, UWORD *
 typedef void (*draw_antic_function)(int nchars, const UBYTE *antic_memptr, UWORD *ptr, const ULONG *t_pm_scanline_ptr);
 
 /* tables for all GTIA and ANTIC modes */
-static draw_antic_function draw_antic_table[4][16] = {
+static THREAD_LOCAL draw_antic_function draw_antic_table[4][16] = {
 /* normal */
 		{ NULL,			NULL,			draw_antic_2,	draw_antic_2,
 		draw_antic_4,	draw_antic_4,	draw_antic_6,	draw_antic_6,
@@ -2624,12 +2872,12 @@ static draw_antic_function draw_antic_table[4][16] = {
 		draw_antic_9_gtia11,	draw_antic_e_gtia11,	draw_antic_e_gtia11,	draw_antic_f_gtia11}};
 
 /* pointer to current GTIA/ANTIC mode routine */
-static draw_antic_function draw_antic_ptr = draw_antic_8;
+static THREAD_LOCAL draw_antic_function draw_antic_ptr = draw_antic_8;
 #ifdef NEW_CYCLE_EXACT
 static draw_antic_function saved_draw_antic_ptr;
 #endif
 /* pointer to current GTIA mode blank drawing routine */
-static void (*draw_antic_0_ptr)(void) = draw_antic_0;
+static THREAD_LOCAL void (*draw_antic_0_ptr)(void) = draw_antic_0;
 
 #ifdef NEW_CYCLE_EXACT
 /* wrapper for antic_0, for dmactl bugs */
@@ -2693,6 +2941,14 @@ void ANTIC_UpdateArtifacting(void)
 
 	art_colours = (ANTIC_artif_mode <= 4 ? art_colour_table[ANTIC_artif_mode - 1] : art_colour_table[2]);
 
+	if (art_curtable == NULL) {
+		/* start with the normal tables */
+		art_colpf1_save = &art_normal_colpf1_save;
+		art_colpf2_save = &art_normal_colpf2_save;
+		art_curtable = art_lookup_normal;
+		art_curlummask = art_lummask_normal;
+		art_curbkmask = art_bkmask_normal;
+	}
 	art_reverse_colpf1_save = art_normal_colpf1_save = ANTIC_cl[C_PF1] & 0x0f0f;
 	art_reverse_colpf2_save = art_normal_colpf2_save = ANTIC_cl[C_PF2];
 	art_white = (ANTIC_cl[C_PF2] & 0xf0) | (ANTIC_cl[C_PF1] & 0x0f);
@@ -2867,6 +3123,7 @@ void ANTIC_Frame(int draw_display)
 	int cpu2antic_index;
 #endif /* NEW_CYCLE_EXACT */
 
+	PROFILE_SWITCH(PROFILE_CPU);
 	ANTIC_ypos = 0;
 	do {
 		POKEY_Scanline();		/* check and generate IRQ */
@@ -3064,7 +3321,7 @@ void ANTIC_Frame(int draw_display)
 		}
 #ifndef NO_YPOS_BREAK_FLICKER
 #define YPOS_BREAK_FLICKER do{if (ANTIC_ypos == ANTIC_break_ypos - 1000) {\
-				static int toggle;\
+				static THREAD_LOCAL int toggle;\
 				if (toggle == 1) {\
 					FILL_VIDEO(scrn_ptr + LBORDER_START, 0x0f0f, (RBORDER_END - LBORDER_START) * 2);\
 				}\
@@ -3075,10 +3332,14 @@ void ANTIC_Frame(int draw_display)
 #endif /* NO_YPOS_BREAK_FLICKER */
 
 #ifdef NEW_CYCLE_EXACT
+		PROFILE_SWITCH(PROFILE_GTIA);
 		GTIA_NewPmScanline();
+		PROFILE_SWITCH(PROFILE_CPU);
 		if (anticmode < 2 || (ANTIC_DMACTL & 3) == 0) {
 			GOEOL_CYCLE_EXACT;
+			PROFILE_SWITCH(PROFILE_ANTIC);
 			draw_partial_scanline(ANTIC_cur_screen_pos, RBORDER_END);
+			PROFILE_SWITCH(PROFILE_CPU);
 			UPDATE_DMACTL;
 			UPDATE_GTIA_BUG;
 			ANTIC_cur_screen_pos = ANTIC_NOT_DRAWING;
@@ -3092,7 +3353,9 @@ void ANTIC_Frame(int draw_display)
 		}
 
 		GOEOL_CYCLE_EXACT;
+		PROFILE_SWITCH(PROFILE_ANTIC);
 		draw_partial_scanline(ANTIC_cur_screen_pos, RBORDER_END);
+		PROFILE_SWITCH(PROFILE_CPU);
 		UPDATE_DMACTL;
 		UPDATE_GTIA_BUG;
 		ANTIC_cur_screen_pos = ANTIC_NOT_DRAWING;
@@ -3102,12 +3365,19 @@ void ANTIC_Frame(int draw_display)
 			ANTIC_xpos += before_cycles[md];
 
 		CPU_GO(SCR_C);
+		PROFILE_SWITCH(PROFILE_GTIA);
 		GTIA_NewPmScanline();
+		PROFILE_SWITCH(PROFILE_CPU);
 
 		ANTIC_xpos += ANTIC_DMAR;
 
 		if (anticmode < 2 || (ANTIC_DMACTL & 3) == 0) {
-			draw_antic_0_ptr();
+			/* blank lines never generate collisions */
+			if (!ANTIC_no_pixels) {
+				PROFILE_SWITCH(PROFILE_ANTIC);
+				draw_antic_0_ptr();
+				PROFILE_SWITCH(PROFILE_CPU);
+			}
 			GOEOL;
 			YPOS_BREAK_FLICKER;
 			scrn_ptr += Screen_WIDTH / 2;
@@ -3134,10 +3404,18 @@ void ANTIC_Frame(int draw_display)
 				ANTIC_xpos -= extra_cycles[md];
 		}
 
-		draw_antic_ptr(chars_displayed[md],
-			antic_memory + ANTIC_margin + ch_offset[md],
-			scrn_ptr + x_min[md],
-			(ULONG *) &GTIA_pm_scanline[x_min[md]]);
+		/* playfield collisions need players or missiles on the line */
+		if (!ANTIC_no_pixels || GTIA_pm_dirty) {
+			PROFILE_SWITCH(PROFILE_ANTIC);
+			draw_antic_ptr(chars_displayed[md],
+				antic_memory + ANTIC_margin + ch_offset[md],
+				scrn_ptr + x_min[md],
+				(ULONG *) &GTIA_pm_scanline[x_min[md]]);
+			PROFILE_SWITCH(PROFILE_CPU);
+		}
+		else if (anticmode < 8)
+			/* the character mode renderers account for the font DMA */
+			ANTIC_xpos += font_cycles[md];
 
 		GOEOL;
 #endif /* NEW_CYCLE_EXACT */
@@ -3149,11 +3427,12 @@ void ANTIC_Frame(int draw_display)
 
 #ifndef NO_SIMPLE_PAL_BLENDING
 	/* Simple PAL blending, using only the base 256 color palette. */
-	if (ANTIC_pal_blending)
+	if (ANTIC_pal_blending && !ANTIC_no_pixels)
 	{
 		int ypos = ANTIC_ypos - 1;
 		/* Start at the last screen line (248). */
 		ULONG *ptr = (ULONG *) (scrn_ptr - 4 * RCHOP);
+		PROFILE_SWITCH(PROFILE_ANTIC);
 		do {
 			int k = 2 * (48 - LCHOP - RCHOP);
 			do {
@@ -3175,6 +3454,7 @@ void ANTIC_Frame(int draw_display)
 			} while (--k);
 			ptr -= 2 * (LCHOP + RCHOP); /* Move one line up */
 		} while (--ypos > 8); /* Stop after line 9 */
+		PROFILE_SWITCH(PROFILE_CPU);
 	}
 #endif /* NO_SIMPLE_PAL_BLENDING */
 
@@ -3194,6 +3474,7 @@ void ANTIC_Frame(int draw_display)
 		OVERSCREEN_LINE;
 	} while (ANTIC_ypos < Atari800_tv_mode);
 	ANTIC_ypos = 0; /* just for monitor.c */
+	PROFILE_SWITCH(PROFILE_OTHER);
 }
 
 #ifdef NEW_CYCLE_EXACT
@@ -23,30 +23,30 @@
 #define ANTIC_OFFSET_NMIRES 0x0f
 #define ANTIC_OFFSET_NMIST 0x0f
 
-extern UBYTE ANTIC_CHACTL;
-extern UBYTE ANTIC_CHBASE;
-extern UWORD ANTIC_dlist;
-extern UBYTE ANTIC_DMACTL;
-extern UBYTE ANTIC_HSCROL;
-extern UBYTE ANTIC_NMIEN;
-extern UBYTE ANTIC_NMIST;
-extern UBYTE ANTIC_PMBASE;
-extern UBYTE ANTIC_VSCROL;
-
-extern int ANTIC_break_ypos;
-extern int ANTIC_ypos;
-extern int ANTIC_wsync_halt;
+extern THREAD_LOCAL UBYTE ANTIC_CHACTL;
+extern THREAD_LOCAL UBYTE ANTIC_CHBASE;
+extern THREAD_LOCAL UWORD ANTIC_dlist;
+extern THREAD_LOCAL UBYTE ANTIC_DMACTL;
+extern THREAD_LOCAL UBYTE ANTIC_HSCROL;
+extern THREAD_LOCAL UBYTE ANTIC_NMIEN;
+extern THREAD_LOCAL UBYTE ANTIC_NMIST;
+extern THREAD_LOCAL UBYTE ANTIC_PMBASE;
+extern THREAD_LOCAL UBYTE ANTIC_VSCROL;
+
+extern THREAD_LOCAL int ANTIC_break_ypos;
+extern THREAD_LOCAL int ANTIC_ypos;
+extern THREAD_LOCAL int ANTIC_wsync_halt;
 
 /* Current clock cycle in a scanline.
    Normally 0 <= ANTIC_xpos && ANTIC_xpos < ANTIC_LINE_C, but in some cases ANTIC_xpos >= ANTIC_LINE_C,
    which means that we are already in line (ypos + 1). */
-extern int ANTIC_xpos;
+extern THREAD_LOCAL int ANTIC_xpos;
 
 /* ANTIC_xpos limit for the currently running 6502 emulation. */
-extern int ANTIC_xpos_limit;
+extern THREAD_LOCAL int ANTIC_xpos_limit;
 
 /* Main clock value at the beginning of the current scanline. */
-extern unsigned int ANTIC_screenline_cpu_clock;
+extern THREAD_LOCAL unsigned int ANTIC_screenline_cpu_clock;
 
 /* Current main clock value. */
 #define ANTIC_CPU_CLOCK (ANTIC_screenline_cpu_clock + ANTIC_XPOS)
@@ -65,11 +65,11 @@ extern unsigned int ANTIC_screenline_cpu_clock;
    memory refresh cycles. */
 #define ANTIC_DMAR     9
 
-extern int ANTIC_artif_mode;
-extern int ANTIC_artif_new;
+extern THREAD_LOCAL int ANTIC_artif_mode;
+extern THREAD_LOCAL int ANTIC_artif_new;
 
-extern UBYTE ANTIC_PENH_input;
-extern UBYTE ANTIC_PENV_input;
+extern THREAD_LOCAL UBYTE ANTIC_PENH_input;
+extern THREAD_LOCAL UBYTE ANTIC_PENV_input;
 
 int ANTIC_Initialise(int *argc, char *argv[]);
 void ANTIC_Reset(void);
@@ -97,21 +97,21 @@ void ANTIC_StateRead(void);
 /* Pointer to 16 KB seen by ANTIC in 0x4000-0x7fff.
    If it's the same what the CPU sees (and what's in memory[0x4000..0x7fff],
    then NULL. */
-extern const UBYTE *ANTIC_xe_ptr;
+extern THREAD_LOCAL const UBYTE *ANTIC_xe_ptr;
 
 /* PM graphics for GTIA */
-extern int ANTIC_player_dma_enabled;
-extern int ANTIC_missile_dma_enabled;
-extern int ANTIC_player_gra_enabled;
-extern int ANTIC_missile_gra_enabled;
-extern int ANTIC_player_flickering;
-extern int ANTIC_missile_flickering;
+extern THREAD_LOCAL int ANTIC_player_dma_enabled;
+extern THREAD_LOCAL int ANTIC_missile_dma_enabled;
+extern THREAD_LOCAL int ANTIC_player_gra_enabled;
+extern THREAD_LOCAL int ANTIC_missile_gra_enabled;
+extern THREAD_LOCAL int ANTIC_player_flickering;
+extern THREAD_LOCAL int ANTIC_missile_flickering;
 
 /* ANTIC colour lookup tables, used by GTIA */
-extern UWORD ANTIC_cl[128];
-extern ULONG ANTIC_lookup_gtia9[16];
-extern ULONG ANTIC_lookup_gtia11[16];
-extern UWORD ANTIC_hires_lookup_l[128];
+extern THREAD_LOCAL UWORD ANTIC_cl[128];
+extern THREAD_LOCAL ULONG ANTIC_lookup_gtia9[16];
+extern THREAD_LOCAL ULONG ANTIC_lookup_gtia11[16];
+extern THREAD_LOCAL UWORD ANTIC_hires_lookup_l[128];
 
 #ifdef NEW_CYCLE_EXACT
 #define ANTIC_NOT_DRAWING -999
@@ -131,7 +131,13 @@ void ANTIC_UpdateScanlinePrior(UBYTE byte);
 #ifndef NO_SIMPLE_PAL_BLENDING
 /* Set to 1 to enable simplified emulation of PAL blending, that uses only
    the standard 8-bit palette. */
-extern int ANTIC_pal_blending;
+extern THREAD_LOCAL int ANTIC_pal_blending;
 #endif /* NO_SIMPLE_PAL_BLENDING */
 
+/* If TRUE, ANTIC_Frame(TRUE) keeps the DMA timing, NMIs and collisions of a
+   drawn frame, but leaves Screen_atari undefined. Only scanlines with
+   players or missiles on them are rendered, to detect collisions.
+   Has no effect with NEW_CYCLE_EXACT. */
+extern THREAD_LOCAL int ANTIC_no_pixels;
+
 #endif /* ANTIC_H_ */
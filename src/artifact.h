@@ -4,6 +4,7 @@
 #include <stdio.h>
 
 #include "config.h"
+#include "atari.h"
 
 typedef enum ARTIFACT_t {
 	ARTIFACT_NONE,       /* Artifacting disabled */
@@ -22,7 +23,7 @@ typedef enum ARTIFACT_t {
 } ARTIFACT_t;
 
 /* The currently used artifact emulation mode. Use ARTIFACT_Set to change this value. */
-extern ARTIFACT_t ARTIFACT_mode;
+extern THREAD_LOCAL ARTIFACT_t ARTIFACT_mode;
 
 /* Set artifacting mode for the current TV system. */
 void ARTIFACT_Set(ARTIFACT_t mode);
@@ -78,6 +78,7 @@
 #ifdef POKEYREC
 #include "pokeyrec.h"
 #endif
+#include "profile.h"
 #include "pia.h"
 #include "platform.h"
 #include "pokey.h"
@@ -151,29 +152,29 @@
 #include "win32\main.h"
 #endif
 
-int Atari800_machine_type = Atari800_MACHINE_XLXE;
+THREAD_LOCAL int Atari800_machine_type = Atari800_MACHINE_XLXE;
 
-int Atari800_builtin_basic = TRUE;
-int Atari800_keyboard_leds = FALSE;
-int Atari800_f_keys = FALSE;
-int Atari800_jumper;
-int Atari800_builtin_game = FALSE;
-int Atari800_keyboard_detached = FALSE;
+THREAD_LOCAL int Atari800_builtin_basic = TRUE;
+THREAD_LOCAL int Atari800_keyboard_leds = FALSE;
+THREAD_LOCAL int Atari800_f_keys = FALSE;
+THREAD_LOCAL int Atari800_jumper;
+THREAD_LOCAL int Atari800_builtin_game = FALSE;
+THREAD_LOCAL int Atari800_keyboard_detached = FALSE;
 
-int Atari800_tv_mode = Atari800_TV_PAL;
-int Atari800_disable_basic = TRUE;
+THREAD_LOCAL int Atari800_tv_mode = Atari800_TV_PAL;
+THREAD_LOCAL int Atari800_disable_basic = TRUE;
 
-int Atari800_os_version = -1;
+THREAD_LOCAL int Atari800_os_version = -1;
 
-int verbose = FALSE;
+THREAD_LOCAL int verbose = FALSE;
 
-int Atari800_display_screen = FALSE;
-int Atari800_nframes = 0;
-int Atari800_refresh_rate = 1;
-int Atari800_collisions_in_skipped_frames = FALSE;
-int Atari800_turbo = FALSE;
-int Atari800_start_in_monitor = FALSE;
-int Atari800_auto_frameskip = FALSE;
+THREAD_LOCAL int Atari800_display_screen = FALSE;
+THREAD_LOCAL int Atari800_nframes = 0;
+THREAD_LOCAL int Atari800_refresh_rate = 1;
+THREAD_LOCAL int Atari800_collisions_in_skipped_frames = FALSE;
+THREAD_LOCAL int Atari800_turbo = FALSE;
+THREAD_LOCAL int Atari800_start_in_monitor = FALSE;
+THREAD_LOCAL int Atari800_auto_frameskip = FALSE;
 
 #ifdef BENCHMARK
 static double benchmark_start_time;
@@ -776,6 +777,9 @@ int Atari800_Initialise(int *argc, char *argv[])
 #endif
 #ifdef POKEYREC
 		|| !POKEYREC_Initialise(argc, argv)
+#endif
+#ifdef PROFILER
+		|| !Profile_Initialise(argc, argv)
 #endif
 		|| !SIO_Initialise (argc, argv)
 		|| !CARTRIDGE_Initialise(argc, argv)
@@ -1035,6 +1039,9 @@ int Atari800_Exit(int run_monitor)
 #endif
 #ifdef POKEYREC
 		POKEYREC_Exit();
+#endif
+#ifdef PROFILER
+		Profile_Exit();
 #endif
 		Devices_Exit();
 #ifdef R_IO_DEVICE
@@ -1273,8 +1280,14 @@ static void basic_frame(void)
 void Atari800_Frame(void)
 {
 #ifndef BASIC
-	static int refresh_counter = 0;
+	static THREAD_LOCAL int refresh_counter = 0;
+#endif
 
+#ifdef PROFILER
+	Profile_Frame();
+#endif
+
+#ifndef BASIC
 #ifdef CTRL_C_HANDLER
 	if (sigint_flag) {
 		sigint_flag = FALSE;
@@ -1330,6 +1343,7 @@ void Atari800_Frame(void)
 	VOTRAXSND_Frame(); /* for the Votrax */
 #endif
 	Devices_Frame();
+	SIO_Frame();
 #ifndef BASIC
 	INPUT_Frame();
 #endif
@@ -1349,6 +1363,9 @@ void Atari800_Frame(void)
 		ANTIC_Frame(TRUE);
 		INPUT_DrawMousePointer();
 		Screen_DrawAtariSpeed(Util_time());
+#ifdef SYNCHRONIZED_SOUND
+		Screen_DrawSoundStats(Util_time());
+#endif
 		Screen_DrawDiskLED();
 		Screen_Draw1200LED();
 #endif /* CURSES_BASIC */
@@ -1367,13 +1384,17 @@ void Atari800_Frame(void)
 		Atari800_display_screen = FALSE;
 	}
 #endif /* BASIC */
+	PROFILE_SWITCH(PROFILE_POKEY);
 	POKEY_Frame();
 #ifdef VIDEO_RECORDING
+	PROFILE_SWITCH(PROFILE_OTHER);
 	File_Export_WriteVideo();
+	PROFILE_SWITCH(PROFILE_POKEY);
 #endif
 #ifdef SOUND
 	Sound_Update();
 #endif
+	PROFILE_SWITCH(PROFILE_OTHER);
 #if defined(AUDIO_RECORDING) || defined(VIDEO_RECORDING)
 	/* multimedia stats are drawn here so they don't get recorded in the video */
 	Screen_DrawMultimediaStats();
@@ -1404,8 +1425,11 @@ void Atari800_Frame(void)
 			else
 				Atari800_display_screen = FALSE;
 		}
-		else
+		else {
+			PROFILE_SWITCH(PROFILE_SYNC);
 			Atari800_Sync();
+			PROFILE_SWITCH(PROFILE_OTHER);
+		}
 #endif /* BENCHMARK */
 #endif /* LIBATARI800 */
 }
@@ -1553,7 +1577,7 @@ void Atari800_SetTVMode(int mode)
 #ifdef SOUND
 #ifdef SOUND_THIN_API
 		if (Sound_enabled)
-			POKEYSND_Init(POKEYSND_FREQ_17_EXACT, Sound_out.freq, Sound_out.channels, Sound_out.sample_size == 2 ? POKEYSND_BIT16 : 0);
+			POKEYSND_Init(POKEYSND_FREQ_17_EXACT, Sound_out.freq, Sound_out.channels, Sound_PokeyFlags(Sound_out.sample_size));
 #elif defined(SUPPORTS_SOUND_REINIT)
 		Sound_Reinit();
 #endif /* defined(SUPPORTS_SOUND_REINIT) */
@@ -50,7 +50,7 @@
 
 /* #define DEBUG 1 */
 
-int CARTRIDGE_autoreboot = TRUE;
+THREAD_LOCAL int CARTRIDGE_autoreboot = TRUE;
 
 static int CartIsFor5200(int type)
 {
@@ -78,13 +78,13 @@ static int CartIsPassthrough(int type)
 	       type == CARTRIDGE_ATRAX_SDX_64 || type == CARTRIDGE_ATRAX_SDX_128;
 }
 
-CARTRIDGE_image_t CARTRIDGE_main = { CARTRIDGE_NONE, 0, 0, NULL, "" }; /* Left/Right cartridge */
-CARTRIDGE_image_t CARTRIDGE_piggyback = { CARTRIDGE_NONE, 0, 0, NULL, "" }; /* Pass through cartridge for SpartaDOSX */
+THREAD_LOCAL CARTRIDGE_image_t CARTRIDGE_main = { CARTRIDGE_NONE, 0, 0, NULL, "" }; /* Left/Right cartridge */
+THREAD_LOCAL CARTRIDGE_image_t CARTRIDGE_piggyback = { CARTRIDGE_NONE, 0, 0, NULL, "" }; /* Pass through cartridge for SpartaDOSX */
 
 /* The currently active cartridge in the left slot - normally points to
    CARTRIDGE_main but can be switched to CARTRIDGE_piggyback if the main
    cartridge is a SpartaDOS X. */
-static CARTRIDGE_image_t *active_cart = &CARTRIDGE_main;
+static THREAD_LOCAL CARTRIDGE_image_t *active_cart;
 
 /* DB_32, XEGS_32, XEGS_07_64, XEGS_128, XEGS_256, XEGS_512, XEGS_1024,
    SWXEGS_32, SWXEGS_64, SWXEGS_128, SWXEGS_256, SWXEGS_512, SWXEGS_1024 */
@@ -1587,6 +1587,7 @@ int CARTRIDGE_Initialise(int *argc, char *argv[])
 	int type_from_commandline = FALSE;
 	int type2_from_commandline = FALSE;
 
+	active_cart = &CARTRIDGE_main;
 	for (i = j = 1; i < *argc; i++) {
 		int i_a = (i + 1 < *argc); /* is argument available? */
 		int a_m = FALSE; /* error, argument missing! */
@@ -1678,6 +1679,13 @@ void CARTRIDGE_Exit(void)
 
 #ifndef BASIC
 
+/* Returns TRUE if CART already holds the image FILENAME of type TYPE, so a
+   rewind state can be loaded without reading the image again. */
+static int IsInserted(CARTRIDGE_image_t const *cart, const char *filename, int type)
+{
+	return STATESAV_REWIND && cart->type == type && strcmp(cart->filename, filename) == 0;
+}
+
 void CARTRIDGE_StateRead(UBYTE version)
 {
 	int saved_type = CARTRIDGE_NONE;
@@ -1688,7 +1696,7 @@ void CARTRIDGE_StateRead(UBYTE version)
 	StateSav_ReadINT(&saved_type, 1);
 	if (saved_type != CARTRIDGE_NONE) {
 		StateSav_ReadFNAME(filename);
-		if (filename[0]) {
+		if (filename[0] && !IsInserted(&CARTRIDGE_main, filename, saved_type < 0 ? -saved_type : saved_type)) {
 			/* Insert the cartridge... */
 			if (CARTRIDGE_Insert(filename) >= 0) {
 				/* And set the type to the saved type, in case it was a raw cartridge image */
@@ -1708,7 +1716,7 @@ void CARTRIDGE_StateRead(UBYTE version)
 	
 		StateSav_ReadINT(&saved_type, 1);
 		StateSav_ReadFNAME(filename);
-		if (filename[0]) {
+		if (filename[0] && !IsInserted(&CARTRIDGE_piggyback, filename, saved_type)) {
 			/* Insert the cartridge... */
 			if (CARTRIDGE_Insert_Second(filename) >= 0) {
 				/* And set the type to the saved type, in case it was a raw cartridge image */
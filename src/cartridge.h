@@ -8,7 +8,7 @@
 /* Indicates whether the emulator should automatically reboot (coldstart)
    after inserting/removing a cartridge. (Doesn't affect the piggyback
    cartridge - in this case system will never autoreboot.) */
-extern int CARTRIDGE_autoreboot;
+extern THREAD_LOCAL int CARTRIDGE_autoreboot;
 
 typedef struct CARTRIDGE_image_t {
 	int type;
@@ -18,8 +18,8 @@ typedef struct CARTRIDGE_image_t {
 	char filename[FILENAME_MAX];
 } CARTRIDGE_image_t;
 
-extern CARTRIDGE_image_t CARTRIDGE_main;
-extern CARTRIDGE_image_t CARTRIDGE_piggyback;
+extern THREAD_LOCAL CARTRIDGE_image_t CARTRIDGE_main;
+extern THREAD_LOCAL CARTRIDGE_image_t CARTRIDGE_piggyback;
 
 int CARTRIDGE_ReadConfig(char *string, char *ptr);
 void CARTRIDGE_WriteConfig(FILE *fp);
@@ -25,6 +25,8 @@
 #ifndef CARTRIDGE_INFO_H_
 #define CARTRIDGE_INFO_H_
 
+#include "atari.h"
+
 /* Min and Max cartridge size in bytes */
 #define CARTRIDGE_MIN_SIZE        2048
 #define CARTRIDGE_MAX_SIZE	  (128 * 1024 * 1024)
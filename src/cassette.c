@@ -36,46 +36,46 @@
 #include "util.h"
 #include "pokey.h"
 
-static IMG_TAPE_t *cassette_file = NULL;
+static THREAD_LOCAL IMG_TAPE_t *cassette_file = NULL;
 
 /* Time till the end of the current tape event (byte or gap), in CPU ticks. */
-static SLONG event_time_left = 0;
+static THREAD_LOCAL SLONG event_time_left = 0;
 
 /* Indicates that there is a SERIN transmission in progress and when it ends,
    the current byte should be copied to POKEY_SERIN. This can be reset by
    rewinding/removing the tape or by resetting POKEY.
    Note that this variable has any meaning when PASSING_GAP is FALSE,
    so it doesn't have to be reset during PASSING_IRG. */
-static int pending_serin = FALSE;
+static THREAD_LOCAL int pending_serin = FALSE;
 
 /* Indicates that an Inter-Record-Gap is currently being passed. It's set to TRUE
    at the beginning of each block. */
-static int passing_gap = FALSE;
+static THREAD_LOCAL int passing_gap = FALSE;
 
 /* if penting_serin == TRUE, this holds the byte that is currently loaded from
    tape. It might be later copied to serin_byte. */
-static UBYTE pending_serin_byte = 0xff;
+static THREAD_LOCAL UBYTE pending_serin_byte = 0xff;
 
 /* Byte most recently loaded from tape; will be accessed by SIO_GetByte(). */
-static UBYTE serin_byte = 0xff;
-
-char CASSETTE_filename[FILENAME_MAX];
-CASSETTE_status_t CASSETTE_status = CASSETTE_STATUS_NONE;
-int CASSETTE_write_protect = FALSE;
-int CASSETTE_record = FALSE;
-int CASSETTE_writable = FALSE;
-int CASSETTE_readable = FALSE;
-
-char CASSETTE_description[CASSETTE_DESCRIPTION_MAX];
-static int cassette_gapdelay = 0;	/* in ms, includes leader and all gaps */
-static int cassette_motor = 0;
-
-int CASSETTE_hold_start_on_reboot = 0;
-int CASSETTE_hold_start = 0;
-int CASSETTE_press_space = 0;
+static THREAD_LOCAL UBYTE serin_byte = 0xff;
+
+THREAD_LOCAL char CASSETTE_filename[FILENAME_MAX];
+THREAD_LOCAL CASSETTE_status_t CASSETTE_status = CASSETTE_STATUS_NONE;
+THREAD_LOCAL int CASSETTE_write_protect = FALSE;
+THREAD_LOCAL int CASSETTE_record = FALSE;
+THREAD_LOCAL int CASSETTE_writable = FALSE;
+THREAD_LOCAL int CASSETTE_readable = FALSE;
+
+THREAD_LOCAL char CASSETTE_description[CASSETTE_DESCRIPTION_MAX];
+static THREAD_LOCAL int cassette_gapdelay = 0;	/* in ms, includes leader and all gaps */
+static THREAD_LOCAL int cassette_motor = 0;
+
+THREAD_LOCAL int CASSETTE_hold_start_on_reboot = 0;
+THREAD_LOCAL int CASSETTE_hold_start = 0;
+THREAD_LOCAL int CASSETTE_press_space = 0;
 /* Indicates whether the tape has ended. During saving the value is always 0;
    during loading it is equal to (CASSETTE_GetPosition() >= CASSETTE_GetSize()). */
-static int eof_of_tape = 0;
+static THREAD_LOCAL int eof_of_tape = 0;
 
 /* Call this function after each change of
    cassette_motor, CASSETTE_status or eof_of_tape. */
@@ -35,6 +35,7 @@
 #include "memory.h"
 #include "pbi.h"
 #include "rtime.h"
+#include "sio.h"
 #include "sysrom.h"
 #ifdef XEP80_EMULATION
 #include "xep80.h"
@@ -66,7 +67,7 @@
 #include "file_export.h"
 #endif
 
-int CFG_save_on_exit = FALSE;
+THREAD_LOCAL int CFG_save_on_exit = FALSE;
 
 /* If another default path config path is defined use it
    otherwise use the default one */
@@ -78,7 +79,7 @@ int CFG_save_on_exit = FALSE;
 #define SYSTEM_WIDE_CFG_FILE "/etc/atari800.cfg"
 #endif
 
-static char rtconfig_filename[FILENAME_MAX];
+static THREAD_LOCAL char rtconfig_filename[FILENAME_MAX];
 
 int CFG_LoadConfig(const char *alternate_config_filename)
 {
@@ -304,6 +305,8 @@ int CFG_LoadConfig(const char *alternate_config_filename)
 			}
 			else if (CASSETTE_ReadConfig(string, ptr)) {
 			}
+			else if (SIO_ReadConfig(string, ptr)) {
+			}
 			else if (RTIME_ReadConfig(string, ptr)) {
 			}
 #ifdef XEP80_EMULATION
@@ -459,6 +462,7 @@ int CFG_WriteConfig(void)
 	PBI_WriteConfig(fp);
 	CARTRIDGE_WriteConfig(fp);
 	CASSETTE_WriteConfig(fp);
+	SIO_WriteConfig(fp);
 	RTIME_WriteConfig(fp);
 #ifdef XEP80_EMULATION
 	XEP80_WriteConfig(fp);
@@ -1,6 +1,8 @@
 #ifndef CFG_H_
 #define CFG_H_
 
+#include "atari.h"
+
 /* Load Atari800 text configuration file. */
 int CFG_LoadConfig(const char *alternate_config_filename);
 
@@ -8,7 +10,7 @@ int CFG_LoadConfig(const char *alternate_config_filename);
 int CFG_WriteConfig(void);
 
 /* Controls whether the configuration file will be saved on emulator exit. */
-extern int CFG_save_on_exit;
+extern THREAD_LOCAL int CFG_save_on_exit;
 
 /* Compares the string PARAM with each entry in the CFG_STRINGS array
    (of size CFG_STRINGS_SIZE), and returns index under which PARAM is found.
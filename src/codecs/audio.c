@@ -45,19 +45,19 @@
 /* Global pointer to current audio codec, or NULL if one has not been
    initialized. This pointer should not be used after a call to
    audio_codec->end(). */
-AUDIO_CODEC_t *audio_codec = NULL;
+THREAD_LOCAL AUDIO_CODEC_t *audio_codec = NULL;
 
 /* Global pointer to the audio codec parameters and summary data. This pointer
    may still be referenced after a call to audio_codec->end(), as it only holds
    static data from the last use of the audio codec. */
-AUDIO_OUT_t *audio_out = NULL;
+THREAD_LOCAL AUDIO_OUT_t *audio_out = NULL;
 
 /* Global variables for the audio buffer and size. This buffer is used to hold
    audio frames generated by the codec. */
-int audio_buffer_size = 0;
-UBYTE *audio_buffer = NULL;
+THREAD_LOCAL int audio_buffer_size = 0;
+THREAD_LOCAL UBYTE *audio_buffer = NULL;
 
-static AUDIO_CODEC_t *requested_audio_codec = NULL;
+static THREAD_LOCAL AUDIO_CODEC_t *requested_audio_codec = NULL;
 
 static AUDIO_CODEC_t *known_audio_codecs[] = {
 	&Audio_Codec_PCM,
@@ -74,9 +74,9 @@ static AUDIO_CODEC_t *known_audio_codecs[] = {
 };
 
 #ifdef AUDIO_CODEC_MP3
-int audio_param_bitrate = 128;
-int audio_param_samplerate = -1;
-int audio_param_quality = 4;
+THREAD_LOCAL int audio_param_bitrate = 128;
+THREAD_LOCAL int audio_param_samplerate = -1;
+THREAD_LOCAL int audio_param_quality = 4;
 #endif
 
 static AUDIO_CODEC_t *match_audio_codec(char *id)
@@ -252,7 +252,8 @@ int CODECS_AUDIO_Init(void)
 		}
 	}
 
-	sample_size = POKEYSND_snd_flags & POKEYSND_BIT16? 2 : 1;
+	/* float output is recorded as 16 bit samples, see POKEYSND_Process */
+	sample_size = POKEYSND_snd_flags & (POKEYSND_BIT16 | POKEYSND_FLOAT32) ? 2 : 1;
 	if (sample_size == 1 && !(audio_codec->codec_flags & AUDIO_CODEC_FLAG_SUPPORTS_8_BIT_SAMPLES)) {
 		File_Export_SetErrorMessageArg("16 bit audio needed for %s", audio_codec->codec_id);
 		return 0;
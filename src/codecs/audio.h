@@ -71,15 +71,15 @@ typedef struct {
     AUDIO_CODEC_End end;
 } AUDIO_CODEC_t;
 
-extern AUDIO_CODEC_t *audio_codec;
-extern AUDIO_OUT_t *audio_out;
-extern int audio_buffer_size;
-extern UBYTE *audio_buffer;
+extern THREAD_LOCAL AUDIO_CODEC_t *audio_codec;
+extern THREAD_LOCAL AUDIO_OUT_t *audio_out;
+extern THREAD_LOCAL int audio_buffer_size;
+extern THREAD_LOCAL UBYTE *audio_buffer;
 
 #ifdef AUDIO_CODEC_MP3
-extern int audio_param_bitrate;
-extern int audio_param_samplerate;
-extern int audio_param_quality;
+extern THREAD_LOCAL int audio_param_bitrate;
+extern THREAD_LOCAL int audio_param_samplerate;
+extern THREAD_LOCAL int audio_param_quality;
 #endif
 
 int CODECS_AUDIO_Initialise(int *argc, char *argv[]);
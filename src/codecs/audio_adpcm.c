@@ -39,16 +39,16 @@
 #define FORMAT_IMA 0x11
 #define FORMAT_YAMAHA 0x20
 
-static AUDIO_OUT_t out;
+static THREAD_LOCAL AUDIO_OUT_t out;
 
-static ADPCMChannelStatus channel_status[2];
+static THREAD_LOCAL ADPCMChannelStatus channel_status[2];
 
-static int samples_per_block;
-static int format_type;
-static float final_duration;
-static SWORD *leftover_samples;
-static SWORD *leftover_samples_boundary;
-static SWORD *leftover_samples_end;
+static THREAD_LOCAL int samples_per_block;
+static THREAD_LOCAL int format_type;
+static THREAD_LOCAL float final_duration;
+static THREAD_LOCAL SWORD *leftover_samples;
+static THREAD_LOCAL SWORD *leftover_samples_boundary;
+static THREAD_LOCAL SWORD *leftover_samples_end;
 
 /* adpcm_step_table[] and adpcm_index_table[] are from the ADPCM reference source */
 static const SBYTE adpcm_index_table[16] = {
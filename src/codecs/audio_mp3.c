@@ -38,14 +38,14 @@
 
 #define DEFAULT_BITRATE 128
 
-static AUDIO_OUT_t out;
-
-static float final_duration;
-static int flushing;
-static int flushed;
-static int last_frame_size;
-static int leftover_bytes;
-static lame_global_flags *lame;
+static THREAD_LOCAL AUDIO_OUT_t out;
+
+static THREAD_LOCAL float final_duration;
+static THREAD_LOCAL int flushing;
+static THREAD_LOCAL int flushed;
+static THREAD_LOCAL int last_frame_size;
+static THREAD_LOCAL int leftover_bytes;
+static THREAD_LOCAL lame_global_flags *lame;
 
 #define AV_RB32(x)                                 \
 	(((ULONG)((const UBYTE*)(x))[0] << 24) |    \
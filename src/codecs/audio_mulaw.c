@@ -36,7 +36,7 @@
    data for each sample. The number of channels and sample rate remain the same.
    */
 
-static AUDIO_OUT_t out;
+static THREAD_LOCAL AUDIO_OUT_t out;
 
 /* From https://en.wikipedia.org/wiki/%CE%9C-law_algorithm the mulaw encoding is
    based on converting samples to 14 bits and then categorizing them in the
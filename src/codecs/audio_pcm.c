@@ -26,7 +26,7 @@
 #include "codecs/audio.h"
 #include "codecs/audio_pcm.h"
 
-static AUDIO_OUT_t out;
+static THREAD_LOCAL AUDIO_OUT_t out;
 
 static int PCM_Init(int sample_rate, float fps, int sample_size, int num_channels)
 {
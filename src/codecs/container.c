@@ -25,8 +25,17 @@
 
 /* This file is compiled when AUDIO_RECORDING or VIDEO_RECORDING is defined. */
 
+#include "config.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+/* The worker thread would not see the machine's thread-local state, so with
+   MULTI_INSTANCE frames are encoded by the emulation thread itself. */
+#if defined(THREADED_ENCODING) && defined(HAVE_LIBPTHREAD) && !defined(MULTI_INSTANCE)
+#include <pthread.h>
+#define ASYNC_ENCODING
+#endif
+#include "colours.h"
 #include "screen.h"
 #include "util.h"
 #include "log.h"
@@ -34,6 +43,7 @@
 #include "codecs/container.h"
 #ifdef AUDIO_RECORDING
 #include "sound.h"
+#include "pokeysnd.h"
 #include "codecs/audio.h"
 #include "codecs/container_wav.h"
 #ifdef AUDIO_CODEC_MP3
@@ -43,31 +53,32 @@
 #ifdef VIDEO_RECORDING
 #include "codecs/video.h"
 #include "codecs/container_avi.h"
+#include "codecs/container_raw.h"
 #endif
 
 /* Global pointer to current multimedia container, or NULL if one has not been
    initialized. This pointer should not be used after a call to
    container->close(). */
-CONTAINER_t *container = NULL;
+THREAD_LOCAL CONTAINER_t *container = NULL;
 
 /* Global variable containing the amount of bytes written to the currently open
    container. This value is updated as the container adds video and audio
    frames, so may be used during the creation of the file */
-ULONG byteswritten;
+THREAD_LOCAL CONTAINER_SIZE_t byteswritten;
 
 /* Global variable containing the number of video frames processed during the
    creation of the multimedia file. This is updated even when audio-only files
    are being created, because the duration of the file must be tracked to write
    audio header information. */
-ULONG video_frame_count;
+THREAD_LOCAL ULONG video_frame_count;
 
 /* Global variable containing the frames per second at time of file creation,
    either Atari800_FPS_NTSC or Atari800_FPS_PAL. */
-float fps;
+THREAD_LOCAL float fps;
 
 /* Global variable containing the text description of the current container type
    and the video and audio codecs being used to write data into the file. */
-char description[32];
+THREAD_LOCAL char description[32];
 
 static CONTAINER_t *known_containers[] = {
 #ifdef AUDIO_RECORDING
@@ -78,26 +89,78 @@ static CONTAINER_t *known_containers[] = {
 #endif
 #ifdef VIDEO_RECORDING
 	&Container_AVI,
+	&Container_RAW,
 #endif
 	NULL,
 };
 
-static FILE *fp = NULL;
+static THREAD_LOCAL FILE *fp = NULL;
 
 /* Some codecs allow for keyframes (full frame compression) and inter-frames
    (only the differences from the previous frame) */
-static int keyframe_count;
+static THREAD_LOCAL int keyframe_count;
 
 /* audio statistics */
-static ULONG audio_frame_count;
-static ULONG total_audio_size;
-static ULONG smallest_audio_frame;
-static ULONG largest_audio_frame;
+static THREAD_LOCAL ULONG audio_frame_count;
+static THREAD_LOCAL ULONG total_audio_size;
+static THREAD_LOCAL ULONG smallest_audio_frame;
+static THREAD_LOCAL ULONG largest_audio_frame;
 
 /* video statistics */
-static ULONG total_video_size;
-static ULONG smallest_video_frame;
-static ULONG largest_video_frame;
+static THREAD_LOCAL ULONG total_video_size;
+static THREAD_LOCAL ULONG smallest_video_frame;
+static THREAD_LOCAL ULONG largest_video_frame;
+
+#ifdef ASYNC_ENCODING
+/* Frames are encoded and written by a worker thread so that slow codecs do not
+   hold up the emulation. The emulation thread copies the screen and the sound
+   samples into a ring of snapshots whose buffers are reused from frame to
+   frame. There is a single worker because interframes and the order of the
+   chunks in the container depend on the frames being encoded in sequence.
+   When the ring is full the emulation waits for the worker; these stalls are
+   counted so they can be shown on screen. */
+#define QUEUE_SIZE 16
+
+enum {
+	SNAPSHOT_VIDEO,
+	SNAPSHOT_AUDIO
+};
+
+typedef struct {
+	int type;
+	UBYTE *data;
+	int data_size;
+	int num_samples;
+	int palette[256];	/* Colours_table of a video frame */
+} SNAPSHOT_t;
+
+static SNAPSHOT_t queue[QUEUE_SIZE];
+static int queue_head;	/* next snapshot to encode */
+static int queue_count;
+static int queue_max_count;
+static ULONG queue_stalls;
+
+/* The worker updates byteswritten and video_frame_count. The emulation
+   thread reads these copies, taken under queue_mutex after each snapshot,
+   for the on-screen stats. */
+static CONTAINER_SIZE_t worker_byteswritten;
+static ULONG worker_video_frame_count;
+
+static pthread_t worker;
+static int worker_running = FALSE;
+static int worker_stop;
+static int worker_failed;
+static pthread_mutex_t queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_not_empty = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t queue_not_full = PTHREAD_COND_INITIALIZER;
+
+static void start_worker(void);
+#endif /* ASYNC_ENCODING */
+
+#ifdef AUDIO_RECORDING
+/* size of one sample passed to CONTAINER_AddAudioSamples, see POKEYSND_Process */
+static THREAD_LOCAL int sample_bytes;
+#endif
 
 
 static CONTAINER_t *match_container(const char *id)
@@ -176,6 +239,7 @@ int CONTAINER_Open(const char *filename)
 		largest_audio_frame = 0;
 
 #ifdef AUDIO_RECORDING
+		sample_bytes = POKEYSND_snd_flags & (POKEYSND_BIT16 | POKEYSND_FLOAT32) ? 2 : 1;
 		if (Sound_enabled) {
 			if (!CODECS_AUDIO_Init()) {
 				/* error message set in codec */
@@ -237,18 +301,21 @@ int CONTAINER_Open(const char *filename)
 	if (!fp) {
 		close_codecs();
 	}
+#ifdef ASYNC_ENCODING
+	else {
+		start_worker();
+	}
+#endif
 
 	return (fp != NULL);
 }
 
 #ifdef AUDIO_RECORDING
-int CONTAINER_AddAudioSamples(const UBYTE *buf, int num_samples)
+static int encode_audio(const UBYTE *buf, int num_samples)
 {
 	int result;
 	int size;
 
-	if (!fp || !audio_codec) return 0;
-
 	if (!buf) {
 		/* This happens at file close time, checking if audio codec has samples
 		   remaining */
@@ -260,7 +327,7 @@ int CONTAINER_AddAudioSamples(const UBYTE *buf, int num_samples)
 	}
 	else
 #ifdef VIDEO_RECORDING
-		if (!video_codec)
+		if (!video_codec && !container->screen_frame)
 #endif
 	{
 		/* Before file close time, there is one call to this function every
@@ -303,7 +370,7 @@ int CONTAINER_AddAudioSamples(const UBYTE *buf, int num_samples)
 		}
 	} while (audio_codec->another_frame());
 
-	result = container->size_check(ftell(fp));
+	result = container->size_check(byteswritten);
 	if (!result) {
 		Log_print("%s maximum file size reached, closing file", container->container_id);
 	}
@@ -312,37 +379,43 @@ int CONTAINER_AddAudioSamples(const UBYTE *buf, int num_samples)
 #endif
 
 #ifdef VIDEO_RECORDING
-int CONTAINER_AddVideoFrame(void)
+static int encode_video(UBYTE *screen, const int *palette)
 {
 	int size;
 	int result;
 	int is_keyframe;
 
-	if (!fp || !video_codec) return 0;
-
-	/* When a codec uses interframes (deltas from the previous frame), a
-	   keyframe is needed every keyframe interval. */
-	if (video_codec->uses_interframes) {
-		keyframe_count--;
-		if (keyframe_count <= 0) {
-			is_keyframe = TRUE;
-			keyframe_count = video_codec_keyframe_interval;
+	if (container->screen_frame) {
+		/* the container stores the screen itself, without a codec */
+		size = container->screen_frame(fp, screen, palette);
+		result = size > 0;
+	}
+	else {
+		/* When a codec uses interframes (deltas from the previous frame), a
+		   keyframe is needed every keyframe interval. */
+		if (video_codec->uses_interframes) {
+			keyframe_count--;
+			if (keyframe_count <= 0) {
+				is_keyframe = TRUE;
+				keyframe_count = video_codec_keyframe_interval;
+			}
+			else {
+				is_keyframe = FALSE;
+			}
 		}
 		else {
-			is_keyframe = FALSE;
+			is_keyframe = TRUE;
 		}
-	}
-	else {
-		is_keyframe = TRUE;
-	}
 
-	size = video_codec->frame((UBYTE *)Screen_atari, is_keyframe, video_buffer, video_buffer_size);
-	if (size < 0) {
-		/* failed creating video frame; force close of file */
-		Log_print("video codec %s failed encoding frame", video_codec->codec_id);
-		return 0;
+		size = video_codec->frame(screen, is_keyframe, video_buffer, video_buffer_size);
+		if (size < 0) {
+			/* failed creating video frame; force close of file */
+			Log_print("video codec %s failed encoding frame", video_codec->codec_id);
+			return 0;
+		}
+		result = container->video_frame(fp, video_buffer, size, is_keyframe);
 	}
-	result = container->video_frame(fp, video_buffer, size, is_keyframe);
+
 	if (result) {
 		/* update statistics */
 		byteswritten += size;
@@ -355,7 +428,7 @@ int CONTAINER_AddVideoFrame(void)
 			largest_video_frame = size;
 		}
 
-		result = container->size_check(ftell(fp));
+		result = container->size_check(byteswritten);
 		if (!result) {
 			Log_print("%s maximum file size reached, closing file", container->container_id);
 		}
@@ -365,6 +438,192 @@ int CONTAINER_AddVideoFrame(void)
 }
 #endif
 
+#ifdef ASYNC_ENCODING
+static void *encode_worker(void *arg)
+{
+	SNAPSHOT_t *s;
+	int ok;
+
+	for (;;) {
+		pthread_mutex_lock(&queue_mutex);
+		while (queue_count == 0 && !worker_stop)
+			pthread_cond_wait(&queue_not_empty, &queue_mutex);
+		if (queue_count == 0) {
+			pthread_mutex_unlock(&queue_mutex);
+			break;
+		}
+		s = &queue[queue_head];
+		ok = !worker_failed;
+		pthread_mutex_unlock(&queue_mutex);
+
+		/* the emulation thread only fills the slots after the queued ones,
+		   so this one can be encoded without holding the lock */
+		if (ok) {
+#ifdef AUDIO_RECORDING
+			if (s->type == SNAPSHOT_AUDIO)
+				ok = encode_audio(s->data, s->num_samples);
+#endif
+#ifdef VIDEO_RECORDING
+			if (s->type == SNAPSHOT_VIDEO)
+				ok = encode_video(s->data, s->palette);
+#endif
+		}
+
+		pthread_mutex_lock(&queue_mutex);
+		queue_head = (queue_head + 1) % QUEUE_SIZE;
+		queue_count--;
+		worker_byteswritten = byteswritten;
+		worker_video_frame_count = video_frame_count;
+		if (!ok)
+			worker_failed = TRUE;
+		pthread_cond_signal(&queue_not_full);
+		pthread_mutex_unlock(&queue_mutex);
+	}
+	return NULL;
+}
+
+static void start_worker(void)
+{
+	queue_head = 0;
+	queue_count = 0;
+	queue_max_count = 0;
+	queue_stalls = 0;
+	worker_byteswritten = byteswritten;
+	worker_video_frame_count = video_frame_count;
+	worker_stop = FALSE;
+	worker_failed = FALSE;
+	/* if the thread can't be created, frames are encoded synchronously */
+	worker_running = pthread_create(&worker, NULL, encode_worker, NULL) == 0;
+}
+
+/* Waits for the worker to encode all queued snapshots and frees the queue.
+   Returns FALSE if encoding any of them failed. */
+static int stop_worker(void)
+{
+	int i;
+
+	if (!worker_running)
+		return TRUE;
+	pthread_mutex_lock(&queue_mutex);
+	worker_stop = TRUE;
+	pthread_cond_signal(&queue_not_empty);
+	pthread_mutex_unlock(&queue_mutex);
+	pthread_join(worker, NULL);
+	worker_running = FALSE;
+
+	for (i = 0; i < QUEUE_SIZE; i++) {
+		free(queue[i].data);
+		queue[i].data = NULL;
+		queue[i].data_size = 0;
+	}
+	return !worker_failed;
+}
+
+/* Copies the data into the next free snapshot, waiting for one if the queue
+   is full. A video frame also keeps the palette it was drawn with, since the
+   worker encodes it later. Returns FALSE if the worker has failed. */
+static int queue_snapshot(int type, const UBYTE *data, int size, int num_samples)
+{
+	SNAPSHOT_t *s;
+
+	pthread_mutex_lock(&queue_mutex);
+	if (queue_count == QUEUE_SIZE) {
+		queue_stalls++;
+		while (queue_count == QUEUE_SIZE && !worker_failed)
+			pthread_cond_wait(&queue_not_full, &queue_mutex);
+	}
+	if (worker_failed) {
+		pthread_mutex_unlock(&queue_mutex);
+		return FALSE;
+	}
+	s = &queue[(queue_head + queue_count) % QUEUE_SIZE];
+	pthread_mutex_unlock(&queue_mutex);
+
+	if (size > s->data_size) {
+		s->data = (UBYTE *)Util_realloc(s->data, size);
+		s->data_size = size;
+	}
+	memcpy(s->data, data, size);
+	if (type == SNAPSHOT_VIDEO)
+		memcpy(s->palette, Colours_table, sizeof(s->palette));
+	s->type = type;
+	s->num_samples = num_samples;
+
+	pthread_mutex_lock(&queue_mutex);
+	queue_count++;
+	if (queue_count > queue_max_count)
+		queue_max_count = queue_count;
+	pthread_cond_signal(&queue_not_empty);
+	pthread_mutex_unlock(&queue_mutex);
+	return TRUE;
+}
+#endif /* ASYNC_ENCODING */
+
+#ifdef AUDIO_RECORDING
+int CONTAINER_AddAudioSamples(const UBYTE *buf, int num_samples)
+{
+	if (!fp || !audio_codec) return 0;
+
+#ifdef ASYNC_ENCODING
+	/* a NULL buffer flushes the codec at close time, after the worker has
+	   finished */
+	if (worker_running && buf)
+		return queue_snapshot(SNAPSHOT_AUDIO, buf, num_samples * sample_bytes, num_samples);
+#endif
+	return encode_audio(buf, num_samples);
+}
+#endif
+
+#ifdef VIDEO_RECORDING
+int CONTAINER_AddVideoFrame(void)
+{
+	if (!fp || (!video_codec && !container->screen_frame)) return 0;
+
+#ifdef ASYNC_ENCODING
+	if (worker_running)
+		return queue_snapshot(SNAPSHOT_VIDEO, (UBYTE *)Screen_atari, Screen_WIDTH * Screen_HEIGHT, 0);
+#endif
+	return encode_video((UBYTE *)Screen_atari, Colours_table);
+}
+#endif
+
+/* Gets the number of snapshots waiting to be encoded, the most that have been
+   waiting at once, and how many times the emulation had to wait for the
+   encoder because the queue was full. Returns FALSE if frames are encoded
+   synchronously. */
+/* Gets the number of video frames and of bytes written so far. While the
+   worker is running, these are as of the last snapshot it has encoded. */
+void CONTAINER_GetProgress(ULONG *video_frames, CONTAINER_SIZE_t *size)
+{
+#ifdef ASYNC_ENCODING
+	if (worker_running) {
+		pthread_mutex_lock(&queue_mutex);
+		*video_frames = worker_video_frame_count;
+		*size = worker_byteswritten;
+		pthread_mutex_unlock(&queue_mutex);
+		return;
+	}
+#endif
+	*video_frames = video_frame_count;
+	*size = byteswritten;
+}
+
+int CONTAINER_GetQueueStats(int *queued, int *max_queued, int *size, ULONG *stalls)
+{
+#ifdef ASYNC_ENCODING
+	if (worker_running) {
+		pthread_mutex_lock(&queue_mutex);
+		*queued = queue_count;
+		*max_queued = queue_max_count;
+		*size = QUEUE_SIZE;
+		*stalls = queue_stalls;
+		pthread_mutex_unlock(&queue_mutex);
+		return TRUE;
+	}
+#endif
+	return FALSE;
+}
+
 /* Closes the current container, flushing any buffered audio data and updating
    the container metadata with the final sizes of all video and audio frames
    written. */
@@ -379,6 +638,13 @@ int CONTAINER_Close(int file_ok)
 
 	if (!fp || !container) return 0;
 
+#ifdef ASYNC_ENCODING
+	if (!stop_worker()) {
+		/* the file is still finalized so what was written is usable */
+		file_ok = FALSE;
+	}
+#endif
+
 	/* Note that all video frames will be written, but the audio codec may
 		still have frames buffered. */
 
@@ -2,6 +2,16 @@
 #define CODECS_CONTAINER_H_
 
 #include "atari.h"
+#ifdef HAVE_INTTYPES_H
+#include <inttypes.h>
+#endif
+
+/* File sizes and offsets; OpenDML AVI files may be larger than 4GB */
+#ifdef HAVE_INTTYPES_H
+typedef uint64_t CONTAINER_SIZE_t;
+#else
+typedef unsigned long CONTAINER_SIZE_t;
+#endif
 
 /* Prepare a file for writing video and audio frames */
 typedef int (*CONTAINER_Prepare)(FILE *fp);
@@ -12,8 +22,14 @@ typedef int (*CONTAINER_SaveAudioFrame)(FILE *fp, const UBYTE *buf, int bufsize)
 /* Save current screen (possibly interlaced) to a buffer */
 typedef int (*CONTAINER_SaveVideoFrame)(FILE *fp, const UBYTE *buf, int bufsize, int is_keyframe);
 
+/* Save the screen directly, for containers that store frames without a video
+   codec. The screen is Screen_WIDTH bytes per line and palette is the
+   Colours_table it was drawn with. Return the number of bytes of video data
+   written, or zero on error. */
+typedef int (*CONTAINER_SaveScreen)(FILE *fp, const UBYTE *screen, const int *palette);
+
 /* Verify the file size is not about to exceed maximum size limits */
-typedef int (*CONTAINER_SizeCheck)(int current_size);
+typedef int (*CONTAINER_SizeCheck)(CONTAINER_SIZE_t current_size);
 
 /* Create a valid file by forcing any final data to be written to the file */
 typedef int (*CONTAINER_Finalize)(FILE *fp);
@@ -24,24 +40,25 @@ typedef struct {
     CONTAINER_Prepare prepare;
     CONTAINER_SaveAudioFrame audio_frame;
     CONTAINER_SaveVideoFrame video_frame;
+    CONTAINER_SaveScreen screen_frame;
     CONTAINER_SizeCheck size_check;
     CONTAINER_Finalize finalize;
 } CONTAINER_t;
 
-/* RIFF files (WAV, AVI) are limited to 4GB in size, so define a reasonable max
-   that's lower than 4GB */
+/* RIFF files (WAV, and AVI without the OpenDML extensions) are limited to 4GB
+   in size, so define a reasonable max that's lower than 4GB */
 #define MAX_RIFF_FILE_SIZE (0xfff00000)
 
 /* number of bytes written to the currently open multimedia file */
-extern ULONG byteswritten;
+extern THREAD_LOCAL CONTAINER_SIZE_t byteswritten;
 
 /* These variables are needed for statistics and on-screen information display. */
-extern ULONG video_frame_count;
-extern float fps;
-extern char description[32];
+extern THREAD_LOCAL ULONG video_frame_count;
+extern THREAD_LOCAL float fps;
+extern THREAD_LOCAL char description[32];
 
 /* Currently open container */
-extern CONTAINER_t *container;
+extern THREAD_LOCAL CONTAINER_t *container;
 
 int CONTAINER_IsSupported(const char *filename);
 int CONTAINER_Open(const char *filename);
@@ -51,6 +68,8 @@ int CONTAINER_AddAudioSamples(const UBYTE *buf, int num_samples);
 #ifdef VIDEO_RECORDING
 int CONTAINER_AddVideoFrame(void);
 #endif
+void CONTAINER_GetProgress(ULONG *video_frames, CONTAINER_SIZE_t *size);
+int CONTAINER_GetQueueStats(int *queued, int *max_queued, int *size, ULONG *stalls);
 int CONTAINER_Close(int file_ok);
 
 #endif /* CODECS_CONTAINER_H_ */
@@ -24,7 +24,17 @@
 
 /* This file is only compiled when VIDEO_RECORDING is defined. */
 
-#include <stdio.h>
+#define _XOPEN_SOURCE 600
+
+#include "config.h"
+/* allow non-ansi fseek/ftell functions */
+#ifdef __STRICT_ANSI__
+#  undef __STRICT_ANSI__
+#  include <stdio.h>
+#  define __STRICT_ANSI__ 1
+#else
+#  include <stdio.h>
+#endif
 #include <stdlib.h>
 #include "file_export.h"
 #include "colours.h"
@@ -39,55 +49,160 @@
 #include "codecs/container_avi.h"
 
 
-/* AVI requires the header at the beginning of the file contains sizes of each
-   chunk, so the header will be rewritten upon the close of the file to update
-   the header values with the final totals. *;
-*/
-static ULONG size_riff;
-static ULONG size_movi;
-
-/* AVI files using the version 1.0 indexes ('idx1') have a 32 bit limit, which
-   limits file size to 4GB. Some media players may fail to play videos greater
-   than 2GB because of their incorrect use of signed rather than unsigned 32 bit
-   values.
-
-   The maximum recording duration depends mostly on the complexity of the video.
-   The audio is saved as raw PCM samples which doesn't vary per frame. On NTSC
-   at 60Hz using 16 bit samples, this will be just under 1500 bytes per frame.
-
-   The size of each encoded video frame depends on the complexity the screen
-   image. The RLE compression is based on scan lines, and performs best when
-   neighboring pixels on the scan line are the same color. Due to overhead in
-   the compression sceme itself, the best it can do is about 1500 bytes on a
-   completely black screen. Complex screens where many neighboring pixels have
-   different colors result in video frames of around 30k. This is still a
-   significant savings over an uncompressed frame which would be 80k.
+/* Files are written in the OpenDML (AVI 2.0) format, which lifts the 4GB
+   limit of the original AVI format:
+
+   RIFF 'AVI '                      first segment, readable by any AVI player
+     LIST 'hdrl'                    headers, rewritten at every checkpoint
+       avih
+       LIST 'strl' strh strf strn indx        video stream
+       LIST 'strl' strh strf strn indx        audio stream, if recorded
+       LIST 'odml' dmlh
+     LIST 'movi'
+       00dc 01wb ... ix00 ix01 ...  frames and their standard indexes
+     idx1                           AVI 1.0 index of the first segment
+   RIFF 'AVIX'                      further segments of up to 1GB each
+     LIST 'movi'
+       00dc 01wb ... ix00 ix01 ...
+
+   The offsets and sizes of the chunks are collected in memory as they are
+   written. At every checkpoint, the standard indexes ('ix00',
+   'ix01') of the chunks since the previous checkpoint are written, entered
+   in the super indexes ('indx') of the stream headers, and the header and
+   the size of the current segment are updated. Should the emulator stop
+   without closing the file, it is playable and seekable up to the last
+   checkpoint in players that support OpenDML.
+
+   The maximum recording duration is limited by the space reserved for the
+   super indexes: one entry per stream at each checkpoint and segment. The
+   first checkpoint comes after CHECKPOINT_SECONDS of video, and the interval
+   doubles each time another quarter of the super indexes is used, up to
+   CHECKPOINT_DOUBLINGS times (10, 20, 40 and 80 seconds), which is enough
+   for about 85 hours. The recording is stopped automatically when they are
+   full.
+
+   The size of each encoded video frame depends on the complexity of the
+   screen image and on the codec; a complex screen takes around 30k per frame
+   with the RLE codec, so a 1GB segment holds about 8 minutes of video. */
+
+#define SEGMENT_SIZE 0x40000000
+#define CHECKPOINT_SECONDS 10
+#define CHECKPOINT_DOUBLINGS 3
+#define SUPER_INDEX_ENTRIES 8192
+#define INDX_SIZE (24 + SUPER_INDEX_ENTRIES * 16)
+#define DMLH_SIZE 248
+
+/* sizes of the header and of each entry of a standard index, and of each
+   entry of the idx1 index */
+#define IX_HEADER_SIZE (8 + 24)
+#define IX_ENTRY_SIZE 8
+#define IDX1_ENTRY_SIZE 16
+
+#define DELTA_FRAME_FLAG 0x80000000 /* in standard indexes: not a keyframe */
+#define AVIIF_KEYFRAME   0x10       /* in idx1 */
+#define AVIF_HASINDEX    0x10       /* in avih */
+
+/* segments after the first lie beyond the 2GB reach of fseek */
+#if defined (_MSC_VER)
+#  define fseeko _fseeki64
+#elif defined (HAVE_WINDOWS_H)
+#  define fseeko fseeko64
+#elif defined (__BEOS__)
+#  define fseeko _fseek
+#elif defined (__DJGPP__)
+#  define fseeko fseek
+#endif
 
-   For complex scenes, therefore, this results in about 8 minutes of video
-   recording per GB, or about 36 minutes when using the full 4GB file size. Less
-   complex video will provide more recording time. For example, recording the
-   unchanging BASIC prompt screen would result in about 6 hours of video.
+typedef struct {
+	ULONG offset; /* of the chunk header, from the start of its segment */
+	ULONG size;
+	UBYTE stream;
+	UBYTE is_keyframe;
+} INDEX_ENTRY_t;
+
+typedef struct {
+	INDEX_ENTRY_t *entries;
+	int count;
+	int allocated;
+} INDEX_LIST_t;
+
+typedef struct {
+	CONTAINER_SIZE_t offset; /* of the standard index chunk in the file */
+	ULONG size;
+	ULONG duration; /* in units of the stream's rate and scale */
+} SUPER_INDEX_ENTRY_t;
+
+static const char * const chunk_ids[2] = { "00dc", "01wb" };
+static const char * const index_ids[2] = { "ix00", "ix01" };
+
+static THREAD_LOCAL int num_streams;
+
+/* chunks written since the last checkpoint, and all chunks of the first
+   segment for its idx1 index */
+static THREAD_LOCAL INDEX_LIST_t pending_index;
+static THREAD_LOCAL INDEX_LIST_t first_segment_index;
+
+static THREAD_LOCAL SUPER_INDEX_ENTRY_t *super_index[2];
+static THREAD_LOCAL int super_index_count[2];
+#ifdef AUDIO_RECORDING
+static THREAD_LOCAL ULONG audio_length_indexed; /* audio_out->length at the last checkpoint */
+#endif
 
-   The video will automatically be stopped should the recording length approach
-   the file size limit. */
+static THREAD_LOCAL int segment; /* 0 is the RIFF 'AVI ' segment */
+static THREAD_LOCAL CONTAINER_SIZE_t segment_start;
+static THREAD_LOCAL ULONG segment_size; /* bytes written to the current segment */
+static THREAD_LOCAL ULONG header_size; /* first segment up to the end of the 'movi' identifier */
 
-#define FRAME_INDEX_ALLOC_SIZE 1000
-static int num_frames_allocated;
-static ULONG frames_written;
-static ULONG *frame_indexes;
-#define FRAME_SIZE_MASK  0x1fffffff
-#define VIDEO_FRAME_FLAG 0x20000000
-#define AUDIO_FRAME_FLAG 0x40000000
-#define KEYFRAME_FLAG    0x80000000
+/* first segment's RIFF and movi LIST sizes, and number of video frames */
+static THREAD_LOCAL ULONG size_riff;
+static THREAD_LOCAL ULONG size_movi;
+static THREAD_LOCAL ULONG first_segment_frames;
+static THREAD_LOCAL int has_idx1;
 
+static THREAD_LOCAL ULONG video_frames;
+static THREAD_LOCAL int first_checkpoint_frames;
+static THREAD_LOCAL int checkpoint_frames;
+static THREAD_LOCAL int frames_since_checkpoint;
 
-static int num_streams;
 
+/* AVI_WriteSuperIndex writes the 'indx' chunk of a stream, which lists its
+   standard index chunks. Unused entries are zero. */
+static void AVI_WriteSuperIndex(FILE *fp, int stream)
+{
+	int i;
+	SUPER_INDEX_ENTRY_t *entry;
+
+	fputs("indx", fp);
+	fputl(INDX_SIZE, fp);
+	fputw(4, fp); /* longs per entry */
+	fputc(0, fp); /* index sub type */
+	fputc(0, fp); /* index type: AVI_INDEX_OF_INDEXES */
+	fputl(super_index_count[stream], fp);
+	fputs(chunk_ids[stream], fp);
+	fputl(0, fp); /* reserved */
+	fputl(0, fp);
+	fputl(0, fp);
+	for (i = 0; i < SUPER_INDEX_ENTRIES; i++) {
+		if (i < super_index_count[stream]) {
+			entry = &super_index[stream][i];
+			fputl((ULONG)(entry->offset & 0xffffffff), fp);
+			fputl((ULONG)(entry->offset >> 16 >> 16), fp);
+			fputl(entry->size, fp);
+			fputl(entry->duration, fp);
+		}
+		else {
+			fputl(0, fp);
+			fputl(0, fp);
+			fputl(0, fp);
+			fputl(0, fp);
+		}
+	}
+}
 
 /* AVI_WriteHeader creates and writes out the file header. Note that this
-   function will have to be called again just prior to closing the file in order
-   to re-write the header with updated size values that are only known after all
-   data has been written.
+   function is called again at every checkpoint and just prior to closing the
+   file in order to re-write the header with updated size values and indexes
+   that are only known after the data has been written.
 
    RETURNS: TRUE if header was written successfully, FALSE if not
    */
@@ -95,7 +210,8 @@ static int AVI_WriteHeader(FILE *fp) {
 	int i;
 	int list_size;
 
-	fseek(fp, 0, SEEK_SET);
+	if (fseeko(fp, 0, SEEK_SET) != 0)
+		return FALSE;
 
 	/* RIFF AVI header */
 	fputs("RIFF", fp);
@@ -106,12 +222,13 @@ static int AVI_WriteHeader(FILE *fp) {
 	fputs("LIST", fp);
 
 	/* total header size includes hdrl identifier plus avih size PLUS the video stream
-	   header which is (strl header LIST + (strh + strf + strn)) */
-	list_size = 4 + 8 + 56 + (12 + (8 + 56 + 8 + 40 + 256*4 + 8 + 16));
+	   header which is (strl header LIST + (strh + strf + strn + indx)) PLUS the
+	   odml header LIST + dmlh */
+	list_size = 4 + 8 + 56 + (12 + (8 + 56 + 8 + 40 + 256*4 + 8 + 16 + 8 + INDX_SIZE)) + (12 + 8 + DMLH_SIZE);
 
 #ifdef AUDIO_RECORDING
-	/* if audio is included, add size of audio stream strl header LIST + (strh + strf + strn) */
-	if (num_streams == 2) list_size += 12 + (8 + 56 + 8 + 18 + audio_out->extra_data_size + 8 + 12);
+	/* if audio is included, add size of audio stream strl header LIST + (strh + strf + strn + indx) */
+	if (num_streams == 2) list_size += 12 + (8 + 56 + 8 + 18 + audio_out->extra_data_size + 8 + 12 + 8 + INDX_SIZE);
 #endif
 
 	fputl(list_size, fp); /* length of header payload */
@@ -127,8 +244,8 @@ static int AVI_WriteHeader(FILE *fp) {
 	fputl((ULONG)(1000000 / fps), fp); /* microseconds per frame */
 	fputl(image_codec_width * image_codec_height * 3, fp); /* approximate bytes per second of video + audio FIXME: should likely be (width * height * 3 + audio) * fps */
 	fputl(0, fp); /* reserved */
-	fputl(0x10, fp); /* flags; 0x10 indicates the index at the end of the file */
-	fputl(video_frame_count, fp); /* number of frames in the video */
+	fputl(has_idx1 ? AVIF_HASINDEX : 0, fp); /* flags; AVIF_HASINDEX indicates the idx1 index */
+	fputl(first_segment_frames, fp); /* number of frames in the first segment */
 	fputl(0, fp); /* initial frames, always zero for us */
 	fputl(num_streams, fp); /* 2 = video and audio, 1 = video only */
 	fputl(image_codec_width * image_codec_height * 3, fp); /* suggested buffer size */
@@ -142,9 +259,9 @@ static int AVI_WriteHeader(FILE *fp) {
 	/* video stream format */
 
 	/* 12 bytes for video stream strl LIST chuck header; LIST payload size includes the
-	   4 bytes of the 'strl' identifier plus the strh + strf + strn sizes */
+	   4 bytes of the 'strl' identifier plus the strh + strf + strn + indx sizes */
 	fputs("LIST", fp);
-	fputl(4 + 8 + 56 + 8 + 40 + 256*4 + 8 + 16, fp);
+	fputl(4 + 8 + 56 + 8 + 40 + 256*4 + 8 + 16 + 8 + INDX_SIZE, fp);
 	fputs("strl", fp);
 
 	/* Stream header format is document at https://docs.microsoft.com/en-us/previous-versions/windows/desktop/api/avifmt/ns-avifmt-avistreamheader */
@@ -163,7 +280,7 @@ static int AVI_WriteHeader(FILE *fp) {
 	fputl(1000000, fp); /* scale */
 	fputl((ULONG)(fps * 1000000), fp); /* rate = frames per second / scale */
 	fputl(0, fp); /* start */
-	fputl(video_frame_count, fp); /* length (for video is number of frames) */
+	fputl(video_frames, fp); /* length (for video is number of frames) */
 	fputl(image_codec_width * image_codec_height * 3, fp); /* suggested buffer size */
 	fputl(0, fp); /* quality */
 	fputl(0, fp); /* sample size (0 = variable sample size) */
@@ -208,14 +325,16 @@ static int AVI_WriteHeader(FILE *fp) {
 	fputc(0, fp); /* null terminator */
 	fputc(0, fp); /* padding to get to 16 bytes */
 
+	AVI_WriteSuperIndex(fp, 0);
+
 #ifdef AUDIO_RECORDING
 	if (num_streams == 2) {
 		/* audio stream format */
 
 		/* 12 bytes for audio stream strl LIST chuck header; LIST payload size includes the
-		4 bytes of the 'strl' identifier plus the strh + strf + strn sizes */
+		4 bytes of the 'strl' identifier plus the strh + strf + strn + indx sizes */
 		fputs("LIST", fp);
-		fputl(4 + 8 + 56 + 8 + 18 + audio_out->extra_data_size + 8 + 12, fp);
+		fputl(4 + 8 + 56 + 8 + 18 + audio_out->extra_data_size + 8 + 12 + 8 + INDX_SIZE, fp);
 		fputs("strl", fp);
 
 		/* stream header format is same as video above even when used for audio */
@@ -264,9 +383,22 @@ static int AVI_WriteHeader(FILE *fp) {
 		/* 12 bytes for name, zero terminated */
 		fputs("POKEY audio", fp);
 		fputc(0, fp); /* null terminator */
+
+		AVI_WriteSuperIndex(fp, 1);
 	}
 #endif /* AUDIO_RECORDING */
 
+	/* OpenDML header, with the number of frames in all segments */
+	fputs("LIST", fp);
+	fputl(4 + 8 + DMLH_SIZE, fp);
+	fputs("odml", fp);
+	fputs("dmlh", fp);
+	fputl(DMLH_SIZE, fp);
+	fputl(video_frames, fp);
+	for (i = 4; i < DMLH_SIZE; i += 4) {
+		fputl(0, fp); /* reserved */
+	}
+
 	/* audia/video data */
 
 	/* 8 bytes for audio/video stream LIST chuck header; LIST payload is the
@@ -274,18 +406,18 @@ static int AVI_WriteHeader(FILE *fp) {
 	  frame of video and the corresponding audio. */
 	fputs("LIST", fp);
 	fputl(size_movi, fp); /* length of all video and audio chunks */
-	size_movi = ftell(fp); /* start of movi payload, will finalize after all chunks written */
 	fputs("movi", fp);
 
-	return (ftell(fp) == 12 + 8 + list_size + 12);
+	header_size = 12 + 8 + list_size + 12;
+	return (ftell(fp) == header_size);
 }
 
 /* AVI_Prepare will start a new video file and write out an initial copy of the
-   header. Note that the file will not be valid until the it is closed with
-   AVI_Finalize because the length information contained in the header must be
-   updated with the number of samples in the file.
+   header. Note that the file will not be playable until the first checkpoint
+   or until it is closed with AVI_Finalize, because the length information and
+   indexes contained in the header must be updated.
 
-   RETURNS: file pointer if successful, NULL if failure during open
+   RETURNS: TRUE if header was written successfully, FALSE if not
    */
 static int AVI_Prepare(FILE *fp)
 {
@@ -302,153 +434,306 @@ static int AVI_Prepare(FILE *fp)
 	/* some variables must exist before the call to WriteHeader */
 	size_riff = 0;
 	size_movi = 0;
+	first_segment_frames = 0;
+	has_idx1 = FALSE;
+	video_frames = 0;
+	super_index_count[0] = 0;
+	super_index_count[1] = 0;
 	if (!AVI_WriteHeader(fp)) {
 		File_Export_SetErrorMessage("Failed writing AVI header");
 		return 0;
 	}
 
-	/* set up video statistics */
-	frames_written = 0;
+	/* until the first checkpoint, describe a file with no frames */
+	size_riff = header_size - 8;
+	size_movi = 4;
+	if (!AVI_WriteHeader(fp)) {
+		File_Export_SetErrorMessage("Failed writing AVI header");
+		return 0;
+	}
 
-	byteswritten = ftell(fp) + 8; /* current size + index header */
+	segment = 0;
+	segment_start = 0;
+	segment_size = header_size;
+	byteswritten = header_size;
 
-	/* allocate space for index which is written at the end of the file */
-	num_frames_allocated = FRAME_INDEX_ALLOC_SIZE;
-	frame_indexes = (ULONG *)Util_malloc(num_frames_allocated * sizeof(ULONG));
-	memset(frame_indexes, 0, num_frames_allocated * sizeof(ULONG));
+	first_checkpoint_frames = (int)(fps * CHECKPOINT_SECONDS);
+	checkpoint_frames = first_checkpoint_frames;
+	frames_since_checkpoint = 0;
+#ifdef AUDIO_RECORDING
+	audio_length_indexed = 0;
+#endif
+
+	super_index[0] = (SUPER_INDEX_ENTRY_t *)Util_malloc(SUPER_INDEX_ENTRIES * sizeof(SUPER_INDEX_ENTRY_t));
+	super_index[1] = (SUPER_INDEX_ENTRY_t *)Util_malloc(SUPER_INDEX_ENTRIES * sizeof(SUPER_INDEX_ENTRY_t));
+	pending_index.count = 0;
+	first_segment_index.count = 0;
 
 	return 1;
 }
 
+static void AVI_AddIndexEntry(INDEX_LIST_t *list, ULONG offset, ULONG size, int stream, int is_keyframe)
+{
+	INDEX_ENTRY_t *entry;
+
+	if (list->count >= list->allocated) {
+		list->allocated = list->allocated ? list->allocated * 2 : 1024;
+		list->entries = (INDEX_ENTRY_t *)Util_realloc(list->entries, list->allocated * sizeof(INDEX_ENTRY_t));
+	}
+	entry = &list->entries[list->count++];
+	entry->offset = offset;
+	entry->size = size;
+	entry->stream = stream;
+	entry->is_keyframe = is_keyframe;
+}
+
+static void AVI_FreeIndex(INDEX_LIST_t *list)
+{
+	free(list->entries);
+	list->entries = NULL;
+	list->count = 0;
+	list->allocated = 0;
+}
+
+/* AVI_WriteStandardIndexes writes an 'ix##' chunk for each stream, listing
+   the chunks written since the last checkpoint, and adds it to the stream's
+   super index.
+
+   RETURNS: TRUE if the indexes were written successfully, FALSE if not
+   */
+static int AVI_WriteStandardIndexes(FILE *fp)
+{
+	int stream;
+	int i;
+	int count;
+	ULONG duration;
+	SUPER_INDEX_ENTRY_t *super;
+	INDEX_ENTRY_t *entry;
+
+	for (stream = 0; stream < num_streams; stream++) {
+		count = 0;
+		for (i = 0; i < pending_index.count; i++) {
+			if (pending_index.entries[i].stream == stream)
+				count++;
+		}
+		if (count == 0)
+			continue;
+		if (super_index_count[stream] >= SUPER_INDEX_ENTRIES)
+			return FALSE;
+
+		duration = count;
+#ifdef AUDIO_RECORDING
+		if (stream == 1) {
+			duration = audio_out->length - audio_length_indexed;
+			audio_length_indexed = audio_out->length;
+		}
+#endif
+		super = &super_index[stream][super_index_count[stream]++];
+		super->offset = segment_start + segment_size;
+		super->size = IX_HEADER_SIZE + count * IX_ENTRY_SIZE;
+		super->duration = duration;
+
+		fputs(index_ids[stream], fp);
+		fputl(super->size - 8, fp);
+		fputw(2, fp); /* longs per entry */
+		fputc(0, fp); /* index sub type */
+		fputc(1, fp); /* index type: AVI_INDEX_OF_CHUNKS */
+		fputl(count, fp);
+		fputs(chunk_ids[stream], fp);
+		fputl((ULONG)(segment_start & 0xffffffff), fp); /* base offset */
+		fputl((ULONG)(segment_start >> 16 >> 16), fp);
+		fputl(0, fp); /* reserved */
+		for (i = 0; i < pending_index.count; i++) {
+			entry = &pending_index.entries[i];
+			if (entry->stream != stream)
+				continue;
+			fputl(entry->offset + 8, fp); /* offset of the data from the base */
+			fputl(entry->is_keyframe ? entry->size : entry->size | DELTA_FRAME_FLAG, fp);
+		}
+		segment_size += super->size;
+		byteswritten += super->size;
+	}
+	pending_index.count = 0;
+	return !ferror(fp);
+}
+
+/* AVI_WriteLegacyIndex writes the 'idx1' index of the first segment, for
+   players that do not support OpenDML. */
+static int AVI_WriteLegacyIndex(FILE *fp)
+{
+	int i;
+	INDEX_ENTRY_t *entry;
+	ULONG index_size;
+
+	/* The index format used here is tag 'idx1" (index version 1.0) & documented at
+	https://docs.microsoft.com/en-us/previous-versions/windows/desktop/api/Aviriff/ns-aviriff-avioldindex
+	*/
+
+	index_size = first_segment_index.count * IDX1_ENTRY_SIZE;
+	fputs("idx1", fp);
+	fputl(index_size, fp);
+
+	for (i = 0; i < first_segment_index.count; i++) {
+		entry = &first_segment_index.entries[i];
+		fputs(chunk_ids[entry->stream], fp);
+		fputl(entry->is_keyframe ? AVIIF_KEYFRAME : 0, fp); /* flags: is a keyframe */
+		fputl(entry->offset - (header_size - 4), fp); /* offset in bytes from start of the 'movi' list */
+		fputl(entry->size, fp); /* size of frame */
+	}
+	segment_size += 8 + index_size;
+	byteswritten += 8 + index_size;
+	AVI_FreeIndex(&first_segment_index);
+	has_idx1 = TRUE;
+	return !ferror(fp);
+}
+
+/* AVI_Checkpoint writes the standard indexes of the chunks since the last
+   checkpoint and updates the header and the size of the current segment, so
+   that everything written so far is playable. When end_segment is TRUE the
+   first segment also gets its idx1 index. The interval to the next
+   checkpoint grows as the super indexes fill.
+
+   RETURNS: TRUE if successful, FALSE if not
+   */
+static int AVI_Checkpoint(FILE *fp, int end_segment)
+{
+	int doublings;
+
+	if (!AVI_WriteStandardIndexes(fp))
+		return FALSE;
+
+	if (segment == 0) {
+		size_movi = segment_size - (header_size - 4);
+		first_segment_frames = video_frames;
+		if (end_segment && !AVI_WriteLegacyIndex(fp))
+			return FALSE;
+		size_riff = segment_size - 8;
+	}
+
+	if (!AVI_WriteHeader(fp))
+		return FALSE;
+	if (segment > 0) {
+		if (fseeko(fp, segment_start + 4, SEEK_SET) != 0)
+			return FALSE;
+		fputl(segment_size - 8, fp); /* RIFF size */
+		if (fseeko(fp, segment_start + 16, SEEK_SET) != 0)
+			return FALSE;
+		fputl(segment_size - 20, fp); /* movi LIST size */
+	}
+	if (fseeko(fp, 0, SEEK_END) != 0)
+		return FALSE;
+	fflush(fp);
+
+	doublings = super_index_count[0] / (SUPER_INDEX_ENTRIES / (CHECKPOINT_DOUBLINGS + 1));
+	if (doublings > CHECKPOINT_DOUBLINGS)
+		doublings = CHECKPOINT_DOUBLINGS;
+	checkpoint_frames = first_checkpoint_frames << doublings;
+	frames_since_checkpoint = 0;
+	return !ferror(fp);
+}
+
+/* AVI_StartSegment ends the current segment and starts a RIFF 'AVIX' one */
+static int AVI_StartSegment(FILE *fp)
+{
+	if (!AVI_Checkpoint(fp, TRUE))
+		return FALSE;
+
+	segment++;
+	segment_start += segment_size;
+	fputs("RIFF", fp);
+	fputl(16, fp); /* updated at the next checkpoint */
+	fputs("AVIX", fp);
+	fputs("LIST", fp);
+	fputl(4, fp);
+	fputs("movi", fp);
+	segment_size = 24;
+	byteswritten += 24;
+	return !ferror(fp);
+}
+
 /* AVI_WriteFrame writes out a single frame of video or audio, and saves the
-   index data for the end-of-file index chunk */
-static int AVI_WriteFrame(FILE *fp, const UBYTE *buf, int size, int frame_type, int is_keyframe) {
+   index data for the standard and idx1 indexes */
+static int AVI_WriteFrame(FILE *fp, const UBYTE *buf, int size, int stream, int is_keyframe) {
 	int padding;
-	int frame_size;
-	int expected_frame_size;
-
-	frame_size = ftell(fp);
+	ULONG index_size;
 
 	/* AVI chunks must be word-aligned, i.e. lengths must be multiples of 2 bytes.
 	   If the size is an odd number, the data is padded with a zero but the length
 	   value still reports the actual length, not the padded length */
 	padding = size % 2;
-	if (frame_type == VIDEO_FRAME_FLAG) {
-		fputs("00dc", fp);
-	}
-	else {
-		fputs("01wb", fp);
+
+	/* start a new segment if this chunk and the indexes wouldn't fit */
+	index_size = 2 * IX_HEADER_SIZE + (pending_index.count + 1) * IX_ENTRY_SIZE;
+	if (segment == 0)
+		index_size += 8 + (first_segment_index.count + 1) * IDX1_ENTRY_SIZE;
+	if (segment_size + 8 + size + padding + index_size > SEGMENT_SIZE) {
+		if (!AVI_StartSegment(fp))
+			return 0;
 	}
+
+	AVI_AddIndexEntry(&pending_index, segment_size, size, stream, is_keyframe);
+	if (segment == 0)
+		AVI_AddIndexEntry(&first_segment_index, segment_size, size, stream, is_keyframe);
+
+	fputs(chunk_ids[stream], fp);
 	fputl(size, fp);
 	fwrite(buf, 1, size, fp);
 	if (padding) {
 		fputc(0, fp);
 	}
-	expected_frame_size = 8 + size + padding;
-
-	size |= frame_type;
-	if (is_keyframe) size |= KEYFRAME_FLAG;
-	frame_indexes[frames_written] = size;
-	frames_written++;
-	if (frames_written >= num_frames_allocated) {
-		num_frames_allocated += FRAME_INDEX_ALLOC_SIZE;
-		frame_indexes = (ULONG *)Util_realloc(frame_indexes, num_frames_allocated * sizeof(ULONG));
-	}
-
-	/* update size limit calculation including the 16 bytes needed for each index entry */
-	frame_size = ftell(fp) - frame_size;
-	byteswritten += frame_size + 16;
+	segment_size += 8 + size + padding;
+	byteswritten += 8 + padding;
 
-	/* check expected file data written equals the calculated size */
-	return frame_size == expected_frame_size;
+	return !ferror(fp);
 }
 
 /* AVI_VideoFrame adds a video frame to the stream and updates the video
    statistics. */
 static int AVI_VideoFrame(FILE *fp, const UBYTE *buf, int bufsize, int is_keyframe) {
-	return AVI_WriteFrame(fp, buf, bufsize, VIDEO_FRAME_FLAG, is_keyframe);
+	if (!AVI_WriteFrame(fp, buf, bufsize, 0, is_keyframe))
+		return 0;
+	video_frames++;
+	if (++frames_since_checkpoint >= checkpoint_frames)
+		return AVI_Checkpoint(fp, FALSE);
+	return 1;
 }
 
 #ifdef AUDIO_RECORDING
 /* AVI_AudioFrame adds audio data to the stream and update the audio
    statistics. */
 static int AVI_AudioFrame(FILE *fp, const UBYTE *buf, int bufsize) {
-	return AVI_WriteFrame(fp, buf, bufsize, AUDIO_FRAME_FLAG, TRUE);
+	return AVI_WriteFrame(fp, buf, bufsize, 1, TRUE);
 }
 #endif
 
-static int AVI_WriteIndex(FILE *fp) {
-	int i;
-	int offset;
-	int size;
-	int index_size;
-	int chunk_size;
-	ULONG index;
-	int is_keyframe;
-
-	if (frames_written == 0) return 0;
-
-	chunk_size = ftell(fp);
-	offset = 4;
-	index_size = frames_written * 16;
-
-	/* The index format used here is tag 'idx1" (index version 1.0) & documented at
-	https://docs.microsoft.com/en-us/previous-versions/windows/desktop/api/Aviriff/ns-aviriff-avioldindex
-	*/
-
-	fputs("idx1", fp);
-	fputl(index_size, fp);
-
-	for (i = 0; i < frames_written; i++) {
-		index = frame_indexes[i];
-		is_keyframe = index & KEYFRAME_FLAG ? 0x10 : 0;
-		size = index & FRAME_SIZE_MASK;
-		if (index & VIDEO_FRAME_FLAG)
-			fputs("00dc", fp); /* stream 0, a compressed video frame */
-		else
-			fputs("01wb", fp); /* stream 1, audio data */
-		fputl(is_keyframe, fp); /* flags: is a keyframe */
-		fputl(offset, fp); /* offset in bytes from start of the 'movi' list */
-		fputl(size, fp); /* size of frame */
-		offset += size + 8 + (size % 2); /* make sure to word-align next offset */
-	}
-
-	chunk_size = ftell(fp) - chunk_size;
-	byteswritten += chunk_size;
-	return (chunk_size == 8 + index_size);
+/* The file size is not limited, but each checkpoint and segment takes an
+   entry of the super indexes; one entry is kept for AVI_Finalize. Both
+   can happen in the same frame. */
+static int AVI_SizeCheck(CONTAINER_SIZE_t size) {
+	return super_index_count[0] < SUPER_INDEX_ENTRIES - 2 && super_index_count[1] < SUPER_INDEX_ENTRIES - 2;
 }
 
-static int AVI_SizeCheck(int size) {
-	return size < MAX_RIFF_FILE_SIZE;
-}
-
-/* AVI_Finalize must be called to create a valid AVI file, because the header
-   at the beginning of the file must be modified to indicate the number of
-   samples in the file.
+/* AVI_Finalize must be called to create a complete AVI file, because the
+   remaining indexes must be written and the header must be updated with the
+   final sizes.
 
    RETURNS: TRUE if file closed with no problems, FALSE if failure during close
    */
 static int AVI_Finalize(FILE *fp)
 {
-	int result = 1;
-
-	size_movi = ftell(fp) - size_movi; /* movi payload ends here */
-	result = AVI_WriteIndex(fp);
-	if (result > 0) {
-		size_riff = ftell(fp) - 8;
-		result = AVI_WriteHeader(fp);
+	int result;
 
-		if (!result) {
-			Log_print("Failed writing AVI header; file will not be playable.");
-		}
-	}
-	else {
-		Log_print("Failed writing AVI index; file will not be playable.");
+	result = AVI_Checkpoint(fp, TRUE);
+	if (!result) {
+		Log_print("Failed writing AVI index; file is playable up to the last checkpoint.");
 	}
 
-	free(frame_indexes);
-	frame_indexes = NULL;
-	num_frames_allocated = 0;
+	AVI_FreeIndex(&pending_index);
+	AVI_FreeIndex(&first_segment_index);
+	free(super_index[0]);
+	free(super_index[1]);
+	super_index[0] = NULL;
+	super_index[1] = NULL;
 	return result;
 }
 
@@ -463,6 +748,7 @@ CONTAINER_t Container_AVI = {
 	NULL,
 #endif
 	&AVI_VideoFrame,
+	NULL,
 	&AVI_SizeCheck,
 	&AVI_Finalize,
 };
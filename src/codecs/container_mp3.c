@@ -63,7 +63,7 @@ static int MP3_AudioFrame(FILE *fp, const UBYTE *buf, int bufsize)
 
 
 /* MP3 doesn't have a size limit. */
-static int MP3_SizeCheck(int size)
+static int MP3_SizeCheck(CONTAINER_SIZE_t size)
 {
 	return 1;
 }
@@ -81,6 +81,7 @@ CONTAINER_t Container_MP3 = {
 	&MP3_Prepare,
 	&MP3_AudioFrame,
 	NULL,
+	NULL,
 	&MP3_SizeCheck,
 	&MP3_Finalize,
 };
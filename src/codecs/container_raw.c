@@ -0,0 +1,368 @@
+/*
+ * container_raw.c - raw frame stream for external encoders
+ *
+ * Copyright (C) 2021 Atari800 development team (see DOC/CREDITS)
+ *
+ * This file is part of the Atari800 emulator project which emulates
+ * the Atari 400, 800, 800XL, 130XE, and 5200 8-bit computers.
+ *
+ * Atari800 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Atari800 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Atari800; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/* This file is only compiled when VIDEO_RECORDING is defined. */
+
+/* The stream is written front to back and never seeks, so it can be written
+   to a named pipe and read by another program while recording. It is a
+   sequence of chunks, each an identifier of 4 characters and the length of
+   the data as a little endian 32 bit value, followed by the data:
+
+     'A8RW'  stream header, always first (28 bytes):
+               version (16 bits, currently 1)
+               pixel format (16 bits): 0 = indexed, 1 = RGB24
+               width, height (16 bits each)
+               rate, scale (32 bits each); frames per second = rate / scale
+               audio format (16 bits): WAV format tag, 1 = PCM, 0 = no audio
+               audio channels (16 bits)
+               audio sample rate (32 bits)
+               audio bits per sample, audio block align (16 bits each)
+     'PAL '  palette, 256 red, green, blue triplets. Sent before the first
+             frame and again whenever the palette changes; indexed only.
+     'VIDF'  one frame, top line first, one byte per pixel (indexed) or red,
+             green and blue bytes per pixel (RGB24)
+     'AUDF'  audio samples, interleaved when stereo
+
+   Audio is held back and sent just before the next frame. The video data is
+   written straight from the screen buffer with a single writev for each
+   frame, together with the audio and palette gathered since the previous
+   frame. */
+
+#include "config.h"
+#if defined(HAVE_WRITEV) && defined(HAVE_SYS_UIO_H) && defined(HAVE_UNISTD_H)
+#define _XOPEN_SOURCE 600 /* for fileno, writev and IOV_MAX */
+#define ZERO_COPY
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef ZERO_COPY
+#include <errno.h>
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+#include "file_export.h"
+#include "colours.h"
+#include "screen.h"
+#include "util.h"
+#include "log.h"
+#ifdef AUDIO_RECORDING
+#include "codecs/audio.h"
+#endif
+#include "codecs/image.h"
+#include "codecs/video.h"
+#include "codecs/container.h"
+#include "codecs/container_raw.h"
+
+#ifdef ZERO_COPY
+typedef struct iovec SPAN_t;
+#ifdef IOV_MAX
+#define MAX_SPANS_PER_WRITE IOV_MAX
+#else
+#define MAX_SPANS_PER_WRITE 16
+#endif
+#else
+typedef struct {
+	void *iov_base;
+	size_t iov_len;
+} SPAN_t;
+/* without writev, the stream is batched by a large stdio buffer */
+#define STREAM_BUFFER_SIZE (1024 * 1024)
+#endif
+
+#define HEADER_SIZE 28
+#define PALETTE_SIZE (256 * 3)
+
+static THREAD_LOCAL int pixel_format;
+static THREAD_LOCAL int frame_size;
+
+/* palette chunk, rebuilt when Colours_table changes */
+static THREAD_LOCAL int palette_sent[256];
+static THREAD_LOCAL UBYTE palette_chunk[8 + PALETTE_SIZE];
+
+/* RGB24 frames are converted here */
+static THREAD_LOCAL UBYTE *rgb_frame;
+
+/* audio chunks waiting to be written with the next frame */
+static THREAD_LOCAL UBYTE *pending_audio;
+static THREAD_LOCAL int pending_size;
+static THREAD_LOCAL int pending_allocated;
+
+/* chunks of the next write: palette, audio, frame header, and the lines */
+static THREAD_LOCAL SPAN_t *spans;
+static THREAD_LOCAL UBYTE frame_header[8];
+
+
+static void PutLong(UBYTE *buf, ULONG x)
+{
+	buf[0] = x & 0xff;
+	buf[1] = (x >> 8) & 0xff;
+	buf[2] = (x >> 16) & 0xff;
+	buf[3] = (x >> 24) & 0xff;
+}
+
+static void AddSpan(int *num_spans, const UBYTE *data, int size)
+{
+	spans[*num_spans].iov_base = (void *) data;
+	spans[*num_spans].iov_len = size;
+	(*num_spans)++;
+}
+
+/* RAW_WriteSpans writes all the spans in order, writing directly from their
+   buffers when possible.
+
+   RETURNS: TRUE if everything was written, FALSE if not
+   */
+static int RAW_WriteSpans(FILE *fp, SPAN_t *span, int num_spans)
+{
+#ifdef ZERO_COPY
+	int fd = fileno(fp);
+
+	while (num_spans > 0) {
+		ssize_t written = writev(fd, span, num_spans < MAX_SPANS_PER_WRITE ? num_spans : MAX_SPANS_PER_WRITE);
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+			return FALSE;
+		}
+		/* a pipe may accept only part of the data */
+		while (num_spans > 0 && (size_t) written >= span->iov_len) {
+			written -= span->iov_len;
+			span++;
+			num_spans--;
+		}
+		if (num_spans > 0) {
+			span->iov_base = (UBYTE *) span->iov_base + written;
+			span->iov_len -= written;
+		}
+	}
+	return TRUE;
+#else
+	int i;
+
+	for (i = 0; i < num_spans; i++) {
+		if (fwrite(span[i].iov_base, 1, span[i].iov_len, fp) != span[i].iov_len)
+			return FALSE;
+	}
+	return TRUE;
+#endif
+}
+
+/* RAW_Prepare writes the stream header. The palette is sent with the first
+   frame.
+
+   RETURNS: TRUE if the header was written, FALSE if not
+   */
+static int RAW_Prepare(FILE *fp)
+{
+	int bytes_per_pixel;
+
+#ifndef ZERO_COPY
+	setvbuf(fp, NULL, _IOFBF, STREAM_BUFFER_SIZE);
+#endif
+	CODECS_IMAGE_SetMargins();
+	pixel_format = video_raw_format;
+	bytes_per_pixel = pixel_format == VIDEO_RAW_RGB24 ? 3 : 1;
+	frame_size = image_codec_width * image_codec_height * bytes_per_pixel;
+
+	fputs("A8RW", fp);
+	fputl(HEADER_SIZE, fp);
+	fputw(1, fp); /* version */
+	fputw(pixel_format, fp);
+	fputw(image_codec_width, fp);
+	fputw(image_codec_height, fp);
+	fputl((ULONG)(fps * 1000000), fp); /* rate */
+	fputl(1000000, fp); /* scale */
+#ifdef AUDIO_RECORDING
+	if (audio_codec) {
+		fputw(audio_codec->format_type, fp);
+		fputw(audio_out->num_channels, fp);
+		fputl(audio_out->sample_rate, fp);
+		fputw(audio_out->bits_per_sample, fp);
+		fputw(audio_out->block_align, fp);
+	}
+	else
+#endif
+	{
+		fputw(0, fp);
+		fputw(0, fp);
+		fputl(0, fp);
+		fputw(0, fp);
+		fputw(0, fp);
+	}
+	/* the rest of the stream is written past stdio */
+	fflush(fp);
+	if (ferror(fp)) {
+		File_Export_SetErrorMessage("Failed writing raw stream header");
+		return 0;
+	}
+
+	/* make the first frame send the palette */
+	palette_sent[0] = ~Colours_table[0];
+	memcpy(palette_chunk, "PAL ", 4);
+	PutLong(palette_chunk + 4, PALETTE_SIZE);
+
+	memcpy(frame_header, "VIDF", 4);
+	PutLong(frame_header + 4, frame_size);
+
+	if (pixel_format == VIDEO_RAW_RGB24)
+		rgb_frame = (UBYTE *)Util_malloc(frame_size);
+	spans = (SPAN_t *)Util_malloc((image_codec_height + 3) * sizeof(SPAN_t));
+	pending_size = 0;
+
+	byteswritten = 8 + HEADER_SIZE;
+	return 1;
+}
+
+#ifdef AUDIO_RECORDING
+/* RAW_AudioFrame keeps the samples until the next video frame, so that both
+   are written at once.
+
+   RETURNS: TRUE */
+static int RAW_AudioFrame(FILE *fp, const UBYTE *buf, int bufsize)
+{
+	if (pending_size + 8 + bufsize > pending_allocated) {
+		pending_allocated = pending_size + 8 + bufsize;
+		pending_audio = (UBYTE *)Util_realloc(pending_audio, pending_allocated);
+	}
+	memcpy(pending_audio + pending_size, "AUDF", 4);
+	PutLong(pending_audio + pending_size + 4, bufsize);
+	memcpy(pending_audio + pending_size + 8, buf, bufsize);
+	pending_size += 8 + bufsize;
+	byteswritten += 8;
+	return 1;
+}
+#endif
+
+/* RAW_ScreenFrame writes the frame with the palette, if it has changed, and
+   the audio since the previous frame. Indexed lines are written from the
+   screen itself. palette is the Colours_table the screen was drawn with.
+
+   RETURNS: size of the frame, or zero if writing failed
+   */
+static int RAW_ScreenFrame(FILE *fp, const UBYTE *screen, const int *palette)
+{
+	int num_spans = 0;
+	int x;
+	int y;
+	const UBYTE *line;
+
+	if (pixel_format == VIDEO_RAW_INDEXED && memcmp(palette_sent, palette, sizeof(palette_sent)) != 0) {
+		UBYTE *p = palette_chunk + 8;
+		memcpy(palette_sent, palette, sizeof(palette_sent));
+		for (x = 0; x < 256; x++) {
+			*p++ = (UBYTE) (palette[x] >> 16);
+			*p++ = (UBYTE) (palette[x] >> 8);
+			*p++ = (UBYTE) palette[x];
+		}
+		AddSpan(&num_spans, palette_chunk, sizeof(palette_chunk));
+		byteswritten += sizeof(palette_chunk);
+	}
+	if (pending_size > 0) {
+		AddSpan(&num_spans, pending_audio, pending_size);
+	}
+	AddSpan(&num_spans, frame_header, 8);
+
+	line = screen + Screen_WIDTH * image_codec_top_margin + image_codec_left_margin;
+	if (pixel_format == VIDEO_RAW_RGB24) {
+		UBYTE *p = rgb_frame;
+		for (y = 0; y < image_codec_height; y++) {
+			for (x = 0; x < image_codec_width; x++) {
+				*p++ = (UBYTE) (palette[line[x]] >> 16);
+				*p++ = (UBYTE) (palette[line[x]] >> 8);
+				*p++ = (UBYTE) palette[line[x]];
+			}
+			line += Screen_WIDTH;
+		}
+		AddSpan(&num_spans, rgb_frame, frame_size);
+	}
+	else if (image_codec_width == Screen_WIDTH) {
+		AddSpan(&num_spans, line, frame_size);
+	}
+	else {
+		for (y = 0; y < image_codec_height; y++) {
+			AddSpan(&num_spans, line, image_codec_width);
+			line += Screen_WIDTH;
+		}
+	}
+
+	pending_size = 0;
+	if (!RAW_WriteSpans(fp, spans, num_spans)) {
+		File_Export_SetErrorMessage("Failed writing to raw stream");
+		return 0;
+	}
+	byteswritten += 8;
+	return frame_size;
+}
+
+static int RAW_SizeCheck(CONTAINER_SIZE_t size) {
+	/* streams have no size limit */
+	return TRUE;
+}
+
+/* RAW_Finalize writes any audio left after the last frame. There is nothing
+   to update at the start of the stream.
+
+   RETURNS: TRUE if the audio was written, FALSE if not
+   */
+static int RAW_Finalize(FILE *fp)
+{
+	int result = TRUE;
+
+	if (pending_size > 0) {
+		spans[0].iov_base = pending_audio;
+		spans[0].iov_len = pending_size;
+		result = RAW_WriteSpans(fp, spans, 1);
+		pending_size = 0;
+	}
+
+	free(spans);
+	spans = NULL;
+	free(rgb_frame);
+	rgb_frame = NULL;
+	free(pending_audio);
+	pending_audio = NULL;
+	pending_allocated = 0;
+	return result;
+}
+
+
+CONTAINER_t Container_RAW = {
+	"a8raw",
+	"Raw frame and PCM stream",
+	&RAW_Prepare,
+#ifdef AUDIO_RECORDING
+	&RAW_AudioFrame,
+#else
+	NULL,
+#endif
+	NULL,
+	&RAW_ScreenFrame,
+	&RAW_SizeCheck,
+	&RAW_Finalize,
+};
+
+/*
+vim:ts=4:sw=4:
+*/
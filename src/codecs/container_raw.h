@@ -0,0 +1,9 @@
+#ifndef CODECS_CONTAINER_RAW_H_
+#define CODECS_CONTAINER_RAW_H_
+
+#include "atari.h"
+#include "codecs/container.h"
+
+extern CONTAINER_t Container_RAW;
+
+#endif /* CODECS_CONTAINER_RAW_H_ */
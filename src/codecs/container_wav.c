@@ -35,7 +35,7 @@
 #include "codecs/audio.h"
 
 
-static int fact_chunk_size;
+static THREAD_LOCAL int fact_chunk_size;
 
 /* WAV_Prepare will start a new sound file and write out the header. Note that
    the file will not be valid until the it is closed with WAV_Finalize because
@@ -133,7 +133,7 @@ static int WAV_AudioFrame(FILE *fp, const UBYTE *buf, int bufsize)
 	return (size > 0);
 }
 
-static int WAV_SizeCheck(int size) {
+static int WAV_SizeCheck(CONTAINER_SIZE_t size) {
 	return size < MAX_RIFF_FILE_SIZE;
 }
 
@@ -181,6 +181,7 @@ CONTAINER_t Container_WAV = {
 	&WAV_Prepare,
 	&WAV_AudioFrame,
 	NULL,
+	NULL,
 	&WAV_SizeCheck,
 	&WAV_Finalize,
 };
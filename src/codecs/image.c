@@ -37,13 +37,13 @@
 #include "codecs/image_png.h"
 #endif
 
-IMAGE_CODEC_t *image_codec = NULL;
+THREAD_LOCAL IMAGE_CODEC_t *image_codec = NULL;
 
 /* image size will be determined in a call to CODECS_IMAGE_SetMargins() below */
-int image_codec_left_margin;
-int image_codec_top_margin;
-int image_codec_width;
-int image_codec_height;
+THREAD_LOCAL int image_codec_left_margin;
+THREAD_LOCAL int image_codec_top_margin;
+THREAD_LOCAL int image_codec_width;
+THREAD_LOCAL int image_codec_height;
 
 static IMAGE_CODEC_t *known_image_codecs[] = {
 	&Image_Codec_PCX,
@@ -16,11 +16,11 @@ typedef struct {
     IMAGE_CODEC_SaveToBuffer to_buffer;
 } IMAGE_CODEC_t;
 
-extern IMAGE_CODEC_t *image_codec;
-extern int image_codec_left_margin;
-extern int image_codec_top_margin;
-extern int image_codec_width;
-extern int image_codec_height;
+extern THREAD_LOCAL IMAGE_CODEC_t *image_codec;
+extern THREAD_LOCAL int image_codec_left_margin;
+extern THREAD_LOCAL int image_codec_top_margin;
+extern THREAD_LOCAL int image_codec_width;
+extern THREAD_LOCAL int image_codec_height;
 
 void CODECS_IMAGE_SetMargins(void);
 int CODECS_IMAGE_Init(const char *filename);
@@ -38,10 +38,27 @@
 
 #include <png.h>
 
+/* The image data is compressed here rather than by libpng, so that slices of
+   rows can be deflated in parallel. Each slice is a raw deflate stream that
+   ends on a full flush, except the last one, so their concatenation is a
+   single valid zlib stream. A slice uses the end of the previous one as its
+   dictionary, so the split costs little compression. */
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#define PNG_SLICES
+#if defined(THREADED_ENCODING) && defined(HAVE_LIBPTHREAD)
+#include <pthread.h>
+#define PNG_THREADS
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#endif /* HAVE_LIBZ */
+
 #ifdef VIDEO_CODEC_PNG
-static int current_png_size = -1;
-static int max_buffer_size = 0;
-static UBYTE *image_buffer = NULL;
+static THREAD_LOCAL int current_png_size = -1;
+static THREAD_LOCAL int max_buffer_size = 0;
+static THREAD_LOCAL UBYTE *image_buffer = NULL;
 
 static void png_write_fn_callback(png_structp png_ptr, png_bytep data, png_size_t length)
 {
@@ -58,6 +75,249 @@ static void png_write_fn_callback(png_structp png_ptr, png_bytep data, png_size_
 }
 #endif /* VIDEO_CODEC_PNG */
 
+#ifdef PNG_SLICES
+#define MAX_SLICES 8
+/* fewer rows than this per slice don't pay for a thread */
+#define MIN_SLICE_ROWS 16
+/* largest dictionary deflate can use */
+#define MAX_DICTIONARY 32768
+
+typedef struct {
+	const UBYTE *in;	/* filtered rows of the slice */
+	int in_size;
+	const UBYTE *dictionary;	/* filtered rows just before the slice */
+	int dictionary_size;
+	int last;
+	UBYTE *out;
+	int out_capacity;
+	int out_size;	/* compressed size, or -1 on error */
+	uLong adler;
+} PNG_SLICE_t;
+
+static THREAD_LOCAL int png_slices = 0;
+
+/* Paeth predictor as defined by the PNG specification */
+static int Paeth(int a, int b, int c)
+{
+	int p = a + b - c;
+	int pa = abs(p - a);
+	int pb = abs(p - b);
+	int pc = abs(p - c);
+	if (pa <= pb && pa <= pc)
+		return a;
+	if (pb <= pc)
+		return b;
+	return c;
+}
+
+/* Applies PNG filter type to the row, storing the type and the filtered
+   bytes in out. prev is the previous row, or NULL for the first one. */
+static void FilterRow(int type, const UBYTE *row, const UBYTE *prev, int size, int bpp, UBYTE *out)
+{
+	int i;
+
+	*out++ = type;
+	for (i = 0; i < size; i++) {
+		int a = i >= bpp ? row[i - bpp] : 0;
+		int b = prev != NULL ? prev[i] : 0;
+		int c = i >= bpp && prev != NULL ? prev[i - bpp] : 0;
+		switch (type) {
+		case 0:
+			out[i] = row[i];
+			break;
+		case 1:
+			out[i] = (UBYTE) (row[i] - a);
+			break;
+		case 2:
+			out[i] = (UBYTE) (row[i] - b);
+			break;
+		case 3:
+			out[i] = (UBYTE) (row[i] - ((a + b) >> 1));
+			break;
+		default:
+			out[i] = (UBYTE) (row[i] - Paeth(a, b, c));
+			break;
+		}
+	}
+}
+
+/* Estimated cost of compressing a filtered row: the usual sum of the
+   absolute values of the bytes */
+static int FilterCost(const UBYTE *out, int size)
+{
+	int cost = 0;
+	int i;
+
+	for (i = 0; i < size; i++)
+		cost += out[i] < 128 ? out[i] : 256 - out[i];
+	return cost;
+}
+
+/* Filters all rows into out. Palette rows are not filtered: the indices
+   are not related by value, and deflate already codes the long runs and
+   the rows repeating the one above that Atari screens are made of better
+   than it codes the output of any filter. For RGB rows (blended interlaced
+   screenshots) the filter with the lowest FilterCost is chosen. */
+static void FilterRows(png_bytep *rows, int width, int height, int bpp, UBYTE *out)
+{
+	int size = width * bpp;
+	UBYTE *trial = bpp == 1 ? NULL : (UBYTE *) Util_malloc(size + 1);
+	int y;
+
+	for (y = 0; y < height; y++) {
+		if (bpp == 1) {
+			*out = 0;
+			memcpy(out + 1, rows[y], size);
+		}
+		else {
+			const UBYTE *prev = y > 0 ? rows[y - 1] : NULL;
+			int best_cost = -1;
+			int type;
+			/* the first row has no row above for Up, Average and Paeth */
+			for (type = 0; type < (y > 0 ? 5 : 2); type++) {
+				int cost;
+				FilterRow(type, rows[y], prev, size, bpp, trial);
+				cost = FilterCost(trial + 1, size);
+				if (best_cost < 0 || cost < best_cost) {
+					best_cost = cost;
+					memcpy(out, trial, size + 1);
+				}
+			}
+		}
+		out += size + 1;
+	}
+	free(trial);
+}
+
+static void *CompressSlice(void *arg)
+{
+	PNG_SLICE_t *slice = (PNG_SLICE_t *) arg;
+	z_stream zstream;
+	int result;
+
+	slice->out_size = -1;
+	slice->adler = adler32(adler32(0L, Z_NULL, 0), slice->in, slice->in_size);
+	memset(&zstream, 0, sizeof(zstream));
+	if (deflateInit2(&zstream, FILE_EXPORT_compression_level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return NULL;
+	if (slice->dictionary_size > 0)
+		deflateSetDictionary(&zstream, slice->dictionary, slice->dictionary_size);
+	zstream.next_in = (Bytef *) slice->in;
+	zstream.avail_in = slice->in_size;
+	zstream.next_out = slice->out;
+	zstream.avail_out = slice->out_capacity;
+	result = deflate(&zstream, slice->last ? Z_FINISH : Z_FULL_FLUSH);
+	if (slice->last ? result == Z_STREAM_END : result == Z_OK && zstream.avail_in == 0 && zstream.avail_out > 0)
+		slice->out_size = zstream.total_out;
+	deflateEnd(&zstream);
+	return NULL;
+}
+
+static int NumSlices(int height)
+{
+	int n;
+
+	if (png_slices == 0) {
+		png_slices = 1;
+#if defined(PNG_THREADS) && defined(_SC_NPROCESSORS_ONLN)
+		n = (int) sysconf(_SC_NPROCESSORS_ONLN);
+		if (n > 1)
+			png_slices = n < MAX_SLICES ? n : MAX_SLICES;
+#endif
+	}
+	n = height / MIN_SLICE_ROWS;
+	if (n > png_slices)
+		n = png_slices;
+	return n > 0 ? n : 1;
+}
+
+/* Writes the rows as the IDAT chunk, compressing slices of rows in
+   parallel. Returns FALSE, without writing anything, on error. */
+static int WriteImageData(png_structp png_ptr, png_bytep *rows, int width, int height, int bpp)
+{
+	int row_size = width * bpp + 1;
+	UBYTE *filtered = (UBYTE *) Util_malloc(row_size * height);
+	PNG_SLICE_t slices[MAX_SLICES];
+#ifdef PNG_THREADS
+	pthread_t threads[MAX_SLICES];
+	int started[MAX_SLICES];
+#endif
+	int num_slices = NumSlices(height);
+	int slice_rows = (height + num_slices - 1) / num_slices;
+	int level_flags;
+	int header;
+	int size;
+	uLong adler;
+	UBYTE *idat;
+	UBYTE *ptr;
+	int i;
+	int ok = TRUE;
+
+	FilterRows(rows, width, height, bpp, filtered);
+
+	for (i = 0; i < num_slices; i++) {
+		PNG_SLICE_t *slice = &slices[i];
+		int first = i * slice_rows;
+		int count = height - first < slice_rows ? height - first : slice_rows;
+		slice->in = filtered + first * row_size;
+		slice->in_size = count * row_size;
+		slice->dictionary_size = first * row_size < MAX_DICTIONARY ? first * row_size : MAX_DICTIONARY;
+		slice->dictionary = slice->in - slice->dictionary_size;
+		slice->last = i == num_slices - 1;
+		/* compressBound plus room for the flush marker */
+		slice->out_capacity = compressBound(slice->in_size) + 64;
+		slice->out = (UBYTE *) Util_malloc(slice->out_capacity);
+	}
+#ifdef PNG_THREADS
+	for (i = 1; i < num_slices; i++)
+		started[i] = pthread_create(&threads[i], NULL, CompressSlice, &slices[i]) == 0;
+	CompressSlice(&slices[0]);
+	for (i = 1; i < num_slices; i++) {
+		if (started[i])
+			pthread_join(threads[i], NULL);
+		else
+			CompressSlice(&slices[i]);
+	}
+#else
+	for (i = 0; i < num_slices; i++)
+		CompressSlice(&slices[i]);
+#endif
+
+	/* zlib header: deflate with a 32K window, the level as zlib sets it */
+	level_flags = FILE_EXPORT_compression_level < 2 ? 0 : FILE_EXPORT_compression_level < 6 ? 1 : FILE_EXPORT_compression_level == 6 ? 2 : 3;
+	header = (0x78 << 8) | (level_flags << 6);
+	header += 31 - header % 31;
+	size = 2 + 4;
+	for (i = 0; i < num_slices; i++) {
+		if (slices[i].out_size < 0)
+			ok = FALSE;
+		else
+			size += slices[i].out_size;
+	}
+	idat = ptr = (UBYTE *) Util_malloc(size);
+	*ptr++ = header >> 8;
+	*ptr++ = header & 0xff;
+	adler = adler32(0L, Z_NULL, 0);
+	for (i = 0; i < num_slices; i++) {
+		if (ok) {
+			memcpy(ptr, slices[i].out, slices[i].out_size);
+			ptr += slices[i].out_size;
+			adler = adler32_combine(adler, slices[i].adler, slices[i].in_size);
+		}
+		free(slices[i].out);
+	}
+	*ptr++ = (UBYTE) (adler >> 24);
+	*ptr++ = (UBYTE) (adler >> 16);
+	*ptr++ = (UBYTE) (adler >> 8);
+	*ptr++ = (UBYTE) adler;
+	if (ok)
+		png_write_chunk(png_ptr, (png_const_bytep) "IDAT", idat, size);
+	free(idat);
+	free(filtered);
+	return ok;
+}
+#endif /* PNG_SLICES */
+
 /* PNG_SaveScreen saves the screen data to the file in PNG format, optionally
    using interlace if ptr2 is not NULL.
 
@@ -141,8 +401,19 @@ static int PNG_SaveScreen(FILE *fp, UBYTE *ptr1, UBYTE *ptr2)
 			ptr2 += Screen_WIDTH - image_codec_width;
 		}
 	}
+#ifdef PNG_SLICES
+	png_write_info(png_ptr, info_ptr);
+	if (WriteImageData(png_ptr, rows, image_codec_width, image_codec_height, ptr2 == NULL ? 1 : 3))
+		png_write_chunk(png_ptr, (png_const_bytep) "IEND", NULL, 0);
+	else {
+		/* let libpng compress the rows instead */
+		png_write_image(png_ptr, rows);
+		png_write_end(png_ptr, info_ptr);
+	}
+#else
 	png_set_rows(png_ptr, info_ptr, rows);
 	png_write_png(png_ptr, info_ptr, PNG_TRANSFORM_IDENTITY, NULL);
+#endif
 	png_destroy_write_struct(&png_ptr, &info_ptr);
 	if (ptr2 != NULL)
 		free(rows[0]);
@@ -43,19 +43,43 @@
 /* Global pointer to current video codec, or NULL if one has not been
    initialized. This pointer should not be used after a call to
    video_codec->end().  */
-VIDEO_CODEC_t *video_codec = NULL;
+THREAD_LOCAL VIDEO_CODEC_t *video_codec = NULL;
 
 /* Global variables for the video buffer and size. This buffer is used to hold
    video frames generated by the codec. */
-int video_buffer_size = 0;
-UBYTE *video_buffer = NULL;
+THREAD_LOCAL int video_buffer_size = 0;
+THREAD_LOCAL UBYTE *video_buffer = NULL;
 
-static VIDEO_CODEC_t *requested_video_codec = NULL;
+static THREAD_LOCAL VIDEO_CODEC_t *requested_video_codec = NULL;
 
 /* Some codecs allow for keyframes (full frame compression) and inter-frames
    (only the differences from the previous frame) */
 #define MAX_KEYFRAME_INTERVAL 500
-int video_codec_keyframe_interval = 0;
+THREAD_LOCAL int video_codec_keyframe_interval = 0;
+
+/* Trade-off between speed and file size for codecs with motion compensation */
+THREAD_LOCAL int video_codec_motion_search = VIDEO_CODEC_SEARCH_DIAMOND;
+
+static char const * const motion_search_names[] = { "fast", "diamond", "exhaustive" };
+
+/* Pixels written by the raw stream container, which bypasses the codecs */
+THREAD_LOCAL int video_raw_format = VIDEO_RAW_INDEXED;
+
+static char const * const raw_format_names[] = { "indexed", "rgb24" };
+
+static int match_name(char const * const *names, int count, const char *name)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (Util_stricmp(name, names[i]) == 0)
+			return i;
+	}
+	return -1;
+}
+
+#define match_motion_search(name) match_name(motion_search_names, sizeof(motion_search_names) / sizeof(motion_search_names[0]), name)
+#define match_raw_format(name) match_name(raw_format_names, sizeof(raw_format_names) / sizeof(raw_format_names[0]), name)
 
 
 static VIDEO_CODEC_t *known_video_codecs[] = {
@@ -149,12 +173,36 @@ int CODECS_VIDEO_Initialise(int *argc, char *argv[])
 			}
 			else a_m = TRUE;
 		}
+		else if (strcmp(argv[i], "-motion-search") == 0) {
+			if (i_a) {
+				int mode = match_motion_search(argv[++i]);
+				if (mode >= 0) {
+					video_codec_motion_search = mode;
+				}
+				else a_i = TRUE;
+			}
+			else a_m = TRUE;
+		}
+		else if (strcmp(argv[i], "-raw-format") == 0) {
+			if (i_a) {
+				int format = match_raw_format(argv[++i]);
+				if (format >= 0) {
+					video_raw_format = format;
+				}
+				else a_i = TRUE;
+			}
+			else a_m = TRUE;
+		}
 		else {
 			if (strcmp(argv[i], "-help") == 0) {
 				char buf[256];
 				Log_print(video_codec_args(buf));
 				Log_print("\t                 Select video codec (default: auto)");
 				Log_print("\t-keyint <num>    Set video keyframe interval to one keyframe every num frames");
+				Log_print("\t-motion-search fast|diamond|exhaustive");
+				Log_print("\t                 Select ZMBV motion search (default: diamond)");
+				Log_print("\t-raw-format indexed|rgb24");
+				Log_print("\t                 Select pixels of .a8raw streams (default: indexed)");
 			}
 			argv[j++] = argv[i];
 		}
@@ -191,6 +239,18 @@ int CODECS_VIDEO_ReadConfig(char *string, char *ptr)
 			video_codec_keyframe_interval = num;
 		else return FALSE;
 	}
+	else if (strcmp(string, "VIDEO_CODEC_MOTION_SEARCH") == 0) {
+		int mode = match_motion_search(ptr);
+		if (mode >= 0)
+			video_codec_motion_search = mode;
+		else return FALSE;
+	}
+	else if (strcmp(string, "VIDEO_RAW_FORMAT") == 0) {
+		int format = match_raw_format(ptr);
+		if (format >= 0)
+			video_raw_format = format;
+		else return FALSE;
+	}
 	else return FALSE;
 	return TRUE;
 }
@@ -204,6 +264,8 @@ void CODECS_VIDEO_WriteConfig(FILE *fp)
 		fprintf(fp, "VIDEO_CODEC=%s\n", requested_video_codec->codec_id);
 	}
 	fprintf(fp, "VIDEO_CODEC_KEYFRAME_INTERVAL=%d\n", video_codec_keyframe_interval);
+	fprintf(fp, "VIDEO_CODEC_MOTION_SEARCH=%s\n", motion_search_names[video_codec_motion_search]);
+	fprintf(fp, "VIDEO_RAW_FORMAT=%s\n", raw_format_names[video_raw_format]);
 }
 
 
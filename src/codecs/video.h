@@ -28,10 +28,25 @@ typedef struct {
     VIDEO_CODEC_End end;
 } VIDEO_CODEC_t;
 
-extern VIDEO_CODEC_t *video_codec;
-extern int video_buffer_size;
-extern UBYTE *video_buffer;
-extern int video_codec_keyframe_interval;
+extern THREAD_LOCAL VIDEO_CODEC_t *video_codec;
+extern THREAD_LOCAL int video_buffer_size;
+extern THREAD_LOCAL UBYTE *video_buffer;
+extern THREAD_LOCAL int video_codec_keyframe_interval;
+
+/* Motion search used by codecs with motion compensation (ZMBV) */
+enum {
+	VIDEO_CODEC_SEARCH_FAST,	/* diamond search counting differing pixels */
+	VIDEO_CODEC_SEARCH_DIAMOND,	/* diamond search estimating the entropy */
+	VIDEO_CODEC_SEARCH_EXHAUSTIVE	/* every vector within 2 pixels, slowest */
+};
+extern THREAD_LOCAL int video_codec_motion_search;
+
+/* Pixels of the frames in raw streams (.a8raw) */
+enum {
+	VIDEO_RAW_INDEXED,	/* one byte per pixel, with the palette */
+	VIDEO_RAW_RGB24		/* three bytes per pixel: red, green, blue */
+};
+extern THREAD_LOCAL int video_raw_format;
 
 int CODECS_VIDEO_Initialise(int *argc, char *argv[]);
 int CODECS_VIDEO_ReadConfig(char *string, char *ptr);
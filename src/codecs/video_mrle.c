@@ -30,13 +30,13 @@
 #include "screen.h"
 #include "util.h"
 
-static int reference_screen_size = 0;
-static UBYTE *reference_screen = NULL;
+static THREAD_LOCAL int reference_screen_size = 0;
+static THREAD_LOCAL UBYTE *reference_screen = NULL;
 
-static int video_left_margin;
-static int video_top_margin;
-static int video_width;
-static int video_height;
+static THREAD_LOCAL int video_left_margin;
+static THREAD_LOCAL int video_top_margin;
+static THREAD_LOCAL int video_width;
+static THREAD_LOCAL int video_height;
 
 /* This file implements the Microsoft Run Length Encoding video codec, fourcc
    code of 'mrle'.
@@ -32,6 +32,8 @@
    - if compression level is zero, raw uncompressed data is stored rather than
      the zlib stream with compression level 0 data
    - motion estimation range is fixed to a value suited to Atari graphics
+   - the motion search is a predictor-based diamond search unless the
+     exhaustive one is selected, see video_codec_motion_search
 */  
 
 
@@ -43,6 +45,8 @@
 #include "log.h"
 #include "util.h"
 #include "file_export.h"
+#include "codecs/video.h"
+#include "simd.h"
 
 /* When zlib is available, ZMBV is the most efficient video codec in atari800
    and is the default. Without zlib, the RLE codec becomes the default because
@@ -71,52 +75,119 @@
    format is supported here. The original FFmpeg code supported many more types. */
 #define ZMBV_FMT_8BPP 4
 
-static int video_left_margin;
-static int video_top_margin;
-static int video_width;
-static int video_height;
-
-static int lrange, urange;
-static UBYTE *work_buf;
-static UBYTE pal[768];
-static UBYTE *prev_buf, *prev_buf_start;
-static int pstride;
+static THREAD_LOCAL int video_left_margin;
+static THREAD_LOCAL int video_top_margin;
+static THREAD_LOCAL int video_width;
+static THREAD_LOCAL int video_height;
+
+/* motion search of the current recording, see video_codec_motion_search */
+static THREAD_LOCAL int motion_search;
+static THREAD_LOCAL int lrange, urange;
+static THREAD_LOCAL UBYTE *work_buf;
+static THREAD_LOCAL UBYTE pal[768];
+static THREAD_LOCAL UBYTE *prev_buf, *prev_buf_start;
+static THREAD_LOCAL int pstride;
 #ifdef HAVE_LIBZ
-static int zlib_init_ok;
-static z_stream zstream;
+static THREAD_LOCAL int zlib_init_ok;
+static THREAD_LOCAL z_stream zstream;
 #endif
-static int score_tab[ZMBV_BLOCK * ZMBV_BLOCK * 4 + 1];
+static THREAD_LOCAL int score_tab[ZMBV_BLOCK * ZMBV_BLOCK * 4 + 1];
+
+/* Range of the motion vectors tried by the diamond search */
+#define MAX_RANGE 16
 
+/* Number of blocks of the frame moved by each vector, and the most common
+   vector of the previous frame */
+static THREAD_LOCAL int mv_count[(2 * MAX_RANGE + 1) * (2 * MAX_RANGE + 1)];
+static THREAD_LOCAL int common_mx, common_my;
+
+static void find_common_vector(void)
+{
+	int i;
+	int best = 0;
+
+	common_mx = common_my = 0;
+	for (i = 0; i < (int)(sizeof(mv_count) / sizeof(mv_count[0])); i++) {
+		if (mv_count[i] > best) {
+			best = mv_count[i];
+			common_mx = i % (2 * MAX_RANGE + 1) - MAX_RANGE;
+			common_my = i / (2 * MAX_RANGE + 1) - MAX_RANGE;
+		}
+		mv_count[i] = 0;
+	}
+}
+
+
+/* Returns the number of pixels that differ between two blocks */
+static int block_diff(UBYTE *src, int stride, UBYTE *src2, int stride2, int bw, int bh)
+{
+	int count = 0;
+	int i, j;
+
+#ifdef SIMD_SSE2
+	if (bw == ZMBV_BLOCK && bh == ZMBV_BLOCK) {
+		/* two rows of the block per register; equal bytes are -1 after the
+		   compare, so subtracting counts them in each byte */
+		__m128i equal = _mm_setzero_si128();
+		for (j = 0; j < ZMBV_BLOCK; j += 2) {
+			__m128i a = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *) src),
+			                               _mm_loadl_epi64((const __m128i *) (src + stride)));
+			__m128i b = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *) src2),
+			                               _mm_loadl_epi64((const __m128i *) (src2 + stride2)));
+			equal = _mm_sub_epi8(equal, _mm_cmpeq_epi8(a, b));
+			src += 2 * stride;
+			src2 += 2 * stride2;
+		}
+		equal = _mm_sad_epu8(equal, _mm_setzero_si128());
+		return ZMBV_BLOCK * ZMBV_BLOCK - _mm_cvtsi128_si32(equal) - _mm_extract_epi16(equal, 4);
+	}
+#endif
+	for (j = 0; j < bh; j++) {
+		for (i = 0; i < bw; i++)
+			count += src[i] != src2[i];
+		src += stride;
+		src2 += stride2;
+	}
+	return count;
+}
 
 static int block_cmp(UBYTE *src, int stride, UBYTE *src2, int stride2, int bw, int bh, int *xored)
 {
 	int sum = 0;
-	int i, j;
-	UWORD histogram[256] = {0};
+	int i, j, n;
+	UBYTE values[ZMBV_BLOCK * ZMBV_BLOCK];
+	UWORD histogram[256];
+
+	/* Exit early if blocks are equal, which is the most common case */
+	*xored = block_diff(src, stride, src2, stride2, bw, bh) > 0;
+	if (!*xored) return 0;
 
-	/* Build frequency histogram of byte values for src[] ^ src2[] */
+	/* Build frequency histogram of byte values for src[] ^ src2[]. Only the
+	   entries of the values present are cleared and summed. */
+	n = 0;
 	for(j = 0; j < bh; j++){
 		for(i = 0; i < bw; i++){
 			int t = src[i] ^ src2[i];
-			histogram[t]++;
+			values[n++] = t;
+			histogram[t] = 0;
 		}
 		src += stride;
 		src2 += stride2;
 	}
-
-	/* If not all the xored values were 0, then the blocks are different */
-	*xored = (histogram[0] < bw * bh);
-
-	/* Exit early if blocks are equal */
-	if (!*xored) return 0;
+	for(i = 0; i < n; i++)
+		histogram[values[i]]++;
 
 	/* Sum the entropy of all values */
-	for(i = 0; i < 256; i++)
-		sum += score_tab[histogram[i]];
+	for(i = 0; i < n; i++){
+		sum += score_tab[histogram[values[i]]];
+		histogram[values[i]] = 0;
+	}
 
 	return sum;
 }
 
+/* Exhaustive search of all motion vectors in range for the one with the
+   lowest entropy of the xored block */
 static int motion_estimation(UBYTE *src, int sstride, UBYTE *prev, int pstride, int x, int y, int *mx, int *my, int *xored)
 {
 	int dx, dy, txored, tv, bv, bw, bh;
@@ -162,6 +233,79 @@ static int motion_estimation(UBYTE *src, int sstride, UBYTE *prev, int pstride,
 	return bv;
 }
 
+/* Cost of a motion vector for the diamond search: the fast search only
+   counts the differing pixels, the normal one estimates the entropy of the
+   xored block like the exhaustive search. Both are 0 for equal blocks. */
+static int search_cost(UBYTE *src, int sstride, UBYTE *prev, int pstride, int bw, int bh)
+{
+	int xored;
+
+	if (motion_search == VIDEO_CODEC_SEARCH_FAST)
+		return block_diff(src, sstride, prev, pstride, bw, bh);
+	return block_cmp(src, sstride, prev, pstride, bw, bh, &xored);
+}
+
+/* Predictor-based search: starting from the best of (0,0) and the predicted
+   motion vectors, step to the neighbouring vector with the lowest cost until
+   none is better. Scrolling moves most blocks of the screen by
+   the same vector, so the search usually ends at a predictor. pred holds
+   num_pred vectors as x, y pairs. */
+static int diamond_search(UBYTE *src, int sstride, UBYTE *prev, int pstride, int x, int y, const int *pred, int num_pred, int *mx, int *my, int *xored)
+{
+	static const int step_x[4] = { -1, 1, 0, 0 };
+	static const int step_y[4] = { 0, 0, -1, 1 };
+	int bw, bh, bv, tv;
+	int bx, by, cx, cy;
+	int from, dir, i, n;
+
+	bw = FFMIN(ZMBV_BLOCK, video_width - x);
+	bh = FFMIN(ZMBV_BLOCK, video_height - y);
+
+	bv = search_cost(src, sstride, prev, pstride, bw, bh);
+	bx = by = 0;
+	for (i = 0; bv && i < num_pred * 2; i += 2) {
+		if ((pred[i] == bx && pred[i + 1] == by) || (!pred[i] && !pred[i + 1]))
+			continue;
+		tv = search_cost(src, sstride, prev + pred[i] + pred[i + 1] * pstride, pstride, bw, bh);
+		if (tv < bv) {
+			bv = tv;
+			bx = pred[i];
+			by = pred[i + 1];
+		}
+	}
+
+	/* direction of the vector we came from, which need not be tried again */
+	from = -1;
+	for (n = 0; bv && n < lrange + urange; n++) {
+		cx = bx;
+		cy = by;
+		dir = -1;
+		for (i = 0; i < 4; i++) {
+			int nx = bx + step_x[i];
+			int ny = by + step_y[i];
+			if (i == from || nx < -lrange || nx > urange || ny < -lrange || ny > urange)
+				continue;
+			tv = search_cost(src, sstride, prev + nx + ny * pstride, pstride, bw, bh);
+			if (tv < bv) {
+				bv = tv;
+				cx = nx;
+				cy = ny;
+				dir = i;
+			}
+		}
+		if (dir < 0)
+			break;
+		bx = cx;
+		by = cy;
+		from = dir ^ 1;
+	}
+
+	*mx = bx;
+	*my = by;
+	*xored = bv > 0;
+	return bv;
+}
+
 static int ZMBV_CreateFrame(UBYTE *source, int keyframe, UBYTE *buf, int bufsize)
 {
 	UBYTE *src;
@@ -230,7 +374,26 @@ static int ZMBV_CreateFrame(UBYTE *source, int keyframe, UBYTE *buf, int bufsize
 				tsrc = src + x;
 				tprev = prev + x;
 
-				motion_estimation(tsrc, Screen_WIDTH, tprev, pstride, x, y, &mx, &my, &xored);
+				if (motion_search == VIDEO_CODEC_SEARCH_EXHAUSTIVE)
+					motion_estimation(tsrc, Screen_WIDTH, tprev, pstride, x, y, &mx, &my, &xored);
+				else {
+					/* predict the vectors of the blocks on the left and above,
+					   and the most common one of the previous frame. Vectors
+					   are stored doubled, with the xored flag in bit 0. */
+					int pred[6];
+					pred[0] = mx;
+					pred[1] = my;
+					pred[2] = pred[3] = 0;
+					if (y > 0) {
+						pred[2] = (signed char) (mv[-bw * 2] & 0xfe) / 2;
+						pred[3] = (signed char) mv[-bw * 2 + 1] / 2;
+					}
+					pred[4] = common_mx;
+					pred[5] = common_my;
+					diamond_search(tsrc, Screen_WIDTH, tprev, pstride, x, y, pred, 3, &mx, &my, &xored);
+					if (mx || my)
+						mv_count[(my + MAX_RANGE) * (2 * MAX_RANGE + 1) + mx + MAX_RANGE]++;
+				}
 				mv[0] = (mx * 2) | !!xored;
 				mv[1] = my * 2;
 				tprev += mx + my * pstride;
@@ -246,6 +409,8 @@ static int ZMBV_CreateFrame(UBYTE *source, int keyframe, UBYTE *buf, int bufsize
 			src += Screen_WIDTH * ZMBV_BLOCK;
 			prev += pstride * ZMBV_BLOCK;
 		}
+		if (motion_search != VIDEO_CODEC_SEARCH_EXHAUSTIVE)
+			find_common_vector();
 	}
 	/* save the previous frame */
 	src = source + (Screen_WIDTH * video_top_margin) + video_left_margin;
@@ -324,8 +489,16 @@ static int ZMBV_Init(int width, int height, int left_margin, int top_margin)
 	for(i = 1; i <= ZMBV_BLOCK * ZMBV_BLOCK; i++)
 		score_tab[i] = -i * log2(i / (double)(ZMBV_BLOCK * ZMBV_BLOCK)) * 256;
 
-	/* Motion estimation range: maximum distance is -64..63 */
-	lrange = urange = 2;
+	/* Motion estimation range: maximum distance is -64..63. The diamond
+	   search can afford to follow fast scrolling; DOSBox's decoder pads the
+	   previous frame by 16 pixels, so don't point further out than that. */
+	motion_search = video_codec_motion_search;
+	if (motion_search == VIDEO_CODEC_SEARCH_EXHAUSTIVE)
+		lrange = urange = 2;
+	else
+		lrange = urange = MAX_RANGE;
+	memset(mv_count, 0, sizeof(mv_count));
+	common_mx = common_my = 0;
 
 	work_size = video_width * video_height + 1024 +
 		((video_width + ZMBV_BLOCK - 1) / ZMBV_BLOCK) * ((video_height + ZMBV_BLOCK - 1) / ZMBV_BLOCK) * 2 + 4;
@@ -42,8 +42,8 @@
 #define M_PI		3.14159265358979323846
 #endif
 
-Colours_setup_t *Colours_setup;
-COLOURS_EXTERNAL_t *Colours_external;
+THREAD_LOCAL Colours_setup_t *Colours_setup;
+THREAD_LOCAL COLOURS_EXTERNAL_t *Colours_external;
 
 /* The NTSC and PAL TV systems maintain that the gamma factor of CRT TV
    receivers should be 2.5 and 2.8, respectively. However, typical CRT TVs
@@ -63,7 +63,7 @@ static char const * const preset_cfg_strings[COLOURS_PRESET_SIZE] = {
 	"VIBRANT"
 };
 
-int Colours_table[256];
+THREAD_LOCAL int Colours_table[256];
 
 void Colours_SetRGB(int i, int r, int g, int b, int *colortable_ptr)
 {
@@ -1,9 +1,11 @@
 #ifndef COLOURS_H_
 #define COLOURS_H_
 
+#include "atari.h"
+
 #include "colours_external.h"
 
-extern int Colours_table[256];
+extern THREAD_LOCAL int Colours_table[256];
 
 typedef enum {
 	COLOURS_PRESET_STANDARD,
@@ -47,7 +49,7 @@ typedef struct Colours_setup_t {
 /* Pointer to the current palette setup. Depending on the current TV system,
    it points to the NTSC setup, or the PAL setup. (See COLOURS_NTSC_setup and
    COLOURS_PAL_setup.) */
-extern Colours_setup_t *Colours_setup;
+extern THREAD_LOCAL Colours_setup_t *Colours_setup;
 
 #define Colours_GetR(x) ((UBYTE) (Colours_table[x] >> 16))
 #define Colours_GetG(x) ((UBYTE) (Colours_table[x] >> 8))
@@ -72,7 +74,7 @@ int Colours_Save(const char *filename);
 /* Pointer to an externally-loaded palette. Depending on the current TV
    system, it points to the external NTSC or PAL palette - they can be loaded
    independently. (See COLOURS_NTSC_external and COLOURS_PAL_external.) */
-extern COLOURS_EXTERNAL_t *Colours_external;
+extern THREAD_LOCAL COLOURS_EXTERNAL_t *Colours_external;
 
 /* Initialise variables before loading from config file. */
 void Colours_PreInitialise(void);
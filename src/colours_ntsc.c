@@ -33,7 +33,7 @@
 #include "log.h"
 #include "util.h"
 
-Colours_setup_t COLOURS_NTSC_setup;
+THREAD_LOCAL Colours_setup_t COLOURS_NTSC_setup;
 
 /* NTSC-specific default setup. */
 static struct {
@@ -42,7 +42,7 @@ static struct {
 	26.8, /* color delay, chosen to match color names given in GTIA.PDF */
 };
 
-COLOURS_EXTERNAL_t COLOURS_NTSC_external = { "", FALSE, FALSE };
+THREAD_LOCAL COLOURS_EXTERNAL_t COLOURS_NTSC_external = { "", FALSE, FALSE };
 
 /* NTSC colorburst angle in YIQ colorspace. Colorburst is at
  * 180 degrees in YUV - that is, a gold color. In YIQ, gold is at
@@ -29,6 +29,9 @@
 #ifdef HAVE_LIBZ
 #include <zlib.h>
 #endif
+#ifdef HAVE_LIBPTHREAD
+#include <pthread.h>
+#endif
 
 #include "afile.h"
 #include "atari.h"
@@ -90,19 +93,27 @@ static int fload(void *buf, int size, FILE *fp)
 	return (int) fread(buf, 1, size, fp) == size;
 }
 
-static int fsave(void *buf, int size, FILE *fp)
-{
-	return (int) fwrite(buf, 1, size, fp) == size;
-}
-
 typedef struct {
-	FILE *fp;
+	UBYTE *data;		/* the ATR image being decompressed */
+	ULONG length;
+	ULONG allocated;
 	int sectorcount;
 	int sectorsize;
 	int current_sector;
 } ATR_Info;
 
-static int write_atr_header(const ATR_Info *pai)
+static void atr_append(ATR_Info *pai, const void *buf, int size)
+{
+	if (pai->length + size > pai->allocated) {
+		pai->allocated = pai->allocated == 0 ? 16 + 1040 * 128 : pai->allocated * 2;
+		pai->data = (UBYTE *) Util_realloc(pai->data, pai->allocated);
+	}
+	memcpy(pai->data + pai->length, buf, size);
+	pai->length += size;
+}
+
+/* Stores the ATR header at the start of the image */
+static void write_atr_header(ATR_Info *pai)
 {
 	int sectorcount;
 	int sectorsize;
@@ -122,22 +133,23 @@ static int write_atr_header(const ATR_Info *pai)
 	header.seccounthi = (UBYTE) (paras >> 8);
 	header.hiseccountlo = (UBYTE) (paras >> 16);
 	header.hiseccounthi = (UBYTE) (paras >> 24);
-	return fsave(&header, sizeof(header), pai->fp);
+	if (pai->length == 0)
+		atr_append(pai, &header, sizeof(header));
+	else
+		memcpy(pai->data, &header, sizeof(header));
 }
 
-static int write_atr_sector(ATR_Info *pai, UBYTE *buf)
+static void write_atr_sector(ATR_Info *pai, UBYTE *buf)
 {
-	return fsave(buf, pai->current_sector++ <= 3 ? 128 : pai->sectorsize, pai->fp);
+	atr_append(pai, buf, pai->current_sector++ <= 3 ? 128 : pai->sectorsize);
 }
 
-static int pad_till_sector(ATR_Info *pai, int till_sector)
+static void pad_till_sector(ATR_Info *pai, int till_sector)
 {
 	UBYTE zero_buf[256];
 	memset(zero_buf, 0, sizeof(zero_buf));
 	while (pai->current_sector < till_sector)
-		if (!write_atr_sector(pai, zero_buf))
-			return FALSE;
-	return TRUE;
+		write_atr_sector(pai, zero_buf);
 }
 
 static int dcm_pass(FILE *infp, ATR_Info *pai)
@@ -156,8 +168,7 @@ static int dcm_pass(FILE *infp, ATR_Info *pai)
 			Log_print("Error: current sector is %d, next sector group at %d", pai->current_sector, sector_no);
 			return FALSE;
 		}
-		if (!pad_till_sector(pai, sector_no))
-			return FALSE;
+		pad_till_sector(pai, sector_no);
 		for (;;) {
 			/* sector */
 			int i;
@@ -222,8 +233,7 @@ static int dcm_pass(FILE *infp, ATR_Info *pai)
 				Log_print("Unrecognized sector coding type 0x%02X", sector_type);
 				return FALSE;
 			}
-			if (!write_atr_sector(pai, sector_buf))
-				return FALSE;
+			write_atr_sector(pai, sector_buf);
 			if (!(sector_type & 0x80))
 				break; /* goto sector group */
 			sector_type = fgetc(infp);
@@ -233,11 +243,12 @@ static int dcm_pass(FILE *infp, ATR_Info *pai)
 	}
 }
 
-int CompFile_DCMtoATR(FILE *infp, FILE *outfp)
+/* Decompresses the DCM image in infp to the ATR image in pai.
+   Returns TRUE on success. */
+static int dcm_to_atr(FILE *infp, ATR_Info *pai)
 {
 	int archive_type;
 	int archive_flags;
-	ATR_Info ai;
 	int pass_flags;
 	int last_sector;
 	archive_type = fgetc(infp);
@@ -252,32 +263,30 @@ int CompFile_DCMtoATR(FILE *infp, FILE *outfp)
 			Log_print("It seems that DCMs of a multi-file archive have been combined in wrong order");
 		return FALSE;
 	}
-	ai.fp = outfp;
-	ai.current_sector = 1;
+	pai->current_sector = 1;
 	switch ((archive_flags >> 5) & 3) {
 	case 0:
-		ai.sectorcount = 720;
-		ai.sectorsize = 128;
+		pai->sectorcount = 720;
+		pai->sectorsize = 128;
 		break;
 	case 1:
-		ai.sectorcount = 720;
-		ai.sectorsize = 256;
+		pai->sectorcount = 720;
+		pai->sectorsize = 256;
 		break;
 	case 2:
-		ai.sectorcount = 1040;
-		ai.sectorsize = 128;
+		pai->sectorcount = 1040;
+		pai->sectorsize = 128;
 		break;
 	default:
 		Log_print("Unrecognized density");
 		return FALSE;
 	}
-	if (!write_atr_header(&ai))
-		return FALSE;
+	write_atr_header(pai);
 	pass_flags = archive_flags;
 	for (;;) {
 		/* pass */
 		int block_type;
-		if (!dcm_pass(infp, &ai))
+		if (!dcm_pass(infp, pai))
 			return FALSE;
 		if (pass_flags & 0x80)
 			break;
@@ -301,11 +310,211 @@ int CompFile_DCMtoATR(FILE *infp, FILE *outfp)
 		}
 		/* TODO: check pass number, this is tricky for >31 */
 	}
-	last_sector = ai.current_sector - 1;
-	if (last_sector <= ai.sectorcount)
-		return pad_till_sector(&ai, ai.sectorcount + 1);
-	/* more sectors written: update ATR header */
-	ai.sectorcount = last_sector;
-	Util_rewind(outfp);
-	return write_atr_header(&ai);
+	last_sector = pai->current_sector - 1;
+	if (last_sector <= pai->sectorcount)
+		pad_till_sector(pai, pai->sectorcount + 1);
+	else {
+		/* more sectors written: update ATR header */
+		pai->sectorcount = last_sector;
+		write_atr_header(pai);
+	}
+	return TRUE;
+}
+
+int CompFile_DCMtoATR(FILE *infp, FILE *outfp)
+{
+	ATR_Info ai;
+	int result;
+	memset(&ai, 0, sizeof(ai));
+	result = dcm_to_atr(infp, &ai)
+		&& fwrite(ai.data, 1, ai.length, outfp) == ai.length;
+	free(ai.data);
+	return result;
+}
+
+
+/* Cache of decompressed images ------------------------------------------- */
+
+/* Decompressed images are kept in memory and shared by all the drives and
+   machines of the process that mount the same compressed file, which is
+   recognized by its contents. Images that are not mounted are dropped,
+   least recently used first, when the cache is full. */
+
+#define CACHE_SIZE 8
+
+typedef struct {
+	UBYTE *compressed;	/* contents of the compressed file, the key */
+	ULONG compressed_length;
+	ULONG hash;			/* FNV-1a of compressed */
+	UBYTE *image;		/* NULL if the entry is free */
+	ULONG length;
+	int references;		/* number of mounts using the image */
+	ULONG last_used;
+} cache_entry_t;
+
+static cache_entry_t cache[CACHE_SIZE];
+static ULONG cache_clock = 0;
+
+#ifdef HAVE_LIBPTHREAD
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+#define LOCK_CACHE pthread_mutex_lock(&cache_mutex)
+#define UNLOCK_CACHE pthread_mutex_unlock(&cache_mutex)
+#else
+#define LOCK_CACHE
+#define UNLOCK_CACHE
+#endif
+
+static ULONG hash_bytes(const UBYTE *data, ULONG length)
+{
+	ULONG hash = 2166136261U;
+	while (length-- > 0) {
+		hash ^= *data++;
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+#ifdef HAVE_LIBZ
+/* Decompresses GZIP data to memory. Returns NULL on error. */
+static UBYTE *inflate_gz(const UBYTE *data, ULONG length, ULONG *out_length)
+{
+	z_stream stream;
+	UBYTE *out = NULL;
+	ULONG allocated = 0;
+	int result;
+	memset(&stream, 0, sizeof(stream));
+	if (inflateInit2(&stream, MAX_WBITS + 16) != Z_OK)
+		return NULL;
+	stream.next_in = (Bytef *) data;
+	stream.avail_in = length;
+	do {
+		if (stream.total_out == allocated) {
+			allocated = allocated == 0 ? 16 + 1040 * 256 : allocated * 2;
+			out = (UBYTE *) Util_realloc(out, allocated);
+		}
+		stream.next_out = out + stream.total_out;
+		stream.avail_out = allocated - stream.total_out;
+		result = inflate(&stream, Z_NO_FLUSH);
+	} while (result == Z_OK);
+	*out_length = stream.total_out;
+	inflateEnd(&stream);
+	if (result != Z_STREAM_END) {
+		Log_print("ZLIB could not decompress the image");
+		free(out);
+		return NULL;
+	}
+	return out;
+}
+#endif /* HAVE_LIBZ */
+
+/* Decompresses the image, whose file contents are data. Returns NULL on error. */
+static UBYTE *decompress(FILE *fp, const UBYTE *data, ULONG length, ULONG *out_length)
+{
+	if (length >= 2 && data[0] == 0x1f && data[1] == 0x8b) {
+#ifdef HAVE_LIBZ
+		return inflate_gz(data, length, out_length);
+#else
+		Log_print("This executable cannot decompress ZLIB files");
+		return NULL;
+#endif
+	}
+	else {
+		ATR_Info ai;
+		memset(&ai, 0, sizeof(ai));
+		Util_rewind(fp);
+		if (!dcm_to_atr(fp, &ai)) {
+			free(ai.data);
+			return NULL;
+		}
+		*out_length = ai.length;
+		return ai.data;
+	}
+}
+
+const UBYTE *CompFile_LoadImage(FILE *fp, ULONG *length)
+{
+	UBYTE *data;
+	ULONG data_length;
+	ULONG hash;
+	int i;
+	cache_entry_t *entry;
+	int flen = Util_flen(fp);
+
+	if (flen < 0)
+		return NULL;
+	data_length = flen;
+	data = (UBYTE *) Util_malloc(data_length > 0 ? data_length : 1);
+	Util_rewind(fp);
+	if (fread(data, 1, data_length, fp) != data_length) {
+		free(data);
+		return NULL;
+	}
+	hash = hash_bytes(data, data_length);
+
+	LOCK_CACHE;
+	for (i = 0; i < CACHE_SIZE; i++) {
+		entry = &cache[i];
+		if (entry->image != NULL && entry->hash == hash && entry->compressed_length == data_length
+		 && memcmp(entry->compressed, data, data_length) == 0) {
+			entry->references++;
+			entry->last_used = ++cache_clock;
+			*length = entry->length;
+			UNLOCK_CACHE;
+			free(data);
+			return entry->image;
+		}
+	}
+	UNLOCK_CACHE;
+
+	/* not in the cache: decompress outside the lock, then find a free
+	   or the least recently used unmounted entry */
+	{
+		UBYTE *image = decompress(fp, data, data_length, length);
+		if (image == NULL) {
+			free(data);
+			return NULL;
+		}
+		LOCK_CACHE;
+		entry = NULL;
+		for (i = 0; i < CACHE_SIZE; i++) {
+			if (cache[i].image == NULL) {
+				entry = &cache[i];
+				break;
+			}
+			if (cache[i].references == 0 && (entry == NULL || cache[i].last_used < entry->last_used))
+				entry = &cache[i];
+		}
+		if (entry == NULL) {
+			/* all the entries are mounted: the image is not cached */
+			UNLOCK_CACHE;
+			free(data);
+			return image;
+		}
+		free(entry->compressed);
+		free(entry->image);
+		entry->compressed = data;
+		entry->compressed_length = data_length;
+		entry->hash = hash;
+		entry->image = image;
+		entry->length = *length;
+		entry->references = 1;
+		entry->last_used = ++cache_clock;
+		UNLOCK_CACHE;
+		return image;
+	}
+}
+
+void CompFile_ReleaseImage(const UBYTE *image)
+{
+	int i;
+	LOCK_CACHE;
+	for (i = 0; i < CACHE_SIZE; i++) {
+		if (cache[i].image == image) {
+			cache[i].references--;
+			UNLOCK_CACHE;
+			return;
+		}
+	}
+	UNLOCK_CACHE;
+	free((void *) image);
 }
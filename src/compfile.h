@@ -3,7 +3,16 @@
 
 #include <stdio.h>  /* FILE */
 
+#include "atari.h"
+
 int CompFile_ExtractGZ(const char *infilename, FILE *outfp);
 int CompFile_DCMtoATR(FILE *infp, FILE *outfp);
 
+/* Decompresses the DCM or GZIP image in fp to memory and sets *length.
+   Images are cached by their contents for the whole process, so loading
+   the same image again does not decompress it. Returns NULL on error.
+   The image is read-only and must be released with CompFile_ReleaseImage. */
+const UBYTE *CompFile_LoadImage(FILE *fp, ULONG *length);
+void CompFile_ReleaseImage(const UBYTE *image);
+
 #endif /* COMPFILE_H_ */
@@ -81,7 +81,7 @@
 #endif
 
 /* For Atari Basic loader */
-void (*CPU_rts_handler)(void) = NULL;
+THREAD_LOCAL void (*CPU_rts_handler)(void) = NULL;
 
 /* 6502 instruction profiling */
 #ifdef MONITOR_PROFILE
@@ -101,8 +101,8 @@ unsigned int CPU_remember_jmp_curpos = 0;
 #define INC_RET_NESTING
 #endif /* MONITOR_BREAK */
 
-UBYTE CPU_cim_encountered = FALSE;
-UBYTE CPU_IRQ;
+THREAD_LOCAL UBYTE CPU_cim_encountered = FALSE;
+THREAD_LOCAL UBYTE CPU_IRQ;
 
 #ifndef FALCON_CPUASM
 /* Windows headers define it */
@@ -127,7 +127,7 @@ UBYTE CPU_IRQ;
 
 /* 6502 stack handling */
 #define PL                  MEMORY_dGetByte(0x0100 + ++S)
-#define PH(x)               MEMORY_dPutByte(0x0100 + S--, x)
+#define PH(x)               (MEMORY_dPutByte(0x0100 + S, x), S--)
 #define PHW(x)              PH((x) >> 8); PH((x) & 0xff)
 
 /* 6502 code fetching */
@@ -185,24 +185,24 @@ UBYTE CPU_IRQ;
 #endif /* NEW_CYCLE_EXACT */
 
 /* 6502 registers. */
-UWORD CPU_regPC;
-UBYTE CPU_regA;
-UBYTE CPU_regX;
-UBYTE CPU_regY;
-UBYTE CPU_regP;						/* Processor Status Byte (Partial) */
-UBYTE CPU_regS;
+THREAD_LOCAL UWORD CPU_regPC;
+THREAD_LOCAL UBYTE CPU_regA;
+THREAD_LOCAL UBYTE CPU_regX;
+THREAD_LOCAL UBYTE CPU_regY;
+THREAD_LOCAL UBYTE CPU_regP;						/* Processor Status Byte (Partial) */
+THREAD_LOCAL UBYTE CPU_regS;
 
 /* Transfer 6502 registers between global variables and local variables inside CPU_GO() */
 #define UPDATE_GLOBAL_REGS  CPU_regPC = GET_PC(); CPU_regS = S; CPU_regA = A; CPU_regX = X; CPU_regY = Y
 #define UPDATE_LOCAL_REGS   SET_PC(CPU_regPC); S = CPU_regS; A = CPU_regA; X = CPU_regX; Y = CPU_regY
 
 /* 6502 flags local to this module */
-static UBYTE N;					/* bit7 set => N flag set */
+static THREAD_LOCAL UBYTE N;					/* bit7 set => N flag set */
 #ifndef NO_V_FLAG_VARIABLE
-static UBYTE V;                 /* non-zero => V flag set */
+static THREAD_LOCAL UBYTE V;                 /* non-zero => V flag set */
 #endif
-static UBYTE Z;					/* zero     => Z flag set */
-static UBYTE C;					/* must be 0 or 1 */
+static THREAD_LOCAL UBYTE Z;					/* zero     => Z flag set */
+static THREAD_LOCAL UBYTE C;					/* must be 0 or 1 */
 /* B, D, I are always in CPU_regP */
 
 void CPU_GetStatus(void)
@@ -514,7 +514,7 @@ void CPU_GO(int limit)
 #define UPDATE_GLOBAL_REGS
 #define UPDATE_LOCAL_REGS
 
-#define PH(x)  MEMORY_dPutByte(0x0100 + S--, x)
+#define PH(x)  (MEMORY_dPutByte(0x0100 + S, x), S--)
 #define PHW(x) PH((x) >> 8); PH((x) & 0xff)
 #define INTERRUPT(address)  \
 	UBYTE S = CPU_regS;     \
@@ -25,12 +25,12 @@ void CPU_NMI(void);
 void CPU_GO(int limit);
 #define CPU_GenerateIRQ() (CPU_IRQ = 1)
 
-extern UWORD CPU_regPC;
-extern UBYTE CPU_regA;
-extern UBYTE CPU_regP;
-extern UBYTE CPU_regS;
-extern UBYTE CPU_regY;
-extern UBYTE CPU_regX;
+extern THREAD_LOCAL UWORD CPU_regPC;
+extern THREAD_LOCAL UBYTE CPU_regA;
+extern THREAD_LOCAL UBYTE CPU_regP;
+extern THREAD_LOCAL UBYTE CPU_regS;
+extern THREAD_LOCAL UBYTE CPU_regY;
+extern THREAD_LOCAL UBYTE CPU_regX;
 
 #define CPU_SetN CPU_regP |= CPU_N_FLAG
 #define CPU_ClrN CPU_regP &= (~CPU_N_FLAG)
@@ -47,11 +47,11 @@ extern UBYTE CPU_regX;
 #define CPU_SetC CPU_regP |= CPU_C_FLAG
 #define CPU_ClrC CPU_regP &= (~CPU_C_FLAG)
 
-extern UBYTE CPU_IRQ;
+extern THREAD_LOCAL UBYTE CPU_IRQ;
 
-extern void (*CPU_rts_handler)(void);
+extern THREAD_LOCAL void (*CPU_rts_handler)(void);
 
-extern UBYTE CPU_cim_encountered;
+extern THREAD_LOCAL UBYTE CPU_cim_encountered;
 
 #define CPU_REMEMBER_PC_STEPS 64
 extern UWORD CPU_remember_PC[CPU_REMEMBER_PC_STEPS];
@@ -25,8 +25,8 @@
 #include <stdio.h>
 #include "cycle_map.h"
 
-int CYCLE_MAP_cpu2antic[CYCLE_MAP_SIZE * (17 * 7 + 1)];
-int CYCLE_MAP_antic2cpu[CYCLE_MAP_SIZE * (17 * 7 + 1)];
+THREAD_LOCAL int CYCLE_MAP_cpu2antic[CYCLE_MAP_SIZE * (17 * 7 + 1)];
+THREAD_LOCAL int CYCLE_MAP_antic2cpu[CYCLE_MAP_SIZE * (17 * 7 + 1)];
 static void try_all_scroll(int md, int use_char_index,
 	int use_font, int use_bitmap, int *cpu2antic, int *antic2cpu);
 static void antic_steal_map(int width, int md, int scroll_offset, int use_char_index,
@@ -40,7 +40,7 @@
 #include "libatari800/cpu_crash.h"
 #endif
 
-int ESC_enable_sio_patch = TRUE;
+THREAD_LOCAL int ESC_enable_sio_patch = TRUE;
 
 /* Now we check address of every escape code, to make sure that the patch
    has been set by the emulator and is not a CIM in Atari program.
@@ -50,8 +50,8 @@ int ESC_enable_sio_patch = TRUE;
    atari.c/devices.c. Unfortunately it can't be done for patches in Atari OS,
    because the OS in XL/XE can be disabled.
 */
-static UWORD esc_address[256];
-static ESC_FunctionType esc_function[256];
+static THREAD_LOCAL UWORD esc_address[256];
+static THREAD_LOCAL ESC_FunctionType esc_function[256];
 
 /* Esc function that removes the wait loop when reading the tape leader. For
    use with standard Atari OSes only. */
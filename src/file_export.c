@@ -49,11 +49,10 @@
 #endif /* defined(AUDIO_RECORDING) || defined(VIDEO_RECORDING) */
 
 #define ERROR_MSG_MAX 40
-static char error_msg[ERROR_MSG_MAX];
-char *FILE_EXPORT_error_message = error_msg;
+THREAD_LOCAL char FILE_EXPORT_error_message[ERROR_MSG_MAX];
 
 #if defined(HAVE_LIBPNG) || defined(HAVE_LIBZ)
-int FILE_EXPORT_compression_level = 6;
+THREAD_LOCAL int FILE_EXPORT_compression_level = 6;
 #endif
 
 #if defined(AUDIO_RECORDING) || defined(VIDEO_RECORDING)
@@ -63,16 +62,16 @@ int FILE_EXPORT_compression_level = 6;
 #ifdef AUDIO_CODEC_MP3
 #define DEFAULT_SOUND_FILENAME_FORMAT_MP3 "atari###.mp3"
 #endif
-static char sound_filename_format[FILENAME_MAX];
-static int sound_no_last = -1;
-static int sound_no_max = 0;
+static THREAD_LOCAL char sound_filename_format[FILENAME_MAX];
+static THREAD_LOCAL int sound_no_last = -1;
+static THREAD_LOCAL int sound_no_max = 0;
 #endif /* AUDIO_RECORDING */
 
 #ifdef VIDEO_RECORDING
 #define DEFAULT_VIDEO_FILENAME_FORMAT "atari###.avi"
-static char video_filename_format[FILENAME_MAX];
-static int video_no_last = -1;
-static int video_no_max = 0;
+static THREAD_LOCAL char video_filename_format[FILENAME_MAX];
+static THREAD_LOCAL int video_no_last = -1;
+static THREAD_LOCAL int video_no_max = 0;
 #endif /* VIDEO_RECORDING */
 
 #endif /* defined(AUDIO_RECORDING) || defined(VIDEO_RECORDING) */
@@ -214,7 +213,7 @@ void fputl(ULONG x, FILE *fp)
 
 void File_Export_SetErrorMessage(const char *string)
 {
-	Util_strlcpy(error_msg, string, ERROR_MSG_MAX);
+	Util_strlcpy(FILE_EXPORT_error_message, string, ERROR_MSG_MAX);
 }
 
 void File_Export_SetErrorMessageArg(const char *format, const char *arg)
@@ -328,7 +327,7 @@ int File_Export_WriteVideo()
 	int result;
 
 	if (!container) return 0;
-	if (!video_codec || (video_codec && !container->video_frame)) return 1;
+	if (!video_codec && !container->screen_frame) return 1;
 	result = CONTAINER_AddVideoFrame();
 	if (!result) {
 		CONTAINER_Close(FALSE);
@@ -346,15 +345,33 @@ int File_Export_WriteVideo()
    */
 int File_Export_GetRecordingStats(int *seconds, int *size, char **media_type)
 {
+	ULONG frames;
+	CONTAINER_SIZE_t bytes;
+
 	if (container) {
-		*seconds = (int)(video_frame_count / fps);
-		*size = byteswritten / 1024;
+		CONTAINER_GetProgress(&frames, &bytes);
+		*seconds = (int)(frames / fps);
+		*size = (int)(bytes / 1024);
 		*media_type = description;
 		return 1;
 	}
 	return 0;
 }
 
+/* File_Export_GetQueueStats gets the number of frames waiting to be encoded,
+   the most that have been waiting at once, the size of the queue and the
+   number of times the emulation had to wait for the encoder.
+
+   RETURNS: TRUE if a file is being written by the encoder thread, FALSE if not
+   */
+int File_Export_GetQueueStats(int *queued, int *max_queued, int *size, ULONG *stalls)
+{
+	if (container) {
+		return CONTAINER_GetQueueStats(queued, max_queued, size, stalls);
+	}
+	return 0;
+}
+
 #endif /* defined(AUDIO_RECORDING) || defined(VIDEO_RECORDING) */
 
 #ifdef SCREENSHOTS
@@ -4,7 +4,7 @@
 #include "atari.h"
 
 #if defined(HAVE_LIBPNG) || defined(HAVE_LIBZ)
-extern int FILE_EXPORT_compression_level;
+extern THREAD_LOCAL int FILE_EXPORT_compression_level;
 #endif
 
 int File_Export_Initialise(int *argc, char *argv[]);
@@ -17,7 +17,7 @@ void fputl(ULONG, FILE *fp);
 #endif
 
 #if defined(AUDIO_RECORDING) || defined(VIDEO_RECORDING)
-extern char *FILE_EXPORT_error_message;
+extern THREAD_LOCAL char FILE_EXPORT_error_message[];
 void File_Export_SetErrorMessage(const char *string);
 void File_Export_SetErrorMessageArg(const char *format, const char *arg);
 
@@ -36,6 +36,7 @@ int File_Export_WriteVideo(void);
 #endif
 
 int File_Export_GetRecordingStats(int *seconds, int *size, char **media_type);
+int File_Export_GetQueueStats(int *queued, int *max_queued, int *size, ULONG *stalls);
 #endif /* defined(AUDIO_RECORDING) || defined(VIDEO_RECORDING) */
 
 #ifdef SCREENSHOTS
@@ -58,44 +58,44 @@
 #define GTIA_OFFSET_HITCLR 0x1e
 #define GTIA_OFFSET_CONSOL 0x1f
 
-extern UBYTE GTIA_GRAFM;
-extern UBYTE GTIA_GRAFP0;
-extern UBYTE GTIA_GRAFP1;
-extern UBYTE GTIA_GRAFP2;
-extern UBYTE GTIA_GRAFP3;
-extern UBYTE GTIA_HPOSP0;
-extern UBYTE GTIA_HPOSP1;
-extern UBYTE GTIA_HPOSP2;
-extern UBYTE GTIA_HPOSP3;
-extern UBYTE GTIA_HPOSM0;
-extern UBYTE GTIA_HPOSM1;
-extern UBYTE GTIA_HPOSM2;
-extern UBYTE GTIA_HPOSM3;
-extern UBYTE GTIA_SIZEP0;
-extern UBYTE GTIA_SIZEP1;
-extern UBYTE GTIA_SIZEP2;
-extern UBYTE GTIA_SIZEP3;
-extern UBYTE GTIA_SIZEM;
-extern UBYTE GTIA_COLPM0;
-extern UBYTE GTIA_COLPM1;
-extern UBYTE GTIA_COLPM2;
-extern UBYTE GTIA_COLPM3;
-extern UBYTE GTIA_COLPF0;
-extern UBYTE GTIA_COLPF1;
-extern UBYTE GTIA_COLPF2;
-extern UBYTE GTIA_COLPF3;
-extern UBYTE GTIA_COLBK;
-extern UBYTE GTIA_GRACTL;
-extern UBYTE GTIA_M0PL;
-extern UBYTE GTIA_M1PL;
-extern UBYTE GTIA_M2PL;
-extern UBYTE GTIA_M3PL;
-extern UBYTE GTIA_P0PL;
-extern UBYTE GTIA_P1PL;
-extern UBYTE GTIA_P2PL;
-extern UBYTE GTIA_P3PL;
-extern UBYTE GTIA_PRIOR;
-extern UBYTE GTIA_VDELAY;
+extern THREAD_LOCAL UBYTE GTIA_GRAFM;
+extern THREAD_LOCAL UBYTE GTIA_GRAFP0;
+extern THREAD_LOCAL UBYTE GTIA_GRAFP1;
+extern THREAD_LOCAL UBYTE GTIA_GRAFP2;
+extern THREAD_LOCAL UBYTE GTIA_GRAFP3;
+extern THREAD_LOCAL UBYTE GTIA_HPOSP0;
+extern THREAD_LOCAL UBYTE GTIA_HPOSP1;
+extern THREAD_LOCAL UBYTE GTIA_HPOSP2;
+extern THREAD_LOCAL UBYTE GTIA_HPOSP3;
+extern THREAD_LOCAL UBYTE GTIA_HPOSM0;
+extern THREAD_LOCAL UBYTE GTIA_HPOSM1;
+extern THREAD_LOCAL UBYTE GTIA_HPOSM2;
+extern THREAD_LOCAL UBYTE GTIA_HPOSM3;
+extern THREAD_LOCAL UBYTE GTIA_SIZEP0;
+extern THREAD_LOCAL UBYTE GTIA_SIZEP1;
+extern THREAD_LOCAL UBYTE GTIA_SIZEP2;
+extern THREAD_LOCAL UBYTE GTIA_SIZEP3;
+extern THREAD_LOCAL UBYTE GTIA_SIZEM;
+extern THREAD_LOCAL UBYTE GTIA_COLPM0;
+extern THREAD_LOCAL UBYTE GTIA_COLPM1;
+extern THREAD_LOCAL UBYTE GTIA_COLPM2;
+extern THREAD_LOCAL UBYTE GTIA_COLPM3;
+extern THREAD_LOCAL UBYTE GTIA_COLPF0;
+extern THREAD_LOCAL UBYTE GTIA_COLPF1;
+extern THREAD_LOCAL UBYTE GTIA_COLPF2;
+extern THREAD_LOCAL UBYTE GTIA_COLPF3;
+extern THREAD_LOCAL UBYTE GTIA_COLBK;
+extern THREAD_LOCAL UBYTE GTIA_GRACTL;
+extern THREAD_LOCAL UBYTE GTIA_M0PL;
+extern THREAD_LOCAL UBYTE GTIA_M1PL;
+extern THREAD_LOCAL UBYTE GTIA_M2PL;
+extern THREAD_LOCAL UBYTE GTIA_M3PL;
+extern THREAD_LOCAL UBYTE GTIA_P0PL;
+extern THREAD_LOCAL UBYTE GTIA_P1PL;
+extern THREAD_LOCAL UBYTE GTIA_P2PL;
+extern THREAD_LOCAL UBYTE GTIA_P3PL;
+extern THREAD_LOCAL UBYTE GTIA_PRIOR;
+extern THREAD_LOCAL UBYTE GTIA_VDELAY;
 
 #ifdef USE_COLOUR_TRANSLATION_TABLE
 
@@ -110,19 +110,19 @@ extern UWORD GTIA_colour_translation_table[256];
 
 #endif /* USE_COLOUR_TRANSLATION_TABLE */
 
-extern UBYTE GTIA_pm_scanline[Screen_WIDTH / 2 + 8];	/* there's a byte for every *pair* of pixels */
-extern int GTIA_pm_dirty;
+extern THREAD_LOCAL UBYTE GTIA_pm_scanline[Screen_WIDTH / 2 + 8];	/* there's a byte for every *pair* of pixels */
+extern THREAD_LOCAL int GTIA_pm_dirty;
 
-extern UBYTE GTIA_collisions_mask_missile_playfield;
-extern UBYTE GTIA_collisions_mask_player_playfield;
-extern UBYTE GTIA_collisions_mask_missile_player;
-extern UBYTE GTIA_collisions_mask_player_player;
+extern THREAD_LOCAL UBYTE GTIA_collisions_mask_missile_playfield;
+extern THREAD_LOCAL UBYTE GTIA_collisions_mask_player_playfield;
+extern THREAD_LOCAL UBYTE GTIA_collisions_mask_missile_player;
+extern THREAD_LOCAL UBYTE GTIA_collisions_mask_player_player;
 
-extern UBYTE GTIA_TRIG[4];
-extern UBYTE GTIA_TRIG_latch[4];
+extern THREAD_LOCAL UBYTE GTIA_TRIG[4];
+extern THREAD_LOCAL UBYTE GTIA_TRIG_latch[4];
 
-extern int GTIA_consol_override;
-extern int GTIA_speaker;
+extern THREAD_LOCAL int GTIA_consol_override;
+extern THREAD_LOCAL int GTIA_speaker;
 
 int GTIA_Initialise(int *argc, char *argv[]);
 void GTIA_Frame(void);
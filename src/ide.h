@@ -15,7 +15,7 @@
    typedef unsigned long long uint64_t;
 #endif
 
-extern int IDE_enabled;
+extern THREAD_LOCAL int IDE_enabled;
 
 int     IDE_Initialise(int *argc, char *argv[]);
 void IDE_Exit(void);
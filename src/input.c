@@ -54,30 +54,30 @@ extern int Atari_POT(int);
 #define Atari_POT(x) 228
 #endif
 
-int INPUT_key_code = AKEY_NONE;
-int INPUT_key_shift = 0;
-int INPUT_key_consol = INPUT_CONSOL_NONE;
+THREAD_LOCAL int INPUT_key_code = AKEY_NONE;
+THREAD_LOCAL int INPUT_key_shift = 0;
+THREAD_LOCAL int INPUT_key_consol = INPUT_CONSOL_NONE;
 
-int INPUT_joy_autofire[4] = {INPUT_AUTOFIRE_OFF, INPUT_AUTOFIRE_OFF, INPUT_AUTOFIRE_OFF, INPUT_AUTOFIRE_OFF};
+THREAD_LOCAL int INPUT_joy_autofire[4] = {INPUT_AUTOFIRE_OFF, INPUT_AUTOFIRE_OFF, INPUT_AUTOFIRE_OFF, INPUT_AUTOFIRE_OFF};
 
-int INPUT_joy_block_opposite_directions = 1;
+THREAD_LOCAL int INPUT_joy_block_opposite_directions = 1;
 
-int INPUT_joy_multijoy = 0;
+THREAD_LOCAL int INPUT_joy_multijoy = 0;
 
-int INPUT_joy_5200_min = 6;
-int INPUT_joy_5200_center = 114;
-int INPUT_joy_5200_max = 220;
+THREAD_LOCAL int INPUT_joy_5200_min = 6;
+THREAD_LOCAL int INPUT_joy_5200_center = 114;
+THREAD_LOCAL int INPUT_joy_5200_max = 220;
 
-int INPUT_cx85 = 0;
+THREAD_LOCAL int INPUT_cx85 = 0;
 
-int INPUT_mouse_mode = INPUT_MOUSE_OFF;
-int INPUT_mouse_port = 0;
-int INPUT_mouse_delta_x = 0;
-int INPUT_mouse_delta_y = 0;
-int INPUT_mouse_buttons = 0;
-int INPUT_mouse_speed = 3;
-int INPUT_mouse_pot_min = 1;		/* min. value of POKEY's POT register */
-int INPUT_mouse_pot_max = 228;		/* max. value of POKEY's POT register */
+THREAD_LOCAL int INPUT_mouse_mode = INPUT_MOUSE_OFF;
+THREAD_LOCAL int INPUT_mouse_port = 0;
+THREAD_LOCAL int INPUT_mouse_delta_x = 0;
+THREAD_LOCAL int INPUT_mouse_delta_y = 0;
+THREAD_LOCAL int INPUT_mouse_buttons = 0;
+THREAD_LOCAL int INPUT_mouse_speed = 3;
+THREAD_LOCAL int INPUT_mouse_pot_min = 1;		/* min. value of POKEY's POT register */
+THREAD_LOCAL int INPUT_mouse_pot_max = 228;		/* max. value of POKEY's POT register */
 /* There should be UI or options for light pen/gun offsets.
    Below are best offsets for different programs:
    AtariGraphics: H = 0..32, V = 0 (there's calibration in the program)
@@ -85,21 +85,21 @@ int INPUT_mouse_pot_max = 228;		/* max. value of POKEY's POT register */
    Barnyard Blaster: H = 40, V = 0
    Operation Blood (light gun version): H = 40, V = 4
  */
-int INPUT_mouse_pen_ofs_h = 42;
-int INPUT_mouse_pen_ofs_v = 2;
-int INPUT_mouse_joy_inertia = 10;
-int INPUT_direct_mouse = 0;
+THREAD_LOCAL int INPUT_mouse_pen_ofs_h = 42;
+THREAD_LOCAL int INPUT_mouse_pen_ofs_v = 2;
+THREAD_LOCAL int INPUT_mouse_joy_inertia = 10;
+THREAD_LOCAL int INPUT_direct_mouse = 0;
 
 #ifndef MOUSE_SHIFT
 #define MOUSE_SHIFT 4
 #endif
-static int mouse_x = 0;
-static int mouse_y = 0;
-static int mouse_move_x = 0;
-static int mouse_move_y = 0;
-static int mouse_pen_show_pointer = 0;
-static int mouse_last_right = 0;
-static int mouse_last_down = 0;
+static THREAD_LOCAL int mouse_x = 0;
+static THREAD_LOCAL int mouse_y = 0;
+static THREAD_LOCAL int mouse_move_x = 0;
+static THREAD_LOCAL int mouse_move_y = 0;
+static THREAD_LOCAL int mouse_pen_show_pointer = 0;
+static THREAD_LOCAL int mouse_last_right = 0;
+static THREAD_LOCAL int mouse_last_down = 0;
 
 static const UBYTE mouse_amiga_codes[16] = {
 	0x00, 0x02, 0x0a, 0x08,
@@ -115,15 +115,22 @@ static const UBYTE mouse_st_codes[16] = {
 	0x04, 0x06, 0x07, 0x05
 };
 
-static UBYTE STICK[4];
-static UBYTE TRIG_input[4];
+static THREAD_LOCAL UBYTE STICK[4];
+static THREAD_LOCAL UBYTE TRIG_input[4];
 
-static int joy_multijoy_no = 0;	/* number of selected joy */
+static THREAD_LOCAL int joy_multijoy_no = 0;	/* number of selected joy */
 
-static int cx85_port = 1;
+static THREAD_LOCAL int cx85_port = 1;
 
-static int max_scanline_counter;
-static int scanline_counter;
+static THREAD_LOCAL int max_scanline_counter;
+static THREAD_LOCAL int scanline_counter;
+
+/* state of the previous frame, used by INPUT_Frame() */
+static THREAD_LOCAL int last_key_code = AKEY_NONE;
+static THREAD_LOCAL int last_key_break = 0;
+static THREAD_LOCAL UBYTE last_stick[4] = {INPUT_STICK_CENTRE, INPUT_STICK_CENTRE, INPUT_STICK_CENTRE, INPUT_STICK_CENTRE};
+static THREAD_LOCAL int last_mouse_buttons = 0;
+static THREAD_LOCAL int bit5_5200 = 0;
 
 #ifdef EVENT_RECORDING
 static gzFile recordfp = NULL; /*output file for input recording*/
@@ -341,9 +348,10 @@ void INPUT_Exit(void) {
    }
    Returned is stick code for the movement direction.
 */
+static THREAD_LOCAL int mouse_step_e = 0;
+
 static UBYTE mouse_step(void)
 {
-	static int e = 0;
 	UBYTE r = INPUT_STICK_CENTRE;
 	int dx = mouse_move_x >= 0 ? mouse_move_x : -mouse_move_x;
 	int dy = mouse_move_y >= 0 ? mouse_move_y : -mouse_move_y;
@@ -366,9 +374,9 @@ static UBYTE mouse_step(void)
 			if (mouse_move_x < 0)
 				mouse_move_x = 0;
 		}
-		e -= dy;
-		if (e < 0) {
-			e += dx;
+		mouse_step_e -= dy;
+		if (mouse_step_e < 0) {
+			mouse_step_e += dx;
 			if (mouse_move_y < 0) {
 				r &= INPUT_STICK_FORWARD;
 				mouse_last_down = 0;
@@ -404,9 +412,9 @@ static UBYTE mouse_step(void)
 			if (mouse_move_y < 0)
 				mouse_move_y = 0;
 		}
-		e -= dx;
-		if (e < 0) {
-			e += dy;
+		mouse_step_e -= dx;
+		if (mouse_step_e < 0) {
+			mouse_step_e += dy;
 			if (mouse_move_x < 0) {
 				r &= INPUT_STICK_LEFT;
 				mouse_last_right = 0;
@@ -431,10 +439,6 @@ static UBYTE mouse_step(void)
 void INPUT_Frame(void)
 {
 	int i;
-	static int last_key_code = AKEY_NONE;
-	static int last_key_break = 0;
-	static UBYTE last_stick[4] = {INPUT_STICK_CENTRE, INPUT_STICK_CENTRE, INPUT_STICK_CENTRE, INPUT_STICK_CENTRE};
-	static int last_mouse_buttons = 0;
 
 	scanline_counter = 10000;	/* do nothing in INPUT_Scanline() */
 
@@ -511,7 +515,6 @@ void INPUT_Frame(void)
 		/* Bit 5 is different for each keypress because it is one
 		 * of the missing lines. */
 		if (Atari800_machine_type == Atari800_MACHINE_5200) {
-			static int bit5_5200 = 0;
 			if (bit5_5200) {
 				INPUT_key_code &= ~0x20;
 			}
@@ -1052,3 +1055,41 @@ void INPUT_DrawMousePointer(void)
 }
 
 #endif /* CURSES_BASIC */
+
+#ifdef LIBATARI800
+void INPUT_SaveFrameState(INPUT_frame_state_t *state)
+{
+	int i;
+	state->last_key_code = last_key_code;
+	state->last_key_break = last_key_break;
+	for (i = 0; i < 4; i++)
+		state->last_stick[i] = last_stick[i];
+	state->last_mouse_buttons = last_mouse_buttons;
+	state->bit5_5200 = bit5_5200;
+	state->mouse_x = mouse_x;
+	state->mouse_y = mouse_y;
+	state->mouse_move_x = mouse_move_x;
+	state->mouse_move_y = mouse_move_y;
+	state->mouse_last_right = mouse_last_right;
+	state->mouse_last_down = mouse_last_down;
+	state->mouse_step_e = mouse_step_e;
+}
+
+void INPUT_RestoreFrameState(INPUT_frame_state_t const *state)
+{
+	int i;
+	last_key_code = state->last_key_code;
+	last_key_break = state->last_key_break;
+	for (i = 0; i < 4; i++)
+		last_stick[i] = (UBYTE) state->last_stick[i];
+	last_mouse_buttons = state->last_mouse_buttons;
+	bit5_5200 = state->bit5_5200;
+	mouse_x = state->mouse_x;
+	mouse_y = state->mouse_y;
+	mouse_move_x = state->mouse_move_x;
+	mouse_move_y = state->mouse_move_y;
+	mouse_last_right = state->mouse_last_right;
+	mouse_last_down = state->mouse_last_down;
+	mouse_step_e = state->mouse_step_e;
+}
+#endif /* LIBATARI800 */
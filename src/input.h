@@ -1,6 +1,8 @@
 #ifndef INPUT_H_
 #define INPUT_H_
 
+#include "atari.h"
+
 /* Keyboard AKEY_* are in akey.h */
 
 /* INPUT_key_consol masks */
@@ -12,9 +14,9 @@
 #define INPUT_CONSOL_SELECT	0x02
 #define INPUT_CONSOL_OPTION	0x04
 
-extern int INPUT_key_code;	/* regular Atari key code */
-extern int INPUT_key_shift;	/* Shift key pressed */
-extern int INPUT_key_consol;	/* Start, Select and Option keys */
+extern THREAD_LOCAL int INPUT_key_code;	/* regular Atari key code */
+extern THREAD_LOCAL int INPUT_key_shift;	/* Shift key pressed */
+extern THREAD_LOCAL int INPUT_key_consol;	/* Start, Select and Option keys */
 
 /* Joysticks ----------------------------------------------------------- */
 
@@ -34,17 +36,17 @@ extern int INPUT_key_consol;	/* Start, Select and Option keys */
 #define INPUT_AUTOFIRE_FIRE	1	/* Fire dependent */
 #define INPUT_AUTOFIRE_CONT	2	/* Continuous */
 
-extern int INPUT_joy_autofire[4];		/* autofire mode for each Atari port */
+extern THREAD_LOCAL int INPUT_joy_autofire[4];		/* autofire mode for each Atari port */
 
-extern int INPUT_joy_block_opposite_directions;	/* can't move joystick left
+extern THREAD_LOCAL int INPUT_joy_block_opposite_directions;	/* can't move joystick left
 											   and right simultaneously */
 
-extern int INPUT_joy_multijoy;	/* emulate MultiJoy4 interface */
+extern THREAD_LOCAL int INPUT_joy_multijoy;	/* emulate MultiJoy4 interface */
 
 /* 5200 joysticks values */
-extern int INPUT_joy_5200_min;
-extern int INPUT_joy_5200_center;
-extern int INPUT_joy_5200_max;
+extern THREAD_LOCAL int INPUT_joy_5200_min;
+extern THREAD_LOCAL int INPUT_joy_5200_center;
+extern THREAD_LOCAL int INPUT_joy_5200_max;
 
 /* Mouse --------------------------------------------------------------- */
 
@@ -60,22 +62,22 @@ extern int INPUT_joy_5200_max;
 #define INPUT_MOUSE_TRAK	8	/* Atari CX22 Trak-Ball */
 #define INPUT_MOUSE_JOY		9	/* Joystick */
 
-extern int INPUT_mouse_mode;			/* device emulated with mouse */
-extern int INPUT_mouse_port;			/* Atari port, to which the emulated device is attached */
-extern int INPUT_mouse_delta_x;		/* x motion since last frame */
-extern int INPUT_mouse_delta_y;		/* y motion since last frame */
-extern int INPUT_mouse_buttons;		/* buttons pressed (b0: left, b1: right, b2: middle */
-extern int INPUT_mouse_speed;			/* how fast the mouse pointer moves */
-extern int INPUT_mouse_pot_min;		/* min. value of POKEY's POT register */
-extern int INPUT_mouse_pot_max;		/* max. value of POKEY's POT register */
-extern int INPUT_mouse_pen_ofs_h;		/* light pen/gun horizontal offset (for calibration) */
-extern int INPUT_mouse_pen_ofs_v;		/* light pen/gun vertical offset (for calibration) */
-extern int INPUT_mouse_joy_inertia;	/* how long the mouse pointer can move (time in Atari frames)
+extern THREAD_LOCAL int INPUT_mouse_mode;			/* device emulated with mouse */
+extern THREAD_LOCAL int INPUT_mouse_port;			/* Atari port, to which the emulated device is attached */
+extern THREAD_LOCAL int INPUT_mouse_delta_x;		/* x motion since last frame */
+extern THREAD_LOCAL int INPUT_mouse_delta_y;		/* y motion since last frame */
+extern THREAD_LOCAL int INPUT_mouse_buttons;		/* buttons pressed (b0: left, b1: right, b2: middle */
+extern THREAD_LOCAL int INPUT_mouse_speed;			/* how fast the mouse pointer moves */
+extern THREAD_LOCAL int INPUT_mouse_pot_min;		/* min. value of POKEY's POT register */
+extern THREAD_LOCAL int INPUT_mouse_pot_max;		/* max. value of POKEY's POT register */
+extern THREAD_LOCAL int INPUT_mouse_pen_ofs_h;		/* light pen/gun horizontal offset (for calibration) */
+extern THREAD_LOCAL int INPUT_mouse_pen_ofs_v;		/* light pen/gun vertical offset (for calibration) */
+extern THREAD_LOCAL int INPUT_mouse_joy_inertia;	/* how long the mouse pointer can move (time in Atari frames)
 								   after a fast motion of mouse */
-extern int INPUT_direct_mouse;      /* When true, convert the mouse pointer
+extern THREAD_LOCAL int INPUT_direct_mouse;      /* When true, convert the mouse pointer
 													position directly into POKEY POT values */
 
-extern int INPUT_cx85;      /* emulate CX85 numeric keypad */
+extern THREAD_LOCAL int INPUT_cx85;      /* emulate CX85 numeric keypad */
 /* Functions ----------------------------------------------------------- */
 
 int INPUT_Initialise(int *argc, char *argv[]);
@@ -90,4 +92,26 @@ int INPUT_Playingback(void);
 void INPUT_RecordInt(int i);
 int INPUT_PlaybackInt(void);
 
+#ifdef LIBATARI800
+/* Input state carried over between frames. It isn't part of the emulated
+   hardware, so it isn't stored in state saves. */
+typedef struct {
+	int last_key_code;
+	int last_key_break;
+	int last_stick[4];
+	int last_mouse_buttons;
+	int bit5_5200;
+	int mouse_x;
+	int mouse_y;
+	int mouse_move_x;
+	int mouse_move_y;
+	int mouse_last_right;
+	int mouse_last_down;
+	int mouse_step_e;
+} INPUT_frame_state_t;
+
+void INPUT_SaveFrameState(INPUT_frame_state_t *state);
+void INPUT_RestoreFrameState(INPUT_frame_state_t const *state);
+#endif /* LIBATARI800 */
+
 #endif /* INPUT_H_ */
@@ -37,30 +37,44 @@
 #include "antic.h"
 #include "cpu.h"
 #include "platform.h"
+#include "pokey.h"
 #include "memory.h"
+#include "profile.h"
 #include "screen.h"
 #include "sio.h"
 #include "../sound.h"
 #include "util.h"
+#ifdef AUDIO_RECORDING
+#include "file_export.h"
+#include "codecs/container.h"
+#endif
 #include "libatari800/main.h"
+#include "libatari800/batch.h"
+#include "libatari800/context.h"
 #include "libatari800/cpu_crash.h"
 #include "libatari800/init.h"
 #include "libatari800/input.h"
+#include "libatari800/rewind.h"
 #include "libatari800/video.h"
 #include "libatari800/sound.h"
 #include "libatari800/statesav.h"
 
 
 #ifdef HAVE_SETJMP
-jmp_buf libatari800_cpu_crash;
+THREAD_LOCAL jmp_buf libatari800_cpu_crash;
 #endif
 
 /* global variable indicating that BRK instruction should exit emulation */
-int libatari800_continue_on_brk = 0;
+THREAD_LOCAL int libatari800_continue_on_brk = 0;
 
 /* global variable indicating last error code */
 int libatari800_error_code;
 
+/* last error code of the machine of this thread */
+THREAD_LOCAL int LIBATARI800_error_code;
+
+
+static int init_machine(int argc, char **argv);
 
 /** Initialize emulator configuration
  * 
@@ -77,6 +91,15 @@ int libatari800_error_code;
  * @retval TRUE if successful
  */
 int libatari800_init(int argc, char **argv) {
+	int status = init_machine(argc, argv);
+	libatari800_error_code = LIBATARI800_error_code;
+	return status;
+}
+
+/* libatari800_init for the machine of the calling thread, without updating
+   libatari800_error_code */
+static int init_machine(int argc, char **argv)
+{
 	int i;
 	int status;
 	int argv_alloced = FALSE;
@@ -114,7 +137,7 @@ int libatari800_init(int argc, char **argv) {
 	}
 
 	CPU_cim_encountered = 0;
-	libatari800_error_code = 0;
+	LIBATARI800_error_code = 0;
 	Atari800_nframes = 0;
 	MEMORY_selftest_enabled = 0;
 	status = Atari800_Initialise(&argc, argv_ptr);
@@ -127,7 +150,7 @@ int libatari800_init(int argc, char **argv) {
 	return status;
 }
 
-char *error_messages[] = {
+static char *error_messages[] = {
 	"no error",
 	"unidentified cartridge",
 	"CPU crash",
@@ -137,7 +160,7 @@ char *error_messages[] = {
 	"memo pad",
 	"invalid escape opcode"
 };
-char *unknown_error = "unknown error";
+static char *unknown_error = "unknown error";
 
 
 /** Get text description of latest error message
@@ -148,10 +171,10 @@ char *unknown_error = "unknown error";
  * @returns text description of error
  */
 const char *libatari800_error_message() {
-	if ((libatari800_error_code < 0) || (libatari800_error_code > (sizeof(error_messages)))) {
+	if ((LIBATARI800_error_code < 0) || (LIBATARI800_error_code > (sizeof(error_messages)))) {
 		return unknown_error;
 	}
-	return error_messages[libatari800_error_code];
+	return error_messages[LIBATARI800_error_code];
 }
 
 
@@ -171,6 +194,64 @@ void libatari800_continue_emulation_on_brk(int cont) {
 }
 
 
+/** Set whether emulated frames update the screen buffer.
+ * 
+ * Frames emulated without drawing keep the exact timing of drawn frames,
+ * including DMA cycle stealing, display list interrupts and collisions
+ * between players, missiles and playfields, so the emulation produces the
+ * same results either way. Only the screen buffer is not updated: its
+ * contents are undefined until the next drawn frame. This makes it cheap
+ * to step through frames that are not observed, and can be changed before
+ * any frame. The setting applies to the machine of the calling thread.
+ * 
+ * Without drawing, only the scanlines that show players or missiles are
+ * rendered, as collisions are detected by the renderer.
+ * 
+ * @param draw if True (the default), frames are drawn into the screen buffer.
+ */
+void libatari800_set_draw_screen(int draw) {
+	ANTIC_no_pixels = !draw;
+}
+
+
+/** Start measuring where the time of each frame goes
+ * 
+ * The time of each frame is split between the CPU, ANTIC drawing, GTIA
+ * players and missiles, POKEY sound, SIO disk operations, the display and
+ * everything else, which includes the caller's own time between frames.
+ * Profiling can also be enabled with the -profile, -profile-file and
+ * -profile-csv command line options of libatari800_init.
+ * 
+ * @param filename file to write a record of each frame to, or NULL to only
+ * log the summary
+ * @param csv if True, the frame records are CSV, otherwise one JSON object
+ * per line
+ * 
+ * @retval FALSE if the library was built without the profiler or the file
+ * cannot be created
+ */
+int libatari800_profile_start(const char *filename, int csv) {
+#ifdef PROFILER
+	return Profile_Start(filename, csv);
+#else
+	return FALSE;
+#endif
+}
+
+
+/** Stop profiling
+ * 
+ * Logs the mean, 50th, 90th and 99th percentile and maximum time per frame
+ * of each section and closes the file of frame records. A JSON file ends
+ * with an object holding the same summary.
+ */
+void libatari800_profile_stop(void) {
+#ifdef PROFILER
+	Profile_Stop();
+#endif
+}
+
+
 /** Clears input array structure
  * 
  * Clears any user input (keystrokes, joysticks, paddles) in the input array
@@ -189,6 +270,9 @@ void libatari800_clear_input_array(input_template_t *input)
 }
 
 
+static int emulate_frame(input_template_t *input);
+static void discard_render_carry(void);
+
 /** Perform one video frame's worth of emulation
  * 
  * This is the main driver for libatari800. This function runs the emulator for enough
@@ -208,11 +292,25 @@ void libatari800_clear_input_array(input_template_t *input)
  */
 int libatari800_next_frame(input_template_t *input)
 {
+	int status;
+
+	status = emulate_frame(input);
+	libatari800_error_code = LIBATARI800_error_code;
+	return status;
+}
+
+/* Emulates a frame for all the functions that run frames. The audio kept
+   by libatari800_render_audio is older than the frame, so it is dropped;
+   libatari800_render_audio takes it before emulating the first frame and
+   only keeps new audio after the last one. */
+static int emulate_frame(input_template_t *input)
+{
+	discard_render_carry();
 	LIBATARI800_Input_array = input;
 	INPUT_key_code = PLATFORM_Keyboard();
 	LIBATARI800_Mouse();
 #ifdef HAVE_SETJMP
-	if ((libatari800_error_code = setjmp(libatari800_cpu_crash))) {
+	if ((LIBATARI800_error_code = setjmp(libatari800_cpu_crash))) {
 		/* called from within CPU_GO to indicate crash */
 		Log_print("libatari800_next_frame: notified of CPU crash: %d\n", CPU_cim_encountered);
 	}
@@ -222,14 +320,16 @@ int libatari800_next_frame(input_template_t *input)
 		/* normal operation */
 		LIBATARI800_Frame();
 		if (CPU_cim_encountered) {
-			libatari800_error_code = LIBATARI800_CPU_CRASH;
+			LIBATARI800_error_code = LIBATARI800_CPU_CRASH;
 		}
 		else if (ANTIC_dlist == 0) {
-			libatari800_error_code = LIBATARI800_DLIST_ERROR;
+			LIBATARI800_error_code = LIBATARI800_DLIST_ERROR;
 		}
 	}
+	PROFILE_SWITCH(PROFILE_DISPLAY);
 	PLATFORM_DisplayScreen();
-	return !libatari800_error_code;
+	PROFILE_SWITCH(PROFILE_OTHER);
+	return !LIBATARI800_error_code;
 }
 
 
@@ -272,7 +372,9 @@ int libatari800_reboot_with_file(const char *filename)
 	file_type = AFILE_OpenFile(filename, FALSE, 1, FALSE);
 	if (file_type != AFILE_ERROR) {
 		Atari800_Coldstart();
+		discard_render_carry();
 	}
+	libatari800_error_code = LIBATARI800_error_code;
 	return file_type;
 }
 
@@ -349,6 +451,166 @@ int libatari800_get_sound_buffer_len() {
 }
 
 
+/* Frames that libatari800_render_audio emulates beyond the length of the
+   requested audio before it gives up */
+#define RENDER_AUDIO_EXTRA_FRAMES 10
+
+/* Audio of the last frame rendered by libatari800_render_audio that was
+   not returned yet */
+static THREAD_LOCAL UBYTE *render_carry = NULL;
+static THREAD_LOCAL unsigned int render_carry_size = 0;
+static THREAD_LOCAL unsigned int render_carry_fill = 0;
+
+static void discard_render_carry(void)
+{
+	render_carry_fill = 0;
+}
+
+/* Copies up to SIZE bytes from the start of the carry to BUFFER and returns
+   the number of bytes copied */
+static unsigned int take_render_carry(UBYTE *buffer, unsigned int size)
+{
+	if (size > render_carry_fill)
+		size = render_carry_fill;
+	if (buffer != NULL)
+		memcpy(buffer, render_carry, size);
+	render_carry_fill -= size;
+	memmove(render_carry, render_carry + size, render_carry_fill);
+	return size;
+}
+
+/** Render audio as fast as possible, without drawing the screen
+ *
+ * Emulates frames with the same \a input until \a seconds of audio are
+ * produced, and copies the audio to \a buffer in the format of \a
+ * libatari800_get_sound_buffer. The frames are not drawn (see \a
+ * libatari800_set_draw_screen), but keep the exact timing of drawn frames,
+ * so the audio is the same as with \a libatari800_next_frame.
+ *
+ * The audio of the last frame that goes beyond \a seconds is kept and
+ * returned first by the next call, so that consecutive calls produce a
+ * continuous stream. It is discarded when a frame is emulated any other
+ * way, e.g. by \a libatari800_next_frame, and when a state is restored or
+ * the machine is rebooted.
+ *
+ * If an audio recording has been started with \a
+ * libatari800_start_audio_recording, the rendered audio is also written
+ * to the recording.
+ *
+ * @param input input template structure defining the user input for all
+ * the emulated frames
+ * @param seconds length of the audio to render
+ * @param buffer buffer for the audio, or NULL to only write the recording
+ * @param buffer_size size of \a buffer in bytes; no more audio is rendered
+ * than fits in it, even if it is shorter than \a seconds
+ *
+ * @returns number of bytes of audio rendered. The rendering stops early if
+ * the emulation fails with an error other than a display list error, in
+ * which case \a libatari800_error_code is set as in \a
+ * libatari800_next_frame. It also stops after the frames that \a seconds
+ * lasts and a few more, so the count is short if the frames did not
+ * produce enough audio.
+ */
+int libatari800_render_audio(input_template_t *input, double seconds, UBYTE *buffer, int buffer_size)
+{
+	unsigned int bytes_per_frame = Sound_out.sample_size * Sound_out.channels;
+	unsigned int size;
+	unsigned int done;
+	unsigned int frames;
+	int no_pixels = ANTIC_no_pixels;
+
+	if (!Sound_enabled || seconds <= 0.0)
+		return 0;
+	size = (unsigned int) (seconds * Sound_out.freq) * bytes_per_frame;
+	if (buffer != NULL && size > (unsigned int) buffer_size)
+		size = buffer_size / bytes_per_frame * bytes_per_frame;
+
+	/* frames that produce no audio would otherwise keep the loop going
+	   forever */
+	frames = (unsigned int) (seconds * (Atari800_tv_mode == Atari800_TV_PAL ? Atari800_FPS_PAL : Atari800_FPS_NTSC))
+		+ 1 + RENDER_AUDIO_EXTRA_FRAMES;
+
+	done = take_render_carry(buffer, size);
+	ANTIC_no_pixels = TRUE;
+	while (done < size && frames-- > 0) {
+		unsigned int part;
+		/* players often turn the display list off, which is no reason
+		   to stop */
+		if (!emulate_frame(input) && LIBATARI800_error_code != LIBATARI800_DLIST_ERROR)
+			break;
+		part = sound_array_fill;
+		if (part > size - done)
+			part = size - done;
+		if (buffer != NULL)
+			memcpy(buffer + done, LIBATARI800_Sound_array, part);
+		done += part;
+		if (part < sound_array_fill) {
+			/* keep the rest for the next call */
+			render_carry_fill = sound_array_fill - part;
+			if (render_carry_fill > render_carry_size) {
+				render_carry_size = sound_hw_buffer_size;
+				render_carry = (UBYTE *) Util_realloc(render_carry, render_carry_size);
+			}
+			memcpy(render_carry, LIBATARI800_Sound_array + part, render_carry_fill);
+		}
+	}
+	ANTIC_no_pixels = no_pixels;
+	libatari800_error_code = LIBATARI800_error_code;
+	return (int) done;
+}
+
+
+/** Start writing the emulated audio to a file
+ *
+ * Audio of all following frames is written to \a filename until \a
+ * libatari800_stop_audio_recording is called. The format is chosen by the
+ * extension of \a filename: \c .wav, or \c .mp3 if libatari800 is built
+ * with MP3 support. The encoding is set by the \c -acodec, \c -ab, \c -ar
+ * and \c -aq options of \a libatari800_init. Float audio (\c -audiofloat)
+ * is recorded as 16-bit.
+ *
+ * @param filename path of the file to create
+ *
+ * @retval FALSE if error; the reason is logged
+ * @retval TRUE if successful
+ */
+int libatari800_start_audio_recording(const char *filename)
+{
+#ifdef AUDIO_RECORDING
+	if (!Sound_enabled) {
+		Log_print("Cannot record audio: sound is disabled");
+		return FALSE;
+	}
+	if (!File_Export_StartRecording(filename))
+		return FALSE;
+	if (container->video_frame != NULL) {
+		/* libatari800 does not write video frames */
+		File_Export_StopRecording();
+		Log_print("Cannot record video, use an audio file format");
+		return FALSE;
+	}
+	return TRUE;
+#else
+	return FALSE;
+#endif
+}
+
+
+/** Finish the file started by \a libatari800_start_audio_recording
+ *
+ * @retval FALSE if error or no recording was started
+ * @retval TRUE if successful
+ */
+int libatari800_stop_audio_recording(void)
+{
+#ifdef AUDIO_RECORDING
+	return File_Export_StopRecording();
+#else
+	return FALSE;
+#endif
+}
+
+
 /** Return the maximum size of the sound buffer.
  *
  * @returns number of bytes allocated in sound buffer
@@ -382,6 +644,7 @@ int libatari800_get_num_sound_channels() {
  *
  * @retval 1 8-bit audio
  * @retval 2 16-bit audio
+ * @retval 4 32-bit float audio (see the \a -audiofloat option)
  */
 int libatari800_get_sound_sample_size() {
 	return Sound_out.sample_size;
@@ -456,6 +719,7 @@ void libatari800_get_current_state(emulator_state_t *state)
 	state->flags.selftest_enabled = MEMORY_selftest_enabled;
 	state->flags.nframes = (ULONG)Atari800_nframes;
 	state->flags.sample_residual = (ULONG)(0xffffffff * sample_residual);
+	state->flags.random_counter = POKEY_GetRandomCounter();
 }
 
 
@@ -472,10 +736,612 @@ void libatari800_get_current_state(emulator_state_t *state)
  */
 void libatari800_restore_state(emulator_state_t *state)
 {
+	discard_render_carry();
 	LIBATARI800_StateLoad(state->state);
 	MEMORY_selftest_enabled = state->flags.selftest_enabled;
 	Atari800_nframes = state->flags.nframes;
 	sample_residual = (double)state->flags.sample_residual / (double)0xffffffff;
+	POKEY_SetRandomCounter(state->flags.random_counter);
+}
+
+
+/** Return the pages of main memory written since the last clear
+ *
+ * Stores a bitmap of the 256 pages of the CPU address space in \a bitmap:
+ * bit \a n & 7 of byte \a n >> 3 is set if page \a n (addresses \a n *
+ * 256 to \a n * 256 + 255) was written by the emulated machine since the
+ * last call to \a libatari800_clear_dirty_pages, or had its contents
+ * changed by switching memory banks or ROMs. Loading a state marks all
+ * pages as written.
+ *
+ * @param bitmap pointer to 32 bytes to store the bitmap in
+ */
+void libatari800_get_dirty_pages(UBYTE *bitmap)
+{
+	int num_pages;
+	int page;
+	UBYTE const *dirty = MEMORY_GetDirty(MEMORY_DIRTY_API, MEMORY_BLOCK_BASE, &num_pages);
+
+	memset(bitmap, 0, 32);
+	for (page = 0; page < 256; page++)
+		if (dirty[page])
+			bitmap[page >> 3] |= 1 << (page & 7);
+}
+
+
+/** Return the pages of extended memory written since the last clear
+ *
+ * Stores a bitmap of the pages of the 130XE-style (\a LIBATARI800_BANKS_XE),
+ * Axlon (\a LIBATARI800_BANKS_AXLON) or Mosaic (\a
+ * LIBATARI800_BANKS_MOSAIC) extended memory in the same format as \a
+ * libatari800_get_dirty_pages. Page \a n is at offset \a n * 256 of the
+ * extended memory as saved in the emulator state; for XE memory, the first
+ * 16K bank holds the base memory at 0x4000-0x7fff while an extended bank
+ * is switched in.
+ *
+ * @param type type of extended memory
+ * @param bitmap memory to store the bitmap in
+ * @param size size of \a bitmap in bytes
+ *
+ * @returns number of pages of the extended memory, or 0 if the machine
+ * doesn't have it. If \a bitmap is too small, only the first \a size * 8
+ * pages are reported.
+ */
+int libatari800_get_dirty_bank_pages(int type, UBYTE *bitmap, int size)
+{
+	static const int blocks[] = { MEMORY_BLOCK_XE, MEMORY_BLOCK_AXLON, MEMORY_BLOCK_MOSAIC };
+	int num_pages = 0;
+	int page;
+	UBYTE const *dirty = NULL;
+
+	if (type >= 0 && type < (int) (sizeof(blocks) / sizeof(blocks[0])))
+		dirty = MEMORY_GetDirty(MEMORY_DIRTY_API, blocks[type], &num_pages);
+	memset(bitmap, 0, size);
+	for (page = 0; page < num_pages && page < size * 8; page++)
+		if (dirty[page])
+			bitmap[page >> 3] |= 1 << (page & 7);
+	return num_pages;
+}
+
+
+/** Mark all pages of memory as unmodified
+ *
+ * Clears the bitmaps returned by \a libatari800_get_dirty_pages and \a
+ * libatari800_get_dirty_bank_pages.
+ */
+void libatari800_clear_dirty_pages(void)
+{
+	MEMORY_ClearDirty(MEMORY_DIRTY_API);
+}
+
+
+/** Return the size of the emulator state
+ *
+ * Returns the exact number of bytes needed by \a libatari800_save_state for
+ * the current machine configuration. The size only changes when the
+ * configuration does (e.g. a different machine type, memory size or
+ * cartridge), so it can be queried once and the buffer reused.
+ *
+ * @returns size in bytes of the serialized emulator state
+ */
+ULONG libatari800_get_state_size(void)
+{
+	return LIBATARI800_StateSize(FALSE) + sizeof(LIBATARI800_extra_state_t);
+}
+
+
+/** Save the state of the emulator into a caller-provided buffer
+ *
+ * Like \a libatari800_get_current_state, but the state is serialized
+ * directly into \a buffer, which only needs to be as large as reported by
+ * \a libatari800_get_state_size rather than \a STATESAV_MAX_SIZE. The
+ * buffer also holds the input handling and POKEY timing state that
+ * emulator_state_t lacks, so that running the same frame again after \a
+ * libatari800_load_state gives identical results.
+ *
+ * @param buffer memory to store the state in
+ * @param size size of \a buffer in bytes
+ * @param tags if not NULL, filled with the offsets of the subsystems within
+ * \a buffer, see \a libatari800_get_current_state
+ *
+ * @returns number of bytes stored, or 0 if \a buffer is too small
+ */
+ULONG libatari800_save_state(UBYTE *buffer, ULONG size, statesav_tags_t *tags)
+{
+	statesav_tags_t local_tags;
+	LIBATARI800_extra_state_t extra;
+	ULONG state_size = LIBATARI800_StateSize(FALSE);
+
+	if (size < state_size + sizeof(LIBATARI800_extra_state_t))
+		return 0;
+	if (tags == NULL)
+		tags = &local_tags;
+	if (!LIBATARI800_StateSaveBuffer(buffer, state_size, tags, FALSE))
+		return 0;
+	/* followed by the variables that aren't part of the state save */
+	LIBATARI800_SaveExtraState(&extra);
+	memcpy(buffer + state_size, &extra, sizeof(extra));
+	return state_size + sizeof(LIBATARI800_extra_state_t);
+}
+
+
+/** Restore the state of the emulator from a caller-provided buffer
+ *
+ * Return the emulator to a state saved by \a libatari800_save_state. The
+ * state is read directly from \a buffer, which is not modified.
+ *
+ * @param buffer state saved by \a libatari800_save_state
+ * @param size number of bytes returned by \a libatari800_save_state
+ *
+ * @retval FALSE if the state could not be read
+ * @retval TRUE if successful
+ */
+int libatari800_load_state(const UBYTE *buffer, ULONG size)
+{
+	LIBATARI800_extra_state_t extra;
+
+	if (size < sizeof(LIBATARI800_extra_state_t))
+		return FALSE;
+	size -= sizeof(LIBATARI800_extra_state_t);
+	if (!LIBATARI800_StateLoadBuffer(buffer, size))
+		return FALSE;
+	discard_render_carry();
+	memcpy(&extra, buffer + size, sizeof(extra));
+	LIBATARI800_RestoreExtraState(&extra);
+	return TRUE;
+}
+
+
+/** Create a rewind buffer
+ *
+ * A rewind buffer stores a history of emulator states in memory. Only every
+ * \a keyframe_interval-th state is stored completely; the states in between
+ * store the parts that changed since the previous one, so that storing a
+ * state for every frame takes little memory and time. When the buffer is
+ * full, the oldest keyframe and the states depending on it are discarded.
+ * The changed memory is found from the pages written by the emulated machine
+ * since the previous state, so a machine can only be used with one rewind
+ * buffer at a time.
+ *
+ * @param capacity maximum number of states kept
+ * @param keyframe_interval number of states between complete states
+ *
+ * @returns pointer to the new rewind buffer
+ */
+libatari800_rewind_t *libatari800_create_rewind(int capacity, int keyframe_interval)
+{
+	return LIBATARI800_Rewind_New(capacity, keyframe_interval);
+}
+
+
+/** Store the current emulator state in a rewind buffer
+ *
+ * Typically called once after every \a libatari800_next_frame. When using
+ * contexts, call from a function run by \a libatari800_call_context, with
+ * one rewind buffer per context.
+ *
+ * @param rw rewind buffer from \a libatari800_create_rewind
+ *
+ * @retval FALSE if the state could not be saved
+ * @retval TRUE if successful
+ */
+int libatari800_rewind_push(libatari800_rewind_t *rw)
+{
+	return LIBATARI800_Rewind_Push(rw);
+}
+
+
+/** Restore an earlier emulator state from a rewind buffer
+ *
+ * Loads the state stored \a steps calls to \a libatari800_rewind_push
+ * before the latest one. The states newer than the restored one are
+ * discarded, so emulation continues from the restored state and repeated
+ * calls go further back in time. Cartridges and disks that are still
+ * inserted are kept rather than loaded again from their files.
+ *
+ * @param rw rewind buffer from \a libatari800_create_rewind
+ * @param steps number of states to go back; 0 restores the latest state
+ *
+ * @retval FALSE if the buffer doesn't hold that many states
+ * @retval TRUE if successful
+ */
+int libatari800_rewind_restore(libatari800_rewind_t *rw, int steps)
+{
+	if (!LIBATARI800_Rewind_Restore(rw, steps))
+		return FALSE;
+	discard_render_carry();
+	return TRUE;
+}
+
+
+/** Return the number of states in a rewind buffer
+ *
+ * @param rw rewind buffer from \a libatari800_create_rewind
+ *
+ * @returns number of states that can be restored
+ */
+int libatari800_rewind_get_count(libatari800_rewind_t *rw)
+{
+	return LIBATARI800_Rewind_Count(rw);
+}
+
+
+/** Return the memory used by the states in a rewind buffer
+ *
+ * @param rw rewind buffer from \a libatari800_create_rewind
+ *
+ * @returns number of bytes of state data stored
+ */
+ULONG libatari800_rewind_get_size(libatari800_rewind_t *rw)
+{
+	return LIBATARI800_Rewind_Bytes(rw);
+}
+
+
+/** Discard all states in a rewind buffer
+ *
+ * Should be called after rebooting or loading a different state, as the
+ * stored history no longer applies.
+ *
+ * @param rw rewind buffer from \a libatari800_create_rewind
+ */
+void libatari800_rewind_clear(libatari800_rewind_t *rw)
+{
+	LIBATARI800_Rewind_Clear(rw);
+}
+
+
+/** Free a rewind buffer
+ *
+ * @param rw rewind buffer from \a libatari800_create_rewind
+ */
+void libatari800_free_rewind(libatari800_rewind_t *rw)
+{
+	LIBATARI800_Rewind_Free(rw);
+}
+
+
+/** Create an emulator context
+ *
+ * A context holds one complete emulated machine, so that any number of
+ * independent machines can be run in the same process, each on its own
+ * thread. Each context must be initialized with \a libatari800_init_context
+ * before its first frame.
+ *
+ * Contexts are only available if libatari800 is configured with \c
+ * --enable-multiinstance. In that build all of the emulator's state is
+ * thread-local: the non-context functions operate on a machine that
+ * belongs to the calling thread, and every context runs its machine on a
+ * thread of its own. Different contexts can be used from different threads
+ * at the same time; calls for the same context are run one at a time, in
+ * order. To use the non-context functions on the machine of a context,
+ * call them from a function run by \a libatari800_call_context.
+ *
+ * @returns pointer to a new context, to be released with \a
+ * libatari800_free_context, or NULL if contexts are not available
+ */
+libatari800_context_t *libatari800_create_context(void)
+{
+#ifdef MULTI_INSTANCE
+	return LIBATARI800_Context_New();
+#else
+	return NULL;
+#endif
+}
+
+
+#ifdef MULTI_INSTANCE
+typedef struct {
+	libatari800_context_t *ctx;
+	int argc;
+	char **argv;
+	input_template_t *input;
+	int status;
+} context_call_t;
+
+static void init_context(void *arg)
+{
+	context_call_t *call = (context_call_t *) arg;
+
+	call->status = init_machine(call->argc, call->argv);
+	call->ctx->initialised = TRUE;
+	sound_array_fill = 0;
+	LIBATARI800_Context_Update(call->ctx);
+}
+
+static void next_frame_context(void *arg)
+{
+	context_call_t *call = (context_call_t *) arg;
+
+	call->status = emulate_frame(call->input);
+	LIBATARI800_Context_Update(call->ctx);
+}
+#endif /* MULTI_INSTANCE */
+
+
+/** Initialize an emulator context
+ *
+ * Same as \a libatari800_init, but configures the machine held in \a ctx.
+ * Other contexts are not affected.
+ *
+ * @param ctx context from \a libatari800_create_context
+ * @param argc number of arguments in @a argv, or -1 if \a argv contains a NULL
+ * terminated list.
+ * @param argv list of arguments.
+ *
+ * @retval FALSE if error in argument list
+ * @retval TRUE if successful
+ */
+int libatari800_init_context(libatari800_context_t *ctx, int argc, char **argv)
+{
+#ifdef MULTI_INSTANCE
+	context_call_t call;
+
+	call.ctx = ctx;
+	call.argc = argc;
+	call.argv = argv;
+	LIBATARI800_Context_Call(ctx, init_context, &call);
+	return call.status;
+#else
+	return FALSE;
+#endif
+}
+
+
+/** Perform one video frame's worth of emulation on a context
+ *
+ * Same as \a libatari800_next_frame, but runs the machine held in \a ctx.
+ * The resulting screen and sound can be retrieved with \a
+ * libatari800_get_screen_ptr_context and \a libatari800_get_sound_buffer_context.
+ *
+ * @param ctx context from \a libatari800_create_context
+ * @param input input template structure defining the user input for the frame
+ *
+ * @returns see \a libatari800_next_frame
+ */
+int libatari800_next_frame_context(libatari800_context_t *ctx, input_template_t *input)
+{
+#ifdef MULTI_INSTANCE
+	context_call_t call;
+
+	call.ctx = ctx;
+	call.input = input;
+	LIBATARI800_Context_Call(ctx, next_frame_context, &call);
+	return call.status;
+#else
+	return FALSE;
+#endif
+}
+
+
+/** Run a function on the machine of a context
+ *
+ * Calls \a func with \a arg on the thread of \a ctx and waits for it to
+ * return. Inside \a func, the non-context \a libatari800_* functions
+ * (memory and state access, disk mounting, rewind, etc.) operate on the
+ * machine held in \a ctx. The \a libatari800_*_context functions must not
+ * be called from \a func.
+ *
+ * @param ctx context from \a libatari800_create_context
+ * @param func function to call
+ * @param arg argument passed to \a func
+ */
+void libatari800_call_context(libatari800_context_t *ctx, void (*func)(void *arg), void *arg)
+{
+#ifdef MULTI_INSTANCE
+	LIBATARI800_Context_Call(ctx, func, arg);
+#endif
+}
+
+
+/** Return the error code of the last frame of a context
+ *
+ * @param ctx context from \a libatari800_create_context
+ *
+ * @returns error code as in \a libatari800_error_code
+ */
+int libatari800_get_error_code_context(libatari800_context_t *ctx)
+{
+#ifdef MULTI_INSTANCE
+	return ctx->error_code;
+#else
+	return 0;
+#endif
+}
+
+
+/** Return pointer to the screen data of a context
+ *
+ * See \a libatari800_get_screen_ptr for the format. The pointer stays valid
+ * until the context is freed; the screen must not be read while a frame of
+ * the context is running.
+ *
+ * @param ctx context from \a libatari800_create_context
+ *
+ * @returns pointer to the emulated screen of the machine in \a ctx
+ */
+UBYTE *libatari800_get_screen_ptr_context(libatari800_context_t *ctx)
+{
+#ifdef MULTI_INSTANCE
+	return ctx->screen;
+#else
+	return NULL;
+#endif
+}
+
+
+/** Return pointer to the sound data of a context
+ *
+ * See \a libatari800_get_sound_buffer for the format.
+ *
+ * @param ctx context from \a libatari800_create_context
+ *
+ * @returns pointer to the sound samples of the last frame of \a ctx
+ */
+UBYTE *libatari800_get_sound_buffer_context(libatari800_context_t *ctx)
+{
+#ifdef MULTI_INSTANCE
+	return ctx->sound_array;
+#else
+	return NULL;
+#endif
+}
+
+
+/** Return the usable size of the sound buffer of a context
+ *
+ * @param ctx context from \a libatari800_create_context
+ *
+ * @returns number of bytes of valid data in the sound buffer of \a ctx
+ */
+int libatari800_get_sound_buffer_len_context(libatari800_context_t *ctx)
+{
+#ifdef MULTI_INSTANCE
+	return (int)ctx->sound_array_fill;
+#else
+	return 0;
+#endif
+}
+
+
+/** Free an emulator context
+ *
+ * Releases the machine held in \a ctx and stops its thread. The context
+ * must not be used after this call.
+ *
+ * @param ctx context from \a libatari800_create_context
+ */
+void libatari800_free_context(libatari800_context_t *ctx)
+{
+#ifdef MULTI_INSTANCE
+	LIBATARI800_Context_Free(ctx);
+#endif
+}
+
+
+/** Create a batch result buffer
+ *
+ * The batch holds the screens and sound buffers produced by \a
+ * libatari800_batch_next_frame. It can be reused for any number of calls.
+ *
+ * @returns pointer to a new batch, to be released with \a libatari800_free_batch
+ */
+libatari800_batch_t *libatari800_create_batch(void)
+{
+	return LIBATARI800_Batch_New();
+}
+
+
+#ifdef MULTI_INSTANCE
+/* Runs one frame of a batch and copies its results into the slot of the
+   frame right away, so that a context that appears several times in the
+   batch fills each of its slots with the frame that belongs to it. */
+static void batch_frame(void *arg)
+{
+	LIBATARI800_Batch_frame_t *frame = (LIBATARI800_Batch_frame_t *) arg;
+	libatari800_batch_t *batch = frame->batch;
+	UBYTE *slot = batch->arena + frame->index * batch->stride;
+
+	batch->status[frame->index] = emulate_frame(frame->input);
+	LIBATARI800_Context_Update(frame->ctx);
+	memcpy(slot, Screen_atari, batch->screen_size);
+	memcpy(slot + batch->sound_offset, LIBATARI800_Sound_array, sound_array_fill);
+	batch->sound_len[frame->index] = sound_array_fill;
+}
+#endif /* MULTI_INSTANCE */
+
+
+/** Perform one video frame's worth of emulation on several contexts
+ *
+ * Runs one frame on each of \a ctx[0] .. \a ctx[count - 1], using \a
+ * input[i] for \a ctx[i], and copies the resulting screens and sound
+ * buffers into the arena of \a batch. Different contexts run in parallel,
+ * each on its own thread. A context may appear more than once to run
+ * several frames on it; its frames are run in the order they appear.
+ *
+ * The return value of \a libatari800_next_frame for each context is stored
+ * in \a batch->status and the number of valid sound bytes in \a
+ * batch->sound_len. Data in the arena is valid until the next call with the
+ * same batch.
+ *
+ * @param batch batch from \a libatari800_create_batch
+ * @param ctx array of \a count initialized contexts
+ * @param input array of \a count input templates
+ * @param count number of contexts to run
+ *
+ * @returns number of contexts that completed the frame without error
+ */
+int libatari800_batch_next_frame(libatari800_batch_t *batch, libatari800_context_t **ctx, input_template_t *input, int count)
+{
+#ifdef MULTI_INSTANCE
+	LIBATARI800_Batch_frame_t *frames;
+	int i;
+	int ok = 0;
+	ULONG sound_size = 0;
+
+	/* the sound buffer of a context holds the most a frame can produce */
+	for (i = 0; i < count; i++)
+		if (ctx[i]->sound_array_size > sound_size)
+			sound_size = ctx[i]->sound_array_size;
+	LIBATARI800_Batch_Reserve(batch, count);
+	LIBATARI800_Batch_Layout(batch, sound_size);
+
+	frames = (LIBATARI800_Batch_frame_t *) batch->frames;
+	for (i = 0; i < count; i++) {
+		frames[i].job.func = batch_frame;
+		frames[i].job.arg = &frames[i];
+		frames[i].batch = batch;
+		frames[i].ctx = ctx[i];
+		frames[i].input = &input[i];
+		frames[i].index = i;
+		LIBATARI800_Context_Post(ctx[i], &frames[i].job);
+	}
+	for (i = 0; i < count; i++) {
+		LIBATARI800_Context_Wait(ctx[i], &frames[i].job);
+		if (batch->status[i])
+			ok++;
+	}
+	return ok;
+#else
+	return 0;
+#endif
+}
+
+
+/** Return pointer to the screen of one instance of a batch
+ *
+ * @param batch batch passed to \a libatari800_batch_next_frame
+ * @param i index of the context in the last batch
+ *
+ * @returns pointer into the batch arena, see \a libatari800_get_screen_ptr
+ * for the format
+ */
+UBYTE *libatari800_batch_get_screen_ptr(libatari800_batch_t *batch, int i)
+{
+	return batch->arena + i * batch->stride;
+}
+
+
+/** Return pointer to the sound data of one instance of a batch
+ *
+ * @param batch batch passed to \a libatari800_batch_next_frame
+ * @param i index of the context in the last batch
+ *
+ * @returns pointer into the batch arena; \a batch->sound_len[i] bytes are valid
+ */
+UBYTE *libatari800_batch_get_sound_buffer(libatari800_batch_t *batch, int i)
+{
+	return batch->arena + i * batch->stride + batch->sound_offset;
+}
+
+
+/** Free a batch result buffer
+ *
+ * @param batch batch from \a libatari800_create_batch
+ */
+void libatari800_free_batch(libatari800_batch_t *batch)
+{
+	LIBATARI800_Batch_Free(batch);
 }
 
 
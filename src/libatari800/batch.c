@@ -0,0 +1,93 @@
+/*
+ * libatari800/batch.c - Atari800 as a library - batched stepping of contexts
+ *
+ * Copyright (C) 2021 Atari800 development team (see DOC/CREDITS)
+ *
+ * This file is part of the Atari800 emulator project which emulates
+ * the Atari 400, 800, 800XL, 130XE, and 5200 8-bit computers.
+ *
+ * Atari800 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Atari800 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Atari800; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#include "config.h"
+#include <stdlib.h>
+#include <string.h>
+
+#include "atari.h"
+#include "screen.h"
+#include "util.h"
+#include "libatari800/batch.h"
+
+libatari800_batch_t *LIBATARI800_Batch_New(void)
+{
+	libatari800_batch_t *batch = (libatari800_batch_t *) Util_malloc(sizeof(libatari800_batch_t));
+	memset(batch, 0, sizeof(libatari800_batch_t));
+	return batch;
+}
+
+void LIBATARI800_Batch_Free(libatari800_batch_t *batch)
+{
+	free(batch->arena_alloc);
+	free(batch->frames);
+	free(batch->sound_len);
+	free(batch->status);
+	free(batch);
+}
+
+static ULONG AlignUp(ULONG size)
+{
+	return (size + LIBATARI800_BATCH_ALIGN - 1) & ~(ULONG)(LIBATARI800_BATCH_ALIGN - 1);
+}
+
+/* Make room for the per-instance results of count instances */
+void LIBATARI800_Batch_Reserve(libatari800_batch_t *batch, int count)
+{
+	if (count > batch->capacity) {
+		batch->sound_len = (int *) Util_realloc(batch->sound_len, count * sizeof(int));
+		batch->status = (int *) Util_realloc(batch->status, count * sizeof(int));
+#ifdef MULTI_INSTANCE
+		batch->frames = Util_realloc(batch->frames, count * sizeof(LIBATARI800_Batch_frame_t));
+#endif
+		batch->capacity = count;
+	}
+	batch->count = count;
+}
+
+/* Lay out the arena for batch->count instances with up to sound_size bytes
+   of sound each. The arena only grows, so that a steady batch size doesn't
+   reallocate on every frame. */
+void LIBATARI800_Batch_Layout(libatari800_batch_t *batch, ULONG sound_size)
+{
+	ULONG size;
+
+	batch->screen_size = Screen_WIDTH * Screen_HEIGHT;
+	batch->sound_offset = AlignUp(batch->screen_size);
+	if (batch->sound_offset + sound_size > batch->stride)
+		batch->stride = AlignUp(batch->sound_offset + sound_size);
+	size = batch->stride * batch->count;
+	if (size > batch->arena_size) {
+		/* the arena must be aligned, so over-allocate and round up */
+		free(batch->arena_alloc);
+		batch->arena_alloc = Util_malloc(size + LIBATARI800_BATCH_ALIGN - 1);
+		batch->arena = (UBYTE *) (((size_t) batch->arena_alloc + LIBATARI800_BATCH_ALIGN - 1)
+		                          & ~(size_t) (LIBATARI800_BATCH_ALIGN - 1));
+		batch->arena_size = size;
+	}
+}
+
+/*
+vim:ts=4:sw=4:
+*/
@@ -0,0 +1,25 @@
+#ifndef LIBATARI800_BATCH_H_
+#define LIBATARI800_BATCH_H_
+
+#include "config.h"
+#include "atari.h"
+#include "libatari800/libatari800.h"
+#include "libatari800/context.h"
+
+#ifdef MULTI_INSTANCE
+/* One frame of a batch, run by the thread of its context */
+typedef struct {
+	LIBATARI800_Context_job_t job;
+	libatari800_batch_t *batch;
+	libatari800_context_t *ctx;
+	input_template_t *input;
+	int index;
+} LIBATARI800_Batch_frame_t;
+#endif /* MULTI_INSTANCE */
+
+libatari800_batch_t *LIBATARI800_Batch_New(void);
+void LIBATARI800_Batch_Free(libatari800_batch_t *batch);
+void LIBATARI800_Batch_Reserve(libatari800_batch_t *batch, int count);
+void LIBATARI800_Batch_Layout(libatari800_batch_t *batch, ULONG sound_size);
+
+#endif /* LIBATARI800_BATCH_H_ */
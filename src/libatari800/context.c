@@ -0,0 +1,152 @@
+/*
+ * libatari800/context.c - Atari800 as a library - multiple emulated machines
+ *
+ * Copyright (C) 2021 Atari800 development team (see DOC/CREDITS)
+ *
+ * This file is part of the Atari800 emulator project which emulates
+ * the Atari 400, 800, 800XL, 130XE, and 5200 8-bit computers.
+ *
+ * Atari800 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Atari800 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Atari800; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/* With MULTI_INSTANCE, all of the emulator's state is declared THREAD_LOCAL,
+   so every thread has a complete machine of its own. A context is a thread
+   that waits for calls from other threads and runs them on its machine, one
+   after another in the order they were posted. Contexts share nothing but
+   the read-only cache of decompressed disk images, so any number of them
+   can run at the same time. */
+
+#include "config.h"
+
+#ifdef MULTI_INSTANCE
+#include <stdlib.h>
+#include <string.h>
+
+#include "atari.h"
+#include "screen.h"
+#include "util.h"
+#include "libatari800/context.h"
+#include "libatari800/cpu_crash.h"
+#include "libatari800/sound.h"
+
+static void *ContextThread(void *arg)
+{
+	libatari800_context_t *ctx = (libatari800_context_t *) arg;
+
+	pthread_mutex_lock(&ctx->mutex);
+	for (;;) {
+		LIBATARI800_Context_job_t *job;
+		while (ctx->first_job == NULL && !ctx->quit)
+			pthread_cond_wait(&ctx->cond, &ctx->mutex);
+		job = ctx->first_job;
+		if (job == NULL)
+			break;
+		ctx->first_job = job->next;
+		if (ctx->first_job == NULL)
+			ctx->last_job = NULL;
+		pthread_mutex_unlock(&ctx->mutex);
+
+		job->func(job->arg);
+
+		pthread_mutex_lock(&ctx->mutex);
+		job->done = TRUE;
+		pthread_cond_broadcast(&ctx->cond);
+	}
+	pthread_mutex_unlock(&ctx->mutex);
+	return NULL;
+}
+
+libatari800_context_t *LIBATARI800_Context_New(void)
+{
+	libatari800_context_t *ctx = (libatari800_context_t *) Util_malloc(sizeof(libatari800_context_t));
+	memset(ctx, 0, sizeof(libatari800_context_t));
+	pthread_mutex_init(&ctx->mutex, NULL);
+	pthread_cond_init(&ctx->cond, NULL);
+	if (pthread_create(&ctx->thread, NULL, ContextThread, ctx) != 0) {
+		pthread_cond_destroy(&ctx->cond);
+		pthread_mutex_destroy(&ctx->mutex);
+		free(ctx);
+		return NULL;
+	}
+	return ctx;
+}
+
+static void ExitMachine(void *arg)
+{
+	libatari800_context_t *ctx = (libatari800_context_t *) arg;
+	if (ctx->initialised)
+		Atari800_Exit(FALSE);
+}
+
+void LIBATARI800_Context_Free(libatari800_context_t *ctx)
+{
+	LIBATARI800_Context_Call(ctx, ExitMachine, ctx);
+	pthread_mutex_lock(&ctx->mutex);
+	ctx->quit = TRUE;
+	pthread_cond_broadcast(&ctx->cond);
+	pthread_mutex_unlock(&ctx->mutex);
+	pthread_join(ctx->thread, NULL);
+	pthread_cond_destroy(&ctx->cond);
+	pthread_mutex_destroy(&ctx->mutex);
+	free(ctx);
+}
+
+/* Queue job to be run by the thread of ctx */
+void LIBATARI800_Context_Post(libatari800_context_t *ctx, LIBATARI800_Context_job_t *job)
+{
+	job->done = FALSE;
+	job->next = NULL;
+	pthread_mutex_lock(&ctx->mutex);
+	if (ctx->last_job != NULL)
+		ctx->last_job->next = job;
+	else
+		ctx->first_job = job;
+	ctx->last_job = job;
+	pthread_cond_broadcast(&ctx->cond);
+	pthread_mutex_unlock(&ctx->mutex);
+}
+
+/* Wait until job, posted to ctx, has been run */
+void LIBATARI800_Context_Wait(libatari800_context_t *ctx, LIBATARI800_Context_job_t *job)
+{
+	pthread_mutex_lock(&ctx->mutex);
+	while (!job->done)
+		pthread_cond_wait(&ctx->cond, &ctx->mutex);
+	pthread_mutex_unlock(&ctx->mutex);
+}
+
+void LIBATARI800_Context_Call(libatari800_context_t *ctx, void (*func)(void *arg), void *arg)
+{
+	LIBATARI800_Context_job_t job;
+	job.func = func;
+	job.arg = arg;
+	LIBATARI800_Context_Post(ctx, &job);
+	LIBATARI800_Context_Wait(ctx, &job);
+}
+
+void LIBATARI800_Context_Update(libatari800_context_t *ctx)
+{
+	ctx->screen = (UBYTE *) Screen_atari;
+	ctx->sound_array = LIBATARI800_Sound_array;
+	ctx->sound_array_fill = sound_array_fill;
+	ctx->sound_array_size = sound_hw_buffer_size;
+	ctx->error_code = LIBATARI800_error_code;
+}
+
+#endif /* MULTI_INSTANCE */
+
+/*
+vim:ts=4:sw=4:
+*/
@@ -0,0 +1,48 @@
+#ifndef LIBATARI800_CONTEXT_H_
+#define LIBATARI800_CONTEXT_H_
+
+#include "config.h"
+#include "atari.h"
+#include "libatari800/libatari800.h"
+
+#ifdef MULTI_INSTANCE
+#include <pthread.h>
+
+/* A call to be run by the thread of a context */
+typedef struct LIBATARI800_Context_job {
+	void (*func)(void *arg);
+	void *arg;
+	int done;
+	struct LIBATARI800_Context_job *next;
+} LIBATARI800_Context_job_t;
+
+/* One emulated machine. The state of the machine is thread-local, so every
+   context has a thread of its own that runs all calls for the machine. */
+struct libatari800_context {
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	LIBATARI800_Context_job_t *first_job;
+	LIBATARI800_Context_job_t *last_job;
+	int quit;
+
+	/* results of the last frame, for the other threads */
+	int initialised;
+	UBYTE *screen;
+	UBYTE *sound_array;
+	unsigned int sound_array_fill;
+	unsigned int sound_array_size;
+	int error_code;
+};
+
+libatari800_context_t *LIBATARI800_Context_New(void);
+void LIBATARI800_Context_Free(libatari800_context_t *ctx);
+void LIBATARI800_Context_Post(libatari800_context_t *ctx, LIBATARI800_Context_job_t *job);
+void LIBATARI800_Context_Wait(libatari800_context_t *ctx, LIBATARI800_Context_job_t *job);
+void LIBATARI800_Context_Call(libatari800_context_t *ctx, void (*func)(void *arg), void *arg);
+/* Copies the results of the last frame of the calling thread's machine into
+   ctx. Must be called from the thread of ctx. */
+void LIBATARI800_Context_Update(libatari800_context_t *ctx);
+#endif /* MULTI_INSTANCE */
+
+#endif /* LIBATARI800_CONTEXT_H_ */
@@ -4,14 +4,19 @@
 #include <stdio.h>
 
 #include "config.h"
+#include "atari.h"
 
 #ifdef HAVE_SETJMP
 #include <setjmp.h>
-extern jmp_buf libatari800_cpu_crash;
+extern THREAD_LOCAL jmp_buf libatari800_cpu_crash;
 #endif /* HAVE_SETJMP */
 
 #include "libatari800/libatari800.h"
 
-extern int libatari800_continue_on_brk;
+extern THREAD_LOCAL int libatari800_continue_on_brk;
+
+/* error code of the machine of the calling thread; libatari800_error_code
+   is a copy of it, updated by the non-context API functions */
+extern THREAD_LOCAL int LIBATARI800_error_code;
 
 #endif /* LIBATARI800_API_H_ */
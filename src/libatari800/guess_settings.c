@@ -1,5 +1,17 @@
+#include "config.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#ifdef HAVE_DIRENT_H
+#include <dirent.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#if defined(HAVE_FORK) && defined(HAVE_SYS_WAIT_H) && defined(HAVE_UNISTD_H)
+#include <sys/wait.h>
+#define PARALLEL
+#endif
 
 #include "libatari800.h"
 
@@ -170,7 +182,22 @@ int check_memo_pad(emulator_state_t *state) {
 
 #define BAD_DLIST_MIN_FRAMES 200
 
-int run_emulator(int num_args, int num_frames, int verbose) {
+/* With -early, a candidate is considered working before num_frames once it
+   has run min_frames and has displayed its own screen (not the OS's graphics
+   0 screen) for the last EARLY_SUCCESS_FRAMES frames. The 5200 has no such
+   OS screen to tell apart, so its candidates always run num_frames. */
+#define EARLY_SUCCESS_FRAMES 100
+int early_success = FALSE;
+
+int uses_own_screen(emulator_state_t *state) {
+	antic_state_t *antic = (antic_state_t *)&state->state[state->tags.antic];
+	UBYTE *memory = (UBYTE *)&state->state[state->tags.base_ram];
+	UWORD ramtop = memory[0x6a] << 8;
+
+	return antic->dlist != ramtop - 0x3e0;
+}
+
+int run_emulator(int num_args, int num_frames, int min_frames, int early, int verbose) {
 	int i;
 
 	if (verbose > 1) {
@@ -184,9 +211,11 @@ int run_emulator(int num_args, int num_frames, int verbose) {
 
 	emulator_state_t state;
 	input_template_t input;
+	libatari800_clear_input_array(&input);
 
 	int frame = 0;
 	int selftest_count = 0;
+	int own_screen_count = 0;
 	while (frame < num_frames) {
 		libatari800_next_frame(&input);
 		libatari800_get_current_state(&state);
@@ -218,6 +247,10 @@ int run_emulator(int num_args, int num_frames, int verbose) {
 			goto exit;
 		}
 		frame++;
+		if (early) {
+			own_screen_count = uses_own_screen(&state) ? own_screen_count + 1 : 0;
+			if (frame >= min_frames && own_screen_count >= EARLY_SUCCESS_FRAMES) goto exit;
+		}
 	}
 exit:
 	return frame;
@@ -243,81 +276,259 @@ cart_types_t *get_first_cart(machine_config_t *machine, int cart_kb) {
 	return cart_desc;
 }
 
-/* Run the emulator using a given set of command line args. If it could be a
-   cartridge, run it multiple times trying the various cart types corresponding
-   to its size.
+/* One emulator run: an image on a machine, possibly as a given cart type */
+typedef struct {
+	char *pathname;
+	int file_index;
+	machine_config_t *machine;
+	cart_types_t *cart_desc;
+	int use_cart_type;
+	int num_frames;
+
+	/* results */
+	int frames; /* > 0 if successful, <= 0 if failed */
+	int error_code;
+} job_t;
+
+job_t *jobs = NULL;
+int num_jobs = 0;
+int jobs_allocated = 0;
+
+job_t *add_job(char *pathname, int file_index, machine_config_t *machine, cart_types_t *cart_desc, int use_cart_type, int num_frames) {
+	job_t *job;
+
+	if (num_jobs == jobs_allocated) {
+		jobs_allocated = jobs_allocated ? jobs_allocated * 2 : 256;
+		jobs = (job_t *)realloc(jobs, jobs_allocated * sizeof(job_t));
+		if (!jobs) {
+			printf("Out of memory\n");
+			exit(1);
+		}
+	}
+	job = &jobs[num_jobs++];
+	job->pathname = pathname;
+	job->file_index = file_index;
+	job->machine = machine;
+	job->cart_desc = cart_desc;
+	job->use_cart_type = use_cart_type;
+	job->num_frames = num_frames;
+	job->frames = 0;
+	job->error_code = 0;
+	return job;
+}
+
+/* Add the runs of the image on a machine. If it could be a cartridge, it is
+   run multiple times trying the various cart types corresponding to its size.
 */
-int run_machine(machine_config_t *machine, char *pathname, int num_frames, int cart_kb, int verbose) {
-	int success;
-	int any_success = 0;
-	char **machine_args;
+void add_machine_jobs(machine_config_t *machine, char *pathname, int file_index, int num_frames, int cart_kb) {
 	cart_types_t *cart_desc = get_first_cart(machine, cart_kb);
-	char cart_type_string[16];
 
 	if (cart_kb < 0 && !cart_desc) {
 		/* have an exact match for a cart type, but not compatible machine */
-		return 0;
+		return;
 	}
 	num_frames = num_frames < machine->min_frames ? machine->min_frames : num_frames;
 	while (1) {
-		/* args array is modified by atari800, so need to recreate it each time */
-		int num_args = 0;
-		while (num_args < (sizeof(default_args) / sizeof(default_args[0]))) {
-			test_args[num_args] = default_args[num_args];
-			// printf("default arg %d: %s\n", num_args, default_args[num_args]);
-			num_args++;
+		add_job(pathname, file_index, machine, cart_desc,
+			cart_desc && ((cart_desc->size == cart_kb) || (cart_kb < 0)), num_frames);
+		if (!cart_desc || (cart_kb < 0)) break;
+		cart_desc++;
+		if (cart_desc->size != cart_kb) cart_desc = NULL;
+	}
+}
+
+void run_job(job_t *job, int verbose) {
+	char **machine_args;
+	char cart_type_string[16];
+
+	/* args array is modified by atari800, so need to recreate it each time */
+	int num_args = 0;
+	while (num_args < (sizeof(default_args) / sizeof(default_args[0]))) {
+		test_args[num_args] = default_args[num_args];
+		num_args++;
+	}
+	machine_args = job->machine->args;
+	while (*machine_args) {
+		test_args[num_args++] = *machine_args++;
+	}
+	if (job->use_cart_type) {
+		test_args[num_args++] = "-cart-type";
+		sprintf(cart_type_string, "%d", job->cart_desc->type);
+		test_args[num_args++] = cart_type_string;
+		test_args[num_args++] = "-cart";
+	}
+	test_args[num_args++] = job->pathname;
+
+	job->frames = run_emulator(num_args, job->num_frames, job->machine->min_frames,
+		early_success && !(job->machine->type & MACHINE_TYPE_5200), verbose);
+	job->error_code = libatari800_error_code;
+}
+
+void print_job(job_t *job, int verbose) {
+	char **machine_args;
+	int success = job->frames;
+
+	if (!verbose) {
+		if (success > 0) {
+			printf("%s: %s (", job->pathname, job->machine->label);
+			machine_args = job->machine->args;
+			while (*machine_args) {
+				printf("%s", *machine_args);
+				machine_args++;
+				if (*machine_args) printf(" ");
+			}
+			if (job->cart_desc) {
+				printf(" -cart-type %d", job->cart_desc->type);
+			}
+			printf(")\n");
 		}
-		machine_args = machine->args;
-		while (*machine_args) {
-			// printf("arg %d: %s\n", num_args, *machine_args);
-			test_args[num_args++] = *machine_args++;
+	}
+	else {
+		printf("%s: %s", job->pathname, job->machine->label);
+		if (success > 0) printf(" status: OK through %d frames", success);
+		else {
+			printf(" status: FAIL");
+			if (job->error_code) {
+				libatari800_error_code = job->error_code;
+				printf(" (%s)", libatari800_error_message());
+			}
 		}
-		if (cart_desc && ((cart_desc->size == cart_kb) || (cart_kb < 0))) {
-			test_args[num_args++] = "-cart-type";
-			sprintf(cart_type_string, "%d", cart_desc->type);
-			test_args[num_args++] = cart_type_string;
-			test_args[num_args++] = "-cart";
+		if (job->cart_desc) {
+			printf(" (cart=%d '%s')", job->cart_desc->type, job->cart_desc->label);
 		}
-		test_args[num_args++] = pathname;
-
-		success = run_emulator(num_args, num_frames, verbose);
-		if (success) any_success++;
-		if (!verbose) {
-			if (success > 0) {
-				printf("%s: %s (", pathname, machine->label);
-				machine_args = machine->args;
-				while (*machine_args) {
-					printf("%s", *machine_args);
-					machine_args++;
-					if (*machine_args) printf(" ");
-				}
-				if (cart_desc) {
-					printf(" -cart-type %d", cart_desc->type);
-				}
-				printf(")\n");
+		printf("\n");
+	}
+}
+
+/* Print the results of finished jobs in order, and the verdict for each
+   image once all of its jobs are printed. */
+int next_to_print = 0;
+int file_success = FALSE;
+
+void print_finished_jobs(char *finished, int verbose) {
+	while (next_to_print < num_jobs && finished[next_to_print]) {
+		job_t *job = &jobs[next_to_print++];
+		print_job(job, verbose);
+		if (job->frames > 0) file_success = TRUE;
+		if (next_to_print == num_jobs || jobs[next_to_print].file_index != job->file_index) {
+			if (!file_success && !verbose) printf("%s: FAIL\n", job->pathname);
+			file_success = FALSE;
+		}
+	}
+	fflush(stdout);
+}
+
+#ifdef PARALLEL
+/* Run each job in a child process, num_workers at a time. The children
+   start from the parent's state, in which the emulator was never
+   initialised, and send back the results through a pipe. */
+void run_jobs_parallel(int num_workers, int verbose) {
+	pid_t *pids = (pid_t *)calloc(num_workers, sizeof(pid_t));
+	int *fds = (int *)calloc(num_workers, sizeof(int));
+	int *worker_job = (int *)calloc(num_workers, sizeof(int));
+	char *finished = (char *)calloc(num_jobs + 1, 1);
+	int next_job = 0;
+	int running = 0;
+	int i;
+
+	if (!pids || !fds || !worker_job || !finished) {
+		printf("Out of memory\n");
+		exit(1);
+	}
+	fflush(stdout);
+	while (next_job < num_jobs || running > 0) {
+		for (i = 0; i < num_workers && next_job < num_jobs; i++) {
+			int fd[2];
+			if (pids[i]) continue;
+			if (pipe(fd) != 0) break;
+			pids[i] = fork();
+			if (pids[i] == 0) {
+				int result[2];
+				close(fd[0]);
+				run_job(&jobs[next_job], verbose);
+				result[0] = jobs[next_job].frames;
+				result[1] = jobs[next_job].error_code;
+				/* _exit does not flush the output of the -vv options */
+				fflush(stdout);
+				if (write(fd[1], result, sizeof(result)) != sizeof(result)) _exit(1);
+				_exit(0);
+			}
+			close(fd[1]);
+			if (pids[i] < 0) {
+				close(fd[0]);
+				pids[i] = 0;
+				break;
 			}
+			fds[i] = fd[0];
+			worker_job[i] = next_job++;
+			running++;
+		}
+		if (running == 0) {
+			/* cannot start any process: run the job here */
+			run_job(&jobs[next_job], verbose);
+			finished[next_job++] = TRUE;
 		}
 		else {
-			printf("%s: %s", pathname, machine->label);
-			if (success > 0) printf(" status: OK through %d frames", success);
-			else {
-				printf(" status: FAIL");
-				if (libatari800_error_code) {
-					printf(" (%s)", libatari800_error_message());
+			pid_t pid = wait(NULL);
+			for (i = 0; i < num_workers; i++) {
+				if (pids[i] && pids[i] == pid) {
+					job_t *job = &jobs[worker_job[i]];
+					int result[2];
+					if (read(fds[i], result, sizeof(result)) == sizeof(result)) {
+						job->frames = result[0];
+						job->error_code = result[1];
+					}
+					else {
+						/* the child died */
+						job->frames = 0;
+						job->error_code = -1;
+					}
+					close(fds[i]);
+					pids[i] = 0;
+					running--;
+					finished[worker_job[i]] = TRUE;
+					break;
 				}
 			}
-			if (cart_desc) {
-				printf(" (cart=%d '%s')", cart_desc->type, cart_desc->label);
-			}
-			printf("\n");
-		}
-		if (!cart_desc || (cart_kb < 0)) break;
-		if (cart_desc) {
-			cart_desc++;
-			if (cart_desc->size != cart_kb) cart_desc = NULL;
 		}
+		print_finished_jobs(finished, verbose);
 	}
-	return any_success;
+	free(pids);
+	free(fds);
+	free(worker_job);
+	free(finished);
+}
+#endif /* PARALLEL */
+
+void run_jobs(int num_workers, int verbose) {
+	char *finished;
+	int i;
+
+#ifdef PARALLEL
+	if (num_workers > 1) {
+		run_jobs_parallel(num_workers, verbose);
+		return;
+	}
+#endif
+	finished = (char *)calloc(num_jobs + 1, 1);
+	if (!finished) {
+		printf("Out of memory\n");
+		exit(1);
+	}
+	for (i = 0; i < num_jobs; i++) {
+		run_job(&jobs[i], verbose);
+		finished[i] = TRUE;
+		print_finished_jobs(finished, verbose);
+	}
+	free(finished);
+}
+
+int default_num_workers(void) {
+#if defined(PARALLEL) && defined(_SC_NPROCESSORS_ONLN)
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	if (n > 1) return (int)n;
+#endif
+	return 1;
 }
 
 #define CHUNK_SIZE 1024
@@ -346,6 +557,7 @@ int guess_cart_kb(char *pathname, int verbose) {
 		}
 		total_len += current_len;
 	} while (current_len == CHUNK_SIZE);
+	fclose(fp);
 	if (total_len == 0) {
 		return INVALID_FILE_SIZE;
 	}
@@ -379,10 +591,75 @@ int guess_cart_kb(char *pathname, int verbose) {
 	return kb;
 }
 
-int main(int argc, char **argv) {
-	input_template_t input;
-	libatari800_clear_input_array(&input);
+int compare_names(const void *a, const void *b) {
+	return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+int num_files = 0;
+
+/* Add the runs of one image on all the selected machines */
+void add_file_jobs(char *pathname, int machine_mask, int num_frames, int verbose) {
+	machine_config_t *machine = machine_config;
+	int cart_kb = guess_cart_kb(pathname, verbose);
+	if (cart_kb == INVALID_FILE_SIZE) return;
+	while (machine->label) {
+		if ((machine->type & machine_mask & MACHINE_TYPE_ALL) && (machine->type & machine_mask & MACHINE_OS_ALL)
+				&& (machine->type & machine_mask & MACHINE_VIDEO_ALL)) {
+			if (verbose > 1) {
+				printf("trying %s\n", machine->label);
+			}
+			add_machine_jobs(machine, pathname, num_files, num_frames, cart_kb);
+		}
+		else if (verbose > 1) {
+			printf("skipping %s\n", machine->label);
+		}
+		machine++;
+	}
+	num_files++;
+}
+
+/* Add the runs of all the images in a directory, in alphabetical order.
+   Returns FALSE if pathname is not a directory. */
+int add_directory_jobs(char *pathname, int machine_mask, int num_frames, int verbose) {
+#ifdef HAVE_OPENDIR
+	DIR *dir = opendir(pathname);
+	struct dirent *entry;
+	char **names = NULL;
+	int num_names = 0;
+	int i;
 
+	if (!dir) return FALSE;
+	while ((entry = readdir(dir)) != NULL) {
+		char *name;
+		if (entry->d_name[0] == '.') continue;
+		name = (char *)malloc(strlen(pathname) + strlen(entry->d_name) + 2);
+		names = (char **)realloc(names, (num_names + 1) * sizeof(char *));
+		if (!name || !names) {
+			printf("Out of memory\n");
+			exit(1);
+		}
+		sprintf(name, "%s/%s", pathname, entry->d_name);
+		names[num_names++] = name;
+	}
+	closedir(dir);
+	qsort(names, num_names, sizeof(char *), compare_names);
+	for (i = 0; i < num_names; i++) {
+		/* subdirectories are skipped; their names stay allocated for the jobs */
+		DIR *subdir = opendir(names[i]);
+		if (subdir) {
+			closedir(subdir);
+			continue;
+		}
+		add_file_jobs(names[i], machine_mask, num_frames, verbose);
+	}
+	free(names);
+	return TRUE;
+#else
+	return FALSE;
+#endif
+}
+
+int main(int argc, char **argv) {
 	/* one time init stuff */
 	int verbose = 1;
 	int machine_flag = MACHINE_TYPE_ALL;
@@ -392,6 +669,7 @@ int main(int argc, char **argv) {
 	int video_flag = MACHINE_VIDEO_ALL;
 	int video_flag_encountered = FALSE;
 	int num_frames = 1000;
+	int num_workers = default_num_workers();
 
 	int i;
 	for (i=1; i<argc; i++) {
@@ -408,6 +686,13 @@ int main(int argc, char **argv) {
 			else if (strcmp(argv[i], "-s") == 0) {
 				verbose = 0;
 			}
+			else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+				num_workers = atoi(argv[++i]);
+				if (num_workers < 1) num_workers = 1;
+			}
+			else if (strcmp(argv[i], "-early") == 0) {
+				early_success = TRUE;
+			}
 			else if (strcmp(argv[i], "-800") == 0) {
 				if (!machine_flag_encountered) machine_flag = 0;
 				machine_flag |= MACHINE_TYPE_800;
@@ -453,24 +738,12 @@ int main(int argc, char **argv) {
 			}
 		}
 		else {
-			int successful_count = 0;
-			machine_config_t *machine = machine_config;
-			int cart_kb = guess_cart_kb(argv[i], verbose);
-			if (cart_kb == INVALID_FILE_SIZE) continue;
-			while (machine->label) {
-				if (machine->type & machine_flag && machine->type & os_flag && machine->type & video_flag) {
-					if (verbose > 1) {
-						printf("trying %s\n", machine->label);
-					}
-					if (run_machine(machine, argv[i], num_frames, cart_kb, verbose)) successful_count++;
-				}
-				else if (verbose > 1) {
-					printf("skipping %s\n", machine->label);
-				}
-				machine++;
-			}
-			if (!successful_count && !verbose) printf("%s: FAIL\n", argv[i]);
+			/* the machine options apply to the images that follow them */
+			int machine_mask = machine_flag | os_flag | video_flag;
+			if (!add_directory_jobs(argv[i], machine_mask, num_frames, verbose))
+				add_file_jobs(argv[i], machine_mask, num_frames, verbose);
 		}
 	}
+	run_jobs(num_workers, verbose);
 	return 0;
 }
@@ -7,7 +7,7 @@
 #define LIBATARI800_FLAG_DELTA_MOUSE 0
 #define LIBATARI800_FLAG_DIRECT_MOUSE 1
 
-extern input_template_t *LIBATARI800_Input_array;
+extern THREAD_LOCAL input_template_t *LIBATARI800_Input_array;
 
 int LIBATARI800_Input_Initialise(int *argc, char *argv[]);
 
@@ -142,6 +142,7 @@ typedef struct {
     UBYTE _align1[3];
     ULONG nframes;
     ULONG sample_residual;
+    ULONG random_counter;
 } statesav_flags_t;
 
 typedef struct {
@@ -272,6 +273,12 @@ const char *libatari800_error_message();
 
 void libatari800_continue_emulation_on_brk(int cont);
 
+void libatari800_set_draw_screen(int draw);
+
+int libatari800_profile_start(const char *filename, int csv);
+
+void libatari800_profile_stop(void);
+
 void libatari800_clear_input_array(input_template_t *input);
 
 int libatari800_next_frame(input_template_t *input);
@@ -288,6 +295,12 @@ UBYTE *libatari800_get_sound_buffer();
 
 int libatari800_get_sound_buffer_len();
 
+int libatari800_render_audio(input_template_t *input, double seconds, UBYTE *buffer, int buffer_size);
+
+int libatari800_start_audio_recording(const char *filename);
+
+int libatari800_stop_audio_recording(void);
+
 int libatari800_get_sound_buffer_allocated_size();
 
 int libatari800_get_sound_frequency();
@@ -304,6 +317,92 @@ void libatari800_get_current_state(emulator_state_t *state);
 
 void libatari800_restore_state(emulator_state_t *state);
 
+/* Extended memory types for libatari800_get_dirty_bank_pages */
+#define LIBATARI800_BANKS_XE 0
+#define LIBATARI800_BANKS_AXLON 1
+#define LIBATARI800_BANKS_MOSAIC 2
+
+void libatari800_get_dirty_pages(UBYTE *bitmap);
+
+int libatari800_get_dirty_bank_pages(int type, UBYTE *bitmap, int size);
+
+void libatari800_clear_dirty_pages(void);
+
+ULONG libatari800_get_state_size(void);
+
+ULONG libatari800_save_state(UBYTE *buffer, ULONG size, statesav_tags_t *tags);
+
+int libatari800_load_state(const UBYTE *buffer, ULONG size);
+
 void libatari800_exit();
 
+typedef struct libatari800_rewind libatari800_rewind_t;
+
+libatari800_rewind_t *libatari800_create_rewind(int capacity, int keyframe_interval);
+
+int libatari800_rewind_push(libatari800_rewind_t *rw);
+
+int libatari800_rewind_restore(libatari800_rewind_t *rw, int steps);
+
+int libatari800_rewind_get_count(libatari800_rewind_t *rw);
+
+ULONG libatari800_rewind_get_size(libatari800_rewind_t *rw);
+
+void libatari800_rewind_clear(libatari800_rewind_t *rw);
+
+void libatari800_free_rewind(libatari800_rewind_t *rw);
+
+typedef struct libatari800_context libatari800_context_t;
+
+libatari800_context_t *libatari800_create_context(void);
+
+int libatari800_init_context(libatari800_context_t *ctx, int argc, char **argv);
+
+int libatari800_next_frame_context(libatari800_context_t *ctx, input_template_t *input);
+
+void libatari800_call_context(libatari800_context_t *ctx, void (*func)(void *arg), void *arg);
+
+int libatari800_get_error_code_context(libatari800_context_t *ctx);
+
+UBYTE *libatari800_get_screen_ptr_context(libatari800_context_t *ctx);
+
+UBYTE *libatari800_get_sound_buffer_context(libatari800_context_t *ctx);
+
+int libatari800_get_sound_buffer_len_context(libatari800_context_t *ctx);
+
+void libatari800_free_context(libatari800_context_t *ctx);
+
+/* Alignment of each instance's data in a batch arena */
+#define LIBATARI800_BATCH_ALIGN 64
+
+/* Results of libatari800_batch_next_frame. The screen and sound data of all
+   instances are copied into one arena; the data of instance i starts at
+   arena + i * stride, with the screen first and the sound samples at
+   sound_offset. All fields are read-only for the caller. */
+typedef struct {
+    int count;
+    UBYTE *arena;
+    ULONG arena_size;
+    ULONG stride;
+    ULONG screen_size;
+    ULONG sound_offset;
+    int *sound_len;
+    int *status;
+
+    /* private */
+    void *arena_alloc;
+    void *frames;
+    int capacity;
+} libatari800_batch_t;
+
+libatari800_batch_t *libatari800_create_batch(void);
+
+int libatari800_batch_next_frame(libatari800_batch_t *batch, libatari800_context_t **ctx, input_template_t *input, int count);
+
+UBYTE *libatari800_batch_get_screen_ptr(libatari800_batch_t *batch, int i);
+
+UBYTE *libatari800_batch_get_sound_buffer(libatari800_batch_t *batch, int i);
+
+void libatari800_free_batch(libatari800_batch_t *batch);
+
 #endif /* LIBATARI800_H_ */
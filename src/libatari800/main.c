@@ -37,6 +37,7 @@
 #include "cpu.h"
 #include "platform.h"
 #include "memory.h"
+#include "profile.h"
 #include "screen.h"
 #include "../sound.h"
 #include "util.h"
@@ -45,6 +46,7 @@
 #include "cartridge.h"
 #include "ui.h"
 #include "cfg.h"
+#include "libatari800/cpu_crash.h"
 #include "libatari800/main.h"
 #include "libatari800/init.h"
 #include "libatari800/input.h"
@@ -104,6 +106,10 @@ int PLATFORM_Initialise(int *argc, char *argv[])
 
 void LIBATARI800_Frame(void)
 {
+#ifdef PROFILER
+	Profile_Frame();
+#endif
+
 	switch (INPUT_key_code) {
 	case AKEY_COLDSTART:
 		Atari800_Coldstart();
@@ -125,15 +131,20 @@ void LIBATARI800_Frame(void)
 	VOTRAXSND_Frame(); /* for the Votrax */
 #endif
 	Devices_Frame();
+	SIO_Frame();
 	INPUT_Frame();
 	GTIA_Frame();
 	ANTIC_Frame(TRUE);
-	INPUT_DrawMousePointer();
-	Screen_DrawAtariSpeed(Util_time());
-	Screen_DrawDiskLED();
-	Screen_Draw1200LED();
+	if (!ANTIC_no_pixels) {
+		INPUT_DrawMousePointer();
+		Screen_DrawAtariSpeed(Util_time());
+		Screen_DrawDiskLED();
+		Screen_Draw1200LED();
+	}
+	PROFILE_SWITCH(PROFILE_POKEY);
 	POKEY_Frame();
 	Sound_Update();
+	PROFILE_SWITCH(PROFILE_OTHER);
 	Atari800_nframes++;
 }
 
@@ -141,7 +152,7 @@ void LIBATARI800_Frame(void)
 /* Stub routines to replace text-based UI */
 
 int UI_SelectCartType(int k) {
-	libatari800_error_code = LIBATARI800_UNIDENTIFIED_CART_TYPE;
+	LIBATARI800_error_code = LIBATARI800_UNIDENTIFIED_CART_TYPE;
 	return CARTRIDGE_NONE;
 }
 
@@ -153,11 +164,11 @@ void UI_Run(void) {
 	;
 }
 
-int UI_is_active;
-int UI_alt_function;
-int UI_current_function;
-char UI_atari_files_dir[UI_MAX_DIRECTORIES][FILENAME_MAX];
-char UI_saved_files_dir[UI_MAX_DIRECTORIES][FILENAME_MAX];
-int UI_n_atari_files_dir;
-int UI_n_saved_files_dir;
-int UI_show_hidden_files = FALSE;
+THREAD_LOCAL int UI_is_active;
+THREAD_LOCAL int UI_alt_function;
+THREAD_LOCAL int UI_current_function;
+THREAD_LOCAL char UI_atari_files_dir[UI_MAX_DIRECTORIES][FILENAME_MAX];
+THREAD_LOCAL char UI_saved_files_dir[UI_MAX_DIRECTORIES][FILENAME_MAX];
+THREAD_LOCAL int UI_n_atari_files_dir;
+THREAD_LOCAL int UI_n_saved_files_dir;
+THREAD_LOCAL int UI_show_hidden_files = FALSE;
@@ -0,0 +1,380 @@
+/*
+ * libatari800/rewind.c - Atari800 as a library - rewind buffer
+ *
+ * Copyright (C) 2021 Atari800 development team (see DOC/CREDITS)
+ *
+ * This file is part of the Atari800 emulator project which emulates
+ * the Atari 400, 800, 800XL, 130XE, and 5200 8-bit computers.
+ *
+ * Atari800 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Atari800 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Atari800; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+/* The rewind buffer is a ring of machine states. A state is an image made
+   of the emulator state without the memory blocks of the machine (saved with
+   LIBATARI800_StateSav_rewind set), padded to whole pages, followed by the
+   pages of the blocks returned by MEMORY_GetBlock(). Every
+   keyframe_interval entries the whole image is kept; the entries in between
+   only hold the pages that changed since the entry before them: the pages
+   of the emulator state that differ, and the pages of memory that the dirty
+   maps report as changed. Restoring an entry replays the deltas on top of
+   the keyframe it follows, loads the emulator state and copies the memory
+   blocks back into the machine.
+
+   The newest image is always kept in rw->current, so restoring it doesn't
+   replay anything. */
+
+#include "config.h"
+#include <stdlib.h>
+#include <string.h>
+
+#include "atari.h"
+#include "memory.h"
+#include "util.h"
+#include "libatari800/rewind.h"
+#include "libatari800/statesav.h"
+
+#define PAGE_SIZE 256
+
+/* Sizes of the parts of an image */
+typedef struct {
+	ULONG state_size;
+	int block_pages[MEMORY_BLOCKS];
+} rewind_layout_t;
+
+typedef struct {
+	int keyframe;
+	LIBATARI800_extra_state_t extra;
+	rewind_layout_t layout;
+	/* keyframe: the whole image; delta: num_pages page numbers followed by
+	   the contents of those pages */
+	UBYTE *data;
+	ULONG data_size;
+	ULONG num_pages;
+} rewind_entry_t;
+
+struct libatari800_rewind {
+	rewind_entry_t *entries;
+	int capacity;
+	int keyframe_interval;
+	int first;
+	int count;
+	int since_keyframe;
+	ULONG bytes;
+
+	UBYTE *current;
+	rewind_layout_t layout;
+	ULONG current_alloc;
+	/* emulator state being pushed */
+	UBYTE *state;
+	ULONG state_alloc;
+	/* numbers of the pages changed by a delta */
+	ULONG *pages;
+	ULONG pages_alloc;
+};
+
+static ULONG StatePages(rewind_layout_t const *layout)
+{
+	return (layout->state_size + PAGE_SIZE - 1) / PAGE_SIZE;
+}
+
+static ULONG ImagePages(rewind_layout_t const *layout)
+{
+	ULONG num_pages = StatePages(layout);
+	int block;
+
+	for (block = 0; block < MEMORY_BLOCKS; block++)
+		num_pages += layout->block_pages[block];
+	return num_pages;
+}
+
+static int SameLayout(rewind_layout_t const *a, rewind_layout_t const *b)
+{
+	int block;
+
+	if (a->state_size != b->state_size)
+		return FALSE;
+	for (block = 0; block < MEMORY_BLOCKS; block++)
+		if (a->block_pages[block] != b->block_pages[block])
+			return FALSE;
+	return TRUE;
+}
+
+/* Make rw->current large enough for an image of LAYOUT */
+static void ReserveImage(libatari800_rewind_t *rw, rewind_layout_t const *layout)
+{
+	ULONG num_pages = ImagePages(layout);
+
+	if (num_pages * PAGE_SIZE > rw->current_alloc) {
+		rw->current = (UBYTE *) Util_realloc(rw->current, num_pages * PAGE_SIZE);
+		rw->current_alloc = num_pages * PAGE_SIZE;
+	}
+	if (num_pages > rw->pages_alloc) {
+		rw->pages = (ULONG *) Util_realloc(rw->pages, num_pages * sizeof(ULONG));
+		rw->pages_alloc = num_pages;
+	}
+}
+
+static rewind_entry_t *Entry(libatari800_rewind_t *rw, int i)
+{
+	return &rw->entries[(rw->first + i) % rw->capacity];
+}
+
+static void FreeEntry(libatari800_rewind_t *rw, rewind_entry_t *e)
+{
+	rw->bytes -= e->data_size;
+	free(e->data);
+	e->data = NULL;
+	e->data_size = 0;
+}
+
+libatari800_rewind_t *LIBATARI800_Rewind_New(int capacity, int keyframe_interval)
+{
+	libatari800_rewind_t *rw = (libatari800_rewind_t *) Util_malloc(sizeof(libatari800_rewind_t));
+
+	memset(rw, 0, sizeof(libatari800_rewind_t));
+	if (capacity < 1)
+		capacity = 1;
+	if (keyframe_interval < 1)
+		keyframe_interval = 1;
+	rw->entries = (rewind_entry_t *) Util_malloc(capacity * sizeof(rewind_entry_t));
+	memset(rw->entries, 0, capacity * sizeof(rewind_entry_t));
+	rw->capacity = capacity;
+	rw->keyframe_interval = keyframe_interval;
+	return rw;
+}
+
+void LIBATARI800_Rewind_Clear(libatari800_rewind_t *rw)
+{
+	int i;
+
+	for (i = 0; i < rw->count; i++)
+		FreeEntry(rw, Entry(rw, i));
+	rw->first = 0;
+	rw->count = 0;
+	rw->since_keyframe = 0;
+}
+
+void LIBATARI800_Rewind_Free(libatari800_rewind_t *rw)
+{
+	LIBATARI800_Rewind_Clear(rw);
+	free(rw->entries);
+	free(rw->current);
+	free(rw->state);
+	free(rw->pages);
+	free(rw);
+}
+
+/* Drop the oldest keyframe together with the deltas that depend on it */
+static void DropOldest(libatari800_rewind_t *rw)
+{
+	do {
+		FreeEntry(rw, Entry(rw, 0));
+		rw->first = (rw->first + 1) % rw->capacity;
+		rw->count--;
+	} while (rw->count > 0 && !Entry(rw, 0)->keyframe);
+}
+
+/* Store the whole image of the new state */
+static void MakeKeyframe(libatari800_rewind_t *rw, rewind_entry_t *e)
+{
+	ULONG size = ImagePages(&e->layout) * PAGE_SIZE;
+	ULONG off = StatePages(&e->layout) * PAGE_SIZE;
+	int block;
+
+	rw->layout = e->layout;
+	ReserveImage(rw, &rw->layout);
+	memcpy(rw->current, rw->state, rw->layout.state_size);
+	memset(rw->current + rw->layout.state_size, 0, off - rw->layout.state_size);
+	for (block = 0; block < MEMORY_BLOCKS; block++) {
+		int num_pages;
+		UBYTE const *data = MEMORY_GetBlock(block, &num_pages);
+		if (num_pages > 0)
+			memcpy(rw->current + off, data, num_pages * PAGE_SIZE);
+		off += num_pages * PAGE_SIZE;
+	}
+
+	e->keyframe = TRUE;
+	e->data = (UBYTE *) Util_malloc(size);
+	memcpy(e->data, rw->current, size);
+	e->data_size = size;
+	e->num_pages = 0;
+}
+
+/* Store the pages of the emulator state that differ from rw->current and
+   the pages of memory written since the last entry */
+static void MakeDelta(libatari800_rewind_t *rw, rewind_entry_t *e)
+{
+	ULONG state_pages = StatePages(&rw->layout);
+	ULONG page = 0;
+	ULONG changed = 0;
+	ULONG i;
+	int block;
+	UBYTE *p;
+
+	for (; page < state_pages; page++) {
+		ULONG off = page * PAGE_SIZE;
+		ULONG len = rw->layout.state_size - off < PAGE_SIZE ? rw->layout.state_size - off : PAGE_SIZE;
+		if (memcmp(rw->current + off, rw->state + off, len) != 0) {
+			memcpy(rw->current + off, rw->state + off, len);
+			rw->pages[changed++] = page;
+		}
+	}
+	for (block = 0; block < MEMORY_BLOCKS; block++) {
+		int num_pages;
+		int n;
+		UBYTE const *dirty = MEMORY_GetDirty(MEMORY_DIRTY_REWIND, block, &num_pages);
+		UBYTE const *data = MEMORY_GetBlock(block, &num_pages);
+		for (n = 0; n < num_pages; n++, page++) {
+			if (dirty[n]) {
+				memcpy(rw->current + page * PAGE_SIZE, data + n * PAGE_SIZE, PAGE_SIZE);
+				rw->pages[changed++] = page;
+			}
+		}
+	}
+
+	e->keyframe = FALSE;
+	e->num_pages = changed;
+	e->data_size = changed * (sizeof(ULONG) + PAGE_SIZE);
+	e->data = (UBYTE *) Util_malloc(e->data_size > 0 ? e->data_size : 1);
+	memcpy(e->data, rw->pages, changed * sizeof(ULONG));
+	p = e->data + changed * sizeof(ULONG);
+	for (i = 0; i < changed; i++) {
+		memcpy(p, rw->current + rw->pages[i] * PAGE_SIZE, PAGE_SIZE);
+		p += PAGE_SIZE;
+	}
+}
+
+static void ApplyDelta(UBYTE *image, rewind_entry_t const *e)
+{
+	ULONG const *pages = (ULONG const *) e->data;
+	UBYTE const *p = e->data + e->num_pages * sizeof(ULONG);
+	ULONG i;
+
+	for (i = 0; i < e->num_pages; i++) {
+		memcpy(image + pages[i] * PAGE_SIZE, p, PAGE_SIZE);
+		p += PAGE_SIZE;
+	}
+}
+
+/* Add the state of the loaded machine as the newest entry */
+int LIBATARI800_Rewind_Push(libatari800_rewind_t *rw)
+{
+	statesav_tags_t tags;
+	rewind_layout_t layout;
+	rewind_entry_t *e;
+	int block;
+	int status;
+
+	LIBATARI800_StateSav_rewind = TRUE;
+	layout.state_size = LIBATARI800_StateSize(FALSE);
+	if (layout.state_size > rw->state_alloc) {
+		rw->state = (UBYTE *) Util_realloc(rw->state, layout.state_size);
+		rw->state_alloc = layout.state_size;
+	}
+	status = LIBATARI800_StateSaveBuffer(rw->state, layout.state_size, &tags, FALSE);
+	LIBATARI800_StateSav_rewind = FALSE;
+	if (!status)
+		return FALSE;
+	for (block = 0; block < MEMORY_BLOCKS; block++)
+		MEMORY_GetBlock(block, &layout.block_pages[block]);
+
+	if (rw->count == rw->capacity)
+		DropOldest(rw);
+	e = Entry(rw, rw->count);
+	LIBATARI800_SaveExtraState(&e->extra);
+	e->layout = layout;
+	if (rw->count == 0 || !SameLayout(&layout, &rw->layout) || rw->since_keyframe + 1 >= rw->keyframe_interval) {
+		MakeKeyframe(rw, e);
+		rw->since_keyframe = 0;
+	}
+	else {
+		MakeDelta(rw, e);
+		rw->since_keyframe++;
+	}
+	MEMORY_ClearDirty(MEMORY_DIRTY_REWIND);
+	rw->bytes += e->data_size;
+	rw->count++;
+	return TRUE;
+}
+
+/* Load the state that was pushed steps entries before the newest one and
+   discard all entries newer than it, so that emulation continues from
+   there. steps = 0 returns to the newest entry. */
+int LIBATARI800_Rewind_Restore(libatari800_rewind_t *rw, int steps)
+{
+	int target;
+	int key;
+	int i;
+	int block;
+	int status;
+	ULONG off;
+
+	if (steps < 0 || steps >= rw->count)
+		return FALSE;
+	target = rw->count - 1 - steps;
+
+	if (steps > 0) {
+		for (key = target; !Entry(rw, key)->keyframe; key--)
+			;
+		rw->layout = Entry(rw, target)->layout;
+		ReserveImage(rw, &rw->layout);
+		memcpy(rw->current, Entry(rw, key)->data, Entry(rw, key)->data_size);
+		for (i = key + 1; i <= target; i++)
+			ApplyDelta(rw->current, Entry(rw, i));
+		rw->since_keyframe = target - key;
+
+		for (i = target + 1; i < rw->count; i++)
+			FreeEntry(rw, Entry(rw, i));
+		rw->count = target + 1;
+	}
+
+	/* The media still inserted are kept, and the memory blocks are copied
+	   back below */
+	LIBATARI800_StateSav_rewind = TRUE;
+	status = LIBATARI800_StateLoadBuffer(rw->current, rw->layout.state_size);
+	LIBATARI800_StateSav_rewind = FALSE;
+	if (!status)
+		return FALSE;
+	off = StatePages(&rw->layout) * PAGE_SIZE;
+	for (block = 0; block < MEMORY_BLOCKS; block++) {
+		int num_pages;
+		UBYTE *data = MEMORY_GetBlock(block, &num_pages);
+		/* loading the state has sized the blocks as they were */
+		if (num_pages != rw->layout.block_pages[block])
+			return FALSE;
+		if (num_pages > 0)
+			memcpy(data, rw->current + off, num_pages * PAGE_SIZE);
+		off += num_pages * PAGE_SIZE;
+	}
+	LIBATARI800_RestoreExtraState(&Entry(rw, target)->extra);
+	MEMORY_ClearDirty(MEMORY_DIRTY_REWIND);
+	return TRUE;
+}
+
+int LIBATARI800_Rewind_Count(libatari800_rewind_t *rw)
+{
+	return rw->count;
+}
+
+/* Memory used by the stored entries, in bytes */
+ULONG LIBATARI800_Rewind_Bytes(libatari800_rewind_t *rw)
+{
+	return rw->bytes;
+}
+
+/*
+vim:ts=4:sw=4:
+*/
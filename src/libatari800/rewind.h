@@ -0,0 +1,16 @@
+#ifndef LIBATARI800_REWIND_H_
+#define LIBATARI800_REWIND_H_
+
+#include "config.h"
+#include "atari.h"
+#include "libatari800/libatari800.h"
+
+libatari800_rewind_t *LIBATARI800_Rewind_New(int capacity, int keyframe_interval);
+void LIBATARI800_Rewind_Free(libatari800_rewind_t *rw);
+void LIBATARI800_Rewind_Clear(libatari800_rewind_t *rw);
+int LIBATARI800_Rewind_Push(libatari800_rewind_t *rw);
+int LIBATARI800_Rewind_Restore(libatari800_rewind_t *rw, int steps);
+int LIBATARI800_Rewind_Count(libatari800_rewind_t *rw);
+ULONG LIBATARI800_Rewind_Bytes(libatari800_rewind_t *rw);
+
+#endif /* LIBATARI800_REWIND_H_ */
@@ -35,18 +35,18 @@
 #include "sound.h"
 #include "util.h"
 
-UBYTE *LIBATARI800_Sound_array;
+THREAD_LOCAL UBYTE *LIBATARI800_Sound_array;
 
-unsigned int sound_array_fill = 0;
+THREAD_LOCAL unsigned int sound_array_fill = 0;
 
-unsigned int sound_hw_buffer_size = 0;
+THREAD_LOCAL unsigned int sound_hw_buffer_size = 0;
 
 /* difference between an integer sample rate and the floating point sample rate, used
    keep track of which frames need to drop a sample to stay at the constant audio
    sampling rate */
-static double sample_diff;
+static THREAD_LOCAL double sample_diff;
 
-double sample_residual;
+THREAD_LOCAL double sample_residual;
 
 int PLATFORM_SoundSetup(Sound_setup_t *setup)
 {
@@ -61,6 +61,7 @@ int PLATFORM_SoundSetup(Sound_setup_t *setup)
 	if (sound_hw_buffer_size == 0)
 	        return FALSE;
 
+	free(LIBATARI800_Sound_array);
 	LIBATARI800_Sound_array = Util_malloc(sound_hw_buffer_size);
 
 	sample_diff = (double)setup->buffer_frames - samples_per_video_frame;
@@ -72,6 +73,7 @@ int PLATFORM_SoundSetup(Sound_setup_t *setup)
 void PLATFORM_SoundExit(void)
 {
 	free(LIBATARI800_Sound_array);
+	LIBATARI800_Sound_array = NULL;
 }
 
 void PLATFORM_SoundPause(void)
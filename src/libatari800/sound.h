@@ -3,13 +3,15 @@
 
 #include <stdio.h>
 
+#include "atari.h"
 
-extern UBYTE *LIBATARI800_Sound_array;
 
-extern unsigned int sound_array_fill;
+extern THREAD_LOCAL UBYTE *LIBATARI800_Sound_array;
 
-extern unsigned int sound_hw_buffer_size;
+extern THREAD_LOCAL unsigned int sound_array_fill;
 
-extern double sample_residual;
+extern THREAD_LOCAL unsigned int sound_hw_buffer_size;
+
+extern THREAD_LOCAL double sample_residual;
 
 #endif /* LIBATARI800_SOUND_H_ */
@@ -26,21 +26,77 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "atari.h"
+#include "memory.h"
 #include "platform.h"
+#include "pokey.h"
 #include "libatari800/statesav.h"
 #include "libatari800/init.h"
+#include "libatari800/sound.h"
 
-UBYTE *LIBATARI800_StateSav_buffer = NULL;
-statesav_tags_t *LIBATARI800_StateSav_tags = NULL;
+THREAD_LOCAL UBYTE *LIBATARI800_StateSav_buffer = NULL;
+THREAD_LOCAL ULONG LIBATARI800_StateSav_buffer_size = 0;
+THREAD_LOCAL statesav_tags_t *LIBATARI800_StateSav_tags = NULL;
+THREAD_LOCAL int LIBATARI800_StateSav_rewind = FALSE;
 
 
-void LIBATARI800_StateSave(UBYTE *buffer, statesav_tags_t *tags) {
-    LIBATARI800_StateSav_buffer = buffer;
-    LIBATARI800_StateSav_tags = tags;
-	StateSav_SaveAtariState(NULL, NULL, 0);
+int LIBATARI800_StateSave(UBYTE *buffer, statesav_tags_t *tags) {
+	return LIBATARI800_StateSaveBuffer(buffer, STATESAV_MAX_SIZE, tags, FALSE);
 }
 
 void LIBATARI800_StateLoad(UBYTE *buffer) {
-    LIBATARI800_StateSav_buffer = buffer;
-	StateSav_ReadAtariState(NULL, NULL);
+	LIBATARI800_StateLoadBuffer(buffer, STATESAV_MAX_SIZE);
+}
+
+/* Save into a buffer of the given size. If verbose is set, the OS and BASIC
+   ROM images are included so the state is complete even if another machine
+   has been running in the meantime. */
+int LIBATARI800_StateSaveBuffer(UBYTE *buffer, ULONG size, statesav_tags_t *tags, int verbose) {
+	int status;
+
+	LIBATARI800_StateSav_buffer = buffer;
+	LIBATARI800_StateSav_buffer_size = size;
+	LIBATARI800_StateSav_tags = tags;
+	status = StateSav_SaveAtariState(NULL, "wb", (UBYTE)verbose);
+	LIBATARI800_StateSav_buffer = NULL;
+	return status;
+}
+
+int LIBATARI800_StateLoadBuffer(const UBYTE *buffer, ULONG size) {
+	int status;
+
+	/* the buffer is only read from when loading */
+	LIBATARI800_StateSav_buffer = (UBYTE *)buffer;
+	LIBATARI800_StateSav_buffer_size = size;
+	status = StateSav_ReadAtariState(NULL, "rb");
+	LIBATARI800_StateSav_buffer = NULL;
+	return status;
+}
+
+/* Number of bytes StateSav_SaveAtariState would produce for the current
+   machine configuration, computed by a save pass that doesn't copy data. */
+ULONG LIBATARI800_StateSize(int verbose) {
+	statesav_tags_t tags;
+
+	LIBATARI800_StateSaveBuffer(NULL, 0, &tags, verbose);
+	return tags.size;
+}
+
+void LIBATARI800_SaveExtraState(LIBATARI800_extra_state_t *extra) {
+	memset(extra, 0, sizeof(LIBATARI800_extra_state_t));
+	extra->flags.selftest_enabled = MEMORY_selftest_enabled;
+	extra->flags.nframes = (ULONG)Atari800_nframes;
+	extra->flags.sample_residual = (ULONG)(0xffffffff * sample_residual);
+	extra->flags.random_counter = POKEY_GetRandomCounter();
+	INPUT_SaveFrameState(&extra->input);
+	extra->pot_scanline = POKEY_GetPotScanline();
+}
+
+void LIBATARI800_RestoreExtraState(LIBATARI800_extra_state_t const *extra) {
+	MEMORY_selftest_enabled = extra->flags.selftest_enabled;
+	Atari800_nframes = extra->flags.nframes;
+	sample_residual = (double)extra->flags.sample_residual / (double)0xffffffff;
+	POKEY_SetRandomCounter(extra->flags.random_counter);
+	INPUT_RestoreFrameState(&extra->input);
+	POKEY_SetPotScanline(extra->pot_scanline);
 }
@@ -7,12 +7,28 @@
 #include "config.h"
 #include "atari.h"
 #include "../statesav.h"
+#include "../input.h"
 #include "libatari800/libatari800.h"
 
-extern UBYTE *LIBATARI800_StateSav_buffer;
-extern statesav_tags_t *LIBATARI800_StateSav_tags;
+/* Emulator variables that aren't part of the state save but affect the
+   following frames */
+typedef struct {
+	statesav_flags_t flags;
+	INPUT_frame_state_t input;
+	int pot_scanline;
+} LIBATARI800_extra_state_t;
 
-void LIBATARI800_StateSave(UBYTE *buffer, statesav_tags_t *tags);
+extern THREAD_LOCAL UBYTE *LIBATARI800_StateSav_buffer;
+extern THREAD_LOCAL ULONG LIBATARI800_StateSav_buffer_size;
+extern THREAD_LOCAL statesav_tags_t *LIBATARI800_StateSav_tags;
+extern THREAD_LOCAL int LIBATARI800_StateSav_rewind;
+
+int LIBATARI800_StateSave(UBYTE *buffer, statesav_tags_t *tags);
 void LIBATARI800_StateLoad(UBYTE *buffer);
+int LIBATARI800_StateSaveBuffer(UBYTE *buffer, ULONG size, statesav_tags_t *tags, int verbose);
+int LIBATARI800_StateLoadBuffer(const UBYTE *buffer, ULONG size);
+ULONG LIBATARI800_StateSize(int verbose);
+void LIBATARI800_SaveExtraState(LIBATARI800_extra_state_t *extra);
+void LIBATARI800_RestoreExtraState(LIBATARI800_extra_state_t const *extra);
 
 #endif /* LIBATARI800_STATESAV_H_ */
@@ -1,8 +1,10 @@
 #ifndef LOG_H_
 #define LOG_H_
 
+#include "atari.h"
+
 #define Log_BUFFER_SIZE 8192
-extern char Log_buffer[Log_BUFFER_SIZE];
+extern THREAD_LOCAL char Log_buffer[Log_BUFFER_SIZE];
 
 void Log_print(const char *format, ...);
 void Log_flushlog(void);
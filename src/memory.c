@@ -44,18 +44,18 @@
 #include "statesav.h"
 #endif
 
-UBYTE MEMORY_mem[65536 + 2];
+THREAD_LOCAL UBYTE MEMORY_mem[65536 + 2];
 
-int MEMORY_ram_size = 64;
+THREAD_LOCAL int MEMORY_ram_size = 64;
 
 #ifndef PAGED_ATTRIB
 
-UBYTE MEMORY_attrib[65536];
+THREAD_LOCAL UBYTE MEMORY_attrib[65536];
 
 #else /* PAGED_ATTRIB */
 
-MEMORY_rdfunc MEMORY_readmap[256];
-MEMORY_wrfunc MEMORY_writemap[256];
+THREAD_LOCAL MEMORY_rdfunc MEMORY_readmap[256];
+THREAD_LOCAL MEMORY_wrfunc MEMORY_writemap[256];
 
 typedef struct map_save {
 	int     code;
@@ -74,48 +74,311 @@ map_save save_map[2] = {
 
 #endif /* PAGED_ATTRIB */
 
-UBYTE MEMORY_basic[8192];
-UBYTE MEMORY_os[16384];
-UBYTE MEMORY_xegame[8192];
+THREAD_LOCAL UBYTE MEMORY_basic[8192];
+THREAD_LOCAL UBYTE MEMORY_os[16384];
+THREAD_LOCAL UBYTE MEMORY_xegame[8192];
 
-int MEMORY_xe_bank = 0;
-int MEMORY_selftest_enabled = 0;
+THREAD_LOCAL int MEMORY_xe_bank = 0;
+THREAD_LOCAL int MEMORY_selftest_enabled = 0;
 
-static UBYTE under_atarixl_os[16384];
-static UBYTE under_cart809F[8192];
-static UBYTE under_cartA0BF[8192];
+static THREAD_LOCAL UBYTE under_atarixl_os[16384];
+static THREAD_LOCAL UBYTE under_cart809F[8192];
+static THREAD_LOCAL UBYTE under_cartA0BF[8192];
 
-static int cart809F_enabled = FALSE;
-int MEMORY_cartA0BF_enabled = FALSE;
+static THREAD_LOCAL int cart809F_enabled = FALSE;
+THREAD_LOCAL int MEMORY_cartA0BF_enabled = FALSE;
 
-static UBYTE *atarixe_memory = NULL;
-static ULONG atarixe_memory_size = 0;
+static THREAD_LOCAL UBYTE *atarixe_memory = NULL;
+static THREAD_LOCAL ULONG atarixe_memory_size = 0;
 
 /* RAM shadowed by Self-Test in the XE bank seen by ANTIC, when ANTIC/CPU
    separate XE access is active. */
-static UBYTE antic_bank_under_selftest[0x800];
+static THREAD_LOCAL UBYTE antic_bank_under_selftest[0x800];
 
-int MEMORY_have_basic = FALSE; /* Atari BASIC image has been successfully read (Atari 800 only) */
+THREAD_LOCAL int MEMORY_have_basic = FALSE; /* Atari BASIC image has been successfully read (Atari 800 only) */
 
 /* Axlon and Mosaic RAM expansions for Atari 400/800 only */
 static void MosaicPutByte(UWORD addr, UBYTE byte);
 static UBYTE MosaicGetByte(UWORD addr, int no_side_effects);
 static void AxlonPutByte(UWORD addr, UBYTE byte);
 static UBYTE AxlonGetByte(UWORD addr, int no_side_effects);
-static UBYTE *axlon_ram = NULL;
-static int axlon_current_bankmask = 0;
-int axlon_curbank = 0;
-int MEMORY_axlon_num_banks = 0x00;
-int MEMORY_axlon_0f_mirror = FALSE; /* The real Axlon had a mirror bank register at 0x0fc0-0x0fff, compatibles did not*/
-static UBYTE *mosaic_ram = NULL;
-static int mosaic_current_num_banks = 0;
-static int mosaic_curbank = 0x3f;
-int MEMORY_mosaic_num_banks = 0;
-
-int MEMORY_enable_mapram = FALSE;
+static THREAD_LOCAL UBYTE *axlon_ram = NULL;
+static THREAD_LOCAL int axlon_current_bankmask = 0;
+THREAD_LOCAL int axlon_curbank = 0;
+THREAD_LOCAL int MEMORY_axlon_num_banks = 0x00;
+THREAD_LOCAL int MEMORY_axlon_0f_mirror = FALSE; /* The real Axlon had a mirror bank register at 0x0fc0-0x0fff, compatibles did not*/
+static THREAD_LOCAL UBYTE *mosaic_ram = NULL;
+static THREAD_LOCAL int mosaic_current_num_banks = 0;
+static THREAD_LOCAL int mosaic_curbank = 0x3f;
+THREAD_LOCAL int MEMORY_mosaic_num_banks = 0;
+
+THREAD_LOCAL int MEMORY_enable_mapram = FALSE;
 
 /* Buffer for storing of MapRAM memory. */
-static UBYTE *mapram_memory = NULL;
+static THREAD_LOCAL UBYTE *mapram_memory = NULL;
+
+#ifdef MEMORY_TRACK_WRITES
+THREAD_LOCAL UBYTE MEMORY_dirty[256];
+
+/* Dirty pages of the extended memory, one entry per page of atarixe_memory,
+   axlon_ram and mosaic_ram. Writes to the bank currently mapped into the
+   CPU address space are only recorded in MEMORY_dirty, and are moved here
+   when the bank is switched out or the maps are read. */
+static THREAD_LOCAL UBYTE *xe_dirty = NULL;
+static THREAD_LOCAL UBYTE *axlon_dirty = NULL;
+static THREAD_LOCAL UBYTE *mosaic_dirty = NULL;
+
+/* Dirty pages of the other memory blocks */
+#ifndef PAGED_ATTRIB
+static THREAD_LOCAL UBYTE attrib_dirty[256];
+#else
+/* The maps are assigned to all over the emulator, so their pages are
+   always reported as changed. */
+static THREAD_LOCAL UBYTE readmap_dirty[sizeof(MEMORY_readmap) >> 8];
+static THREAD_LOCAL UBYTE writemap_dirty[sizeof(MEMORY_writemap) >> 8];
+#endif
+static THREAD_LOCAL UBYTE under_os_dirty[sizeof(under_atarixl_os) >> 8];
+static THREAD_LOCAL UBYTE under_cart_dirty[sizeof(under_cartA0BF) >> 8];
+static THREAD_LOCAL UBYTE under_selftest_dirty[sizeof(antic_bank_under_selftest) >> 8];
+static THREAD_LOCAL UBYTE mapram_dirty[0x800 >> 8];
+
+/* The maps above collect changes until MEMORY_GetDirty() or
+   MEMORY_ClearDirty() move them into the maps of every user */
+static THREAD_LOCAL UBYTE *user_dirty[MEMORY_DIRTY_USERS][MEMORY_BLOCKS];
+static THREAD_LOCAL int user_num_pages[MEMORY_DIRTY_USERS][MEMORY_BLOCKS];
+
+void MEMORY_MarkDirtyRange(int addr, int size)
+{
+	int page;
+	for (page = addr >> 8; page <= (addr + size - 1) >> 8; page++)
+		MEMORY_dirty[page] = MEMORY_DIRTY | MEMORY_DIRTY_WINDOW;
+}
+
+#ifndef PAGED_ATTRIB
+void MEMORY_SetAttrib(int addr1, int addr2, UBYTE attrib)
+{
+	int addr = addr1;
+	while (addr <= addr2) {
+		/* end of the page or of the range */
+		int end = (addr | 0xff) < addr2 ? addr | 0xff : addr2;
+		int i;
+		for (i = addr; i <= end && MEMORY_attrib[i] == attrib; i++);
+		if (i <= end) {
+			memset(MEMORY_attrib + i, attrib, end - i + 1);
+			attrib_dirty[addr >> 8] = 1;
+		}
+		addr = end + 1;
+	}
+}
+#endif /* PAGED_ATTRIB */
+
+/* Resizes the dirty map of an extended memory of SIZE bytes. */
+static void AllocBankDirty(UBYTE **bank_dirty, int size)
+{
+	if (size > 0) {
+		*bank_dirty = (UBYTE *) Util_realloc(*bank_dirty, size >> 8);
+		memset(*bank_dirty, 1, size >> 8);
+	}
+	else if (*bank_dirty != NULL) {
+		free(*bank_dirty);
+		*bank_dirty = NULL;
+	}
+}
+
+/* Copies SIZE bytes from SRC to OFFSET in BLOCK, and marks the pages that
+   change in the dirty map BLOCK_DIRTY. */
+static void CopyToBlock(UBYTE *block, UBYTE *block_dirty, int offset, const UBYTE *src, int size)
+{
+	int i;
+	for (i = 0; i < size; i += 256) {
+		int len = size - i < 256 ? size - i : 256;
+		if (memcmp(block + offset + i, src + i, len) != 0) {
+			memcpy(block + offset + i, src + i, len);
+			block_dirty[(offset + i) >> 8] = 1;
+		}
+	}
+}
+
+/* Moves writes to the NUM pages of a banked window starting at page FIRST
+   into the dirty map of the bank mapped there. */
+static void FlushWindowDirty(UBYTE *bank_dirty, int first, int num)
+{
+	int i;
+	for (i = 0; i < num; i++) {
+		if (MEMORY_dirty[first + i] & MEMORY_DIRTY_WINDOW) {
+			bank_dirty[i] = 1;
+			MEMORY_dirty[first + i] &= ~MEMORY_DIRTY_WINDOW;
+		}
+	}
+}
+
+/* Marks the pages of a window as changed after a new bank is switched in.
+   The new bank itself isn't modified. */
+static void MarkWindowSwapped(int first, int num)
+{
+	int i;
+	for (i = 0; i < num; i++)
+		MEMORY_dirty[first + i] |= MEMORY_DIRTY;
+}
+
+static int XECPUBank(void)
+{
+	return ((PIA_PORTB | PIA_PORTB_mask) & 0x10) ? 0 : MEMORY_xe_bank;
+}
+
+static void FlushAllWindows(void)
+{
+	if (atarixe_memory != NULL && Atari800_machine_type == Atari800_MACHINE_XLXE)
+		FlushWindowDirty(xe_dirty + (XECPUBank() << 6), 0x40, 64);
+	if (axlon_ram != NULL)
+		FlushWindowDirty(axlon_dirty + (axlon_curbank << 6), 0x40, 64);
+	if (mosaic_ram != NULL && mosaic_curbank < mosaic_current_num_banks)
+		FlushWindowDirty(mosaic_dirty + (mosaic_curbank << 4), 0xc0, 16);
+}
+
+/* Returns the contents of memory block BLOCK and its number of pages, and
+   stores the map of its pages changed since the last collection in DIRTY. */
+static UBYTE *Block(int block, int *num_pages, UBYTE **dirty)
+{
+	*num_pages = 0;
+	*dirty = NULL;
+	switch (block) {
+	case MEMORY_BLOCK_BASE:
+		*num_pages = 256;
+		*dirty = MEMORY_dirty;
+		return MEMORY_mem;
+#ifndef PAGED_ATTRIB
+	case MEMORY_BLOCK_ATTRIB:
+		*num_pages = 256;
+		*dirty = attrib_dirty;
+		return MEMORY_attrib;
+#else
+	case MEMORY_BLOCK_ATTRIB:
+		*num_pages = sizeof(MEMORY_readmap) >> 8;
+		*dirty = readmap_dirty;
+		return (UBYTE *) MEMORY_readmap;
+	case MEMORY_BLOCK_WRITEMAP:
+		*num_pages = sizeof(MEMORY_writemap) >> 8;
+		*dirty = writemap_dirty;
+		return (UBYTE *) MEMORY_writemap;
+#endif
+	case MEMORY_BLOCK_XE:
+		if (xe_dirty != NULL)
+			*num_pages = atarixe_memory_size >> 8;
+		*dirty = xe_dirty;
+		return atarixe_memory;
+	case MEMORY_BLOCK_AXLON:
+		if (axlon_dirty != NULL)
+			*num_pages = (axlon_current_bankmask + 1) << 6;
+		*dirty = axlon_dirty;
+		return axlon_ram;
+	case MEMORY_BLOCK_MOSAIC:
+		if (mosaic_dirty != NULL)
+			*num_pages = (mosaic_current_num_banks * 0x1000) >> 8;
+		*dirty = mosaic_dirty;
+		return mosaic_ram;
+	case MEMORY_BLOCK_UNDER_OS:
+		*num_pages = sizeof(under_atarixl_os) >> 8;
+		*dirty = under_os_dirty;
+		return under_atarixl_os;
+	case MEMORY_BLOCK_UNDER_CART:
+		*num_pages = sizeof(under_cartA0BF) >> 8;
+		*dirty = under_cart_dirty;
+		return under_cartA0BF;
+	case MEMORY_BLOCK_UNDER_SELFTEST:
+		*num_pages = sizeof(antic_bank_under_selftest) >> 8;
+		*dirty = under_selftest_dirty;
+		return antic_bank_under_selftest;
+	case MEMORY_BLOCK_MAPRAM:
+		if (mapram_memory != NULL)
+			*num_pages = 0x800 >> 8;
+		*dirty = mapram_dirty;
+		return mapram_memory;
+	}
+	return NULL;
+}
+
+static void MarkAllDirty(void)
+{
+	int block;
+	for (block = 0; block < MEMORY_BLOCKS; block++) {
+		int num_pages;
+		UBYTE *dirty;
+		Block(block, &num_pages, &dirty);
+		if (num_pages > 0)
+			memset(dirty, MEMORY_DIRTY, num_pages);
+	}
+}
+
+/* Moves the changes to BLOCK since the last call into the maps of every
+   user. */
+static void CollectDirty(int block)
+{
+	int num_pages;
+	UBYTE *dirty;
+	int user;
+	int i;
+
+	FlushAllWindows();
+	Block(block, &num_pages, &dirty);
+	for (user = 0; user < MEMORY_DIRTY_USERS; user++) {
+		if (num_pages != user_num_pages[user][block] || user_dirty[user][block] == NULL) {
+			/* the block was resized, so all of it is new */
+			user_dirty[user][block] = (UBYTE *) Util_realloc(user_dirty[user][block], num_pages + 1);
+			memset(user_dirty[user][block], 1, num_pages);
+			user_num_pages[user][block] = num_pages;
+		}
+	}
+	for (i = 0; i < num_pages; i++) {
+		if (dirty[i]) {
+			for (user = 0; user < MEMORY_DIRTY_USERS; user++)
+				user_dirty[user][block][i] = 1;
+#ifdef PAGED_ATTRIB
+			if (block == MEMORY_BLOCK_ATTRIB || block == MEMORY_BLOCK_WRITEMAP)
+				continue;
+#endif
+			dirty[i] = 0;
+		}
+	}
+}
+
+/* Returns memory block BLOCK (see MEMORY_BLOCK_*) and stores its number of
+   256-byte pages in NUM_PAGES, or returns NULL if the machine doesn't have
+   that block. */
+UBYTE *MEMORY_GetBlock(int block, int *num_pages)
+{
+	UBYTE *dirty;
+	UBYTE *data = Block(block, num_pages, &dirty);
+	if (*num_pages == 0)
+		return NULL;
+	return data;
+}
+
+/* Returns the map of pages of memory block BLOCK changed since USER last
+   called MEMORY_ClearDirty() (one entry per page, non-zero if dirty), and
+   stores the number of pages in NUM_PAGES. */
+UBYTE const *MEMORY_GetDirty(int user, int block, int *num_pages)
+{
+	CollectDirty(block);
+	*num_pages = user_num_pages[user][block];
+	return user_dirty[user][block];
+}
+
+void MEMORY_ClearDirty(int user)
+{
+	int block;
+	for (block = 0; block < MEMORY_BLOCKS; block++) {
+		CollectDirty(block);
+		memset(user_dirty[user][block], 0, user_num_pages[user][block]);
+	}
+}
+#else /* MEMORY_TRACK_WRITES */
+#define AllocBankDirty(bank_dirty, size)
+#define CopyToBlock(block, block_dirty, offset, src, size) memcpy((block) + (offset), src, size)
+#define FlushWindowDirty(bank_dirty, first, num)
+#define MarkWindowSwapped(first, num)
+#define MarkAllDirty()
+#endif /* MEMORY_TRACK_WRITES */
 
 static void alloc_axlon_memory(void){
 	if (MEMORY_axlon_num_banks > 0 && Atari800_machine_type == Atari800_MACHINE_800) {
@@ -125,12 +388,14 @@ static void alloc_axlon_memory(void){
 			axlon_ram = (UBYTE *)Util_realloc(axlon_ram, size);
 		}
 		memset(axlon_ram, 0, size);
+		AllocBankDirty(&axlon_dirty, size);
 	} else {
 		if (axlon_ram != NULL) {
 			free(axlon_ram);
 			axlon_ram = NULL;
 			axlon_current_bankmask = 0;
 		}
+		AllocBankDirty(&axlon_dirty, 0);
 	}
 }
 
@@ -142,12 +407,14 @@ static void alloc_mosaic_memory(void){
 			mosaic_ram = (UBYTE *)Util_realloc(mosaic_ram, size);
 		}
 		memset(mosaic_ram, 0, size);
+		AllocBankDirty(&mosaic_dirty, size);
 	} else {
 		if (mosaic_ram != NULL) {
 			free(mosaic_ram);
 			mosaic_ram = NULL;
 			mosaic_current_num_banks = 0;
 		}
+		AllocBankDirty(&mosaic_dirty, 0);
 	}
 }
 
@@ -163,6 +430,7 @@ static void AllocXEMemory(void)
 			atarixe_memory = (UBYTE *) Util_malloc(size);
 			atarixe_memory_size = size;
 			memset(atarixe_memory, 0, size);
+			AllocBankDirty(&xe_dirty, size);
 		}
 	}
 	/* atarixe_memory not needed, free it */
@@ -170,6 +438,7 @@ static void AllocXEMemory(void)
 		free(atarixe_memory);
 		atarixe_memory = NULL;
 		atarixe_memory_size = 0;
+		AllocBankDirty(&xe_dirty, 0);
 	}
 }
 
@@ -208,7 +477,7 @@ void MEMORY_InitialiseMachine(void)
 		if (GTIA_GRACTL & 4)
 			GTIA_TRIG_latch[3] = 0;
 	}
-	memcpy(MEMORY_mem + os_rom_start, MEMORY_os, os_size);
+	MEMORY_dCopyToMem(MEMORY_os, os_rom_start, os_size);
 	switch (Atari800_machine_type) {
 	case Atari800_MACHINE_5200:
 		MEMORY_dFillMem(0x0000, 0x00, 0xf800);
@@ -334,6 +603,7 @@ void MEMORY_InitialiseMachine(void)
 	axlon_curbank = 0;
 	mosaic_curbank = 0x3f;
 	AllocMapRAM();
+	MarkAllDirty();
 	Atari800_Coldstart();
 }
 
@@ -350,25 +620,31 @@ void MEMORY_StateSave(UBYTE SaveVerbose)
 		if (MEMORY_axlon_num_banks > 0){
 			StateSav_SaveINT(&axlon_curbank, 1);
 			StateSav_SaveINT(&MEMORY_axlon_0f_mirror, 1);
-			StateSav_SaveUBYTE(axlon_ram, MEMORY_axlon_num_banks * 0x4000);
+			if (!STATESAV_REWIND)
+				StateSav_SaveUBYTE(axlon_ram, MEMORY_axlon_num_banks * 0x4000);
 		}
 		StateSav_SaveINT(&mosaic_current_num_banks, 1);
 		if (mosaic_current_num_banks > 0) {
 			StateSav_SaveINT(&mosaic_curbank, 1);
-			StateSav_SaveUBYTE(mosaic_ram, mosaic_current_num_banks * 0x1000);
+			if (!STATESAV_REWIND)
+				StateSav_SaveUBYTE(mosaic_ram, mosaic_current_num_banks * 0x1000);
 		}
 	}
 
 	/* Save amount of base RAM in kilobytes. */
 	temp = MEMORY_ram_size > 64 ? 64 : MEMORY_ram_size;
 	StateSav_SaveINT(&temp, 1);
+	/* The rewind buffer keeps the memory blocks (see MEMORY_GetBlock())
+	   itself */
 	STATESAV_TAG(base_ram);
-	StateSav_SaveUBYTE(&MEMORY_mem[0], 65536);
+	if (!STATESAV_REWIND)
+		StateSav_SaveUBYTE(&MEMORY_mem[0], 65536);
 	STATESAV_TAG(base_ram_attrib);
 #ifndef PAGED_ATTRIB
-	StateSav_SaveUBYTE(&MEMORY_attrib[0], 65536);
+	if (!STATESAV_REWIND)
+		StateSav_SaveUBYTE(&MEMORY_attrib[0], 65536);
 #else
-	{
+	if (!STATESAV_REWIND) {
 		/* I assume here that consecutive calls to StateSav_SaveUBYTE()
 		   are equivalent to a single call with all the values
 		   (i.e. StateSav_SaveUBYTE() doesn't write any headers). */
@@ -398,11 +674,13 @@ void MEMORY_StateSave(UBYTE SaveVerbose)
 	if (Atari800_machine_type == Atari800_MACHINE_XLXE) {
 		if (SaveVerbose != 0)
 			StateSav_SaveUBYTE(&MEMORY_basic[0], 8192);
-		StateSav_SaveUBYTE(&under_cartA0BF[0], 8192);
+		if (!STATESAV_REWIND)
+			StateSav_SaveUBYTE(&under_cartA0BF[0], 8192);
 
 		if (SaveVerbose != 0)
 			StateSav_SaveUBYTE(&MEMORY_os[0], 16384);
-		StateSav_SaveUBYTE(&under_atarixl_os[0], 16384);
+		if (!STATESAV_REWIND)
+			StateSav_SaveUBYTE(&under_atarixl_os[0], 16384);
 		if (SaveVerbose != 0)
 			StateSav_SaveUBYTE(MEMORY_xegame, 0x2000);
 	}
@@ -422,7 +700,7 @@ void MEMORY_StateSave(UBYTE SaveVerbose)
 
 	StateSav_SaveINT(&MEMORY_cartA0BF_enabled, 1);
 
-	if (MEMORY_ram_size > 64) {
+	if (MEMORY_ram_size > 64 && !STATESAV_REWIND) {
 		StateSav_SaveUBYTE(&atarixe_memory[0], atarixe_memory_size);
 		if (ANTIC_xe_ptr != NULL && MEMORY_selftest_enabled)
 			StateSav_SaveUBYTE(antic_bank_under_selftest, 0x800);
@@ -431,7 +709,7 @@ void MEMORY_StateSave(UBYTE SaveVerbose)
 	/* Simius XL/XE MapRAM expansion */
 	if (Atari800_machine_type == Atari800_MACHINE_XLXE && MEMORY_ram_size > 20) {
 		StateSav_SaveINT(&MEMORY_enable_mapram, 1);
-		if (MEMORY_enable_mapram) {
+		if (MEMORY_enable_mapram && !STATESAV_REWIND) {
 			StateSav_SaveUBYTE( mapram_memory, 0x800 );
 		}
 	}
@@ -460,7 +738,8 @@ void MEMORY_StateRead(UBYTE SaveVerbose, UBYTE StateVersion)
 				StateSav_ReadINT(&temp, 1);
 			}
 			alloc_axlon_memory();
-			StateSav_ReadUBYTE(axlon_ram, MEMORY_axlon_num_banks * 0x4000);
+			if (!STATESAV_REWIND)
+				StateSav_ReadUBYTE(axlon_ram, MEMORY_axlon_num_banks * 0x4000);
 		}
 		StateSav_ReadINT(&MEMORY_mosaic_num_banks, 1);
 		if (MEMORY_mosaic_num_banks > 0) {
@@ -473,18 +752,21 @@ void MEMORY_StateRead(UBYTE SaveVerbose, UBYTE StateVersion)
 				StateSav_ReadINT(&temp, 1); /* Ignore Mosaic RAM size - can be derived. */
 			}
 			alloc_mosaic_memory();
-			StateSav_ReadUBYTE(mosaic_ram, mosaic_current_num_banks * 0x1000);
+			if (!STATESAV_REWIND)
+				StateSav_ReadUBYTE(mosaic_ram, mosaic_current_num_banks * 0x1000);
 		}
 	}
 
 	if (StateVersion >= 7)
 		/* Read amount of base RAM in kilobytes. */
 		StateSav_ReadINT(&base_ram_kb, 1);
-	StateSav_ReadUBYTE(&MEMORY_mem[0], 65536);
+	if (!STATESAV_REWIND)
+		StateSav_ReadUBYTE(&MEMORY_mem[0], 65536);
 #ifndef PAGED_ATTRIB
-	StateSav_ReadUBYTE(&MEMORY_attrib[0], 65536);
+	if (!STATESAV_REWIND)
+		StateSav_ReadUBYTE(&MEMORY_attrib[0], 65536);
 #else
-	{
+	if (!STATESAV_REWIND) {
 		UBYTE attrib_page[256];
 		int i;
 		for (i = 0; i < 256; i++) {
@@ -579,11 +861,13 @@ void MEMORY_StateRead(UBYTE SaveVerbose, UBYTE StateVersion)
 	if (Atari800_machine_type == Atari800_MACHINE_XLXE) {
 		if (SaveVerbose)
 			StateSav_ReadUBYTE(&MEMORY_basic[0], 8192);
-		StateSav_ReadUBYTE(&under_cartA0BF[0], 8192);
+		if (!STATESAV_REWIND)
+			StateSav_ReadUBYTE(&under_cartA0BF[0], 8192);
 
 		if (SaveVerbose)
 			StateSav_ReadUBYTE(&MEMORY_os[0], 16384);
-		StateSav_ReadUBYTE(&under_atarixl_os[0], 16384);
+		if (!STATESAV_REWIND)
+			StateSav_ReadUBYTE(&under_atarixl_os[0], 16384);
 		if (StateVersion >= 7 && SaveVerbose)
 			StateSav_ReadUBYTE(MEMORY_xegame, 0x2000);
 	}
@@ -645,7 +929,8 @@ void MEMORY_StateRead(UBYTE SaveVerbose, UBYTE StateVersion)
 	ANTIC_xe_ptr = NULL;
 	AllocXEMemory();
 	if (MEMORY_ram_size > 64) {
-		StateSav_ReadUBYTE(&atarixe_memory[0], atarixe_memory_size);
+		if (!STATESAV_REWIND)
+			StateSav_ReadUBYTE(&atarixe_memory[0], atarixe_memory_size);
 		/* a hack that makes state files compatible with previous versions:
 		   for 130 XE there's written 192 KB of unused data */
 		if (MEMORY_ram_size == 128 && StateVersion <= 6) {
@@ -667,7 +952,7 @@ void MEMORY_StateRead(UBYTE SaveVerbose, UBYTE StateVersion)
 				break;
 			}
 
-			if (ANTIC_xe_ptr != NULL && MEMORY_selftest_enabled)
+			if (ANTIC_xe_ptr != NULL && MEMORY_selftest_enabled && !STATESAV_REWIND)
 				/* Also read ANTIC-visible memory shadowed by Self Test. */
 				StateSav_ReadUBYTE(antic_bank_under_selftest, 0x800);
 
@@ -678,10 +963,12 @@ void MEMORY_StateRead(UBYTE SaveVerbose, UBYTE StateVersion)
 	if (StateVersion >= 7 && Atari800_machine_type == Atari800_MACHINE_XLXE && MEMORY_ram_size > 20) {
 		StateSav_ReadINT(&MEMORY_enable_mapram, 1);
 		AllocMapRAM();
-		if (mapram_memory != NULL) {
+		if (mapram_memory != NULL && !STATESAV_REWIND) {
 			StateSav_ReadUBYTE(mapram_memory, 0x800);
 		}
 	}
+
+	MarkAllDirty();
 }
 
 #endif /* BASIC */
@@ -743,8 +1030,8 @@ void MEMORY_HandlePORTB(UBYTE byte, UBYTE oldval)
 
 	if (mapram_selected && !new_mapram_selected) {
 		/* Restore RAM hidden by MapRAM. */
-		memcpy(mapram_memory, MEMORY_mem + 0x5000, 0x800);
-		memcpy(MEMORY_mem + 0x5000, under_atarixl_os + 0x1000, 0x800);
+		CopyToBlock(mapram_memory, mapram_dirty, 0, MEMORY_mem + 0x5000, 0x800);
+		MEMORY_dCopyToMem(under_atarixl_os + 0x1000, 0x5000, 0x800);
 	}
 
 	/* Switch XE memory bank in 0x4000-0x7fff */
@@ -785,16 +1072,18 @@ void MEMORY_HandlePORTB(UBYTE byte, UBYTE oldval)
 		        || antic_bank != new_antic_bank
 		        || (MEMORY_ram_size == MEMORY_RAM_320_COMPY_SHOP && (byte & 0x20) == 0))) {
 			/* Disable Self Test ROM */
-			memcpy(MEMORY_mem + 0x5000, under_atarixl_os + 0x1000, 0x800);
+			MEMORY_dCopyToMem(under_atarixl_os + 0x1000, 0x5000, 0x800);
 			if (ANTIC_xe_ptr != NULL)
 				/* Also disable Self Test from XE bank accessed by ANTIC. */
-				memcpy(atarixe_memory + (antic_bank << 14) + 0x1000, antic_bank_under_selftest, 0x800);
+				CopyToBlock(atarixe_memory, xe_dirty, (antic_bank << 14) + 0x1000, antic_bank_under_selftest, 0x800);
 			MEMORY_SetRAM(0x5000, 0x57ff);
 			MEMORY_selftest_enabled = FALSE;
 		}
 		if (cpu_bank != new_cpu_bank) {
-			memcpy(atarixe_memory + (cpu_bank << 14), MEMORY_mem + 0x4000, 0x4000);
+			FlushWindowDirty(xe_dirty + (cpu_bank << 6), 0x40, 64);
+			CopyToBlock(atarixe_memory, xe_dirty, cpu_bank << 14, MEMORY_mem + 0x4000, 0x4000);
 			memcpy(MEMORY_mem + 0x4000, atarixe_memory + (new_cpu_bank << 14), 0x4000);
+			MarkWindowSwapped(0x40, 64);
 		}
 
 		if (MEMORY_ram_size == 128 || MEMORY_ram_size == MEMORY_RAM_320_COMPY_SHOP)
@@ -809,20 +1098,20 @@ void MEMORY_HandlePORTB(UBYTE byte, UBYTE oldval)
 		if (byte & 0x01) {
 			/* Enable OS ROM */
 			if (MEMORY_ram_size > 48) {
-				memcpy(under_atarixl_os, MEMORY_mem + 0xc000, 0x1000);
-				memcpy(under_atarixl_os + 0x1800, MEMORY_mem + 0xd800, 0x2800);
+				CopyToBlock(under_atarixl_os, under_os_dirty, 0, MEMORY_mem + 0xc000, 0x1000);
+				CopyToBlock(under_atarixl_os, under_os_dirty, 0x1800, MEMORY_mem + 0xd800, 0x2800);
 				MEMORY_SetROM(0xc000, 0xcfff);
 				MEMORY_SetROM(0xd800, 0xffff);
 			}
-			memcpy(MEMORY_mem + 0xc000, MEMORY_os, 0x1000);
-			memcpy(MEMORY_mem + 0xd800, MEMORY_os + 0x1800, 0x2800);
+			MEMORY_dCopyToMem(MEMORY_os, 0xc000, 0x1000);
+			MEMORY_dCopyToMem(MEMORY_os + 0x1800, 0xd800, 0x2800);
 			ESC_PatchOS();
 		}
 		else {
 			/* Disable OS ROM */
 			if (MEMORY_ram_size > 48) {
-				memcpy(MEMORY_mem + 0xc000, under_atarixl_os, 0x1000);
-				memcpy(MEMORY_mem + 0xd800, under_atarixl_os + 0x1800, 0x2800);
+				MEMORY_dCopyToMem(under_atarixl_os, 0xc000, 0x1000);
+				MEMORY_dCopyToMem(under_atarixl_os + 0x1800, 0xd800, 0x2800);
 				MEMORY_SetRAM(0xc000, 0xcfff);
 				MEMORY_SetRAM(0xd800, 0xffff);
 			} else {
@@ -832,10 +1121,10 @@ void MEMORY_HandlePORTB(UBYTE byte, UBYTE oldval)
 			/* When OS ROM is disabled we also have to disable Self Test - Jindroush */
 			if (MEMORY_selftest_enabled) {
 				if (MEMORY_ram_size > 20) {
-					memcpy(MEMORY_mem + 0x5000, under_atarixl_os + 0x1000, 0x800);
+					MEMORY_dCopyToMem(under_atarixl_os + 0x1000, 0x5000, 0x800);
 					if (ANTIC_xe_ptr != NULL)
 						/* Also disable Self Test from XE bank accessed by ANTIC. */
-						memcpy(atarixe_memory + (antic_bank << 14) + 0x1000, antic_bank_under_selftest, 0x800);
+						CopyToBlock(atarixe_memory, xe_dirty, (antic_bank << 14) + 0x1000, antic_bank_under_selftest, 0x800);
 					MEMORY_SetRAM(0x5000, 0x57ff);
 				}
 				else
@@ -851,19 +1140,19 @@ void MEMORY_HandlePORTB(UBYTE byte, UBYTE oldval)
 		UBYTE const *builtin_cart_old = builtin_cart(oldval);
 		if (builtin_cart_old != builtin_cart_new) {
 			if (builtin_cart_old == NULL && MEMORY_ram_size > 40) { /* switching RAM out */
-				memcpy(under_cartA0BF, MEMORY_mem + 0xa000, 0x2000);
+				CopyToBlock(under_cartA0BF, under_cart_dirty, 0, MEMORY_mem + 0xa000, 0x2000);
 				MEMORY_SetROM(0xa000, 0xbfff);
 			}
 			if (builtin_cart_new == NULL) { /* switching RAM in */
 				if (MEMORY_ram_size > 40) {
-					memcpy(MEMORY_mem + 0xa000, under_cartA0BF, 0x2000);
+					MEMORY_dCopyToMem(under_cartA0BF, 0xa000, 0x2000);
 					MEMORY_SetRAM(0xa000, 0xbfff);
 				}
 				else
 					MEMORY_dFillMem(0xa000, 0xff, 0x2000);
 			}
 			else
-				memcpy(MEMORY_mem + 0xa000, builtin_cart_new, 0x2000);
+				MEMORY_dCopyToMem(builtin_cart_new, 0xa000, 0x2000);
 		}
 	}
 
@@ -872,10 +1161,10 @@ void MEMORY_HandlePORTB(UBYTE byte, UBYTE oldval)
 		if (MEMORY_selftest_enabled) {
 			/* Disable Self Test ROM */
 			if (MEMORY_ram_size > 20) {
-				memcpy(MEMORY_mem + 0x5000, under_atarixl_os + 0x1000, 0x800);
+				MEMORY_dCopyToMem(under_atarixl_os + 0x1000, 0x5000, 0x800);
 				if (ANTIC_xe_ptr != NULL)
 					/* Also disable Self Test from XE bank accessed by ANTIC. */
-					memcpy(atarixe_memory + (antic_bank << 14) + 0x1000, antic_bank_under_selftest, 0x800);
+					CopyToBlock(atarixe_memory, xe_dirty, (antic_bank << 14) + 0x1000, antic_bank_under_selftest, 0x800);
 				MEMORY_SetRAM(0x5000, 0x57ff);
 			}
 			else
@@ -892,22 +1181,22 @@ void MEMORY_HandlePORTB(UBYTE byte, UBYTE oldval)
 		&& !((byte & 0x10) == 0 && MEMORY_ram_size == 1088)) {
 			/* Enable Self Test ROM */
 			if (MEMORY_ram_size > 20) {
-				memcpy(under_atarixl_os + 0x1000, MEMORY_mem + 0x5000, 0x800);
+				CopyToBlock(under_atarixl_os, under_os_dirty, 0x1000, MEMORY_mem + 0x5000, 0x800);
 				if (ANTIC_xe_ptr != NULL)
 					/* Also backup RAM under Self Test from XE bank accessed by ANTIC. */
-					memcpy(antic_bank_under_selftest, atarixe_memory + (antic_bank << 14) + 0x1000, 0x800);
+					CopyToBlock(antic_bank_under_selftest, under_selftest_dirty, 0, atarixe_memory + (antic_bank << 14) + 0x1000, 0x800);
 				MEMORY_SetROM(0x5000, 0x57ff);
 			}
-			memcpy(MEMORY_mem + 0x5000, MEMORY_os + 0x1000, 0x800);
+			MEMORY_dCopyToMem(MEMORY_os + 0x1000, 0x5000, 0x800);
 			if (ANTIC_xe_ptr != NULL)
 				/* Also enable Self Test in the XE bank accessed by ANTIC. */
-				memcpy(atarixe_memory + (antic_bank << 14) + 0x1000, MEMORY_os + 0x1000, 0x800);
+				CopyToBlock(atarixe_memory, xe_dirty, (antic_bank << 14) + 0x1000, MEMORY_os + 0x1000, 0x800);
 			MEMORY_selftest_enabled = TRUE;
 		}
 		else if (!mapram_selected && new_mapram_selected) {
 			/* Enable MapRAM */
-			memcpy(under_atarixl_os + 0x1000, MEMORY_mem + 0x5000, 0x800);
-			memcpy(MEMORY_mem + 0x5000, mapram_memory, 0x800);
+			CopyToBlock(under_atarixl_os, under_os_dirty, 0x1000, MEMORY_mem + 0x5000, 0x800);
+			MEMORY_dCopyToMem(mapram_memory, 0x5000, 0x800);
 		}
 	}
 }
@@ -931,19 +1220,23 @@ static void MosaicPutByte(UWORD addr, UBYTE byte)
 	if (newbank == mosaic_curbank || (newbank >= mosaic_current_num_banks && mosaic_curbank >= mosaic_current_num_banks)) return; /*same bank or rom -> rom*/
 	if (newbank >= mosaic_current_num_banks && mosaic_curbank < mosaic_current_num_banks) {
 		/*ram ->rom*/
-		memcpy(mosaic_ram + mosaic_curbank*0x1000, MEMORY_mem + 0xc000,0x1000);
+		FlushWindowDirty(mosaic_dirty + (mosaic_curbank << 4), 0xc0, 16);
+		CopyToBlock(mosaic_ram, mosaic_dirty, mosaic_curbank*0x1000, MEMORY_mem + 0xc000, 0x1000);
 		MEMORY_dFillMem(0xc000, 0xff, 0x1000);
 		MEMORY_SetROM(0xc000, 0xcfff);
 	}
 	else if (newbank < mosaic_current_num_banks && mosaic_curbank >= mosaic_current_num_banks) {
 		/*rom->ram*/
 		memcpy(MEMORY_mem + 0xc000, mosaic_ram+newbank*0x1000,0x1000);
+		MarkWindowSwapped(0xc0, 16);
 		MEMORY_SetRAM(0xc000, 0xcfff);
 	}
 	else {
 		/*ram -> ram*/
-		memcpy(mosaic_ram + mosaic_curbank*0x1000, MEMORY_mem + 0xc000, 0x1000);
+		FlushWindowDirty(mosaic_dirty + (mosaic_curbank << 4), 0xc0, 16);
+		CopyToBlock(mosaic_ram, mosaic_dirty, mosaic_curbank*0x1000, MEMORY_mem + 0xc000, 0x1000);
 		memcpy(MEMORY_mem + 0xc000, mosaic_ram + newbank*0x1000, 0x1000);
+		MarkWindowSwapped(0xc0, 16);
 		MEMORY_SetRAM(0xc000, 0xcfff);
 	}
 	mosaic_curbank = newbank;
@@ -972,15 +1265,17 @@ static void AxlonPutByte(UWORD addr, UBYTE byte)
 {
 	int newbank;
 	/*Write-through to RAM if it is the page 0x0f shadow*/
-	if ((addr&0xff00) == 0x0f00) MEMORY_mem[addr] = byte;
+	if ((addr&0xff00) == 0x0f00) MEMORY_dPutByte(addr, byte);
 	if ((addr&0xff) < 0xc0) return; /*0xffc0-0xffff and 0x0fc0-0x0fff only*/
 #ifdef DEBUG
 	Log_print("AxlonPutByte:%4X:%2X", addr, byte);
 #endif
 	newbank = (byte&axlon_current_bankmask);
 	if (newbank == axlon_curbank) return;
-	memcpy(axlon_ram + axlon_curbank*0x4000, MEMORY_mem + 0x4000, 0x4000);
+	FlushWindowDirty(axlon_dirty + (axlon_curbank << 6), 0x40, 64);
+	CopyToBlock(axlon_ram, axlon_dirty, axlon_curbank*0x4000, MEMORY_mem + 0x4000, 0x4000);
 	memcpy(MEMORY_mem + 0x4000, axlon_ram + newbank*0x4000, 0x4000);
+	MarkWindowSwapped(0x40, 64);
 	axlon_curbank = newbank;
 }
 
@@ -996,7 +1291,7 @@ void MEMORY_Cart809fDisable(void)
 {
 	if (cart809F_enabled) {
 		if (MEMORY_ram_size > 32) {
-			memcpy(MEMORY_mem + 0x8000, under_cart809F, 0x2000);
+			MEMORY_dCopyToMem(under_cart809F, 0x8000, 0x2000);
 			MEMORY_SetRAM(0x8000, 0x9fff);
 		}
 		else
@@ -1024,14 +1319,14 @@ void MEMORY_CartA0bfDisable(void)
 		UBYTE const *builtin = builtin_cart(PIA_PORTB | PIA_PORTB_mask);
 		if (builtin == NULL) { /* switch RAM in */
 			if (MEMORY_ram_size > 40) {
-				memcpy(MEMORY_mem + 0xa000, under_cartA0BF, 0x2000);
+				MEMORY_dCopyToMem(under_cartA0BF, 0xa000, 0x2000);
 				MEMORY_SetRAM(0xa000, 0xbfff);
 			}
 			else
 				MEMORY_dFillMem(0xa000, 0xff, 0x2000);
 		}
 		else
-			memcpy(MEMORY_mem + 0xa000, builtin, 0x2000);
+			MEMORY_dCopyToMem(builtin, 0xa000, 0x2000);
 		MEMORY_cartA0BF_enabled = FALSE;
 		if (Atari800_machine_type == Atari800_MACHINE_XLXE) {
 			GTIA_TRIG[3] = 0;
@@ -1048,7 +1343,7 @@ void MEMORY_CartA0bfEnable(void)
 		/* or accessing extended 576K or 1088K memory */
 		if (MEMORY_ram_size > 40 && builtin_cart(PIA_PORTB | PIA_PORTB_mask) == NULL) {
 			/* Back-up 0xa000-0xbfff RAM */
-			memcpy(under_cartA0BF, MEMORY_mem + 0xa000, 0x2000);
+			CopyToBlock(under_cartA0BF, under_cart_dirty, 0, MEMORY_mem + 0xa000, 0x2000);
 			MEMORY_SetROM(0xa000, 0xbfff);
 		}
 		MEMORY_cartA0BF_enabled = TRUE;
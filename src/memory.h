@@ -6,18 +6,54 @@
 
 #include "atari.h"
 
+#ifdef MEMORY_TRACK_WRITES
+/* Pages of MEMORY_mem changed since the last MEMORY_ClearDirty(). An entry
+   is non-zero if the page is dirty; MEMORY_DIRTY_WINDOW additionally marks
+   writes to a banked memory window that haven't been attributed to the
+   bank yet. */
+#define MEMORY_DIRTY         0x01
+#define MEMORY_DIRTY_WINDOW  0x02
+extern THREAD_LOCAL UBYTE MEMORY_dirty[256];
+#define MEMORY_MarkDirty(x)				(MEMORY_dirty[(x) >> 8] = MEMORY_DIRTY | MEMORY_DIRTY_WINDOW)
+void MEMORY_MarkDirtyRange(int addr, int size);
+
+/* Blocks of memory that make up the memory state of the machine */
+#define MEMORY_BLOCK_BASE           0	/* MEMORY_mem */
+#define MEMORY_BLOCK_ATTRIB         1	/* MEMORY_attrib, or MEMORY_readmap with PAGED_ATTRIB */
+#define MEMORY_BLOCK_WRITEMAP       2	/* MEMORY_writemap with PAGED_ATTRIB */
+#define MEMORY_BLOCK_XE             3	/* 130XE-style extended memory */
+#define MEMORY_BLOCK_AXLON          4
+#define MEMORY_BLOCK_MOSAIC         5
+#define MEMORY_BLOCK_UNDER_OS       6	/* RAM under the OS ROM */
+#define MEMORY_BLOCK_UNDER_CART     7	/* RAM under BASIC or cartridge at 0xa000 */
+#define MEMORY_BLOCK_UNDER_SELFTEST 8	/* XE bank seen by ANTIC under Self Test */
+#define MEMORY_BLOCK_MAPRAM         9
+#define MEMORY_BLOCKS               10
+/* Users of the dirty maps. Every user has maps of its own, so clearing them
+   doesn't hide changes from the other users. */
+#define MEMORY_DIRTY_API     0
+#define MEMORY_DIRTY_REWIND  1
+#define MEMORY_DIRTY_USERS   2
+UBYTE *MEMORY_GetBlock(int block, int *num_pages);
+UBYTE const *MEMORY_GetDirty(int user, int block, int *num_pages);
+void MEMORY_ClearDirty(int user);
+#else /* MEMORY_TRACK_WRITES */
+#define MEMORY_MarkDirty(x)				((void) 0)
+#define MEMORY_MarkDirtyRange(addr, size)	((void) 0)
+#endif /* MEMORY_TRACK_WRITES */
+
 #define MEMORY_dGetByte(x)				(MEMORY_mem[x])
-#define MEMORY_dPutByte(x, y)			(MEMORY_mem[x] = y)
+#define MEMORY_dPutByte(x, y)			(MEMORY_MarkDirty(x), MEMORY_mem[x] = y)
 
 #ifndef WORDS_BIGENDIAN
 #ifdef WORDS_UNALIGNED_OK
 #define MEMORY_dGetWord(x)				UNALIGNED_GET_WORD(MEMORY_mem+(x), memory_read_word_stat)
-#define MEMORY_dPutWord(x, y)			UNALIGNED_PUT_WORD(MEMORY_mem+(x), (y), memory_write_word_stat)
+#define MEMORY_dPutWord(x, y)			(MEMORY_MarkDirty(x), MEMORY_MarkDirty((x) + 1), UNALIGNED_PUT_WORD(MEMORY_mem+(x), (y), memory_write_word_stat))
 #define MEMORY_dGetWordAligned(x)		UNALIGNED_GET_WORD(MEMORY_mem+(x), memory_read_aligned_word_stat)
-#define MEMORY_dPutWordAligned(x, y)	UNALIGNED_PUT_WORD(MEMORY_mem+(x), (y), memory_write_aligned_word_stat)
+#define MEMORY_dPutWordAligned(x, y)	(MEMORY_MarkDirty(x), UNALIGNED_PUT_WORD(MEMORY_mem+(x), (y), memory_write_aligned_word_stat))
 #else	/* WORDS_UNALIGNED_OK */
 #define MEMORY_dGetWord(x)				(MEMORY_mem[x] + (MEMORY_mem[(x) + 1] << 8))
-#define MEMORY_dPutWord(x, y)			(MEMORY_mem[x] = (UBYTE) (y), MEMORY_mem[(x) + 1] = (UBYTE) ((y) >> 8))
+#define MEMORY_dPutWord(x, y)			(MEMORY_dPutByte(x, (UBYTE) (y)), MEMORY_dPutByte((x) + 1, (UBYTE) ((y) >> 8)))
 /* faster versions of MEMORY_jdGetWord and MEMORY_dPutWord for even addresses */
 /* TODO: guarantee that memory is UWORD-aligned and use UWORD access */
 #define MEMORY_dGetWordAligned(x)		MEMORY_dGetWord(x)
@@ -26,16 +62,16 @@
 #else	/* WORDS_BIGENDIAN */
 /* can't do any word optimizations for big endian machines */
 #define MEMORY_dGetWord(x)				(MEMORY_mem[x] + (MEMORY_mem[(x) + 1] << 8))
-#define MEMORY_dPutWord(x, y)			(MEMORY_mem[x] = (UBYTE) (y), MEMORY_mem[(x) + 1] = (UBYTE) ((y) >> 8))
+#define MEMORY_dPutWord(x, y)			(MEMORY_dPutByte(x, (UBYTE) (y)), MEMORY_dPutByte((x) + 1, (UBYTE) ((y) >> 8)))
 #define MEMORY_dGetWordAligned(x)		MEMORY_dGetWord(x)
 #define MEMORY_dPutWordAligned(x, y)	MEMORY_dPutWord(x, y)
 #endif	/* WORDS_BIGENDIAN */
 
 #define MEMORY_dCopyFromMem(from, to, size)	memcpy(to, MEMORY_mem + (from), size)
-#define MEMORY_dCopyToMem(from, to, size)		memcpy(MEMORY_mem + (to), from, size)
-#define MEMORY_dFillMem(addr1, value, length)	memset(MEMORY_mem + (addr1), value, length)
+#define MEMORY_dCopyToMem(from, to, size)		(MEMORY_MarkDirtyRange(to, size), memcpy(MEMORY_mem + (to), from, size))
+#define MEMORY_dFillMem(addr1, value, length)	(MEMORY_MarkDirtyRange(addr1, length), memset(MEMORY_mem + (addr1), value, length))
 
-extern UBYTE MEMORY_mem[65536 + 2];
+extern THREAD_LOCAL UBYTE MEMORY_mem[65536 + 2];
 
 /* RAM size in kilobytes.
    Valid values for Atari800_MACHINE_800 are: 16, 48, 52.
@@ -44,7 +80,7 @@ extern UBYTE MEMORY_mem[65536 + 2];
    The only valid value for Atari800_MACHINE_5200 is 16. */
 #define MEMORY_RAM_320_RAMBO       320
 #define MEMORY_RAM_320_COMPY_SHOP  321
-extern int MEMORY_ram_size;
+extern THREAD_LOCAL int MEMORY_ram_size;
 
 #define MEMORY_RAM       0
 #define MEMORY_ROM       1
@@ -52,31 +88,38 @@ extern int MEMORY_ram_size;
 
 #ifndef PAGED_ATTRIB
 
-extern UBYTE MEMORY_attrib[65536];
+extern THREAD_LOCAL UBYTE MEMORY_attrib[65536];
 /* Reads a byte from ADDR. Can potentially have side effects, when reading
    from hardware area. */
 #define MEMORY_GetByte(addr)		(MEMORY_attrib[addr] == MEMORY_HARDWARE ? MEMORY_HwGetByte(addr, FALSE) : MEMORY_mem[addr])
 /* Reads a byte from ADDR, but without any side effects. */
 #define MEMORY_SafeGetByte(addr)		(MEMORY_attrib[addr] == MEMORY_HARDWARE ? MEMORY_HwGetByte(addr, TRUE) : MEMORY_mem[addr])
-#define MEMORY_PutByte(addr, byte)	 do { if (MEMORY_attrib[addr] == MEMORY_RAM) MEMORY_mem[addr] = byte; else if (MEMORY_attrib[addr] == MEMORY_HARDWARE) MEMORY_HwPutByte(addr, byte); } while (0)
+#define MEMORY_PutByte(addr, byte)	 do { if (MEMORY_attrib[addr] == MEMORY_RAM) MEMORY_dPutByte(addr, byte); else if (MEMORY_attrib[addr] == MEMORY_HARDWARE) MEMORY_HwPutByte(addr, byte); } while (0)
+#ifdef MEMORY_TRACK_WRITES
+void MEMORY_SetAttrib(int addr1, int addr2, UBYTE attrib);
+#define MEMORY_SetRAM(addr1, addr2) MEMORY_SetAttrib(addr1, addr2, MEMORY_RAM)
+#define MEMORY_SetROM(addr1, addr2) MEMORY_SetAttrib(addr1, addr2, MEMORY_ROM)
+#define MEMORY_SetHARDWARE(addr1, addr2) MEMORY_SetAttrib(addr1, addr2, MEMORY_HARDWARE)
+#else /* MEMORY_TRACK_WRITES */
 #define MEMORY_SetRAM(addr1, addr2) memset(MEMORY_attrib + (addr1), MEMORY_RAM, (addr2) - (addr1) + 1)
 #define MEMORY_SetROM(addr1, addr2) memset(MEMORY_attrib + (addr1), MEMORY_ROM, (addr2) - (addr1) + 1)
 #define MEMORY_SetHARDWARE(addr1, addr2) memset(MEMORY_attrib + (addr1), MEMORY_HARDWARE, (addr2) - (addr1) + 1)
+#endif /* MEMORY_TRACK_WRITES */
 
 #else /* PAGED_ATTRIB */
 
 typedef UBYTE (*MEMORY_rdfunc)(UWORD addr, int no_side_effects);
 typedef void (*MEMORY_wrfunc)(UWORD addr, UBYTE value);
-extern MEMORY_rdfunc MEMORY_readmap[256];
+extern THREAD_LOCAL MEMORY_rdfunc MEMORY_readmap[256];
 extern MEMORY_rdfunc MEMORY_safe_readmap[256];
-extern MEMORY_wrfunc MEMORY_writemap[256];
+extern THREAD_LOCAL MEMORY_wrfunc MEMORY_writemap[256];
 void MEMORY_ROM_PutByte(UWORD addr, UBYTE byte);
 /* Reads a byte from ADDR. Can potentially have side effects, when reading
    from hardware area. */
 #define MEMORY_GetByte(addr)		(MEMORY_readmap[(addr) >> 8] ? (*MEMORY_readmap[(addr) >> 8])(addr, FALSE) : MEMORY_mem[addr])
 /* Reads a byte from ADDR, but without any side effects. */
 #define MEMORY_SafeGetByte(addr)		(MEMORY_readmap[(addr) >> 8] ? (*MEMORY_readmap[(addr) >> 8])(addr, TRUE) : MEMORY_mem[addr])
-#define MEMORY_PutByte(addr,byte)	(MEMORY_writemap[(addr) >> 8] ? ((*MEMORY_writemap[(addr) >> 8])(addr, byte), 0) : (MEMORY_mem[addr] = byte))
+#define MEMORY_PutByte(addr,byte)	(MEMORY_writemap[(addr) >> 8] ? ((*MEMORY_writemap[(addr) >> 8])(addr, byte), 0) : (MEMORY_dPutByte(addr, byte)))
 #define MEMORY_SetRAM(addr1, addr2) do { \
 		int i; \
 		for (i = (addr1) >> 8; i <= (addr2) >> 8; i++) { \
@@ -94,15 +137,15 @@ void MEMORY_ROM_PutByte(UWORD addr, UBYTE byte);
 
 #endif /* PAGED_ATTRIB */
 
-extern UBYTE MEMORY_basic[8192];
-extern UBYTE MEMORY_os[16384];
-extern UBYTE MEMORY_xegame[8192];
+extern THREAD_LOCAL UBYTE MEMORY_basic[8192];
+extern THREAD_LOCAL UBYTE MEMORY_os[16384];
+extern THREAD_LOCAL UBYTE MEMORY_xegame[8192];
 
-extern int MEMORY_xe_bank;
-extern int MEMORY_selftest_enabled;
+extern THREAD_LOCAL int MEMORY_xe_bank;
+extern THREAD_LOCAL int MEMORY_selftest_enabled;
 
-extern int MEMORY_have_basic;
-extern int MEMORY_cartA0BF_enabled;
+extern THREAD_LOCAL int MEMORY_have_basic;
+extern THREAD_LOCAL int MEMORY_cartA0BF_enabled;
 
 /* Verifies if SIZE is a correct value for RAM size. */
 int MEMORY_SizeValid(int size);
@@ -116,16 +159,16 @@ void MEMORY_Cart809fDisable(void);
 void MEMORY_Cart809fEnable(void);
 void MEMORY_CartA0bfDisable(void);
 void MEMORY_CartA0bfEnable(void);
-#define MEMORY_CopyROM(addr1, addr2, src) memcpy(MEMORY_mem + (addr1), src, (addr2) - (addr1) + 1)
+#define MEMORY_CopyROM(addr1, addr2, src) (MEMORY_MarkDirtyRange(addr1, (addr2) - (addr1) + 1), memcpy(MEMORY_mem + (addr1), src, (addr2) - (addr1) + 1))
 void MEMORY_GetCharset(UBYTE *cs);
 
 /* Mosaic and Axlon 400/800 RAM extensions */
-extern int MEMORY_mosaic_num_banks;
-extern int MEMORY_axlon_0f_mirror;
-extern int MEMORY_axlon_num_banks;
+extern THREAD_LOCAL int MEMORY_mosaic_num_banks;
+extern THREAD_LOCAL int MEMORY_axlon_0f_mirror;
+extern THREAD_LOCAL int MEMORY_axlon_num_banks;
 
 /* Controls presence of MapRAM memory modification for XL/XE mode. */
-extern int MEMORY_enable_mapram;
+extern THREAD_LOCAL int MEMORY_enable_mapram;
 
 #ifndef PAGED_MEM
 /* Reads a byte from the specified special address (not RAM or ROM). */
@@ -23,7 +23,9 @@
 */
 
 #include "config.h"
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 #ifdef ASAP /* external project, see http://asap.sf.net */
@@ -36,6 +38,7 @@
 #include "remez.h"
 #include "antic.h"
 #include "gtia.h"
+#include "util.h"
 
 #define CONSOLE_VOL 8
 #ifdef NONLINEAR_MIXING
@@ -69,12 +72,12 @@ static const double pokeymix[61+CONSOLE_VOL] = { /* Nonlinear POKEY mixing array
 # define M_PI 3.141592653589793
 #endif
 
-static int num_cur_pokeys = 0;
+static THREAD_LOCAL int num_cur_pokeys = 0;
 
 /* Filter */
-static int pokey_frq; /* Hz - for easier resampling */
-static int filter_size;
-static double filter_data[SND_FILTER_SIZE];
+static THREAD_LOCAL int pokey_frq; /* Hz - for easier resampling */
+static THREAD_LOCAL int filter_size;
+static THREAD_LOCAL double filter_data[SND_FILTER_SIZE];
 static int audible_frq;
 
 static const int pokey_frq_ideal =  1789790; /* Hz - True */
@@ -95,10 +98,10 @@ static const int filter_size_8_8 = 1214;
 static int snd_quality = 0;
 
 /* Poly tables */
-static int poly4tbl[15];
-static int poly5tbl[31];
-static unsigned char poly17tbl[131071];
-static int poly9tbl[511];
+static THREAD_LOCAL int poly4tbl[15];
+static THREAD_LOCAL int poly5tbl[31];
+static THREAD_LOCAL unsigned char poly17tbl[131071];
+static THREAD_LOCAL int poly9tbl[511];
 
 
 struct stPokeyState;
@@ -264,12 +267,10 @@ typedef struct stPokeyState
 
 } PokeyState;
 
-PokeyState pokey_states[NPOKEYS];
+THREAD_LOCAL PokeyState pokey_states[NPOKEYS];
 
-static struct {
-    double s16;
-    double s8;
-} volume;
+/* Full scale of the mixing bus, scaled by POKEYSND_volume */
+static THREAD_LOCAL double volume;
 
 /* Forward declarations for ResetPokeyState */
 
@@ -1154,6 +1155,282 @@ static double generate_sample(PokeyState* ps)
     return read_resam_all(ps);
 }
 
+/* Filter design cache
+
+   REMEZ_CreateFilter takes several milliseconds, and the same filter is
+   designed again on every sound initialisation. A designed filter only
+   depends on the number of taps, the band edges and the stopband weight,
+   so it is looked up by these, first among the filters designed by this
+   process, then among the filters for the common playback rates baked into
+   mzpokeysnd_filters.h, and then in a cache file in the home directory.
+   Only filters not found anywhere are designed, and they are added to the
+   cache file unless MZPOKEYSND_save_filters is FALSE.
+
+   The cache file has a header line and then one line for each filter: the
+   number of taps, the band edges, the stopband weight and the taps. A line
+   that is cut short or has the wrong number of taps is ignored, and
+   dropped when the file is next written. The file is rewritten under a
+   temporary name and renamed into place, so that processes saving filters
+   at the same time cannot mix up their lines; a filter lost that way is
+   just designed and saved again later. */
+
+typedef struct {
+    int numtaps;
+    double band_pass;   /* passband edge */
+    double band_stop;   /* stopband edge */
+    double weight;      /* stopband weight */
+    const double *h;
+} mz_filter_t;
+
+#include "mzpokeysnd_filters.h"
+
+#ifndef DEFAULT_FILTER_CACHE_NAME
+#define DEFAULT_FILTER_CACHE_NAME ".atari800.filters"
+#endif
+
+#define FILTER_CACHE_HEADER "Atari800 REMEZ filter cache 1"
+
+typedef struct filter_cache_entry {
+    mz_filter_t filter;
+    struct filter_cache_entry *next;
+} filter_cache_entry;
+
+static THREAD_LOCAL filter_cache_entry *filter_cache = NULL;
+
+int MZPOKEYSND_save_filters = TRUE;
+
+#ifdef MZPOKEYSND_PRINT_FILTERS
+/* Set while printing the filters for mzpokeysnd_filters.h */
+static int printing_filters = FALSE;
+#endif
+
+static int filter_matches(const mz_filter_t *f, int numtaps, const double bands[], double weight)
+{
+    return f->numtaps == numtaps && f->band_pass == bands[1]
+        && f->band_stop == bands[2] && f->weight == weight;
+}
+
+/* Returns the name of the cache file in buf, or FALSE if there is no
+   home directory to keep it in. */
+static int filter_cache_filename(char *buf)
+{
+    const char *home = getenv("HOME");
+    if (home == NULL)
+        return FALSE;
+    Util_catpath(buf, home, DEFAULT_FILTER_CACHE_NAME);
+    return TRUE;
+}
+
+/* Reads a number of the current line of the cache file. Returns FALSE at
+   the end of the line or if there is no number. */
+static int filter_cache_read_number(FILE *fp, double *x)
+{
+    int c;
+    do
+        c = fgetc(fp);
+    while (c == ' ' || c == '\t');
+    if (c == EOF)
+        return FALSE;
+    ungetc(c, fp);
+    return c != '\n' && fscanf(fp, "%lf", x) == 1;
+}
+
+/* Reads the next line of the cache file into f, and its taps into h, which
+   must hold SND_FILTER_SIZE taps. Returns -1 at the end of the file, FALSE
+   if the line is damaged and TRUE otherwise. The whole line is consumed. */
+static int filter_cache_read(FILE *fp, mz_filter_t *f, double h[])
+{
+    double numtaps;
+    int ok;
+    int c;
+    int i;
+
+    c = fgetc(fp);
+    if (c == EOF)
+        return -1;
+    ungetc(c, fp);
+    ok = filter_cache_read_number(fp, &numtaps)
+      && numtaps >= 1 && numtaps <= SND_FILTER_SIZE && numtaps == (int) numtaps
+      && filter_cache_read_number(fp, &f->band_pass)
+      && filter_cache_read_number(fp, &f->band_stop)
+      && filter_cache_read_number(fp, &f->weight);
+    if (ok) {
+        f->numtaps = (int) numtaps;
+        for (i = 0; ok && i < f->numtaps; i++)
+            ok = filter_cache_read_number(fp, &h[i]);
+    }
+    f->h = h;
+    /* the taps must end the line */
+    do
+        c = fgetc(fp);
+    while (c == ' ' || c == '\t' || c == '\r');
+    if (c != '\n') {
+        ok = FALSE;
+        while (c != '\n' && c != EOF)
+            c = fgetc(fp);
+    }
+    return ok;
+}
+
+/* Opens the cache file and skips its header. Returns NULL if there is no
+   cache file or it has a different format. */
+static FILE *filter_cache_open(const char *filename)
+{
+    char header[64];
+    FILE *fp = fopen(filename, "r");
+    if (fp == NULL)
+        return NULL;
+    if (fgets(header, sizeof(header), fp) == NULL
+     || strncmp(header, FILTER_CACHE_HEADER, strlen(FILTER_CACHE_HEADER)) != 0) {
+        fclose(fp);
+        return NULL;
+    }
+    return fp;
+}
+
+static void filter_cache_write(FILE *fp, const double h[], int numtaps, double band_pass, double band_stop, double weight)
+{
+    int i;
+    /* 17 significant digits read back as the same doubles */
+    fprintf(fp, "%d %.17g %.17g %.17g", numtaps, band_pass, band_stop, weight);
+    for (i = 0; i < numtaps; i++)
+        fprintf(fp, " %.17g", h[i]);
+    fputc('\n', fp);
+}
+
+/* Reads the filter into h from the cache file. Returns FALSE if not found. */
+static int filter_cache_load(double h[], int numtaps, const double bands[], double weight)
+{
+    char filename[FILENAME_MAX];
+    FILE *fp;
+    mz_filter_t f;
+    double *taps;
+    int result;
+    int found = FALSE;
+
+    if (!filter_cache_filename(filename))
+        return FALSE;
+    fp = filter_cache_open(filename);
+    if (fp == NULL)
+        return FALSE;
+    taps = (double *) Util_malloc(SND_FILTER_SIZE * sizeof(double));
+    while ((result = filter_cache_read(fp, &f, taps)) >= 0) {
+        if (result && filter_matches(&f, numtaps, bands, weight)) {
+            memcpy(h, taps, numtaps * sizeof(double));
+            found = TRUE;
+            break;
+        }
+    }
+    free(taps);
+    fclose(fp);
+    return found;
+}
+
+/* Adds the filter to the cache file, with the intact filters already in it */
+static void filter_cache_save(const double h[], int numtaps, const double bands[], double weight)
+{
+    char filename[FILENAME_MAX];
+    char tmpname[FILENAME_MAX];
+    FILE *in;
+    FILE *out;
+    mz_filter_t f;
+    double *taps;
+    int result;
+    int ok;
+
+    if (!MZPOKEYSND_save_filters || !filter_cache_filename(filename))
+        return;
+    out = Util_uniqopen_beside(tmpname, filename, "w");
+    if (out == NULL)
+        return;
+    fprintf(out, "%s\n", FILTER_CACHE_HEADER);
+    in = filter_cache_open(filename);
+    if (in != NULL) {
+        taps = (double *) Util_malloc(SND_FILTER_SIZE * sizeof(double));
+        while ((result = filter_cache_read(in, &f, taps)) >= 0) {
+            if (result && !filter_matches(&f, numtaps, bands, weight))
+                filter_cache_write(out, taps, f.numtaps, f.band_pass, f.band_stop, f.weight);
+        }
+        free(taps);
+        fclose(in);
+    }
+    filter_cache_write(out, h, numtaps, bands[1], bands[2], weight);
+    ok = !ferror(out);
+    ok = fclose(out) == 0 && ok;
+#ifdef HAVE_WINDOWS_H
+    /* rename does not replace an existing file there */
+    if (ok)
+        remove(filename);
+#endif
+    if (!ok || rename(tmpname, filename) != 0)
+        remove(tmpname);
+}
+
+#ifdef MZPOKEYSND_PRINT_FILTERS
+static mz_filter_t printed_filters[16];
+static int num_printed_filters = 0;
+
+static void print_filter(const double h[], int numtaps, const double bands[], double weight)
+{
+    mz_filter_t *f = &printed_filters[num_printed_filters];
+    int i;
+    for (i = 0; i < num_printed_filters; i++)
+        if (filter_matches(&printed_filters[i], numtaps, bands, weight))
+            return;
+    f->numtaps = numtaps;
+    f->band_pass = bands[1];
+    f->band_stop = bands[2];
+    f->weight = weight;
+    printf("static const double filter_%d[] = {", num_printed_filters++);
+    for (i = 0; i < numtaps; i++)
+        printf("%s%.17g,", i % 4 == 0 ? "\n\t" : " ", h[i]);
+    printf("\n};\n\n");
+}
+#endif
+
+/* REMEZ_CreateFilter for a lowpass filter with bands 0..bands[1] and
+   bands[2]..bands[3] */
+static void design_filter(double h[], int numtaps, double bands[],
+                          const double desired[], const double weights[])
+{
+    filter_cache_entry *entry;
+    int i;
+
+#ifdef MZPOKEYSND_PRINT_FILTERS
+    if (printing_filters) {
+        REMEZ_CreateFilter(h, numtaps, 2, bands, desired, weights, REMEZ_BANDPASS);
+        print_filter(h, numtaps, bands, weights[1]);
+        return;
+    }
+#endif
+    for (entry = filter_cache; entry != NULL; entry = entry->next) {
+        if (filter_matches(&entry->filter, numtaps, bands, weights[1])) {
+            memcpy(h, entry->filter.h, numtaps * sizeof(double));
+            return;
+        }
+    }
+    for (i = 0; i < (int) (sizeof(baked_filters) / sizeof(baked_filters[0])); i++) {
+        if (filter_matches(&baked_filters[i], numtaps, bands, weights[1])) {
+            memcpy(h, baked_filters[i].h, numtaps * sizeof(double));
+            return;
+        }
+    }
+    if (!filter_cache_load(h, numtaps, bands, weights[1])) {
+        REMEZ_CreateFilter(h, numtaps, 2, bands, desired, weights, REMEZ_BANDPASS);
+        filter_cache_save(h, numtaps, bands, weights[1]);
+    }
+
+    entry = (filter_cache_entry *) Util_malloc(sizeof(filter_cache_entry));
+    entry->filter.numtaps = numtaps;
+    entry->filter.band_pass = bands[1];
+    entry->filter.band_stop = bands[2];
+    entry->filter.weight = weights[1];
+    entry->filter.h = (double *) Util_malloc(numtaps * sizeof(double));
+    memcpy((double *) entry->filter.h, h, numtaps * sizeof(double));
+    entry->next = filter_cache;
+    filter_cache = entry;
+}
+
 /******************************************
  filter table generator by Krzysztof Nikiel
  ******************************************/
@@ -1230,7 +1507,7 @@ found:
 
   bands[1] *= (double)interlevel;
   bands[2] *= (double)interlevel;
-  REMEZ_CreateFilter(filter_data, (size / interlevel) + 1, 2, bands, desired, weights, REMEZ_BANDPASS);
+  design_filter(filter_data, (size / interlevel) + 1, bands, desired, weights);
   for (i = size - interlevel; i >= 0; i -= interlevel)
   {
     int s;
@@ -1258,8 +1535,34 @@ found:
   return size;
 }
 
-static void mzpokeysnd_process_8(void* sndbuffer, int sndn);
-static void mzpokeysnd_process_16(void* sndbuffer, int sndn);
+#ifdef MZPOKEYSND_PRINT_FILTERS
+/* Prints mzpokeysnd_filters.h: the filters for the common playback rates
+   at all qualities. 8000 Hz is left out as REMEZ_CreateFilter fails for
+   its parameters. */
+static void print_baked_filters(void)
+{
+    static const int rates[] = {11025, 22050, 44100, 48000};
+    double cutoff;
+    int i, quality;
+
+    printing_filters = TRUE;
+    printf("/* Filters for the common playback rates, see design_filter in mzpokeysnd.c.\n"
+           "   Generated by MZPOKEYSND_Init built with -DMZPOKEYSND_PRINT_FILTERS. */\n\n");
+    for (i = 0; i < (int) (sizeof(rates) / sizeof(rates[0])); i++) {
+        int frq = (int)(((double)pokey_frq_ideal/rates[i]) + 0.5) * rates[i];
+        for (quality = 0; quality < 3; quality++)
+            remez_filter_table((double)rates[i]/frq, &cutoff, quality);
+    }
+    printf("static const mz_filter_t baked_filters[] = {\n");
+    for (i = 0; i < num_printed_filters; i++)
+        printf("\t{%d, %.17g, %.17g, %.17g, filter_%d},\n", printed_filters[i].numtaps,
+               printed_filters[i].band_pass, printed_filters[i].band_stop, printed_filters[i].weight, i);
+    printf("};\n");
+    fflush(stdout);
+}
+#endif
+
+static void mzpokeysnd_process_f(float* bus, int sndn);
 static void Update_pokey_sound_mz(UWORD addr, UBYTE val, UBYTE chip, UBYTE gain);
 #ifdef SERIO_SOUND
 static void Update_serio_sound_mz(int out, UBYTE data);
@@ -1308,6 +1611,11 @@ int MZPOKEYSND_Init(ULONG freq17, int playback_freq, UBYTE num_pokeys,
 {
     double cutoff;
 
+#ifdef MZPOKEYSND_PRINT_FILTERS
+    print_baked_filters();
+    exit(0);
+#endif
+
     snd_quality = quality;
 
     POKEYSND_Update_ptr = Update_pokey_sound_mz;
@@ -1325,7 +1633,7 @@ int MZPOKEYSND_Init(ULONG freq17, int playback_freq, UBYTE num_pokeys,
 	POKEYSND_samp_freq=playback_freq;
 #endif  /* VOL_ONLY_SOUND */
 
-	POKEYSND_Process_ptr = (flags & POKEYSND_BIT16) ? mzpokeysnd_process_16 : mzpokeysnd_process_8;
+	POKEYSND_Process_ptr = mzpokeysnd_process_f;
 
     switch(playback_freq)
     {
@@ -1426,8 +1734,7 @@ int MZPOKEYSND_Init(ULONG freq17, int playback_freq, UBYTE num_pokeys,
 #ifdef SYNCHRONIZED_SOUND
 	init_syncsound();
 #endif
-        volume.s8 = POKEYSND_volume * 0xff / 256.0;
-        volume.s16 = POKEYSND_volume * 0xffff / 256.0;
+        volume = POKEYSND_volume * 0xffff / 256.0 / 32768.0;
 
 	return 0; /* OK */
 }
@@ -2316,60 +2623,11 @@ void mzpokeysnd_debugreset(UBYTE chip)
 
 #define MAX_SAMPLE 152
 
-static void mzpokeysnd_process_8(void* sndbuffer, int sndn)
-{
-    int i;
-    int nsam = sndn;
-    UBYTE *buffer = (UBYTE *) sndbuffer;
-
-    if(num_cur_pokeys<1)
-        return; /* module was not initialized */
-
-    /* if there are two pokeys, then the signal is stereo
-       we assume even sndn */
-    while(nsam >= (int) num_cur_pokeys)
-    {
-#ifdef VOL_ONLY_SOUND
-        if( POKEYSND_sampbuf_rptr!=POKEYSND_sampbuf_ptr )
-            { int l;
-            if( POKEYSND_sampbuf_cnt[POKEYSND_sampbuf_rptr]>0 )
-                POKEYSND_sampbuf_cnt[POKEYSND_sampbuf_rptr]-=1280;
-            while(  (l=POKEYSND_sampbuf_cnt[POKEYSND_sampbuf_rptr])<=0 )
-                {	POKEYSND_sampout=POKEYSND_sampbuf_val[POKEYSND_sampbuf_rptr];
-                        POKEYSND_sampbuf_rptr++;
-                        if( POKEYSND_sampbuf_rptr>=POKEYSND_SAMPBUF_MAX )
-                                POKEYSND_sampbuf_rptr=0;
-                        if( POKEYSND_sampbuf_rptr!=POKEYSND_sampbuf_ptr )
-                            {
-                            POKEYSND_sampbuf_cnt[POKEYSND_sampbuf_rptr]+=l;
-                            }
-                        else	break;
-                }
-            }
-#endif
-
-#ifdef VOL_ONLY_SOUND
-        buffer[0] = (UBYTE)floor((generate_sample(pokey_states) + POKEYSND_sampout)
-         * (255.0 / 2 / MAX_SAMPLE / 4 * M_PI * 0.95) + 128 + 0.5 + 0.5 * rand() / RAND_MAX - 0.25);
-#else
-        buffer[0] = (UBYTE)floor(generate_sample(pokey_states)
-         * (255.0 / 2 / MAX_SAMPLE / 4 * M_PI * 0.95) + 128 + 0.5 + 0.5 * rand() / RAND_MAX - 0.25);
-#endif
-        for(i=1; i<num_cur_pokeys; i++)
-        {
-            buffer[i] = (UBYTE)floor(generate_sample(pokey_states + i)
-             * (255.0 / 2 / MAX_SAMPLE / 4 * M_PI * 0.95) + 128 + 0.5 + 0.5 * rand() / RAND_MAX - 0.25);
-        }
-        buffer += num_cur_pokeys;
-        nsam -= num_cur_pokeys;
-    }
-}
-
-static void mzpokeysnd_process_16(void* sndbuffer, int sndn)
+static void mzpokeysnd_process_f(float* bus, int sndn)
 {
     int i;
     int nsam = sndn;
-    SWORD *buffer = (SWORD *) sndbuffer;
+    float *buffer = bus;
 
     if(num_cur_pokeys<1)
         return; /* module was not initialized */
@@ -2396,17 +2654,18 @@ static void mzpokeysnd_process_16(void* sndbuffer, int sndn)
                 }
             }
 #endif
+        /* the dither is added when the bus is converted to the output format */
 #ifdef VOL_ONLY_SOUND
-        buffer[0] = (SWORD)floor((generate_sample(pokey_states) + POKEYSND_sampout)
-         * (65535.0 / 2 / MAX_SAMPLE / 4 * M_PI * 0.95) + 0.5 + 0.5 * rand() / RAND_MAX - 0.25);
+        buffer[0] = (float)((generate_sample(pokey_states) + POKEYSND_sampout)
+         * (volume / 2 / MAX_SAMPLE / 4 * M_PI * 0.95));
 #else
-        buffer[0] = (SWORD)floor(generate_sample(pokey_states)
-         * (65535.0 / 2 / MAX_SAMPLE / 4 * M_PI * 0.95) + 0.5 + 0.5 * rand() / RAND_MAX - 0.25);
+        buffer[0] = (float)(generate_sample(pokey_states)
+         * (volume / 2 / MAX_SAMPLE / 4 * M_PI * 0.95));
 #endif
         for(i=1; i<num_cur_pokeys; i++)
         {
-            buffer[i] = (SWORD)floor(generate_sample(pokey_states + i)
-             * (65535.0 / 2 / MAX_SAMPLE / 4 * M_PI * 0.95) + 0.5 + 0.5 * rand() / RAND_MAX - 0.25);
+            buffer[i] = (float)(generate_sample(pokey_states + i)
+             * (volume / 2 / MAX_SAMPLE / 4 * M_PI * 0.95));
         }
         buffer += num_cur_pokeys;
         nsam -= num_cur_pokeys;
@@ -2418,13 +2677,13 @@ static void generate_sync(unsigned int num_ticks)
 {
 	double new_samp_pos;
 	unsigned int ticks;
-	UBYTE *buffer = POKEYSND_process_buffer + POKEYSND_process_buffer_fill;
-	UBYTE *buffer_end = POKEYSND_process_buffer + POKEYSND_process_buffer_length;
+	float *buffer = POKEYSND_process_bus + POKEYSND_process_buffer_fill;
+	float *buffer_end = POKEYSND_process_bus + POKEYSND_process_buffer_length;
 	unsigned int i;
 
 	for (;;) {
 		double int_part;
-		new_samp_pos = samp_pos + ticks_per_sample;
+		new_samp_pos = samp_pos + ticks_per_sample * POKEYSND_resample_ratio;
 		new_samp_pos = modf(new_samp_pos, &int_part);
 		ticks = (unsigned int)int_part;
 		if (ticks > num_ticks) {
@@ -2440,24 +2699,12 @@ static void generate_sync(unsigned int num_ticks)
 		for (i = 0; i < num_cur_pokeys; ++i) {
 			/* advance pokey to the new position and produce a sample */
 			advance_ticks(pokey_states + i, ticks);
-			if (POKEYSND_snd_flags & POKEYSND_BIT16) {
-				*((SWORD *)buffer) = (SWORD)floor(
-					interp_read_resam_all(pokey_states + i, samp_pos)
-					* (volume.s16 / 2 / MAX_SAMPLE / 4 * M_PI * 0.95)
-					+ 0.5 + 0.5 * rand() / RAND_MAX - 0.25
-				);
-				buffer += 2;
-			}
-			else
-				*buffer++ = (UBYTE)floor(
-					interp_read_resam_all(pokey_states + i, samp_pos)
-					* (volume.s8 / 2 / MAX_SAMPLE / 4 * M_PI * 0.95)
-					+ 128 + 0.5 + 0.5 * rand() / RAND_MAX - 0.25
-				);
+			*buffer++ = (float)(interp_read_resam_all(pokey_states + i, samp_pos)
+				* (volume / 2 / MAX_SAMPLE / 4 * M_PI * 0.95));
 		}
 	}
 
-	POKEYSND_process_buffer_fill = buffer - POKEYSND_process_buffer;
+	POKEYSND_process_buffer_fill = buffer - POKEYSND_process_bus;
 	if (num_ticks > 0) {
 		/* remaining ticks */
 		for (i = 0; i < num_cur_pokeys; ++i)
@@ -2512,8 +2759,8 @@ static void Update_consol_sound_mz( int set )
 		pokey_states[0].forcero = 1; /* first chip */
 	}
 #elif defined(VOL_ONLY_SOUND)
-	static int prev_atari_speaker=0;
-	static unsigned int prev_cpu_clock=0;
+	static THREAD_LOCAL int prev_atari_speaker=0;
+	static THREAD_LOCAL unsigned int prev_cpu_clock=0;
 	int d;
 
 	if( !set && POKEYSND_samp_consol_val==0 )	return;
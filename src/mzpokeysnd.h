@@ -3,6 +3,10 @@
 
 #include "atari.h"
 
+/* Set to FALSE to keep designed filters out of the cache file in the home
+   directory; the file is still read. */
+extern int MZPOKEYSND_save_filters;
+
 int MZPOKEYSND_Init(ULONG freq17,
                         int playback_freq,
                         UBYTE num_pokeys,
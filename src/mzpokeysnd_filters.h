@@ -0,0 +1,505 @@
+/* Filters for the common playback rates, see design_filter in mzpokeysnd.c.
+   Generated by MZPOKEYSND_Init built with -DMZPOKEYSND_PRINT_FILTERS. */
+
+static const double filter_0[] = {
+	0.0064809763773755079, 0.00076423463830297648, 0.00080275503055413891, 0.00083933006734875863,
+	0.00087135489634063298, 0.00090072834158201566, 0.000924466648790864, 0.00094448584679834966,
+	0.00095807629391252201, 0.00096682210471953978, 0.00096835565303707684, 0.00096441817863515071,
+	0.00095245489151257507, 0.00093460814860914058, 0.00090812840684850315, 0.00087543884532245199,
+	0.00083371078014898186, 0.00078546330945713702, 0.00072763051008471389, 0.00066292741669745237,
+	0.00058779290234348201, 0.00050546457314334145, 0.00041206853325916, 0.00031168110903605602,
+	0.00020068408509940267, 8.4081151411514264e-05, -4.1932131664462262e-05, -0.00017114304788723201,
+	-0.00031135039660554361, -0.00045554911465356575, -0.00062101892513359341, -0.00077782210932061404,
+	-0.00093906360043711048, -0.0011161239069172027, -0.0012887816010049907, -0.0014703512937800712,
+	-0.0016512809102971419, -0.0018369540373843038, -0.0020218118439951373, -0.0022086618130377645,
+	-0.0023934473934651822, -0.002577991948971391, -0.0027586496605898716, -0.0029366128481154688,
+	-0.0031086178394023113, -0.0032753291385886614, -0.003434015995749841, -0.0035850269680916444,
+	-0.0037259783425998981, -0.0038570805342037513, -0.0039759720822463134, -0.0040825538977206782,
+	-0.0041745460697459619, -0.0042513246481325128, -0.0043112776354223411, -0.0043536602563332685,
+	-0.0043775747872259532, -0.0043831422158302586, -0.0043680953802968069, -0.0043319838457293088,
+	-0.0042717167921140862, -0.0041889550468225886, -0.0040861016551792901, -0.0039542004691656652,
+	-0.0038002372106107369, -0.0036200273232346557, -0.003414100531923433, -0.0031822311377830681,
+	-0.0029239917705348069, -0.0026396147143161477, -0.0023288420769191631, -0.0019917723995342153,
+	-0.001628508267439687, -0.0012394030216565425, -0.00082473447992355568, -0.00038530723185902264,
+	7.8485021761736352e-05, 0.00056559367278313723, 0.0010754351322927978, 0.0016069165743649054,
+	0.0021593142533953302, 0.0027312282665297983, 0.0033218967655482311, 0.0039292359942736128,
+	0.0045524439377755375, 0.0051892945735687269, 0.005838615548048284, 0.0064994435571455785,
+	0.007169257441346338, 0.0078463887994108545, 0.0085288798804755341, 0.0092143552225451945,
+	0.009903315433965474, 0.010590603715336943, 0.011275826366597881, 0.011957755671901675,
+	0.012632257733502713, 0.013299185286854642, 0.013955145805837845, 0.014599251027359114,
+	0.015228789050035276, 0.015842327334716806, 0.016437386329642433, 0.017012590367268588,
+	0.017565510644983663, 0.018094953010284687, 0.018598679999618398, 0.019075530053637671,
+	0.019523588545309976, 0.019941726502065077, 0.020328176909120907, 0.020682045989949393,
+	0.021001638257612847, 0.021286373554077094, 0.021535097459820511, 0.021746924504936083,
+	0.021921831434107461, 0.022057628954505134, 0.022155181479272458, 0.022214102554992021,
+	0.022233329240157987, 0.022214102554992021, 0.022155181479272458, 0.022057628954505134,
+	0.021921831434107461, 0.021746924504936083, 0.021535097459820511, 0.021286373554077094,
+	0.021001638257612847, 0.020682045989949393, 0.020328176909120907, 0.019941726502065077,
+	0.019523588545309976, 0.019075530053637671, 0.018598679999618398, 0.018094953010284687,
+	0.017565510644983663, 0.017012590367268588, 0.016437386329642433, 0.015842327334716806,
+	0.015228789050035276, 0.014599251027359114, 0.013955145805837845, 0.013299185286854642,
+	0.012632257733502713, 0.011957755671901675, 0.011275826366597881, 0.010590603715336943,
+	0.009903315433965474, 0.0092143552225451945, 0.0085288798804755341, 0.0078463887994108545,
+	0.007169257441346338, 0.0064994435571455785, 0.005838615548048284, 0.0051892945735687269,
+	0.0045524439377755375, 0.0039292359942736128, 0.0033218967655482311, 0.0027312282665297983,
+	0.0021593142533953302, 0.0016069165743649054, 0.0010754351322927978, 0.00056559367278313723,
+	7.8485021761736352e-05, -0.00038530723185902264, -0.00082473447992355568, -0.0012394030216565425,
+	-0.001628508267439687, -0.0019917723995342153, -0.0023288420769191631, -0.0026396147143161477,
+	-0.0029239917705348069, -0.0031822311377830681, -0.003414100531923433, -0.0036200273232346557,
+	-0.0038002372106107369, -0.0039542004691656652, -0.0040861016551792901, -0.0041889550468225886,
+	-0.0042717167921140862, -0.0043319838457293088, -0.0043680953802968069, -0.0043831422158302586,
+	-0.0043775747872259532, -0.0043536602563332685, -0.0043112776354223411, -0.0042513246481325128,
+	-0.0041745460697459619, -0.0040825538977206782, -0.0039759720822463134, -0.0038570805342037513,
+	-0.0037259783425998981, -0.0035850269680916444, -0.003434015995749841, -0.0032753291385886614,
+	-0.0031086178394023113, -0.0029366128481154688, -0.0027586496605898716, -0.002577991948971391,
+	-0.0023934473934651822, -0.0022086618130377645, -0.0020218118439951373, -0.0018369540373843038,
+	-0.0016512809102971419, -0.0014703512937800712, -0.0012887816010049907, -0.0011161239069172027,
+	-0.00093906360043711048, -0.00077782210932061404, -0.00062101892513359341, -0.00045554911465356575,
+	-0.00031135039660554361, -0.00017114304788723201, -4.1932131664462262e-05, 8.4081151411514264e-05,
+	0.00020068408509940267, 0.00031168110903605602, 0.00041206853325916, 0.00050546457314334145,
+	0.00058779290234348201, 0.00066292741669745237, 0.00072763051008471389, 0.00078546330945713702,
+	0.00083371078014898186, 0.00087543884532245199, 0.00090812840684850315, 0.00093460814860914058,
+	0.00095245489151257507, 0.00096441817863515071, 0.00096835565303707684, 0.00096682210471953978,
+	0.00095807629391252201, 0.00094448584679834966, 0.000924466648790864, 0.00090072834158201566,
+	0.00087135489634063298, 0.00083933006734875863, 0.00080275503055413891, 0.00076423463830297648,
+	0.0064809763773755079,
+};
+
+static const double filter_1[] = {
+	-0.00023463918619088395, -0.00013464003866877757, -0.00017040759492001153, -0.00021010568181041402,
+	-0.00025326078469718109, -0.00029938251910185953, -0.00034768117691961619, -0.00039738016283915651,
+	-0.00044738450134169981, -0.00049657278551375975, -0.00054349564124122956, -0.00058668760504107628,
+	-0.00062441719838720949, -0.00065503656577357264, -0.00067671476743762498, -0.00068776730996804097,
+	-0.00068629024739246046, -0.00067058540114170993, -0.00063888163251287367, -0.00058987747749692713,
+	-0.00052229352524424768, -0.00043522972597101266, -0.00032768308981375252, -0.00019943526818937788,
+	-5.0594146714579718e-05, 0.00011800708019293973, 0.00030618985963669739, 0.00051174271977274405,
+	0.00073287424022685328, 0.00096731836655045199, 0.0012115967246657258, 0.0014625359521190245,
+	0.0017158424719966134, 0.0019672650965929443, 0.0022118256489153617, 0.0024444634052360947,
+	0.0026596770987747792, 0.002851995356277625, 0.003015781750576541, 0.0031455549059308174,
+	0.0032358692666836697, 0.003281686403690524, 0.0032783217245288092, 0.0032217541303705501,
+	0.0031084980233696646, 0.0029359019943332133, 0.0027022002926594666, 0.0024067301578631485,
+	0.0020498217970361292, 0.001632985812583206, 0.0011589889302714767, 0.00063198145640742357,
+	5.7191560232853566e-05, -0.00055870911665312814, -0.001207673879087326, -0.0018807356708348329,
+	-0.002567430045753159, -0.0032565351943269032, -0.0039357128804513855, -0.004591913592834956,
+	-0.0052114750893434694, -0.0057803145019193723, -0.0062841416113494876, -0.0067086193749890059,
+	-0.0070396617528248745, -0.0072636567846820783, -0.0073676898360299564, -0.0073397910529961908,
+	-0.0071691221806487442, -0.0068462968899158354, -0.0063635306286390653, -0.0057148107768335539,
+	-0.0048961166102740412, -0.0039055525696599811, -0.0027434690203651975, -0.0014124963728984977,
+	8.2351234392480019e-05, 0.0017336307842613266, 0.0035315679683593075, 0.0054641327878971694,
+	0.0075169807092656154, 0.0096738309868659861, 0.011916376929297208, 0.014224674025691119,
+	0.016577354505148603, 0.018951773603753622, 0.021324443394265837, 0.023671204167133978,
+	0.025967684004397435, 0.028189514564772995, 0.030312722250897598, 0.032314059914894097,
+	0.03417131550707507, 0.035863679461097399, 0.037371960322095596, 0.038678928854514141,
+	0.039769600693776927, 0.040631330667494678, 0.041254136530705157, 0.041630739206075004,
+	0.041756764288432335, 0.041630739206075004, 0.041254136530705157, 0.040631330667494678,
+	0.039769600693776927, 0.038678928854514141, 0.037371960322095596, 0.035863679461097399,
+	0.03417131550707507, 0.032314059914894097, 0.030312722250897598, 0.028189514564772995,
+	0.025967684004397435, 0.023671204167133978, 0.021324443394265837, 0.018951773603753622,
+	0.016577354505148603, 0.014224674025691119, 0.011916376929297208, 0.0096738309868659861,
+	0.0075169807092656154, 0.0054641327878971694, 0.0035315679683593075, 0.0017336307842613266,
+	8.2351234392480019e-05, -0.0014124963728984977, -0.0027434690203651975, -0.0039055525696599811,
+	-0.0048961166102740412, -0.0057148107768335539, -0.0063635306286390653, -0.0068462968899158354,
+	-0.0071691221806487442, -0.0073397910529961908, -0.0073676898360299564, -0.0072636567846820783,
+	-0.0070396617528248745, -0.0067086193749890059, -0.0062841416113494876, -0.0057803145019193723,
+	-0.0052114750893434694, -0.004591913592834956, -0.0039357128804513855, -0.0032565351943269032,
+	-0.002567430045753159, -0.0018807356708348329, -0.001207673879087326, -0.00055870911665312814,
+	5.7191560232853566e-05, 0.00063198145640742357, 0.0011589889302714767, 0.001632985812583206,
+	0.0020498217970361292, 0.0024067301578631485, 0.0027022002926594666, 0.0029359019943332133,
+	0.0031084980233696646, 0.0032217541303705501, 0.0032783217245288092, 0.003281686403690524,
+	0.0032358692666836697, 0.0031455549059308174, 0.003015781750576541, 0.002851995356277625,
+	0.0026596770987747792, 0.0024444634052360947, 0.0022118256489153617, 0.0019672650965929443,
+	0.0017158424719966134, 0.0014625359521190245, 0.0012115967246657258, 0.00096731836655045199,
+	0.00073287424022685328, 0.00051174271977274405, 0.00030618985963669739, 0.00011800708019293973,
+	-5.0594146714579718e-05, -0.00019943526818937788, -0.00032768308981375252, -0.00043522972597101266,
+	-0.00052229352524424768, -0.00058987747749692713, -0.00063888163251287367, -0.00067058540114170993,
+	-0.00068629024739246046, -0.00068776730996804097, -0.00067671476743762498, -0.00065503656577357264,
+	-0.00062441719838720949, -0.00058668760504107628, -0.00054349564124122956, -0.00049657278551375975,
+	-0.00044738450134169981, -0.00039738016283915651, -0.00034768117691961619, -0.00029938251910185953,
+	-0.00025326078469718109, -0.00021010568181041402, -0.00017040759492001153, -0.00013464003866877757,
+	-0.00023463918619088395,
+};
+
+static const double filter_2[] = {
+	0.00099441997147023441, 2.7416600004878653e-05, 6.3074541865090513e-06, -2.9684812688654087e-05,
+	-8.1414037833332797e-05, -0.00014892065228527086, -0.000232715789991158, -0.00033231969613877046,
+	-0.00044767173220610479, -0.00057756280568998532, -0.00072121418915660192, -0.00087646298764246678,
+	-0.0010417235406647055, -0.0012140579255633436, -0.0013908290767667821, -0.0015683367065188693,
+	-0.0017433010364821466, -0.0019113274995960533, -0.0020685317668672678, -0.002210035200592023,
+	-0.0023317751148485186, -0.0024288627773578547, -0.0024973706956443564, -0.0025326922139578818,
+	-0.0025318036839485632, -0.002490833414166413, -0.0024080741493678537, -0.0022808377469597848,
+	-0.0021091732648997889, -0.0018915525203069032, -0.0016302191067002953, -0.0013237004909800669,
+	-0.00097942493215455949, -0.00060032894175016907, -0.00018870007012578572, 0.00024619526415300611,
+	0.00069912428929454554, 0.0011608478906636895, 0.0016235352797773618, 0.0020769791578784278,
+	0.0025119269340261245, 0.002917583458745902, 0.0032841686209960069, 0.0036011857064249062,
+	0.0038589786988911883, 0.0040482892483037587, 0.0041609508817344425, 0.0041894515910197759,
+	0.0041279285545247589, 0.0039717479333356226, 0.0037182784281696306, 0.0033664414531734996,
+	0.0029173975968845214, 0.002374202263049826, 0.0017424569983076894, 0.0010295491641241659,
+	0.00024546597182324291, -0.0005980295225146157, -0.0014868898961606185, -0.002405484357114197,
+	-0.0033361847107843969, -0.0042600599651222999, -0.005156617543213414, -0.0060048435495819027,
+	-0.0067843318518131628, -0.0074718925565450591, -0.0080469688650950336, -0.0084885277837358011,
+	-0.0087768572242035939, -0.0088936218360222245, -0.0088223137037663785, -0.0085486744230082838,
+	-0.0080608926051067755, -0.0073502253507715136, -0.0064105933963747117, -0.005239956827159672,
+	-0.0038392069336856899, -0.0022129480768999068, -0.00036963005708096877, 0.0016787221478752859,
+	0.0039165077834324687, 0.0063247911088483424, 0.0088813146943397814, 0.011560902687957571,
+	0.014335648709642677, 0.017175588615312657, 0.020048809166152232, 0.022922089934167642,
+	0.025761416963502932, 0.028532322149868568, 0.031200583950697809, 0.033732588200986333,
+	0.036096212276236564, 0.038260986601833406, 0.040199023873499259, 0.041884347663592218,
+	0.043294995773353301, 0.044412420802385055, 0.045221290260847632, 0.045711119232406242,
+	0.045875042274808958, 0.045711119232406242, 0.045221290260847632, 0.044412420802385055,
+	0.043294995773353301, 0.041884347663592218, 0.040199023873499259, 0.038260986601833406,
+	0.036096212276236564, 0.033732588200986333, 0.031200583950697809, 0.028532322149868568,
+	0.025761416963502932, 0.022922089934167642, 0.020048809166152232, 0.017175588615312657,
+	0.014335648709642677, 0.011560902687957571, 0.0088813146943397814, 0.0063247911088483424,
+	0.0039165077834324687, 0.0016787221478752859, -0.00036963005708096877, -0.0022129480768999068,
+	-0.0038392069336856899, -0.005239956827159672, -0.0064105933963747117, -0.0073502253507715136,
+	-0.0080608926051067755, -0.0085486744230082838, -0.0088223137037663785, -0.0088936218360222245,
+	-0.0087768572242035939, -0.0084885277837358011, -0.0080469688650950336, -0.0074718925565450591,
+	-0.0067843318518131628, -0.0060048435495819027, -0.005156617543213414, -0.0042600599651222999,
+	-0.0033361847107843969, -0.002405484357114197, -0.0014868898961606185, -0.0005980295225146157,
+	0.00024546597182324291, 0.0010295491641241659, 0.0017424569983076894, 0.002374202263049826,
+	0.0029173975968845214, 0.0033664414531734996, 0.0037182784281696306, 0.0039717479333356226,
+	0.0041279285545247589, 0.0041894515910197759, 0.0041609508817344425, 0.0040482892483037587,
+	0.0038589786988911883, 0.0036011857064249062, 0.0032841686209960069, 0.002917583458745902,
+	0.0025119269340261245, 0.0020769791578784278, 0.0016235352797773618, 0.0011608478906636895,
+	0.00069912428929454554, 0.00024619526415300611, -0.00018870007012578572, -0.00060032894175016907,
+	-0.00097942493215455949, -0.0013237004909800669, -0.0016302191067002953, -0.0018915525203069032,
+	-0.0021091732648997889, -0.0022808377469597848, -0.0024080741493678537, -0.002490833414166413,
+	-0.0025318036839485632, -0.0025326922139578818, -0.0024973706956443564, -0.0024288627773578547,
+	-0.0023317751148485186, -0.002210035200592023, -0.0020685317668672678, -0.0019113274995960533,
+	-0.0017433010364821466, -0.0015683367065188693, -0.0013908290767667821, -0.0012140579255633436,
+	-0.0010417235406647055, -0.00087646298764246678, -0.00072121418915660192, -0.00057756280568998532,
+	-0.00044767173220610479, -0.00033231969613877046, -0.000232715789991158, -0.00014892065228527086,
+	-8.1414037833332797e-05, -2.9684812688654087e-05, 6.3074541865090513e-06, 2.7416600004878653e-05,
+	0.00099441997147023441,
+};
+
+static const double filter_3[] = {
+	0.0029135568566097687, 0.0043715026305720002, 6.1685849727784233e-05, 0.0028069739490520192,
+	0.0015380324919993943, 0.0025158485116537031, 0.002185540839824677, 0.0025528212266846422,
+	0.002473778064488816, 0.0025891484736580007, 0.0025309402830669451, 0.0025023828194279726,
+	0.0023852874423559152, 0.0022448841248335922, 0.0020431432806701498, 0.0018040817356735472,
+	0.0015166324765070948, 0.0011925477419320457, 0.00083245926166042208, 0.0004456435549215574,
+	3.7192090508087332e-05, -0.00038302624012391361, -0.00080612107777917712, -0.0012235800242339201,
+	-0.0016248209345641822, -0.0020005358151387554, -0.0023406852071336222, -0.0026340929671315617,
+	-0.0028731635194964729, -0.0030465489436915624, -0.0031499715977740205, -0.0031755333543387275,
+	-0.0031225950120688851, -0.0029865854852347946, -0.0027669582962910116, -0.0024640193439511297,
+	-0.0020811322662079136, -0.0016248253933661384, -0.0011060351266568213, -0.00053248609726976709,
+	8.5444067881988324e-05, 0.00073599658647224679, 0.0014010775633582786, 0.0020632863105646709,
+	0.0027078098657929844, 0.0033212011815368257, 0.0038815537064836527, 0.0043711210695729632,
+	0.0047746837345295648, 0.0050828697394816828, 0.0052742153777980373, 0.0053397964808076896,
+	0.0052747350835387541, 0.0050710295791759454, 0.0047212052103676651, 0.0042317873261885899,
+	0.0036050645182060729, 0.0028443754350283208, 0.0019657745080408121, 0.00098253048788283386,
+	-8.8861841275178686e-05, -0.0012280518327849102, -0.0024059010962247866, -0.0036053756637745436,
+	-0.0047879769079774114, -0.0059303243762646764, -0.0069988658646305702, -0.0079634179777166719,
+	-0.0087896556440814535, -0.0094554752521823215, -0.0099219316352403553, -0.010170872895351095,
+	-0.01017424676638029, -0.0099127528827858153, -0.0093725045126633218, -0.008538869331764393,
+	-0.0074059829435851737, -0.0059721737220602587, -0.0042401218195415044, -0.0022194297446096094,
+	7.457741135282996e-05, 0.0026256345804175547, 0.0054043430071359843, 0.0083864395227924368,
+	0.011532852626446903, 0.014807089159738983, 0.018172632198676274, 0.021575737609948815,
+	0.024982377159965544, 0.028335040920894075, 0.031595346716644344, 0.034711363719801963,
+	0.037638674869860569, 0.040336085960182184, 0.042761051466168418, 0.04488088414988714,
+	0.046659273046656742, 0.048071475152736583, 0.049098202732545747, 0.049717501000278053,
+	0.049926924232862539, 0.049717501000278053, 0.049098202732545747, 0.048071475152736583,
+	0.046659273046656742, 0.04488088414988714, 0.042761051466168418, 0.040336085960182184,
+	0.037638674869860569, 0.034711363719801963, 0.031595346716644344, 0.028335040920894075,
+	0.024982377159965544, 0.021575737609948815, 0.018172632198676274, 0.014807089159738983,
+	0.011532852626446903, 0.0083864395227924368, 0.0054043430071359843, 0.0026256345804175547,
+	7.457741135282996e-05, -0.0022194297446096094, -0.0042401218195415044, -0.0059721737220602587,
+	-0.0074059829435851737, -0.008538869331764393, -0.0093725045126633218, -0.0099127528827858153,
+	-0.01017424676638029, -0.010170872895351095, -0.0099219316352403553, -0.0094554752521823215,
+	-0.0087896556440814535, -0.0079634179777166719, -0.0069988658646305702, -0.0059303243762646764,
+	-0.0047879769079774114, -0.0036053756637745436, -0.0024059010962247866, -0.0012280518327849102,
+	-8.8861841275178686e-05, 0.00098253048788283386, 0.0019657745080408121, 0.0028443754350283208,
+	0.0036050645182060729, 0.0042317873261885899, 0.0047212052103676651, 0.0050710295791759454,
+	0.0052747350835387541, 0.0053397964808076896, 0.0052742153777980373, 0.0050828697394816828,
+	0.0047746837345295648, 0.0043711210695729632, 0.0038815537064836527, 0.0033212011815368257,
+	0.0027078098657929844, 0.0020632863105646709, 0.0014010775633582786, 0.00073599658647224679,
+	8.5444067881988324e-05, -0.00053248609726976709, -0.0011060351266568213, -0.0016248253933661384,
+	-0.0020811322662079136, -0.0024640193439511297, -0.0027669582962910116, -0.0029865854852347946,
+	-0.0031225950120688851, -0.0031755333543387275, -0.0031499715977740205, -0.0030465489436915624,
+	-0.0028731635194964729, -0.0026340929671315617, -0.0023406852071336222, -0.0020005358151387554,
+	-0.0016248209345641822, -0.0012235800242339201, -0.00080612107777917712, -0.00038302624012391361,
+	3.7192090508087332e-05, 0.0004456435549215574, 0.00083245926166042208, 0.0011925477419320457,
+	0.0015166324765070948, 0.0018040817356735472, 0.0020431432806701498, 0.0022448841248335922,
+	0.0023852874423559152, 0.0025023828194279726, 0.0025309402830669451, 0.0025891484736580007,
+	0.002473778064488816, 0.0025528212266846422, 0.002185540839824677, 0.0025158485116537031,
+	0.0015380324919993943, 0.0028069739490520192, 6.1685849727784233e-05, 0.0043715026305720002,
+	0.0029135568566097687,
+};
+
+static const double filter_4[] = {
+	0.00018789013547522714, 0.00019129341235189114, 0.00027009679908368583, 0.00035216532191377118,
+	0.0004282527580934564, 0.00048660774714626241, 0.00051372790172844133, 0.00049529853696405506,
+	0.0004175936308206331, 0.00026891918062609845, 4.1484499882574805e-05, -0.00026689135109589265,
+	-0.00065121662679305879, -0.0010984389454274392, -0.0015868693243615043, -0.0020863117084406755,
+	-0.002558944814838962, -0.0029616747522956369, -0.0032489625742523893, -0.0033761484452391973,
+	-0.0033034377752941672, -0.0030010451940569419, -0.0024526220224848354, -0.0016589282885964153,
+	-0.00064163932454189396, 0.00055681482881300638, 0.001871773423912328, 0.003219578388499956,
+	0.0045007895712754851, 0.0056064403321442495, 0.0064250582219488751, 0.0068515525517162199,
+	0.0067962754975606421, 0.0061944984022354044, 0.0050146501456004942, 0.0032655420332858595,
+	0.0010011360759145118, -0.0016773594205028376, -0.0046228858600927576, -0.0076469984869878029,
+	-0.010528132052091571, -0.013022823780847667, -0.01487963196752945, -0.015854695633823006,
+	-0.015728593256512876, -0.014322245510667393, -0.011512063898441638, -0.0072422901164958973,
+	-0.0015336280623773747, 0.005512118881027565, 0.01371268575401933, 0.022810754123683965,
+	0.032484586350425136, 0.042363000208684325, 0.052044123942253204, 0.06111650122647156,
+	0.069181798097087022, 0.075876961902192272, 0.080895104492792552, 0.084003210281868024,
+	0.085055752381459168, 0.084003210281868024, 0.080895104492792552, 0.075876961902192272,
+	0.069181798097087022, 0.06111650122647156, 0.052044123942253204, 0.042363000208684325,
+	0.032484586350425136, 0.022810754123683965, 0.01371268575401933, 0.005512118881027565,
+	-0.0015336280623773747, -0.0072422901164958973, -0.011512063898441638, -0.014322245510667393,
+	-0.015728593256512876, -0.015854695633823006, -0.01487963196752945, -0.013022823780847667,
+	-0.010528132052091571, -0.0076469984869878029, -0.0046228858600927576, -0.0016773594205028376,
+	0.0010011360759145118, 0.0032655420332858595, 0.0050146501456004942, 0.0061944984022354044,
+	0.0067962754975606421, 0.0068515525517162199, 0.0064250582219488751, 0.0056064403321442495,
+	0.0045007895712754851, 0.003219578388499956, 0.001871773423912328, 0.00055681482881300638,
+	-0.00064163932454189396, -0.0016589282885964153, -0.0024526220224848354, -0.0030010451940569419,
+	-0.0033034377752941672, -0.0033761484452391973, -0.0032489625742523893, -0.0029616747522956369,
+	-0.002558944814838962, -0.0020863117084406755, -0.0015868693243615043, -0.0010984389454274392,
+	-0.00065121662679305879, -0.00026689135109589265, 4.1484499882574805e-05, 0.00026891918062609845,
+	0.0004175936308206331, 0.00049529853696405506, 0.00051372790172844133, 0.00048660774714626241,
+	0.0004282527580934564, 0.00035216532191377118, 0.00027009679908368583, 0.00019129341235189114,
+	0.00018789013547522714,
+};
+
+static const double filter_5[] = {
+	0.00021232381312612852, 0.00025173570056322066, 0.00038155438234938863, 0.00053600058684082552,
+	0.00070886796116801255, 0.00089040092051309409, 0.0010675607782459694, 0.0012244733528006858,
+	0.0013436094238583039, 0.001407155954446985, 0.0013987603801814661, 0.001305180372356717,
+	0.0011183571364362945, 0.00083708829869103723, 0.00046834700478215528, 2.7526453607330913e-05,
+	-0.00046121029216496067, -0.00096587682083794011, -0.0014485969661577071, -0.0018687067511394114,
+	-0.0021849311850533383, -0.0023603679553951002, -0.002366011721102654, -0.0021837069536474688,
+	-0.0018105382978240037, -0.0012594407874939038, -0.00056117951350198906, 0.00023740105685381401,
+	0.0010751274692475667, 0.0018809625406456957, 0.0025791064639096727, 0.0030957648047318497,
+	0.0033658276850344602, 0.0033399552345752133, 0.0029906560024283786, 0.0023172094094906356,
+	0.0013482266171371325, 0.00014231421662272623, -0.0012144132206023542, -0.0026134076616452849,
+	-0.0039314433270728148, -0.0050401356046700105, -0.0058176000733112226, -0.0061596682679213328,
+	-0.005991547184322492, -0.0052771849294344503, -0.0040264797257081528, -0.0022989533233663132,
+	-0.00020316276207967555, 0.0021080346385620036, 0.004446833916897458, 0.0066036254191271342,
+	0.0083634640766653955, 0.0095243714518559123, 0.0099163360363479607, 0.0094193939603585599,
+	0.0079790174614749916, 0.0056175595326627865, 0.0024403469613096668, -0.0013644110790917291,
+	-0.0055324561335237865, -0.0097367637088439634, -0.013606943888777286, -0.016753387690273121,
+	-0.018794656884444084, -0.019386321378864844, -0.018248705019570557, -0.015191938055340313,
+	-0.01013569879374336, -0.0031223020188508584, 0.0056783277505608595, 0.015972515308613135,
+	0.027355449735197782, 0.039332241898878059, 0.051345730391925561, 0.062809740189910618,
+	0.073145053124395495, 0.081815981777710794, 0.088364661559822477, 0.092440767450917241,
+	0.093824446804576092, 0.092440767450917241, 0.088364661559822477, 0.081815981777710794,
+	0.073145053124395495, 0.062809740189910618, 0.051345730391925561, 0.039332241898878059,
+	0.027355449735197782, 0.015972515308613135, 0.0056783277505608595, -0.0031223020188508584,
+	-0.01013569879374336, -0.015191938055340313, -0.018248705019570557, -0.019386321378864844,
+	-0.018794656884444084, -0.016753387690273121, -0.013606943888777286, -0.0097367637088439634,
+	-0.0055324561335237865, -0.0013644110790917291, 0.0024403469613096668, 0.0056175595326627865,
+	0.0079790174614749916, 0.0094193939603585599, 0.0099163360363479607, 0.0095243714518559123,
+	0.0083634640766653955, 0.0066036254191271342, 0.004446833916897458, 0.0021080346385620036,
+	-0.00020316276207967555, -0.0022989533233663132, -0.0040264797257081528, -0.0052771849294344503,
+	-0.005991547184322492, -0.0061596682679213328, -0.0058176000733112226, -0.0050401356046700105,
+	-0.0039314433270728148, -0.0026134076616452849, -0.0012144132206023542, 0.00014231421662272623,
+	0.0013482266171371325, 0.0023172094094906356, 0.0029906560024283786, 0.0033399552345752133,
+	0.0033658276850344602, 0.0030957648047318497, 0.0025791064639096727, 0.0018809625406456957,
+	0.0010751274692475667, 0.00023740105685381401, -0.00056117951350198906, -0.0012594407874939038,
+	-0.0018105382978240037, -0.0021837069536474688, -0.002366011721102654, -0.0023603679553951002,
+	-0.0021849311850533383, -0.0018687067511394114, -0.0014485969661577071, -0.00096587682083794011,
+	-0.00046121029216496067, 2.7526453607330913e-05, 0.00046834700478215528, 0.00083708829869103723,
+	0.0011183571364362945, 0.001305180372356717, 0.0013987603801814661, 0.001407155954446985,
+	0.0013436094238583039, 0.0012244733528006858, 0.0010675607782459694, 0.00089040092051309409,
+	0.00070886796116801255, 0.00053600058684082552, 0.00038155438234938863, 0.00025173570056322066,
+	0.00021232381312612852,
+};
+
+static const double filter_6[] = {
+	-0.00010839101874914897, 9.638747266638525e-05, 0.0001587657361229957, 0.00026474750880484821,
+	0.00040858718251273731, 0.00058540022109477066, 0.00078822658228450875, 0.0010069743217087546,
+	0.0012281340905613376, 0.0014353303555687503, 0.0016102177072729431, 0.0017339688397256755,
+	0.0017889170648962137, 0.0017605264563217518, 0.0016391794088566089, 0.0014219141342363213,
+	0.0011135897716298216, 0.00072754503450343571, 0.00028536730576469483, -0.00018396734937090463,
+	-0.00064604578209468625, -0.0010634738143861879, -0.0013991069983642712, -0.0016194682352509752,
+	-0.0016984387040272152, -0.0016202422822760901, -0.0013821730215773892, -0.00099581216424033162,
+	-0.00048748389254111218, 0.000103209241602071, 0.00072561801985036292, 0.0013222981615129512,
+	0.0018335616631290793, 0.0022036662326368316, 0.002385914046557718, 0.0023487337266414102,
+	0.0020785477845941761, 0.0015841717885546629, 0.00089740132010053856, 7.0303453258785167e-05,
+	-0.00082619321751271619, -0.0017094484306926306, -0.0024913538314113573, -0.0030872637662798528,
+	-0.0034240756060633566, -0.003448850907633787, -0.0031351933116012766, -0.0024883016941256685,
+	-0.0015465602035697843, -0.00038061211084612704, 0.00091143983660580189, 0.0022113411475673879,
+	0.0033910840580319052, 0.0043245887782559249, 0.0049005039864110072, 0.0050341343963136807,
+	0.0046780881546324704, 0.0038295986979277907, 0.002534371294972808, 0.0008857927890219869,
+	-0.0009805357592113464, -0.0028968769025328033, -0.0046771610788633837, -0.0061339105477868179,
+	-0.007096343100694744, -0.0074284847684013798, -0.0070450269785836094, -0.0059238488023848719,
+	-0.0041131819661720794, -0.0017329323318821552, 0.0010311260448753736, 0.0039394838840399148,
+	0.0067175580047933942, 0.0090781304988782861, 0.010748323974240128, 0.011495954050986867,
+	0.011155174946277102, 0.0096479643734525555, 0.0069994811220953409, 0.0033455092446022534,
+	-0.0010690560857746132, -0.005901342026952321, -0.010730685504250163, -0.01508688064247022,
+	-0.018484407241251992, -0.020460290997722945, -0.020612477902916829, -0.018635754225726241,
+	-0.014352045097056444, -0.0077324635067720334, 0.0010910952400402234, 0.011826044917164125,
+	0.02403136283602076, 0.037141675911978596, 0.050501162626334056, 0.063405446677805358,
+	0.075148351936188504, 0.085069534943579453, 0.092600222129046478, 0.097302777773832699,
+	0.098901668324613681, 0.097302777773832699, 0.092600222129046478, 0.085069534943579453,
+	0.075148351936188504, 0.063405446677805358, 0.050501162626334056, 0.037141675911978596,
+	0.02403136283602076, 0.011826044917164125, 0.0010910952400402234, -0.0077324635067720334,
+	-0.014352045097056444, -0.018635754225726241, -0.020612477902916829, -0.020460290997722945,
+	-0.018484407241251992, -0.01508688064247022, -0.010730685504250163, -0.005901342026952321,
+	-0.0010690560857746132, 0.0033455092446022534, 0.0069994811220953409, 0.0096479643734525555,
+	0.011155174946277102, 0.011495954050986867, 0.010748323974240128, 0.0090781304988782861,
+	0.0067175580047933942, 0.0039394838840399148, 0.0010311260448753736, -0.0017329323318821552,
+	-0.0041131819661720794, -0.0059238488023848719, -0.0070450269785836094, -0.0074284847684013798,
+	-0.007096343100694744, -0.0061339105477868179, -0.0046771610788633837, -0.0028968769025328033,
+	-0.0009805357592113464, 0.0008857927890219869, 0.002534371294972808, 0.0038295986979277907,
+	0.0046780881546324704, 0.0050341343963136807, 0.0049005039864110072, 0.0043245887782559249,
+	0.0033910840580319052, 0.0022113411475673879, 0.00091143983660580189, -0.00038061211084612704,
+	-0.0015465602035697843, -0.0024883016941256685, -0.0031351933116012766, -0.003448850907633787,
+	-0.0034240756060633566, -0.0030872637662798528, -0.0024913538314113573, -0.0017094484306926306,
+	-0.00082619321751271619, 7.0303453258785167e-05, 0.00089740132010053856, 0.0015841717885546629,
+	0.0020785477845941761, 0.0023487337266414102, 0.002385914046557718, 0.0022036662326368316,
+	0.0018335616631290793, 0.0013222981615129512, 0.00072561801985036292, 0.000103209241602071,
+	-0.00048748389254111218, -0.00099581216424033162, -0.0013821730215773892, -0.0016202422822760901,
+	-0.0016984387040272152, -0.0016194682352509752, -0.0013991069983642712, -0.0010634738143861879,
+	-0.00064604578209468625, -0.00018396734937090463, 0.00028536730576469483, 0.00072754503450343571,
+	0.0011135897716298216, 0.0014219141342363213, 0.0016391794088566089, 0.0017605264563217518,
+	0.0017889170648962137, 0.0017339688397256755, 0.0016102177072729431, 0.0014353303555687503,
+	0.0012281340905613376, 0.0010069743217087546, 0.00078822658228450875, 0.00058540022109477066,
+	0.00040858718251273731, 0.00026474750880484821, 0.0001587657361229957, 9.638747266638525e-05,
+	-0.00010839101874914897,
+};
+
+static const double filter_7[] = {
+	-0.00014832115179844846, -7.6767615098445491e-05, -6.5298947006074061e-05, -2.062877768040021e-05,
+	6.799084842508456e-05, 0.00020940949694813862, 0.00040855858682699238, 0.00066459682176646894,
+	0.00096916286088657077, 0.0013054404521794011, 0.0016479820229651694, 0.0019637281649414005,
+	0.0022139726855015958, 0.0023577857861027491, 0.0023561448815867386, 0.002177114837171484,
+	0.0018008267548771111, 0.0012242752742545162, 0.00046480410526198135, -0.0004377757983094415,
+	-0.0014213408109085459, -0.0024040677296224512, -0.0032903258752730665, -0.0039782738480289804,
+	-0.0043696634940028033, -0.0043806331452932914, -0.003954026588023715, -0.0030677597069625868,
+	-0.0017439581474372854, -5.2913151823131886e-05, 0.0018876189924163663, 0.0039167038262553138,
+	0.005841363477725966, 0.0074509719018362392, 0.0085366963342387598, 0.0089122912888230446,
+	0.0084362556664565377, 0.0070316818695540977, 0.0047029768564552108, 0.0015463428555315853,
+	-0.0022465652549958841, -0.0063940133836441456, -0.010537721896256617, -0.014265392581325269,
+	-0.017139414101232216, -0.018731471941003934, -0.018658736368517888, -0.016619695838357301,
+	-0.012425755870193983, -0.0060263114242745447, 0.0024763784568607432, 0.012823278540285303,
+	0.024607136878777958, 0.03729327944977933, 0.050251825795692935, 0.06279782582096359,
+	0.074238456100793715, 0.083921083215481876, 0.091280656791866616, 0.095880572332483108,
+	0.097445305703337551, 0.095880572332483108, 0.091280656791866616, 0.083921083215481876,
+	0.074238456100793715, 0.06279782582096359, 0.050251825795692935, 0.03729327944977933,
+	0.024607136878777958, 0.012823278540285303, 0.0024763784568607432, -0.0060263114242745447,
+	-0.012425755870193983, -0.016619695838357301, -0.018658736368517888, -0.018731471941003934,
+	-0.017139414101232216, -0.014265392581325269, -0.010537721896256617, -0.0063940133836441456,
+	-0.0022465652549958841, 0.0015463428555315853, 0.0047029768564552108, 0.0070316818695540977,
+	0.0084362556664565377, 0.0089122912888230446, 0.0085366963342387598, 0.0074509719018362392,
+	0.005841363477725966, 0.0039167038262553138, 0.0018876189924163663, -5.2913151823131886e-05,
+	-0.0017439581474372854, -0.0030677597069625868, -0.003954026588023715, -0.0043806331452932914,
+	-0.0043696634940028033, -0.0039782738480289804, -0.0032903258752730665, -0.0024040677296224512,
+	-0.0014213408109085459, -0.0004377757983094415, 0.00046480410526198135, 0.0012242752742545162,
+	0.0018008267548771111, 0.002177114837171484, 0.0023561448815867386, 0.0023577857861027491,
+	0.0022139726855015958, 0.0019637281649414005, 0.0016479820229651694, 0.0013054404521794011,
+	0.00096916286088657077, 0.00066459682176646894, 0.00040855858682699238, 0.00020940949694813862,
+	6.799084842508456e-05, -2.062877768040021e-05, -6.5298947006074061e-05, -7.6767615098445491e-05,
+	-0.00014832115179844846,
+};
+
+static const double filter_8[] = {
+	-0.00022146910141106435, -0.00027452590305840694, -0.00041774575786336507, -0.00058276300772880862,
+	-0.00075773386336202111, -0.00092611119211872791, -0.0010676015283401939, -0.0011597508393114163,
+	-0.0011804322563439941, -0.0011106810662832012, -0.00093769734419126135, -0.00065738113186191403,
+	-0.00027673987940145353, 0.00018493108425748193, 0.00069624254827869709, 0.0012156634727791403,
+	0.0016941885255668566, 0.0020799597666894252, 0.0023241956828236902, 0.0023871340175914096,
+	0.0022429640710021387, 0.0018864732905847113, 0.0013342861701143064, 0.0006270797660988957,
+	-0.00017275512198562402, -0.00098571819520001415, -0.0017220543792569327, -0.002291447804232522,
+	-0.002612935806437885, -0.0026257070170846082, -0.0022981316760743616, -0.0016347768675229666,
+	-0.00067942645658301175, 0.00048564603336216725, 0.0017454258553558995, 0.0029621553333641182,
+	0.0039892170047528671, 0.0046870700210830188, 0.0049406279209320359, 0.0046749716657586765,
+	0.0038680840849573944, 0.0025589228081480103, 0.00084874801569624929, -0.0011043615601523445,
+	-0.0030981671516041227, -0.0049055838010103039, -0.00629810962878066, -0.007072543725710703,
+	-0.0070765356081617719, -0.0062314996648185654, -0.004548743394956708, -0.0021374962825925089,
+	0.00079795485549487538, 0.00397157901565164, 0.0070397872952982568, 0.0096339889963360584,
+	0.011399548997682732, 0.01203640717052647, 0.011338412385092124, 0.0092258137303891114,
+	0.0057679633283052381, 0.0011923088443635355, -0.0041218200948081188, -0.0096655268279317481,
+	-0.014837230666018103, -0.018992191735146803, -0.021499450133206994, -0.021802513919603979,
+	-0.019476610361222117, -0.014278157767039633, -0.0061800628845653316, 0.0046100510727381172,
+	0.017652311786681116, 0.032297405587719513, 0.047729360228671185, 0.063024109011489915,
+	0.077220061966134179, 0.089393411911463688, 0.098732784287948114, 0.10460520634281595,
+	0.10660864224444008, 0.10460520634281595, 0.098732784287948114, 0.089393411911463688,
+	0.077220061966134179, 0.063024109011489915, 0.047729360228671185, 0.032297405587719513,
+	0.017652311786681116, 0.0046100510727381172, -0.0061800628845653316, -0.014278157767039633,
+	-0.019476610361222117, -0.021802513919603979, -0.021499450133206994, -0.018992191735146803,
+	-0.014837230666018103, -0.0096655268279317481, -0.0041218200948081188, 0.0011923088443635355,
+	0.0057679633283052381, 0.0092258137303891114, 0.011338412385092124, 0.01203640717052647,
+	0.011399548997682732, 0.0096339889963360584, 0.0070397872952982568, 0.00397157901565164,
+	0.00079795485549487538, -0.0021374962825925089, -0.004548743394956708, -0.0062314996648185654,
+	-0.0070765356081617719, -0.007072543725710703, -0.00629810962878066, -0.0049055838010103039,
+	-0.0030981671516041227, -0.0011043615601523445, 0.00084874801569624929, 0.0025589228081480103,
+	0.0038680840849573944, 0.0046749716657586765, 0.0049406279209320359, 0.0046870700210830188,
+	0.0039892170047528671, 0.0029621553333641182, 0.0017454258553558995, 0.00048564603336216725,
+	-0.00067942645658301175, -0.0016347768675229666, -0.0022981316760743616, -0.0026257070170846082,
+	-0.002612935806437885, -0.002291447804232522, -0.0017220543792569327, -0.00098571819520001415,
+	-0.00017275512198562402, 0.0006270797660988957, 0.0013342861701143064, 0.0018864732905847113,
+	0.0022429640710021387, 0.0023871340175914096, 0.0023241956828236902, 0.0020799597666894252,
+	0.0016941885255668566, 0.0012156634727791403, 0.00069624254827869709, 0.00018493108425748193,
+	-0.00027673987940145353, -0.00065738113186191403, -0.00093769734419126135, -0.0011106810662832012,
+	-0.0011804322563439941, -0.0011597508393114163, -0.0010676015283401939, -0.00092611119211872791,
+	-0.00075773386336202111, -0.00058276300772880862, -0.00041774575786336507, -0.00027452590305840694,
+	-0.00022146910141106435,
+};
+
+static const double filter_9[] = {
+	0.00018519283168224308, 6.4617977000273226e-05, 3.772395432088442e-05, -2.6370503724938856e-05,
+	-0.00013511785639275833, -0.00029268147750800079, -0.00049852241615268549, -0.00074607172839998796,
+	-0.0010222121542453558, -0.0013073453692907728, -0.0015766029354934861, -0.0018017427822777797,
+	-0.0019540491643020839, -0.0020074876642770384, -0.0019423339852953614, -0.0017483862040012872,
+	-0.0014277222391979399, -0.00099611923385479703, -0.00048313408209058918, 6.9747440098137236e-05,
+	0.00061232227338713606, 0.0010904115687825353, 0.0014515496141066613, 0.0016514903244624921,
+	0.0016603326466169146, 0.0014672287499338525, 0.0010830949335313006, 0.00054177170679245445,
+	-0.00010131614984153391, -0.00077603100498371076, -0.0014020402437299436, -0.0018995784273678554,
+	-0.0021983563798083955, -0.0022469492765860677, -0.0020208576416554957, -0.0015273518563723467,
+	-0.00080739040055489248, 6.7010690294725037e-05, 0.0009989887301812151, 0.0018771710503793905,
+	0.0025881541301420491, 0.003030739116846828, 0.003129250286390604, 0.002845159776201805,
+	0.0021846292325648597, 0.0012014543615138245, -6.2186853050206522e-06, -0.0013045583315550511,
+	-0.0025381950833625183, -0.0035477690269953674, -0.0041898150256864559, -0.0043558246916676775,
+	-0.003988576324623027, -0.0030930383178630911, -0.0017408995125494848, -6.6512198504518788e-05,
+	0.0017451951435077011, 0.0034775111986176982, 0.0049069516305848297, 0.0058304031211948628,
+	0.0060919950427904676, 0.0056064180814312196, 0.0043748470141230789, 0.0024918698529283519,
+	0.00014094317676262115, -0.0024210278054564707, -0.0048897954654696504, -0.006947288201945831,
+	-0.0083000317136815212, -0.0087170806148682018, -0.0080638697341983163, -0.0063267301432514567,
+	-0.0036252139662905055, -0.00020890518412586826, 0.0035611389685919811, 0.0072462184745908627,
+	0.010375471229939641, 0.012499553003190389, 0.013246016899993881, 0.012371019385351031,
+	0.0098005573907024423, 0.0056566429726016875, 0.00026340866220030422, -0.0058678385752960142,
+	-0.012075206002501344, -0.01760163855214901, -0.021664492988528319, -0.023532687485756688,
+	-0.022604250966870996, -0.018475585311102605, -0.010995748189297858, -0.00029873278389335416,
+	0.013189792556442873, 0.028773605111732457, 0.045533267260596172, 0.062396759916076849,
+	0.078226190077422458, 0.091913685252370758, 0.10247655892509329, 0.10914341200419522,
+	0.11142203704216538, 0.10914341200419522, 0.10247655892509329, 0.091913685252370758,
+	0.078226190077422458, 0.062396759916076849, 0.045533267260596172, 0.028773605111732457,
+	0.013189792556442873, -0.00029873278389335416, -0.010995748189297858, -0.018475585311102605,
+	-0.022604250966870996, -0.023532687485756688, -0.021664492988528319, -0.01760163855214901,
+	-0.012075206002501344, -0.0058678385752960142, 0.00026340866220030422, 0.0056566429726016875,
+	0.0098005573907024423, 0.012371019385351031, 0.013246016899993881, 0.012499553003190389,
+	0.010375471229939641, 0.0072462184745908627, 0.0035611389685919811, -0.00020890518412586826,
+	-0.0036252139662905055, -0.0063267301432514567, -0.0080638697341983163, -0.0087170806148682018,
+	-0.0083000317136815212, -0.006947288201945831, -0.0048897954654696504, -0.0024210278054564707,
+	0.00014094317676262115, 0.0024918698529283519, 0.0043748470141230789, 0.0056064180814312196,
+	0.0060919950427904676, 0.0058304031211948628, 0.0049069516305848297, 0.0034775111986176982,
+	0.0017451951435077011, -6.6512198504518788e-05, -0.0017408995125494848, -0.0030930383178630911,
+	-0.003988576324623027, -0.0043558246916676775, -0.0041898150256864559, -0.0035477690269953674,
+	-0.0025381950833625183, -0.0013045583315550511, -6.2186853050206522e-06, 0.0012014543615138245,
+	0.0021846292325648597, 0.002845159776201805, 0.003129250286390604, 0.003030739116846828,
+	0.0025881541301420491, 0.0018771710503793905, 0.0009989887301812151, 6.7010690294725037e-05,
+	-0.00080739040055489248, -0.0015273518563723467, -0.0020208576416554957, -0.0022469492765860677,
+	-0.0021983563798083955, -0.0018995784273678554, -0.0014020402437299436, -0.00077603100498371076,
+	-0.00010131614984153391, 0.00054177170679245445, 0.0010830949335313006, 0.0014672287499338525,
+	0.0016603326466169146, 0.0016514903244624921, 0.0014515496141066613, 0.0010904115687825353,
+	0.00061232227338713606, 6.9747440098137236e-05, -0.00048313408209058918, -0.00099611923385479703,
+	-0.0014277222391979399, -0.0017483862040012872, -0.0019423339852953614, -0.0020074876642770384,
+	-0.0019540491643020839, -0.0018017427822777797, -0.0015766029354934861, -0.0013073453692907728,
+	-0.0010222121542453558, -0.00074607172839998796, -0.00049852241615268549, -0.00029268147750800079,
+	-0.00013511785639275833, -2.6370503724938856e-05, 3.772395432088442e-05, 6.4617977000273226e-05,
+	0.00018519283168224308,
+};
+
+static const mz_filter_t baked_filters[] = {
+	{241, 0.0086604938271604929, 0.014660493827160493, 6, filter_0},
+	{201, 0.016070987654320985, 0.029320987654320986, 90, filter_1},
+	{201, 0.019070987654320984, 0.029320987654320986, 25, filter_2},
+	{201, 0.021820987654320983, 0.029320987654320986, 6, filter_3},
+	{121, 0.033426829268292685, 0.057926829268292679, 90, filter_4},
+	{161, 0.040676829268292684, 0.057926829268292679, 90, filter_5},
+	{201, 0.044676829268292681, 0.057926829268292679, 90, filter_6},
+	{121, 0.039689189189189192, 0.0641891891891892, 90, filter_7},
+	{161, 0.046939189189189191, 0.0641891891891892, 90, filter_8},
+	{201, 0.050939189189189195, 0.0641891891891892, 90, filter_9},
+};
@@ -53,16 +53,16 @@
 
 /* stores the current state of the D1FF register, real hardware has 1
  * bit per device, the bits are on the devices themselves */
-static UBYTE D1FF_LATCH = 0;
+static THREAD_LOCAL UBYTE D1FF_LATCH = 0;
 
 /* 1400XL/1450XLD and 1090 have ram here */
-int PBI_D6D7ram = FALSE;
+THREAD_LOCAL int PBI_D6D7ram = FALSE;
 
 /* So far as is currently implemented: PBI_IRQ can be generated by the 1400/1450 Votrax and the Black Box button */
 /* Each emulated PBI device will set a bit in this variable to indicate IRQ status */
 /* The actual hardware has only one common line.  The device driver rom has to
  * figure it out*/
-int PBI_IRQ = 0;
+THREAD_LOCAL int PBI_IRQ = 0;
 
 #ifdef PBI_DEBUG
 #define D(a) a
@@ -190,7 +190,7 @@ UBYTE PBI_D1GetByte(UWORD addr, int no_side_effects)
 
 void PBI_D1PutByte(UWORD addr, UBYTE byte)
 {
-	static int fp_active = TRUE;
+	static THREAD_LOCAL int fp_active = TRUE;
 #ifdef PBI_MIO
 	if (PBI_MIO_enabled) {
 		PBI_MIO_D1PutByte(addr, byte);
@@ -298,7 +298,7 @@ void PBI_D6PutByte(UWORD addr, UBYTE byte)
 	}
 #endif
 	/* XLD/1090 has ram here */
-	if (PBI_D6D7ram) MEMORY_mem[addr]=byte;
+	if (PBI_D6D7ram) MEMORY_dPutByte(addr, byte);
 }
 
 /* read page $D7xx */
@@ -315,7 +315,7 @@ UBYTE PBI_D7GetByte(UWORD addr, int no_side_effects)
 void PBI_D7PutByte(UWORD addr, UBYTE byte)
 {
 	D(printf("PBI_D7PutByte:%4x <- %2x\n",addr,byte));
-	if (PBI_D6D7ram) MEMORY_mem[addr]=byte;
+	if (PBI_D6D7ram) MEMORY_dPutByte(addr, byte);
 }
 
 #ifndef BASIC
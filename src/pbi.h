@@ -15,8 +15,8 @@ UBYTE PBI_D6GetByte(UWORD addr, int no_side_effects);
 void PBI_D6PutByte(UWORD addr, UBYTE byte);
 UBYTE PBI_D7GetByte(UWORD addr, int no_side_effects);
 void PBI_D7PutByte(UWORD addr, UBYTE byte);
-extern int PBI_IRQ;
-extern int PBI_D6D7ram;
+extern THREAD_LOCAL int PBI_IRQ;
+extern THREAD_LOCAL int PBI_D6D7ram;
 void PBI_StateSave(void);
 void PBI_StateRead(void);
 #define PBI_NOT_HANDLED -1
@@ -46,19 +46,19 @@
 /* information source: http://www.mathyvannisselroy.nl/bbdoku.txt*/
 #define BB_BUTTON_IRQ_MASK 1
 
-int PBI_BB_enabled = FALSE;
+THREAD_LOCAL int PBI_BB_enabled = FALSE;
 
-static UBYTE *bb_rom;
-static int bb_ram_bank_offset = 0;
-static UBYTE *bb_ram;
+static THREAD_LOCAL UBYTE *bb_rom;
+static THREAD_LOCAL int bb_ram_bank_offset = 0;
+static THREAD_LOCAL UBYTE *bb_ram;
 #define BB_RAM_SIZE 0x10000
-static UBYTE bb_rom_bank = 0;
-static int bb_rom_size;
-static int bb_rom_high_bit = 0x00;/*0x10*/
-static char bb_rom_filename[FILENAME_MAX];
-static UBYTE bb_PCR = 0; /* VIA Peripheral control register*/
-static int bb_scsi_enabled = FALSE;
-static char bb_scsi_disk_filename[FILENAME_MAX] = Util_FILENAME_NOT_SET;
+static THREAD_LOCAL UBYTE bb_rom_bank = 0;
+static THREAD_LOCAL int bb_rom_size;
+static THREAD_LOCAL int bb_rom_high_bit = 0x00;/*0x10*/
+static THREAD_LOCAL char bb_rom_filename[FILENAME_MAX];
+static THREAD_LOCAL UBYTE bb_PCR = 0; /* VIA Peripheral control register*/
+static THREAD_LOCAL int bb_scsi_enabled = FALSE;
+static THREAD_LOCAL char bb_scsi_disk_filename[FILENAME_MAX] = Util_FILENAME_NOT_SET;
 
 static void init_bb(void)
 {
@@ -257,10 +257,10 @@ UBYTE PBI_BB_D6GetByte(UWORD addr, int no_side_effects)
 /* $D6xx */
 void PBI_BB_D6PutByte(UWORD addr, UBYTE byte)
 {
-	MEMORY_mem[addr]=byte;
+	MEMORY_dPutByte(addr, byte);
 }
 
-static int buttondown;
+static THREAD_LOCAL int buttondown;
 
 void PBI_BB_Menu(void)
 {
@@ -275,7 +275,7 @@ void PBI_BB_Menu(void)
 
 void PBI_BB_Frame(void)
 {
-	static int count = 0;
+	static THREAD_LOCAL int count = 0;
 	if (buttondown) {
 	 	if (count < 1) count++;
 		else {
@@ -4,7 +4,7 @@
 #include "atari.h"
 #include <stdio.h>
 
-extern int PBI_BB_enabled;
+extern THREAD_LOCAL int PBI_BB_enabled;
 void PBI_BB_Menu(void);
 void PBI_BB_Frame(void);
 int PBI_BB_Initialise(int *argc, char *argv[]);
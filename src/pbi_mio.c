@@ -40,18 +40,18 @@
 #define D(a) do{}while(0)
 #endif
 
-int PBI_MIO_enabled = FALSE;
+THREAD_LOCAL int PBI_MIO_enabled = FALSE;
 
-static UBYTE *mio_rom;
+static THREAD_LOCAL UBYTE *mio_rom;
 static int mio_rom_size = 0x4000;
-static int mio_ram_bank_offset = 0;
-static UBYTE *mio_ram;
-static int mio_ram_size = 0x100000;
-static UBYTE mio_rom_bank = 0;
-static int mio_ram_enabled = FALSE;
-static char mio_rom_filename[FILENAME_MAX];
-static char mio_scsi_disk_filename[FILENAME_MAX] = Util_FILENAME_NOT_SET;
-static int mio_scsi_enabled = FALSE;
+static THREAD_LOCAL int mio_ram_bank_offset = 0;
+static THREAD_LOCAL UBYTE *mio_ram;
+static THREAD_LOCAL int mio_ram_size = 0x100000;
+static THREAD_LOCAL UBYTE mio_rom_bank = 0;
+static THREAD_LOCAL int mio_ram_enabled = FALSE;
+static THREAD_LOCAL char mio_rom_filename[FILENAME_MAX];
+static THREAD_LOCAL char mio_scsi_disk_filename[FILENAME_MAX] = Util_FILENAME_NOT_SET;
+static THREAD_LOCAL int mio_scsi_enabled = FALSE;
 
 static void init_mio(void)
 {
@@ -229,7 +229,7 @@ UBYTE PBI_MIO_D6GetByte(UWORD addr, int no_side_effects)
 void PBI_MIO_D6PutByte(UWORD addr, UBYTE byte)
 {
 	if (!mio_ram_enabled) return;
-	MEMORY_mem[addr]=byte;
+	MEMORY_dPutByte(addr, byte);
 }
 
 #ifndef BASIC
@@ -33,16 +33,16 @@
 #define D(a) do{}while(0)
 #endif
 
-int PBI_SCSI_CD = FALSE;
-int PBI_SCSI_MSG = FALSE;
-int PBI_SCSI_IO = FALSE;
-int PBI_SCSI_BSY = FALSE;
-int PBI_SCSI_REQ = FALSE;
-int PBI_SCSI_ACK = FALSE;
+THREAD_LOCAL int PBI_SCSI_CD = FALSE;
+THREAD_LOCAL int PBI_SCSI_MSG = FALSE;
+THREAD_LOCAL int PBI_SCSI_IO = FALSE;
+THREAD_LOCAL int PBI_SCSI_BSY = FALSE;
+THREAD_LOCAL int PBI_SCSI_REQ = FALSE;
+THREAD_LOCAL int PBI_SCSI_ACK = FALSE;
 
-int PBI_SCSI_SEL = FALSE;
+THREAD_LOCAL int PBI_SCSI_SEL = FALSE;
 
-static UBYTE scsi_byte;
+static THREAD_LOCAL UBYTE scsi_byte;
 
 #define SCSI_PHASE_SELECTION 0
 #define SCSI_PHASE_DATAIN 1
@@ -51,12 +51,12 @@ static UBYTE scsi_byte;
 #define SCSI_PHASE_STATUS 4 
 #define SCSI_PHASE_MSGIN 5
 
-static int scsi_phase = SCSI_PHASE_SELECTION;
-static int scsi_bufpos = 0;
-static UBYTE scsi_buffer[256];
-static int scsi_count = 0;
+static THREAD_LOCAL int scsi_phase = SCSI_PHASE_SELECTION;
+static THREAD_LOCAL int scsi_bufpos = 0;
+static THREAD_LOCAL UBYTE scsi_buffer[256];
+static THREAD_LOCAL int scsi_count = 0;
 
-FILE *PBI_SCSI_disk = NULL;
+THREAD_LOCAL FILE *PBI_SCSI_disk = NULL;
 
 static void scsi_changephase(int phase)
 {
@@ -4,14 +4,14 @@
 #include "atari.h"
 #include <stdio.h>
 
-extern int PBI_SCSI_CD;
-extern int PBI_SCSI_MSG;
-extern int PBI_SCSI_IO;
-extern int PBI_SCSI_BSY;
-extern int PBI_SCSI_REQ;
-extern int PBI_SCSI_SEL;
-extern int PBI_SCSI_ACK;
-extern FILE *PBI_SCSI_disk;
+extern THREAD_LOCAL int PBI_SCSI_CD;
+extern THREAD_LOCAL int PBI_SCSI_MSG;
+extern THREAD_LOCAL int PBI_SCSI_IO;
+extern THREAD_LOCAL int PBI_SCSI_BSY;
+extern THREAD_LOCAL int PBI_SCSI_REQ;
+extern THREAD_LOCAL int PBI_SCSI_SEL;
+extern THREAD_LOCAL int PBI_SCSI_ACK;
+extern THREAD_LOCAL FILE *PBI_SCSI_disk;
 
 void PBI_SCSI_PutByte(UBYTE byte);
 UBYTE PBI_SCSI_GetByte(void);
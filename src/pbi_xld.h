@@ -11,8 +11,8 @@ int PBI_XLD_D1GetByte(UWORD addr);
 UBYTE PBI_XLD_D1ffGetByte(void);
 void PBI_XLD_D1PutByte(UWORD addr, UBYTE byte);
 int PBI_XLD_D1ffPutByte(UBYTE byte);
-extern int PBI_XLD_enabled;
-extern int PBI_XLD_v_enabled;
+extern THREAD_LOCAL int PBI_XLD_enabled;
+extern THREAD_LOCAL int PBI_XLD_v_enabled;
 void PBI_XLD_VInit(int playback_freq, int num_pokeys, int bit16);
 void PBI_XLD_VFrame(void);
 void PBI_XLD_VProcess(void *sndbuffer, int sndn);
@@ -39,21 +39,21 @@
 #include "statesav.h"
 #endif
 
-UBYTE PIA_PACTL;
-UBYTE PIA_PBCTL;
-UBYTE PIA_PORTA;
-UBYTE PIA_PORTB;
-UBYTE PIA_PORT_input[2];
+THREAD_LOCAL UBYTE PIA_PACTL;
+THREAD_LOCAL UBYTE PIA_PBCTL;
+THREAD_LOCAL UBYTE PIA_PORTA;
+THREAD_LOCAL UBYTE PIA_PORTB;
+THREAD_LOCAL UBYTE PIA_PORT_input[2];
 
-UBYTE PIA_PORTA_mask;
-UBYTE PIA_PORTB_mask;
-int PIA_CA2 = 1;
-int PIA_CA2_negpending = 0;
-int PIA_CA2_pospending = 0;
-int PIA_CB2 = 1;
-int PIA_CB2_negpending = 0;
-int PIA_CB2_pospending = 0;
-int PIA_IRQ = 0;
+THREAD_LOCAL UBYTE PIA_PORTA_mask;
+THREAD_LOCAL UBYTE PIA_PORTB_mask;
+THREAD_LOCAL int PIA_CA2 = 1;
+THREAD_LOCAL int PIA_CA2_negpending = 0;
+THREAD_LOCAL int PIA_CA2_pospending = 0;
+THREAD_LOCAL int PIA_CB2 = 1;
+THREAD_LOCAL int PIA_CB2_negpending = 0;
+THREAD_LOCAL int PIA_CB2_pospending = 0;
+THREAD_LOCAL int PIA_IRQ = 0;
 
 int PIA_Initialise(int *argc, char *argv[])
 {
@@ -63,29 +63,29 @@
 void pokey_update(void);
 #endif
 
-UBYTE POKEY_KBCODE;
-UBYTE POKEY_SERIN;
-UBYTE POKEY_IRQST;
-UBYTE POKEY_IRQEN;
-UBYTE POKEY_SKSTAT;
-UBYTE POKEY_SKCTL;
-int POKEY_DELAYED_SERIN_IRQ;
-int POKEY_DELAYED_SEROUT_IRQ;
-int POKEY_DELAYED_XMTDONE_IRQ;
+THREAD_LOCAL UBYTE POKEY_KBCODE;
+THREAD_LOCAL UBYTE POKEY_SERIN;
+THREAD_LOCAL UBYTE POKEY_IRQST;
+THREAD_LOCAL UBYTE POKEY_IRQEN;
+THREAD_LOCAL UBYTE POKEY_SKSTAT;
+THREAD_LOCAL UBYTE POKEY_SKCTL;
+THREAD_LOCAL int POKEY_DELAYED_SERIN_IRQ;
+THREAD_LOCAL int POKEY_DELAYED_SEROUT_IRQ;
+THREAD_LOCAL int POKEY_DELAYED_XMTDONE_IRQ;
 
 /* structures to hold the 9 pokey control bytes */
-UBYTE POKEY_AUDF[4 * POKEY_MAXPOKEYS];	/* AUDFx (D200, D202, D204, D206) */
-UBYTE POKEY_AUDC[4 * POKEY_MAXPOKEYS];	/* AUDCx (D201, D203, D205, D207) */
-UBYTE POKEY_AUDCTL[POKEY_MAXPOKEYS];	/* AUDCTL (D208) */
-int POKEY_DivNIRQ[4], POKEY_DivNMax[4];
-int POKEY_Base_mult[POKEY_MAXPOKEYS];		/* selects either 64Khz or 15Khz clock mult */
+THREAD_LOCAL UBYTE POKEY_AUDF[4 * POKEY_MAXPOKEYS];	/* AUDFx (D200, D202, D204, D206) */
+THREAD_LOCAL UBYTE POKEY_AUDC[4 * POKEY_MAXPOKEYS];	/* AUDCx (D201, D203, D205, D207) */
+THREAD_LOCAL UBYTE POKEY_AUDCTL[POKEY_MAXPOKEYS];	/* AUDCTL (D208) */
+THREAD_LOCAL int POKEY_DivNIRQ[4], POKEY_DivNMax[4];
+THREAD_LOCAL int POKEY_Base_mult[POKEY_MAXPOKEYS];		/* selects either 64Khz or 15Khz clock mult */
 
-UBYTE POKEY_POT_input[8] = {228, 228, 228, 228, 228, 228, 228, 228};
-static int pot_scanline;
+THREAD_LOCAL UBYTE POKEY_POT_input[8] = {228, 228, 228, 228, 228, 228, 228, 228};
+static THREAD_LOCAL int pot_scanline;
 
-UBYTE POKEY_poly9_lookup[511];
-UBYTE POKEY_poly17_lookup[16385];
-static ULONG random_scanline_counter;
+THREAD_LOCAL UBYTE POKEY_poly9_lookup[511];
+THREAD_LOCAL UBYTE POKEY_poly17_lookup[16385];
+static THREAD_LOCAL ULONG random_scanline_counter;
 
 ULONG POKEY_GetRandomCounter(void)
 {
@@ -97,6 +97,16 @@ void POKEY_SetRandomCounter(ULONG value)
 	random_scanline_counter = value;
 }
 
+int POKEY_GetPotScanline(void)
+{
+	return pot_scanline;
+}
+
+void POKEY_SetPotScanline(int value)
+{
+	pot_scanline = value;
+}
+
 UBYTE POKEY_GetByte(UWORD addr, int no_side_effects)
 {
 	UBYTE byte = 0xff;
@@ -265,9 +275,15 @@ void POKEY_PutByte(UWORD addr, UBYTE byte)
 		/* check if cassette 2-tone mode has been enabled */
 		if ((POKEY_SKCTL & 0x08) == 0x00) {
 			/* intelligent device */
-			POKEY_DELAYED_SEROUT_IRQ = SIO_SEROUT_INTERVAL;
+			if (SIO_turbo_transfer) {
+				POKEY_DELAYED_SEROUT_IRQ = SIO_TURBO_INTERVAL;
+				POKEY_DELAYED_XMTDONE_IRQ = SIO_TURBO_INTERVAL + 1;
+			}
+			else {
+				POKEY_DELAYED_SEROUT_IRQ = SIO_SEROUT_INTERVAL;
+				POKEY_DELAYED_XMTDONE_IRQ = SIO_XMTDONE_INTERVAL;
+			}
 			POKEY_IRQST |= 0x08;
-			POKEY_DELAYED_XMTDONE_IRQ = SIO_XMTDONE_INTERVAL;
 		}
 		else {
 			/* cassette */
@@ -484,7 +500,12 @@ void POKEY_Scanline(void)
 
 	random_scanline_counter += ANTIC_LINE_C;
 
-	if (POKEY_DELAYED_SERIN_IRQ > 0) {
+	if (POKEY_DELAYED_SERIN_IRQ == 1 && SIO_turbo_transfer
+	 && (POKEY_IRQEN & 0x20) && !(POKEY_IRQST & 0x20)) {
+		/* A turbo transfer waits until the previous byte is serviced
+		   instead of overrunning it. */
+	}
+	else if (POKEY_DELAYED_SERIN_IRQ > 0) {
 		if (--POKEY_DELAYED_SERIN_IRQ == 0) {
 			/* Load a byte to SERIN - even when the IRQ is disabled. */
 			POKEY_SERIN = SIO_GetByte();
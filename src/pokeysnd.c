@@ -24,6 +24,7 @@
 
 #include "config.h"
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 #ifdef ASAP /* external project, see http://asap.sf.net */
@@ -46,6 +47,8 @@
 #include "gtia.h"
 #include "util.h"
 
+#include "simd.h"
+
 #ifdef WORDS_UNALIGNED_OK
 #  define READ_U32(x)     (*(ULONG *) (x))
 #  define WRITE_U32(x, d) (*(ULONG *) (x) = (d))
@@ -78,13 +81,13 @@
 /* GLOBAL VARIABLE DEFINITIONS */
 
 /* number of pokey chips currently emulated */
-static UBYTE Num_pokeys;
+static THREAD_LOCAL UBYTE Num_pokeys;
 
-static UBYTE pokeysnd_AUDV[4 * POKEY_MAXPOKEYS];	/* Channel volume - derived */
+static THREAD_LOCAL UBYTE pokeysnd_AUDV[4 * POKEY_MAXPOKEYS];	/* Channel volume - derived */
 
 static UBYTE Outbit[4 * POKEY_MAXPOKEYS];		/* current state of the output (high or low) */
 
-static UBYTE Outvol[4 * POKEY_MAXPOKEYS];		/* last output volume for each channel */
+static THREAD_LOCAL UBYTE Outvol[4 * POKEY_MAXPOKEYS];		/* last output volume for each channel */
 
 /* Initialize the bit patterns for the polynomials. */
 
@@ -107,28 +110,28 @@ static UBYTE bit5[POKEY_POLY5_SIZE] =
 {0, 0, 1, 1, 0, 0, 0, 1, 1, 1, 1, 0, 0, 1, 0, 1, 0, 1, 1, 0, 1, 1, 1, 0, 1, 0, 0, 0, 0, 0, 1};
 #endif
 
-static ULONG P4 = 0,			/* Global position pointer for the 4-bit  POLY array */
+static THREAD_LOCAL ULONG P4 = 0,			/* Global position pointer for the 4-bit  POLY array */
  P5 = 0,						/* Global position pointer for the 5-bit  POLY array */
  P9 = 0,						/* Global position pointer for the 9-bit  POLY array */
  P17 = 0;						/* Global position pointer for the 17-bit POLY array */
 
-static ULONG Div_n_cnt[4 * POKEY_MAXPOKEYS],		/* Divide by n counter. one for each channel */
+static THREAD_LOCAL ULONG Div_n_cnt[4 * POKEY_MAXPOKEYS],		/* Divide by n counter. one for each channel */
  Div_n_max[4 * POKEY_MAXPOKEYS];		/* Divide by n maximum, one for each channel */
 
-static ULONG Samp_n_max,		/* Sample max.  For accuracy, it is *256 */
+static THREAD_LOCAL ULONG Samp_n_max,		/* Sample max.  For accuracy, it is *256 */
  Samp_n_cnt[2];					/* Sample cnt. */
 
 #ifdef INTERPOLATE_SOUND
 #ifdef CLIP_SOUND
-static SWORD last_val = 0;		/* last output value */
+static THREAD_LOCAL SWORD last_val = 0;		/* last output value */
 #else
-static UWORD last_val = 0;
+static THREAD_LOCAL UWORD last_val = 0;
 #endif
 #ifdef STEREO_SOUND
 #ifdef CLIP_SOUND
-static SWORD last_val2 = 0;	/* last output value */
+static THREAD_LOCAL SWORD last_val2 = 0;	/* last output value */
 #else
-static UWORD last_val2 = 0;
+static THREAD_LOCAL UWORD last_val2 = 0;
 #endif
 #endif
 #endif
@@ -136,88 +139,100 @@ static UWORD last_val2 = 0;
 /* Volume only emulations declarations */
 #ifdef VOL_ONLY_SOUND
 
-int	POKEYSND_sampbuf_val[POKEYSND_SAMPBUF_MAX];	/* volume values */
-int	POKEYSND_sampbuf_cnt[POKEYSND_SAMPBUF_MAX];	/* relative start time */
-int	POKEYSND_sampbuf_ptr = 0;		/* pointer to sampbuf */
-int	POKEYSND_sampbuf_rptr = 0;		/* pointer to read from sampbuf */
-int	POKEYSND_sampbuf_last = 0;		/* last absolute time */
-int	POKEYSND_sampbuf_AUDV[4 * POKEY_MAXPOKEYS];	/* prev. channel volume */
-int	POKEYSND_sampbuf_lastval = 0;		/* last volume */
-int	POKEYSND_sampout;			/* last out volume */
-int	POKEYSND_samp_freq;
-int	POKEYSND_samp_consol_val = 0;		/* actual value of console sound */
+THREAD_LOCAL int	POKEYSND_sampbuf_val[POKEYSND_SAMPBUF_MAX];	/* volume values */
+THREAD_LOCAL int	POKEYSND_sampbuf_cnt[POKEYSND_SAMPBUF_MAX];	/* relative start time */
+THREAD_LOCAL int	POKEYSND_sampbuf_ptr = 0;		/* pointer to sampbuf */
+THREAD_LOCAL int	POKEYSND_sampbuf_rptr = 0;		/* pointer to read from sampbuf */
+THREAD_LOCAL int	POKEYSND_sampbuf_last = 0;		/* last absolute time */
+THREAD_LOCAL int	POKEYSND_sampbuf_AUDV[4 * POKEY_MAXPOKEYS];	/* prev. channel volume */
+THREAD_LOCAL int	POKEYSND_sampbuf_lastval = 0;		/* last volume */
+THREAD_LOCAL int	POKEYSND_sampout;			/* last out volume */
+THREAD_LOCAL int	POKEYSND_samp_freq;
+THREAD_LOCAL int	POKEYSND_samp_consol_val = 0;		/* actual value of console sound */
 #ifdef STEREO_SOUND
-static int	sampbuf_val2[POKEYSND_SAMPBUF_MAX];	/* volume values */
-static int	sampbuf_cnt2[POKEYSND_SAMPBUF_MAX];	/* relative start time */
-static int	sampbuf_ptr2 = 0;		/* pointer to sampbuf */
-static int	sampbuf_rptr2 = 0;		/* pointer to read from sampbuf */
-static int	sampbuf_last2 = 0;		/* last absolute time */
-static int	sampbuf_lastval2 = 0;		/* last volume */
-static int	sampout2;			/* last out volume */
+static THREAD_LOCAL int	sampbuf_val2[POKEYSND_SAMPBUF_MAX];	/* volume values */
+static THREAD_LOCAL int	sampbuf_cnt2[POKEYSND_SAMPBUF_MAX];	/* relative start time */
+static THREAD_LOCAL int	sampbuf_ptr2 = 0;		/* pointer to sampbuf */
+static THREAD_LOCAL int	sampbuf_rptr2 = 0;		/* pointer to read from sampbuf */
+static THREAD_LOCAL int	sampbuf_last2 = 0;		/* last absolute time */
+static THREAD_LOCAL int	sampbuf_lastval2 = 0;		/* last volume */
+static THREAD_LOCAL int	sampout2;			/* last out volume */
 #endif
 #endif  /* VOL_ONLY_SOUND */
 
-static ULONG snd_freq17 = POKEYSND_FREQ_17_EXACT;
-int POKEYSND_playback_freq = 44100;
-UBYTE POKEYSND_num_pokeys = 1;
-int POKEYSND_snd_flags = 0;
-static int mz_quality = 0;		/* default quality for mzpokeysnd */
+static THREAD_LOCAL ULONG snd_freq17 = POKEYSND_FREQ_17_EXACT;
+THREAD_LOCAL int POKEYSND_playback_freq = 44100;
+THREAD_LOCAL UBYTE POKEYSND_num_pokeys = 1;
+THREAD_LOCAL int POKEYSND_snd_flags = 0;
+static THREAD_LOCAL int mz_quality = 0;		/* default quality for mzpokeysnd */
 #ifdef __PLUS
 int mz_clear_regs = 0;
 #endif
 
 #ifndef __MINT__
-int POKEYSND_enable_new_pokey = TRUE;
+THREAD_LOCAL int POKEYSND_enable_new_pokey = TRUE;
 #else
 /* too slow on Falcon */
-int POKEYSND_enable_new_pokey = FALSE;
+THREAD_LOCAL int POKEYSND_enable_new_pokey = FALSE;
 #endif
 
-int POKEYSND_bienias_fix = TRUE;  /* when TRUE, high frequencies get emulated: better sound but slower */
+THREAD_LOCAL int POKEYSND_bienias_fix = TRUE;  /* when TRUE, high frequencies get emulated: better sound but slower */
 #if defined(__PLUS) && !defined(_WX_)
 #define BIENIAS_FIX (g_Sound.nBieniasFix)
 #else
 #define BIENIAS_FIX POKEYSND_bienias_fix
 #endif
 #ifndef ASAP
-int POKEYSND_stereo_enabled = FALSE;
+THREAD_LOCAL int POKEYSND_stereo_enabled = FALSE;
 #endif
 
-int POKEYSND_volume = 0x100;
+THREAD_LOCAL int POKEYSND_volume = 0x100;
 
 /* multiple sound engine interface */
-static void pokeysnd_process_8(void *sndbuffer, int sndn);
-static void pokeysnd_process_16(void *sndbuffer, int sndn);
-static void null_pokey_process(void *sndbuffer, int sndn) {}
-void (*POKEYSND_Process_ptr)(void *sndbuffer, int sndn) = null_pokey_process;
+static void pokeysnd_process_f(float *bus, int sndn);
+static void null_pokey_process(float *bus, int sndn)
+{
+	memset(bus, 0, sndn * sizeof(float));
+}
+THREAD_LOCAL void (*POKEYSND_Process_ptr)(float *bus, int sndn) = null_pokey_process;
+
+/* the mixing bus of POKEYSND_Process */
+static THREAD_LOCAL float *mix_bus = NULL;
+static THREAD_LOCAL int mix_bus_size = 0;
+#ifdef AUDIO_RECORDING
+/* 16-bit copy of the output for the recorder when the output is float */
+static THREAD_LOCAL SWORD *record_buffer = NULL;
+static THREAD_LOCAL int record_buffer_size = 0;
+#endif
 
 static void Update_pokey_sound_rf(UWORD, UBYTE, UBYTE, UBYTE);
 static void null_pokey_sound(UWORD addr, UBYTE val, UBYTE chip, UBYTE gain) {}
-void (*POKEYSND_Update_ptr) (UWORD addr, UBYTE val, UBYTE chip, UBYTE gain)
+THREAD_LOCAL void (*POKEYSND_Update_ptr) (UWORD addr, UBYTE val, UBYTE chip, UBYTE gain)
   = null_pokey_sound;
 
 #ifdef SERIO_SOUND
 static void Update_serio_sound_rf(int out, UBYTE data);
 static void null_serio_sound(int out, UBYTE data) {}
-void (*POKEYSND_UpdateSerio)(int out, UBYTE data) = null_serio_sound;
-int POKEYSND_serio_sound_enabled = 1;
+THREAD_LOCAL void (*POKEYSND_UpdateSerio)(int out, UBYTE data) = null_serio_sound;
+THREAD_LOCAL int POKEYSND_serio_sound_enabled = 1;
 #endif
 
 #ifdef CONSOLE_SOUND
 static void Update_consol_sound_rf(int set);
 static void null_consol_sound(int set) {}
-void (*POKEYSND_UpdateConsol_ptr)(int set) = null_consol_sound;
-int POKEYSND_console_sound_enabled = 1;
+THREAD_LOCAL void (*POKEYSND_UpdateConsol_ptr)(int set) = null_consol_sound;
+THREAD_LOCAL int POKEYSND_console_sound_enabled = 1;
 #endif
 
 #ifdef VOL_ONLY_SOUND
 static void Update_vol_only_sound_rf(void);
 static void null_vol_only_sound(void) {}
-void (*POKEYSND_UpdateVolOnly)(void) = null_vol_only_sound;
+THREAD_LOCAL void (*POKEYSND_UpdateVolOnly)(void) = null_vol_only_sound;
 #endif
 
 #ifdef SYNCHRONIZED_SOUND
 UBYTE *POKEYSND_process_buffer = NULL;
+float *POKEYSND_process_bus = NULL;
 unsigned int POKEYSND_process_buffer_length;
 unsigned int POKEYSND_process_buffer_fill;
 static unsigned int prev_update_tick;
@@ -228,6 +243,7 @@ void (*POKEYSND_GenerateSync)(unsigned int num_ticks) = null_generate_sync;
 
 static double ticks_per_sample;
 static double samp_pos;
+double POKEYSND_resample_ratio = 1.0;
 static int speaker;
 static int const CONSOLE_VOL = 32;
 #endif /* SYNCHRONIZED_SOUND */
@@ -338,10 +354,13 @@ int POKEYSND_Init(ULONG freq17, int playback_freq, UBYTE num_pokeys,
 		double samples_per_frame = (double)POKEYSND_playback_freq/(Atari800_tv_mode == Atari800_TV_PAL ? Atari800_FPS_PAL : Atari800_FPS_NTSC);
 		unsigned int ticks_per_frame = Atari800_tv_mode*114;
 		unsigned int max_ticks_per_frame = ticks_per_frame + surplus_ticks;
-		double ticks_per_sample = (double)ticks_per_frame / samples_per_frame;
-		POKEYSND_process_buffer_length = POKEYSND_num_pokeys * (unsigned int)ceil((double)max_ticks_per_frame / ticks_per_sample) * ((POKEYSND_snd_flags & POKEYSND_BIT16) ? 2:1);
+		/* the shortest ticks_per_sample that POKEYSND_resample_ratio allows */
+		double ticks_per_sample = (double)ticks_per_frame / samples_per_frame * (1.0 - POKEYSND_RESAMPLE_MAX_ADJUST);
+		POKEYSND_process_buffer_length = POKEYSND_num_pokeys * (unsigned int)ceil((double)max_ticks_per_frame / ticks_per_sample);
 		free(POKEYSND_process_buffer);
-		POKEYSND_process_buffer = (UBYTE *)Util_malloc(POKEYSND_process_buffer_length);
+		POKEYSND_process_buffer = (UBYTE *)Util_malloc(POKEYSND_process_buffer_length * POKEYSND_SAMPLE_SIZE(POKEYSND_snd_flags));
+		free(POKEYSND_process_bus);
+		POKEYSND_process_bus = (float *)Util_malloc(POKEYSND_process_buffer_length * sizeof(float));
 		POKEYSND_process_buffer_fill = 0;
 	    prev_update_tick = ANTIC_CPU_CLOCK;
 	}
@@ -358,14 +377,136 @@ void POKEYSND_SetMzQuality(int quality)	/* specially for win32, perhaps not need
 	mz_quality = quality;
 }
 
+/* State of the dither noise: a xorshift generator for each of 4 lanes, so
+   that the SIMD and the plain conversion produce the same noise. */
+static THREAD_LOCAL ULONG dither_state[4] = { 0x2545f491, 0x9e3779b9, 0x6a09e667, 0xbb67ae85 };
+
+/* Returns the next dither value of the lane, uniform in [-0.25, 0.25) */
+static float dither(int lane)
+{
+	ULONG x = dither_state[lane];
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	dither_state[lane] = x;
+	return (float) (x >> 8) * (0.5f / 16777216.0f) - 0.25f;
+}
+
+/* Returns a bus sample scaled, dithered and clipped to [lo, hi] */
+static int convert_sample(float x, float scale, float offset, float lo, float hi, int lane)
+{
+	int i;
+	x = x * scale + offset + dither(lane);
+	if (x < lo)
+		x = lo;
+	else if (x > hi)
+		x = hi;
+	/* round half up; the cast truncates toward zero, so step down for
+	   negative fractions instead of calling floor() */
+	x += 0.5f;
+	i = (int) x;
+	return (float) i > x ? i - 1 : i;
+}
+
+#ifdef SIMD_SSE2
+/* convert_sample for 4 bus samples at once */
+static __m128i convert4_sse(const float *bus, __m128 scale, __m128 offset, __m128 lo, __m128 hi, __m128i *state)
+{
+	__m128i x = *state;
+	__m128 d;
+	__m128 v;
+	x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+	x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+	x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+	*state = x;
+	d = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(x, 8)), _mm_set1_ps(0.5f / 16777216.0f)), _mm_set1_ps(0.25f));
+	v = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(bus), scale), offset), d);
+	v = _mm_min_ps(_mm_max_ps(v, lo), hi);
+	return _mm_cvtps_epi32(v);
+}
+#endif
+
+void POKEYSND_ConvertBus(void *sndbuffer, const float *bus, int sndn, int flags)
+{
+	int i = 0;
+
+	if (flags & POKEYSND_FLOAT32) {
+		memcpy(sndbuffer, bus, sndn * sizeof(float));
+		return;
+	}
+	if (flags & POKEYSND_BIT16) {
+		SWORD *out = (SWORD *) sndbuffer;
+#ifdef SIMD_SSE2
+		__m128 scale = _mm_set1_ps(32768.0f);
+		__m128 offset = _mm_setzero_ps();
+		__m128 lo = _mm_set1_ps(-32768.0f);
+		__m128 hi = _mm_set1_ps(32767.0f);
+		__m128i state = _mm_loadu_si128((const __m128i *) dither_state);
+		for (; i + 8 <= sndn; i += 8) {
+			__m128i a = convert4_sse(bus + i, scale, offset, lo, hi, &state);
+			__m128i b = convert4_sse(bus + i + 4, scale, offset, lo, hi, &state);
+			_mm_storeu_si128((__m128i *) (out + i), _mm_packs_epi32(a, b));
+		}
+		_mm_storeu_si128((__m128i *) dither_state, state);
+#endif
+		for (; i < sndn; i++)
+			out[i] = (SWORD) convert_sample(bus[i], 32768.0f, 0.0f, -32768.0f, 32767.0f, i & 3);
+	}
+	else {
+		UBYTE *out = (UBYTE *) sndbuffer;
+#ifdef SIMD_SSE2
+		__m128 scale = _mm_set1_ps(128.0f);
+		__m128 offset = _mm_set1_ps(POKEYSND_SAMP_MID);
+		__m128 lo = _mm_set1_ps(POKEYSND_SAMP_MIN);
+		__m128 hi = _mm_set1_ps(POKEYSND_SAMP_MAX);
+		__m128i state = _mm_loadu_si128((const __m128i *) dither_state);
+		for (; i + 8 <= sndn; i += 8) {
+			__m128i a = convert4_sse(bus + i, scale, offset, lo, hi, &state);
+			__m128i b = convert4_sse(bus + i + 4, scale, offset, lo, hi, &state);
+			__m128i w = _mm_packs_epi32(a, b);
+#ifndef POKEYSND_SIGNED_SAMPLES
+			_mm_storel_epi64((__m128i *) (out + i), _mm_packus_epi16(w, w));
+#else
+			_mm_storel_epi64((__m128i *) (out + i), _mm_packs_epi16(w, w));
+#endif
+		}
+		_mm_storeu_si128((__m128i *) dither_state, state);
+#endif
+		for (; i < sndn; i++)
+			out[i] = (UBYTE) convert_sample(bus[i], 128.0f, POKEYSND_SAMP_MID, POKEYSND_SAMP_MIN, POKEYSND_SAMP_MAX, i & 3);
+	}
+}
+
+#ifdef AUDIO_RECORDING
+/* Passes the converted output to the recorder, which takes 8- or 16-bit
+   samples only (see CODECS_AUDIO_Init). */
+static void record_audio(const void *sndbuffer, const float *bus, int sndn)
+{
+	if ((POKEYSND_snd_flags & POKEYSND_FLOAT32) && File_Export_IsRecording()) {
+		if (sndn > record_buffer_size) {
+			record_buffer_size = sndn;
+			record_buffer = (SWORD *) Util_realloc(record_buffer, sndn * sizeof(SWORD));
+		}
+		POKEYSND_ConvertBus(record_buffer, bus, sndn, POKEYSND_BIT16);
+		sndbuffer = record_buffer;
+	}
+	File_Export_WriteAudio((const UBYTE *) sndbuffer, sndn);
+}
+#endif
+
 void POKEYSND_Process(void *sndbuffer, int sndn)
 {
-	POKEYSND_Process_ptr(sndbuffer, sndn);
+	if (sndn > mix_bus_size) {
+		mix_bus_size = sndn;
+		mix_bus = (float *) Util_realloc(mix_bus, sndn * sizeof(float));
+	}
+	POKEYSND_Process_ptr(mix_bus, sndn);
 #if defined(PBI_XLD) || defined (VOICEBOX)
-	VOTRAXSND_Process(sndbuffer,sndn);
+	VOTRAXSND_Process(mix_bus, sndn);
 #endif
+	POKEYSND_ConvertBus(sndbuffer, mix_bus, sndn, POKEYSND_snd_flags);
 #if defined(AUDIO_RECORDING)
-	File_Export_WriteAudio((const unsigned char *)sndbuffer, sndn);
+	record_audio(sndbuffer, mix_bus, sndn);
 #endif
 }
 
@@ -380,14 +521,15 @@ int POKEYSND_UpdateProcessBuffer(void)
 {
 	int sndn;
 	Update_synchronized_sound();
-	sndn = POKEYSND_process_buffer_fill / ((POKEYSND_snd_flags & POKEYSND_BIT16) ? 2 : 1);
+	sndn = POKEYSND_process_buffer_fill;
 	POKEYSND_process_buffer_fill = 0;
 
 #if defined(PBI_XLD) || defined (VOICEBOX)
-	VOTRAXSND_Process(POKEYSND_process_buffer, sndn);
+	VOTRAXSND_Process(POKEYSND_process_bus, sndn);
 #endif
+	POKEYSND_ConvertBus(POKEYSND_process_buffer, POKEYSND_process_bus, sndn, POKEYSND_snd_flags);
 #if defined(AUDIO_RECORDING)
-	File_Export_WriteAudio((const unsigned char *)POKEYSND_process_buffer, sndn);
+	record_audio(POKEYSND_process_buffer, POKEYSND_process_bus, sndn);
 #endif
 	return sndn;
 }
@@ -421,7 +563,7 @@ static int pokeysnd_init_rf(ULONG freq17, int playback_freq,
 	POKEYSND_UpdateVolOnly = Update_vol_only_sound_rf;
 #endif
 
-	POKEYSND_Process_ptr = (flags & POKEYSND_BIT16) ? pokeysnd_process_16 : pokeysnd_process_8;
+	POKEYSND_Process_ptr = pokeysnd_process_f;
 
 #ifdef VOL_ONLY_SOUND
 	POKEYSND_samp_freq = playback_freq;
@@ -744,15 +886,24 @@ static void Update_pokey_sound_rf(UWORD addr, UBYTE val, UBYTE chip,
 /*                    plus right samples.                                    */
 /*          num_pokeys - number of currently active pokeys to process        */
 /*                                                                           */
-/* Outputs: the buffer will be filled with n bytes of audio - no return val  */
-/*          Also the buffer will be written to disk if Sound recording is ON */
+/* Outputs: the bus will be filled with n float samples - no return val     */
 /*                                                                           */
 /*****************************************************************************/
 
-static void pokeysnd_process_8(void *sndbuffer, int sndn)
+/* Turns an 8-bit engine sample into a bus sample. POKEYSND_volume only
+   scales the wider formats; the 8-bit output stays the engine's own samples. */
+#ifndef POKEYSND_SIGNED_SAMPLES
+#define RF_BUS_SAMPLE(x) ((float) ((int) (UBYTE) (x) - 0x80) * gain)
+#else
+#define RF_BUS_SAMPLE(x) ((float) (SBYTE) (x) * gain)
+#endif
+
+static void pokeysnd_process_f(float *bus, int sndn)
 {
-	register UBYTE *buffer = (UBYTE *) sndbuffer;
+	register float *buffer = bus;
 	register int n = sndn;
+	float gain = (float) ((POKEYSND_snd_flags & (POKEYSND_BIT16 | POKEYSND_FLOAT32))
+	                      ? POKEYSND_volume : 0x100) * (1.0f / 32768.0f);
 
 	register ULONG *div_n_ptr;
 	register UBYTE *samp_cnt_w_ptr;
@@ -1156,46 +1307,46 @@ static void pokeysnd_process_8(void *sndbuffer, int sndn)
 
 #ifdef CLIP_SOUND
 			if (iout > POKEYSND_SAMP_MAX) {	/* then check high limit */
-				*buffer++ = (UBYTE) POKEYSND_SAMP_MAX;	/* and limit if greater */
+				*buffer++ = RF_BUS_SAMPLE(POKEYSND_SAMP_MAX);	/* and limit if greater */
 			}
 			else if (iout < POKEYSND_SAMP_MIN) {		/* else check low limit */
-				*buffer++ = (UBYTE) POKEYSND_SAMP_MIN;	/* and limit if less */
+				*buffer++ = RF_BUS_SAMPLE(POKEYSND_SAMP_MIN);	/* and limit if less */
 			}
 			else {				/* otherwise use raw value */
-				*buffer++ = (UBYTE) iout;
+				*buffer++ = RF_BUS_SAMPLE(iout);
 			}
 #ifdef STEREO_SOUND
 #ifdef __PLUS
 			if (POKEYSND_stereo_enabled) {
 				if (iout2 > POKEYSND_SAMP_MAX)
-					*buffer++ = (UBYTE) POKEYSND_SAMP_MAX;
+					*buffer++ = RF_BUS_SAMPLE(POKEYSND_SAMP_MAX);
 				else if (iout2 < POKEYSND_SAMP_MIN)
-					*buffer++ = (UBYTE) POKEYSND_SAMP_MIN;
+					*buffer++ = RF_BUS_SAMPLE(POKEYSND_SAMP_MIN);
 				else
-					*buffer++ = (UBYTE) iout2;
+					*buffer++ = RF_BUS_SAMPLE(iout2);
 			}
 #else /* __PLUS */
 			if (Num_pokeys > 1) {
 				if ((POKEYSND_stereo_enabled ? iout2 : iout) > POKEYSND_SAMP_MAX) {	/* then check high limit */
-					*buffer++ = (UBYTE) POKEYSND_SAMP_MAX;	/* and limit if greater */
+					*buffer++ = RF_BUS_SAMPLE(POKEYSND_SAMP_MAX);	/* and limit if greater */
 				}
 				else if ((POKEYSND_stereo_enabled ? iout2 : iout) < POKEYSND_SAMP_MIN) {		/* else check low limit */
-					*buffer++ = (UBYTE) POKEYSND_SAMP_MIN;	/* and limit if less */
+					*buffer++ = RF_BUS_SAMPLE(POKEYSND_SAMP_MIN);	/* and limit if less */
 				}
 				else {				/* otherwise use raw value */
-					*buffer++ = (UBYTE) (POKEYSND_stereo_enabled ? iout2 : iout);
+					*buffer++ = RF_BUS_SAMPLE(POKEYSND_stereo_enabled ? iout2 : iout);
 				}
 			}
 #endif /* __PLUS */
 #endif /* STEREO_SOUND */
 #else /* CLIP_SOUND */
-			*buffer++ = (UBYTE) iout;	/* clipping not selected, use value */
+			*buffer++ = RF_BUS_SAMPLE(iout);	/* clipping not selected, use value */
 #ifdef STEREO_SOUND
 			if (Num_pokeys > 1)
 #ifdef ASAP
-				*buffer++ = (UBYTE) iout2;
+				*buffer++ = RF_BUS_SAMPLE(iout2);
 #else
-				*buffer++ = (UBYTE) (POKEYSND_stereo_enabled ? iout2 : iout);
+				*buffer++ = RF_BUS_SAMPLE(POKEYSND_stereo_enabled ? iout2 : iout);
 #endif
 #endif /* STEREO_SOUND */
 #endif /* CLIP_SOUND */
@@ -1234,6 +1385,8 @@ static void pokeysnd_process_8(void *sndbuffer, int sndn)
 #endif  /* VOL_ONLY_SOUND */
 }
 
+#undef RF_BUS_SAMPLE
+
 #ifdef SERIO_SOUND
 static void Update_serio_sound_rf(int out, UBYTE data)
 {
@@ -1287,39 +1440,17 @@ void POKEYSND_SetVolume(int vol)
     POKEYSND_volume = vol * 0x100 / 100;
 }
 
-static void pokeysnd_process_16(void *sndbuffer, int sndn)
-{
-	UWORD *buffer = (UWORD *) sndbuffer;
-	int i;
-
-	pokeysnd_process_8(buffer, sndn);
-
-	for (i = sndn - 1; i >= 0; i--) {
-#ifndef POKEYSND_SIGNED_SAMPLES
-		int smp = ((int) (((UBYTE *) buffer)[i]) - 0x80) * POKEYSND_volume;
-#else
-		int smp = ((int) ((SBYTE *) buffer)[i]) * POKEYSND_volume;
-#endif
-		if (smp > 32767)
-			smp = 32767;
-		else if (smp < -32768)
-			smp = -32768;
-
-		buffer[i] = smp;
-	}
-}
-
 #ifdef SYNCHRONIZED_SOUND
 static void Generate_sync_rf(unsigned int num_ticks)
 {
 	double new_samp_pos;
 	unsigned int ticks;
-	UBYTE *buffer = POKEYSND_process_buffer + POKEYSND_process_buffer_fill;
-	UBYTE *buffer_end = POKEYSND_process_buffer + POKEYSND_process_buffer_length;
+	float *buffer = POKEYSND_process_bus + POKEYSND_process_buffer_fill;
+	float *buffer_end = POKEYSND_process_bus + POKEYSND_process_buffer_length;
 
 	for (;;) {
 		double int_part;
-		new_samp_pos = samp_pos + ticks_per_sample;
+		new_samp_pos = samp_pos + ticks_per_sample * POKEYSND_resample_ratio;
 		new_samp_pos = modf(new_samp_pos, &int_part);
 		ticks = (unsigned int)int_part;
 		if (ticks > num_ticks) {
@@ -1332,18 +1463,11 @@ static void Generate_sync_rf(unsigned int num_ticks)
 		samp_pos = new_samp_pos;
 		num_ticks -= ticks;
 
-		if (POKEYSND_snd_flags & POKEYSND_BIT16) {
-			pokeysnd_process_16(buffer, POKEYSND_num_pokeys);
-			buffer += 2 * POKEYSND_num_pokeys;
-		}
-		else {
-			pokeysnd_process_8(buffer, POKEYSND_num_pokeys);
-			buffer += POKEYSND_num_pokeys;
-		}
-
+		pokeysnd_process_f(buffer, POKEYSND_num_pokeys);
+		buffer += POKEYSND_num_pokeys;
 	}
 
-	POKEYSND_process_buffer_fill = buffer - POKEYSND_process_buffer;
+	POKEYSND_process_buffer_fill = buffer - POKEYSND_process_bus;
 }
 #endif /* SYNCHRONIZED_SOUND */
 
@@ -1365,8 +1489,8 @@ static void Update_consol_sound_rf(int set)
 	if (set)
 		speaker = CONSOLE_VOL * GTIA_speaker;
 #elif defined(VOL_ONLY_SOUND)
-	static int prev_atari_speaker = 0;
-	static unsigned int prev_cpu_clock = 0;
+	static THREAD_LOCAL int prev_atari_speaker = 0;
+	static THREAD_LOCAL unsigned int prev_cpu_clock = 0;
 	int d;
 #ifdef __PLUS
 	if (!g_Sound.nDigitized)
@@ -78,23 +78,29 @@ extern "C" {
 
 /* init flags */
 #define POKEYSND_BIT16	1
-
-extern SLONG POKEYSND_playback_freq;
-extern UBYTE POKEYSND_num_pokeys;
-extern int POKEYSND_snd_flags;
-extern int POKEYSND_volume;
-
-extern int POKEYSND_enable_new_pokey;
-extern int POKEYSND_stereo_enabled;
-extern int POKEYSND_serio_sound_enabled;
-extern int POKEYSND_console_sound_enabled;
-extern int POKEYSND_bienias_fix;
-
-extern void (*POKEYSND_Process_ptr)(void *sndbuffer, int sndn);
-extern void (*POKEYSND_Update_ptr)(UWORD addr, UBYTE val, UBYTE chip, UBYTE gain);
-extern void (*POKEYSND_UpdateSerio)(int out, UBYTE data);
-extern void (*POKEYSND_UpdateConsol_ptr)(int set);
-extern void (*POKEYSND_UpdateVolOnly)(void);
+#define POKEYSND_FLOAT32	2	/* 32-bit float output, takes precedence over POKEYSND_BIT16 */
+
+/* Number of bytes in one output sample for the given init flags */
+#define POKEYSND_SAMPLE_SIZE(flags) (((flags) & POKEYSND_FLOAT32) ? 4 : ((flags) & POKEYSND_BIT16) ? 2 : 1)
+
+extern THREAD_LOCAL SLONG POKEYSND_playback_freq;
+extern THREAD_LOCAL UBYTE POKEYSND_num_pokeys;
+extern THREAD_LOCAL int POKEYSND_snd_flags;
+extern THREAD_LOCAL int POKEYSND_volume;
+
+extern THREAD_LOCAL int POKEYSND_enable_new_pokey;
+extern THREAD_LOCAL int POKEYSND_stereo_enabled;
+extern THREAD_LOCAL int POKEYSND_serio_sound_enabled;
+extern THREAD_LOCAL int POKEYSND_console_sound_enabled;
+extern THREAD_LOCAL int POKEYSND_bienias_fix;
+
+/* The sound engines render into a mixing bus of interleaved floats, where
+   +/-1.0 is the full scale of the output format. */
+extern THREAD_LOCAL void (*POKEYSND_Process_ptr)(float *bus, int sndn);
+extern THREAD_LOCAL void (*POKEYSND_Update_ptr)(UWORD addr, UBYTE val, UBYTE chip, UBYTE gain);
+extern THREAD_LOCAL void (*POKEYSND_UpdateSerio)(int out, UBYTE data);
+extern THREAD_LOCAL void (*POKEYSND_UpdateConsol_ptr)(int set);
+extern THREAD_LOCAL void (*POKEYSND_UpdateVolOnly)(void);
 
 int POKEYSND_Init(ULONG freq17, int playback_freq, UBYTE num_pokeys,
                      int flags
@@ -106,9 +112,12 @@ void POKEYSND_Update(UWORD addr, UBYTE val, UBYTE /*chip*/, UBYTE gain);
 void POKEYSND_UpdateConsol(int set);
 
 /* Fill sndbuffer with sndn samples of audio. Number of bytes written to
-   sndbuffer is sndn with 8-bit sound, and 2*sndn with 16-bit sound. sndn
+   sndbuffer is sndn * POKEYSND_SAMPLE_SIZE(POKEYSND_snd_flags). sndn
    must be a multiple of POKEYSND_num_pokeys. */
 void POKEYSND_Process(void *sndbuffer, int sndn);
+/* Convert sndn samples of a mixing bus to the output format given by the
+   init flags. 8- and 16-bit output is dithered and clipped. */
+void POKEYSND_ConvertBus(void *sndbuffer, const float *bus, int sndn, int flags);
 int POKEYSND_DoInit(void);
 void POKEYSND_SetMzQuality(int quality);
 void POKEYSND_SetVolume(int vol);
@@ -117,24 +126,33 @@ void POKEYSND_SetVolume(int vol);
 #ifdef VOL_ONLY_SOUND
 
 #define	POKEYSND_SAMPBUF_MAX	2000
-extern int	POKEYSND_sampbuf_val[POKEYSND_SAMPBUF_MAX];	/* volume values */
-extern int	POKEYSND_sampbuf_cnt[POKEYSND_SAMPBUF_MAX];	/* relative start time */
-extern int	POKEYSND_sampbuf_ptr;                    /* pointer to sampbuf */
-extern int	POKEYSND_sampbuf_rptr;                   /* pointer to read from sampbuf */
-extern int	POKEYSND_sampbuf_last;                   /* last absolute time */
-extern int	POKEYSND_sampbuf_AUDV[4 * POKEY_MAXPOKEYS];	/* prev. channel volume */
-extern int	POKEYSND_sampbuf_lastval;		/* last volume */
-extern int	POKEYSND_sampout;			/* last out volume */
-extern int	POKEYSND_samp_freq;
-extern int	POKEYSND_samp_consol_val;		/* actual value of console sound */
+extern THREAD_LOCAL int	POKEYSND_sampbuf_val[POKEYSND_SAMPBUF_MAX];	/* volume values */
+extern THREAD_LOCAL int	POKEYSND_sampbuf_cnt[POKEYSND_SAMPBUF_MAX];	/* relative start time */
+extern THREAD_LOCAL int	POKEYSND_sampbuf_ptr;                    /* pointer to sampbuf */
+extern THREAD_LOCAL int	POKEYSND_sampbuf_rptr;                   /* pointer to read from sampbuf */
+extern THREAD_LOCAL int	POKEYSND_sampbuf_last;                   /* last absolute time */
+extern THREAD_LOCAL int	POKEYSND_sampbuf_AUDV[4 * POKEY_MAXPOKEYS];	/* prev. channel volume */
+extern THREAD_LOCAL int	POKEYSND_sampbuf_lastval;		/* last volume */
+extern THREAD_LOCAL int	POKEYSND_sampout;			/* last out volume */
+extern THREAD_LOCAL int	POKEYSND_samp_freq;
+extern THREAD_LOCAL int	POKEYSND_samp_consol_val;		/* actual value of console sound */
 #endif  /* VOL_ONLY_SOUND */
 
 #ifdef SYNCHRONIZED_SOUND
+/* The sync engines render into POKEYSND_process_bus; length and fill are
+   in samples. POKEYSND_UpdateProcessBuffer converts the bus to the output
+   format in POKEYSND_process_buffer and returns the number of samples. */
 extern UBYTE *POKEYSND_process_buffer;
+extern float *POKEYSND_process_bus;
 extern unsigned int POKEYSND_process_buffer_length;
 extern unsigned int POKEYSND_process_buffer_fill;
 extern void (*POKEYSND_GenerateSync)(unsigned int num_ticks);
 int POKEYSND_UpdateProcessBuffer(void);
+/* Multiplies the number of CPU ticks per generated sample, to adjust the
+   sample rate to the audio output's clock (see Sound_drc). Must stay
+   within 1.0 +/- POKEYSND_RESAMPLE_MAX_ADJUST. */
+extern double POKEYSND_resample_ratio;
+#define POKEYSND_RESAMPLE_MAX_ADJUST 0.005
 #endif /* SYNCHRONIZED_SOUND */
 
 #ifdef __cplusplus
@@ -0,0 +1,323 @@
+/*
+ * profile.c - measure where the time of each emulated frame goes
+ *
+ * Copyright (C) 2021 Atari800 development team (see DOC/CREDITS)
+ *
+ * This file is part of the Atari800 emulator project which emulates
+ * the Atari 400, 800, 800XL, 130XE, and 5200 8-bit computers.
+ *
+ * Atari800 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Atari800 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Atari800; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/* The emulator is always in exactly one section (see profile.h). Each
+   PROFILE_SWITCH reads the clock once and charges the time since the
+   previous switch to the section being left, so the sections of a frame
+   add up to its total time. Sections nested in the CPU (SIO) switch back
+   to PROFILE_CPU when they are done.
+
+   The time spent writing the frame records is not charged to any frame. */
+
+#define _POSIX_C_SOURCE 199309L /* for clock_gettime */
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_CLOCK_GETTIME
+#include <time.h>
+#elif defined(HAVE_WINDOWS_H)
+#include <windows.h>
+#endif
+
+#include "atari.h"
+#include "log.h"
+#include "profile.h"
+#include "util.h"
+
+THREAD_LOCAL int Profile_enabled = FALSE;
+THREAD_LOCAL int Profile_section = PROFILE_OTHER;
+
+static const char * const section_names[PROFILE_SECTIONS] = {
+	"cpu", "antic", "gtia", "pokey", "sio", "display", "sync", "other"
+};
+
+static THREAD_LOCAL FILE *output = NULL;
+static THREAD_LOCAL int output_csv = FALSE;
+
+/* the frame being measured */
+static THREAD_LOCAL int frame_started = FALSE;
+static THREAD_LOCAL ULONG frame_number;
+static THREAD_LOCAL double last_time;
+static THREAD_LOCAL double frame_us[PROFILE_SECTIONS];
+static THREAD_LOCAL ULONG frame_calls[PROFILE_SECTIONS];
+
+/* Times of all the frames measured so far, for the percentiles:
+   PROFILE_SECTIONS + 1 entries per frame, the last one is the total. */
+#define HISTORY_STRIDE (PROFILE_SECTIONS + 1)
+static THREAD_LOCAL float *history = NULL;
+static THREAD_LOCAL ULONG history_frames = 0;
+static THREAD_LOCAL ULONG history_size = 0;
+static THREAD_LOCAL double total_calls[PROFILE_SECTIONS];
+
+/* Returns the current time in microseconds */
+static double Now(void)
+{
+#ifdef HAVE_CLOCK_GETTIME
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e6 + ts.tv_nsec * 1e-3;
+#elif defined(HAVE_WINDOWS_H)
+	static double us_per_count = 0.0;
+	LARGE_INTEGER count;
+	if (us_per_count == 0.0) {
+		LARGE_INTEGER freq;
+		QueryPerformanceFrequency(&freq);
+		us_per_count = 1e6 / (double) freq.QuadPart;
+	}
+	QueryPerformanceCounter(&count);
+	return (double) count.QuadPart * us_per_count;
+#else
+	return Util_time() * 1e6;
+#endif
+}
+
+void Profile_Switch(int section)
+{
+	double now = Now();
+	frame_us[Profile_section] += now - last_time;
+	last_time = now;
+	Profile_section = section;
+	frame_calls[section]++;
+}
+
+static void WriteHeader(void)
+{
+	int i;
+	if (!output_csv)
+		return;
+	fputs("frame,total_us", output);
+	for (i = 0; i < PROFILE_SECTIONS; i++)
+		fprintf(output, ",%s_us,%s_calls", section_names[i], section_names[i]);
+	fputc('\n', output);
+}
+
+static void WriteFrame(double total)
+{
+	int i;
+	if (output_csv) {
+		fprintf(output, "%lu,%.2f", (unsigned long) frame_number, total);
+		for (i = 0; i < PROFILE_SECTIONS; i++)
+			fprintf(output, ",%.2f,%lu", frame_us[i], (unsigned long) frame_calls[i]);
+	}
+	else {
+		fprintf(output, "{\"frame\":%lu,\"total_us\":%.2f", (unsigned long) frame_number, total);
+		for (i = 0; i < PROFILE_SECTIONS; i++)
+			fprintf(output, ",\"%s\":{\"us\":%.2f,\"calls\":%lu}",
+			        section_names[i], frame_us[i], (unsigned long) frame_calls[i]);
+		fputc('}', output);
+	}
+	fputc('\n', output);
+}
+
+/* Finishes the frame being measured */
+static void EndFrame(void)
+{
+	double total = 0.0;
+	float *h;
+	int i;
+
+	frame_us[Profile_section] += Now() - last_time;
+	for (i = 0; i < PROFILE_SECTIONS; i++)
+		total += frame_us[i];
+
+	if (output != NULL)
+		WriteFrame(total);
+
+	if (history_frames >= history_size) {
+		history_size = history_size == 0 ? 4096 : history_size * 2;
+		history = (float *) Util_realloc(history, history_size * HISTORY_STRIDE * sizeof(float));
+	}
+	h = history + history_frames * HISTORY_STRIDE;
+	for (i = 0; i < PROFILE_SECTIONS; i++) {
+		h[i] = (float) frame_us[i];
+		total_calls[i] += frame_calls[i];
+	}
+	h[PROFILE_SECTIONS] = (float) total;
+	history_frames++;
+}
+
+void Profile_Frame(void)
+{
+	if (!Profile_enabled)
+		return;
+	if (frame_started) {
+		EndFrame();
+		frame_number++;
+	}
+	frame_started = TRUE;
+	memset(frame_us, 0, sizeof(frame_us));
+	memset(frame_calls, 0, sizeof(frame_calls));
+	Profile_section = PROFILE_OTHER;
+	last_time = Now();
+}
+
+int Profile_Start(const char *filename, int csv)
+{
+	Profile_Stop();
+	if (filename != NULL) {
+		output = fopen(filename, "w");
+		if (output == NULL) {
+			Log_print("Cannot create profile file %s", filename);
+			return FALSE;
+		}
+		output_csv = csv;
+		WriteHeader();
+	}
+	frame_started = FALSE;
+	frame_number = 0;
+	history_frames = 0;
+	memset(total_calls, 0, sizeof(total_calls));
+	Profile_enabled = TRUE;
+	return TRUE;
+}
+
+static int CompareFloats(const void *a, const void *b)
+{
+	float x = *(const float *) a;
+	float y = *(const float *) b;
+	return x < y ? -1 : x > y;
+}
+
+/* Returns the nearest-rank percentile p of the sorted values */
+static float Percentile(const float *sorted, ULONG n, int p)
+{
+	ULONG rank = (n * p + 99) / 100;
+	return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+static void Summary(void)
+{
+	float *column;
+	ULONG n = history_frames;
+	int i;
+
+	column = (float *) Util_malloc(n * sizeof(float));
+	Log_print("Profile of %lu frames, in microseconds per frame:", (unsigned long) n);
+	Log_print("section      mean      p50      p90      p99      max  calls/frame");
+	if (output != NULL && !output_csv)
+		fprintf(output, "{\"summary\":{\"frames\":%lu", (unsigned long) n);
+	for (i = 0; i <= PROFILE_SECTIONS; i++) {
+		const char *name = i < PROFILE_SECTIONS ? section_names[i] : "total";
+		double sum = 0.0;
+		double calls = 0.0;
+		ULONG f;
+		if (i < PROFILE_SECTIONS)
+			calls = total_calls[i];
+		else {
+			int k;
+			for (k = 0; k < PROFILE_SECTIONS; k++)
+				calls += total_calls[k];
+		}
+		for (f = 0; f < n; f++) {
+			column[f] = history[f * HISTORY_STRIDE + i];
+			sum += column[f];
+		}
+		qsort(column, n, sizeof(float), CompareFloats);
+		Log_print("%-8s%9.1f%9.1f%9.1f%9.1f%9.1f%13.1f", name, sum / n,
+		          Percentile(column, n, 50), Percentile(column, n, 90),
+		          Percentile(column, n, 99), column[n - 1], calls / n);
+		if (output != NULL && !output_csv)
+			fprintf(output, ",\"%s\":{\"mean\":%.2f,\"p50\":%.2f,\"p90\":%.2f,\"p99\":%.2f,\"max\":%.2f}",
+			        name, sum / n, Percentile(column, n, 50), Percentile(column, n, 90),
+			        Percentile(column, n, 99), column[n - 1]);
+	}
+	if (output != NULL && !output_csv)
+		fputs("}}\n", output);
+	free(column);
+}
+
+void Profile_Stop(void)
+{
+	if (!Profile_enabled)
+		return;
+	Profile_enabled = FALSE;
+	if (frame_started)
+		EndFrame();
+	if (history_frames > 0)
+		Summary();
+	if (output != NULL) {
+		fclose(output);
+		output = NULL;
+	}
+	free(history);
+	history = NULL;
+	history_size = 0;
+	history_frames = 0;
+	frame_started = FALSE;
+	Profile_section = PROFILE_OTHER;
+}
+
+int Profile_Initialise(int *argc, char *argv[])
+{
+	int i, j;
+	const char *filename = NULL;
+	int csv = FALSE;
+	int enable = FALSE;
+
+	for (i = j = 1; i < *argc; i++) {
+		int i_a = (i + 1 < *argc);		/* is argument available? */
+		int a_m = FALSE;			/* error, argument missing! */
+
+		if (strcmp(argv[i], "-profile") == 0)
+			enable = TRUE;
+		else if (strcmp(argv[i], "-profile-file") == 0) {
+			if (i_a) {
+				filename = argv[++i];
+				enable = TRUE;
+			}
+			else a_m = TRUE;
+		}
+		else if (strcmp(argv[i], "-profile-csv") == 0)
+			csv = TRUE;
+		else {
+			if (strcmp(argv[i], "-help") == 0) {
+				Log_print("\t-profile         Log the percentiles of frame times on exit");
+				Log_print("\t-profile-file <file>");
+				Log_print("\t                 Also write the times of each frame to <file>");
+				Log_print("\t-profile-csv     Write the frame times as CSV (default: JSON lines)");
+			}
+			argv[j++] = argv[i];
+		}
+
+		if (a_m) {
+			Log_print("Missing argument for '%s'", argv[i]);
+			return FALSE;
+		}
+	}
+	*argc = j;
+
+	if (enable)
+		return Profile_Start(filename, csv);
+	return TRUE;
+}
+
+void Profile_Exit(void)
+{
+	Profile_Stop();
+}
+
+/*
+vim:ts=4:sw=4:
+*/
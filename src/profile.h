@@ -0,0 +1,45 @@
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include "atari.h"
+
+/* Sections of the emulation that frame time is charged to */
+enum {
+	PROFILE_CPU,		/* CPU_GO and the ANTIC timing around it */
+	PROFILE_ANTIC,		/* drawing the playfield */
+	PROFILE_GTIA,		/* players, missiles and their collisions */
+	PROFILE_POKEY,		/* POKEY frame and sound generation */
+	PROFILE_SIO,		/* disk operations */
+	PROFILE_DISPLAY,	/* copying the screen to the host display */
+	PROFILE_SYNC,		/* waiting for the host's frame rate */
+	PROFILE_OTHER,		/* everything else, including the host between frames */
+	PROFILE_SECTIONS
+};
+
+extern THREAD_LOCAL int Profile_enabled;
+extern THREAD_LOCAL int Profile_section;
+
+/* Charges the time since the previous switch to Profile_section and makes
+   section the current one. */
+void Profile_Switch(int section);
+
+#ifdef PROFILER
+#define PROFILE_SWITCH(section) do { if (Profile_enabled) Profile_Switch(section); } while (0)
+#else
+#define PROFILE_SWITCH(section) do {} while (0)
+#endif
+
+/* Called at the start of each emulated frame. */
+void Profile_Frame(void);
+
+/* Starts profiling. If filename is not NULL, a record of each frame is
+   written to it, as CSV if csv is TRUE or as JSON lines otherwise.
+   Returns FALSE if the file cannot be created. */
+int Profile_Start(const char *filename, int csv);
+/* Stops profiling and logs the percentiles of the frame times. */
+void Profile_Stop(void);
+
+int Profile_Initialise(int *argc, char *argv[]);
+void Profile_Exit(void);
+
+#endif /* PROFILE_H_ */
@@ -191,37 +191,37 @@ extern void dc_set_baud(int baud);
 /*---------------------------------------------------------------------------
   Global Variables
 ---------------------------------------------------------------------------*/
-static int connected;
-static int do_once;
-static int rdev_fd;
+static THREAD_LOCAL int connected;
+static THREAD_LOCAL int do_once;
+static THREAD_LOCAL int rdev_fd;
 
 #ifdef R_NETWORK
-static struct sockaddr_in in;
-static struct sockaddr_in peer_in;
-static int sock;
-static int portnum = 9000;
-static char inetaddress[256];
+static THREAD_LOCAL struct sockaddr_in in;
+static THREAD_LOCAL struct sockaddr_in peer_in;
+static THREAD_LOCAL int sock;
+static THREAD_LOCAL int portnum = 9000;
+static THREAD_LOCAL char inetaddress[256];
 static char CONNECT_STRING[40] = "\r\n_CONNECT 2400\r\n";
 static int retval;
 #endif /* R_NETWORK */
 
-static char MESSAGE[256];
-static char command_buf[256];
-static char bufout[256];
-static int concurrent;
+static THREAD_LOCAL char MESSAGE[256];
+static THREAD_LOCAL char command_buf[256];
+static THREAD_LOCAL char bufout[256];
+static THREAD_LOCAL int concurrent;
 
-static int command_end = 0;
-static int translation = 1;
-static int trans_cr = 0;
-static int linefeeds = 1;
-static int bufend = 0;
+static THREAD_LOCAL int command_end = 0;
+static THREAD_LOCAL int translation = 1;
+static THREAD_LOCAL int trans_cr = 0;
+static THREAD_LOCAL int linefeeds = 1;
+static THREAD_LOCAL int bufend = 0;
 
 #ifndef R_NETWORK
-int RDevice_serial_enabled = 1;
+THREAD_LOCAL int RDevice_serial_enabled = 1;
 #else
-int RDevice_serial_enabled = 0;  /* Default to network, if enabled. Use parameter to -rdevice command line switch to enable serial mode. */
+THREAD_LOCAL int RDevice_serial_enabled = 0;  /* Default to network, if enabled. Use parameter to -rdevice command line switch to enable serial mode. */
 #endif
-char RDevice_serial_device[FILENAME_MAX];
+THREAD_LOCAL char RDevice_serial_device[FILENAME_MAX];
 
 /*---------------------------------------------------------------------------
    Host Support Function - If Disconnect signal is found, then close socket
@@ -25,6 +25,8 @@
 #ifndef RDEVICE_H_
 #define RDEVICE_H_
 
+#include "atari.h"
+
 extern void RDevice_OPEN(void);
 extern void RDevice_CLOS(void);
 extern void RDevice_READ(void);
@@ -33,8 +35,8 @@ extern void RDevice_STAT(void);
 extern void RDevice_SPEC(void);
 extern void RDevice_INIT(void);
 
-extern int RDevice_serial_enabled;
-extern char RDevice_serial_device[];
+extern THREAD_LOCAL int RDevice_serial_enabled;
+extern THREAD_LOCAL char RDevice_serial_device[];
 
 extern void RDevice_Exit(void);
 
@@ -19,7 +19,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 
 #include "atari.h"
 
-extern int RTIME_enabled;
+extern THREAD_LOCAL int RTIME_enabled;
 
 int RTIME_ReadConfig(char *string, char *ptr);
 void RTIME_WriteConfig(FILE *fp);
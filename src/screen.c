@@ -37,12 +37,15 @@
 #include "pia.h"
 #include "screen.h"
 #include "sio.h"
+#ifdef SYNCHRONIZED_SOUND
+#include "sound.h"
+#endif
 #include "util.h"
 #if defined(SCREENSHOTS) || defined(AUDIO_RECORDING) || defined(VIDEO_RECORDING)
 #include "file_export.h"
 #endif
 
-ULONG *Screen_atari = NULL;
+THREAD_LOCAL ULONG *Screen_atari = NULL;
 #ifdef DIRTYRECT
 UBYTE *Screen_dirty = NULL;
 #endif
@@ -59,15 +62,15 @@ ULONG *Screen_atari2 = NULL;
    Currently Screen_visible variables are used only to place
    disk led and snailmeter in the corners of the screen.
 */
-int Screen_visible_x1 = 24;				/* 0 .. Screen_WIDTH */
-int Screen_visible_y1 = 0;				/* 0 .. Screen_HEIGHT */
-int Screen_visible_x2 = 360;			/* 0 .. Screen_WIDTH */
-int Screen_visible_y2 = Screen_HEIGHT;	/* 0 .. Screen_HEIGHT */
+THREAD_LOCAL int Screen_visible_x1 = 24;				/* 0 .. Screen_WIDTH */
+THREAD_LOCAL int Screen_visible_y1 = 0;				/* 0 .. Screen_HEIGHT */
+THREAD_LOCAL int Screen_visible_x2 = 360;			/* 0 .. Screen_WIDTH */
+THREAD_LOCAL int Screen_visible_y2 = Screen_HEIGHT;	/* 0 .. Screen_HEIGHT */
 
-int Screen_show_atari_speed = FALSE;
-int Screen_show_disk_led = TRUE;
-int Screen_show_sector_counter = FALSE;
-int Screen_show_1200_leds = TRUE;
+THREAD_LOCAL int Screen_show_atari_speed = FALSE;
+THREAD_LOCAL int Screen_show_disk_led = TRUE;
+THREAD_LOCAL int Screen_show_sector_counter = FALSE;
+THREAD_LOCAL int Screen_show_1200_leds = TRUE;
 
 #ifdef SCREENSHOTS
 #ifdef HAVE_LIBPNG
@@ -76,13 +79,16 @@ int Screen_show_1200_leds = TRUE;
 #define DEFAULT_SCREENSHOT_FILENAME_FORMAT "atari###.pcx"
 #endif
 
-static char screenshot_filename_format[FILENAME_MAX];
-static int screenshot_no_last = -1;
-static int screenshot_no_max = 0;
+static THREAD_LOCAL char screenshot_filename_format[FILENAME_MAX];
+static THREAD_LOCAL int screenshot_no_last = -1;
+static THREAD_LOCAL int screenshot_no_max = 0;
 #endif /* !SCREENSHOTS */
 
 #if defined(AUDIO_RECORDING) || defined(VIDEO_RECORDING)
-int Screen_show_multimedia_stats = TRUE;
+THREAD_LOCAL int Screen_show_multimedia_stats = TRUE;
+#endif
+#ifdef SYNCHRONIZED_SOUND
+THREAD_LOCAL int Screen_show_sound_stats = FALSE;
 #endif
 
 int Screen_Initialise(int *argc, char *argv[])
@@ -116,6 +122,11 @@ int Screen_Initialise(int *argc, char *argv[])
 		else if (strcmp(argv[i], "-showspeed") == 0) {
 			Screen_show_atari_speed = TRUE;
 		}
+#ifdef SYNCHRONIZED_SOUND
+		else if (strcmp(argv[i], "-showsoundstats") == 0) {
+			Screen_show_sound_stats = TRUE;
+		}
+#endif
 		else {
 			if (strcmp(argv[i], "-help") == 0) {
 				help_only = TRUE;
@@ -127,6 +138,9 @@ int Screen_Initialise(int *argc, char *argv[])
 				Log_print("\t-no-showstats    Don't show recording stats of video or audio");
 #endif
 				Log_print("\t-showspeed       Show percentage of actual speed");
+#ifdef SYNCHRONIZED_SOUND
+				Log_print("\t-showsoundstats  Show fill of the sound buffer and underruns");
+#endif
 			}
 			argv[j++] = argv[i];
 		}
@@ -176,6 +190,10 @@ int Screen_ReadConfig(char *string, char *ptr)
 #if defined(AUDIO_RECORDING) || defined(VIDEO_RECORDING)
 	else if (strcmp(string, "SCREEN_SHOW_MULTIMEDIA_STATS") == 0)
 		return (Screen_show_multimedia_stats = Util_sscanbool(ptr)) != -1;
+#endif
+#ifdef SYNCHRONIZED_SOUND
+	else if (strcmp(string, "SCREEN_SHOW_SOUND_STATS") == 0)
+		return (Screen_show_sound_stats = Util_sscanbool(ptr)) != -1;
 #endif
 	else return FALSE;
 	return TRUE;
@@ -190,6 +208,9 @@ void Screen_WriteConfig(FILE *fp)
 #if defined(AUDIO_RECORDING) || defined(VIDEO_RECORDING)
 	fprintf(fp, "SCREEN_SHOW_MULTIMEDIA_STATS=%d\n", Screen_show_multimedia_stats);
 #endif
+#ifdef SYNCHRONIZED_SOUND
+	fprintf(fp, "SCREEN_SHOW_SOUND_STATS=%d\n", Screen_show_sound_stats);
+#endif
 }
 
 #define SMALLFONT_WIDTH    5
@@ -647,12 +668,42 @@ static UBYTE *SmallFont_DrawInt(UBYTE *screen, int n, UBYTE color1, UBYTE color2
 	return screen;
 }
 
+#if defined(AUDIO_RECORDING) || defined(VIDEO_RECORDING) || defined(SYNCHRONIZED_SOUND)
+static UBYTE *SmallFont_DrawString(UBYTE *screen, char *s, UBYTE color1, UBYTE color2)
+{
+	char cin;
+	char cout;
+
+	while (*s) {
+		cin = *s++;
+		if ((cin >= '0') && (cin <= '9')) {
+			cout = cin - '0';
+		}
+		else if ((cin >= 'A') && (cin <= 'Z')) {
+			cout = cin - 'A' + SMALLFONT_A;
+		}
+		else if ((cin >= 'a') && (cin <= 'z')) {
+			cout = cin - 'a' + SMALLFONT_A;
+		}
+		else if (cin == '_') {
+			cout = SMALLFONT_UNDER;
+		}
+		else {
+			cout = SMALLFONT_SPACE;
+		}
+		SmallFont_DrawChar(screen, cout, color1, color2);
+		screen += SMALLFONT_WIDTH;
+	}
+	return screen;
+}
+#endif
+
 void Screen_DrawAtariSpeed(double cur_time)
 {
 	if (Screen_show_atari_speed) {
-		static int percent_display = 100;
-		static int last_updated = 0;
-		static double last_time = 0;
+		static THREAD_LOCAL int percent_display = 100;
+		static THREAD_LOCAL int last_updated = 0;
+		static THREAD_LOCAL double last_time = 0;
 		if ((cur_time - last_time) >= 0.5) {
 			percent_display = (int) (100 * (Atari800_nframes - last_updated) / (cur_time - last_time) / (Atari800_tv_mode == Atari800_TV_PAL ? 50 : 60));
 			last_updated = Atari800_nframes;
@@ -669,6 +720,32 @@ void Screen_DrawAtariSpeed(double cur_time)
 	}
 }
 
+#ifdef SYNCHRONIZED_SOUND
+void Screen_DrawSoundStats(double cur_time)
+{
+	if (Screen_show_sound_stats) {
+		static THREAD_LOCAL Sound_stats_t stats;
+		static THREAD_LOCAL double last_time = 0;
+		UBYTE *screen = (UBYTE *) Screen_atari + Screen_visible_x1 + Screen_visible_y1 * Screen_WIDTH;
+		/* the lowest fill is taken over the time between updates */
+		if ((cur_time - last_time) >= 0.5) {
+			Sound_GetStats(&stats);
+			last_time = cur_time;
+		}
+		/* sizes in frames: "SOUND 99999/99999  LOW 99999  UNDERRUNS 999999" */
+		screen = SmallFont_DrawString(screen, "SOUND      ", 0x0c, 0x00);
+		SmallFont_DrawInt(screen - SMALLFONT_WIDTH, (int) stats.fill, 0x0c, 0x00);
+		SmallFont_DrawChar(screen, SMALLFONT_SLASH, 0x0c, 0x00);
+		screen = SmallFont_DrawString(screen + SMALLFONT_WIDTH, "     ", 0x0c, 0x00);
+		SmallFont_DrawInt(screen - SMALLFONT_WIDTH, (int) stats.size, 0x0c, 0x00);
+		screen = SmallFont_DrawString(screen, "  LOW      ", 0x0c, 0x00);
+		SmallFont_DrawInt(screen - SMALLFONT_WIDTH, (int) stats.min_fill, 0x0c, 0x00);
+		screen = SmallFont_DrawString(screen, "  UNDERRUNS       ", 0x0c, 0x00);
+		SmallFont_DrawInt(screen - SMALLFONT_WIDTH, stats.underflows > 999999 ? 999999 : (int) stats.underflows, 0x0c, 0x00);
+	}
+}
+#endif /* SYNCHRONIZED_SOUND */
+
 void Screen_DrawDiskLED(void)
 {
 	if (Screen_show_disk_led || Screen_show_sector_counter) {
@@ -751,34 +828,6 @@ static UBYTE *SmallFont_DrawFloat(UBYTE *screen, float f, int num_decimal_places
 	return screen;
 }
 
-static UBYTE *SmallFont_DrawString(UBYTE *screen, char *s, UBYTE color1, UBYTE color2)
-{
-	char cin;
-	char cout;
-
-	while (*s) {
-		cin = *s++;
-		if ((cin >= '0') && (cin <= '9')) {
-			cout = cin - '0';
-		}
-		else if ((cin >= 'A') && (cin <= 'Z')) {
-			cout = cin - 'A' + SMALLFONT_A;
-		}
-		else if ((cin >= 'a') && (cin <= 'z')) {
-			cout = cin - 'a' + SMALLFONT_A;
-		}
-		else if (cin == '_') {
-			cout = SMALLFONT_UNDER;
-		}
-		else {
-			cout = SMALLFONT_SPACE;
-		}
-		SmallFont_DrawChar(screen, cout, color1, color2);
-		screen += SMALLFONT_WIDTH;
-	}
-	return screen;
-}
-
 void Screen_DrawMultimediaStats(void)
 {
 	if (Screen_show_multimedia_stats) {
@@ -790,6 +839,10 @@ void Screen_DrawMultimediaStats(void)
 		int decimal_digits;
 		char *media_description;
 		UBYTE *screen;
+		int queued;
+		int max_queued;
+		int queue_size;
+		ULONG stalls;
 
 		if (File_Export_GetRecordingStats(&elapsed_time, &size, &media_description)) {
 			num = 10 + strlen(media_description) + 2 + 7 + 2 + 6;
@@ -846,6 +899,20 @@ void Screen_DrawMultimediaStats(void)
 			screen += SMALLFONT_WIDTH;
 			SmallFont_DrawChar(screen, SMALLFONT_B, 0x0f, 0x34);
 		}
+
+		/* once the encoder has fallen behind, show how far: "QUEUE 99/16  STALLS 999999" */
+		if (File_Export_GetQueueStats(&queued, &max_queued, &queue_size, &stalls) && (max_queued > 1 || stalls > 0)) {
+			num = 6 + 5 + 9 + 6;
+			screen = (UBYTE *) Screen_atari + Screen_visible_x1 + (Screen_visible_x2 - Screen_visible_x1) / 2 - (num * SMALLFONT_WIDTH) / 2 + (Screen_visible_y2 - 2 * SMALLFONT_HEIGHT) * Screen_WIDTH;
+
+			screen = SmallFont_DrawString(screen, "QUEUE  ", 0x0f, 0x34);
+			SmallFont_DrawInt(screen - SMALLFONT_WIDTH, queued, 0x0f, 0x34);
+			SmallFont_DrawChar(screen, SMALLFONT_SLASH, 0x0f, 0x34);
+			screen = SmallFont_DrawString(screen + SMALLFONT_WIDTH, "  ", 0x0f, 0x34);
+			SmallFont_DrawInt(screen - SMALLFONT_WIDTH, queue_size, 0x0f, 0x34);
+			screen = SmallFont_DrawString(screen, "  STALLS       ", 0x0f, 0x34);
+			SmallFont_DrawInt(screen - SMALLFONT_WIDTH, stalls > 999999 ? 999999 : (int) stalls, 0x0f, 0x34);
+		}
 	}
 }
 #endif /* defined(AUDIO_RECORDING) || defined(VIDEO_RECORDING) */
@@ -11,7 +11,7 @@ extern UBYTE *Screen_dirty;
 #endif /* CLIENTUPDATE */
 #endif /* DIRTYRECT */
 
-extern ULONG *Screen_atari;
+extern THREAD_LOCAL ULONG *Screen_atari;
 
 /* Dimensions of Screen_atari.
    Screen_atari is Screen_WIDTH * Screen_HEIGHT bytes.
@@ -34,21 +34,29 @@ extern ULONG *Screen_atari2;
    Currently Screen_visible variables are used only to place
    disk led and snailmeter in the corners of the screen.
 */
-extern int Screen_visible_x1;
-extern int Screen_visible_y1;
-extern int Screen_visible_x2;
-extern int Screen_visible_y2;
+extern THREAD_LOCAL int Screen_visible_x1;
+extern THREAD_LOCAL int Screen_visible_y1;
+extern THREAD_LOCAL int Screen_visible_x2;
+extern THREAD_LOCAL int Screen_visible_y2;
 
-extern int Screen_show_atari_speed;
-extern int Screen_show_disk_led;
-extern int Screen_show_sector_counter;
-extern int Screen_show_1200_leds;
-extern int Screen_show_multimedia_stats;
+extern THREAD_LOCAL int Screen_show_atari_speed;
+extern THREAD_LOCAL int Screen_show_disk_led;
+extern THREAD_LOCAL int Screen_show_sector_counter;
+extern THREAD_LOCAL int Screen_show_1200_leds;
+extern THREAD_LOCAL int Screen_show_multimedia_stats;
+#ifdef SYNCHRONIZED_SOUND
+extern THREAD_LOCAL int Screen_show_sound_stats;
+#endif
 
 int Screen_Initialise(int *argc, char *argv[]);
 int Screen_ReadConfig(char *string, char *ptr);
 void Screen_WriteConfig(FILE *fp);
 void Screen_DrawAtariSpeed(double);
+#ifdef SYNCHRONIZED_SOUND
+/* Shows the fill level of the sound buffer and the underruns counted by
+   Sound_GetStats, updated every half second. */
+void Screen_DrawSoundStats(double);
+#endif
 void Screen_DrawDiskLED(void);
 void Screen_Draw1200LED(void);
 void Screen_DrawMultimediaStats(void);
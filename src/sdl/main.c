@@ -41,6 +41,7 @@
 #include "log.h"
 #include "monitor.h"
 #include "platform.h"
+#include "profile.h"
 #ifdef SOUND
 #include "../sound.h"
 #endif
@@ -198,8 +199,11 @@ int main(int argc, char **argv)
 #endif
 		SDL_INPUT_Mouse();
 		Atari800_Frame();
-		if (Atari800_display_screen)
+		if (Atari800_display_screen) {
+			PROFILE_SWITCH(PROFILE_DISPLAY);
 			PLATFORM_DisplayScreen();
+			PROFILE_SWITCH(PROFILE_OTHER);
+		}
 	}
 }
 
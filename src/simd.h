@@ -0,0 +1,16 @@
+#ifndef SIMD_H_
+#define SIMD_H_
+
+/* Vector instructions used by the renderers, the sound generators and the
+   ZMBV encoder, next to their plain C versions. SSE2 is part of x86-64,
+   so it is used whenever the compiler targets it, without run-time
+   detection. Define NO_SIMD to build the plain C code only. */
+
+#include "config.h"
+
+#if defined(__SSE2__) && !defined(NO_SIMD)
+#include <emmintrin.h>
+#define SIMD_SSE2
+#endif /* __SSE2__ && !NO_SIMD */
+
+#endif /* SIMD_H_ */
@@ -29,6 +29,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+#include <sys/mman.h>
+#define SIO_MMAP
+#endif
 
 #include "afile.h"
 #include "antic.h"  /* ANTIC_ypos */
@@ -43,6 +47,7 @@
 #include "platform.h"
 #include "pokey.h"
 #include "pokeysnd.h"
+#include "profile.h"
 #include "sio.h"
 #include "util.h"
 #ifndef BASIC
@@ -64,20 +69,45 @@
 #define BOOT_SECTORS_LOGICAL	0
 #define BOOT_SECTORS_PHYSICAL	1
 #define BOOT_SECTORS_SIO2PC		2
-static int boot_sectors_type[SIO_MAX_DRIVES];
+static THREAD_LOCAL int boot_sectors_type[SIO_MAX_DRIVES];
 
-static int image_type[SIO_MAX_DRIVES];
+static THREAD_LOCAL int image_type[SIO_MAX_DRIVES];
 #define IMAGE_TYPE_XFD  0
 #define IMAGE_TYPE_ATR  1
 #define IMAGE_TYPE_PRO  2
 #define IMAGE_TYPE_VAPI 3
-static FILE *disk[SIO_MAX_DRIVES] = { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
-static int sectorcount[SIO_MAX_DRIVES];
-static int sectorsize[SIO_MAX_DRIVES];
+static THREAD_LOCAL FILE *disk[SIO_MAX_DRIVES] = { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+/* Contents of the mounted images. Sectors are read and written in memory,
+   and the written blocks are stored back to disk[] by SIO_Frame, once the
+   drive has not been written for SIO_WRITE_BACK_FRAMES, and by
+   SIO_Dismount.
+   Where possible the image is mapped copy-on-write, so emulators that
+   mount the same image share its pages, and only written pages are copied.
+   Compressed images are shared through the CompFile cache and their
+   changes are never stored. */
+static THREAD_LOCAL UBYTE *image_data[SIO_MAX_DRIVES];
+static THREAD_LOCAL ULONG image_length[SIO_MAX_DRIVES];
+#define IMAGE_MALLOC  0
+#define IMAGE_MAPPED  1
+#define IMAGE_CACHED  2
+static THREAD_LOCAL int image_storage[SIO_MAX_DRIVES];
+static THREAD_LOCAL int image_compressed[SIO_MAX_DRIVES];
+static THREAD_LOCAL ULONG image_pos[SIO_MAX_DRIVES];	/* position of the next ReadImage/WriteImage */
+/* Bit map of the DIRTY_BLOCK-byte blocks of the image written since the
+   last FlushImage, allocated on the first write. The sectors of ATR and
+   XFD images start on a block, so only the written sectors are stored. */
+#define DIRTY_BLOCK 16
+static THREAD_LOCAL UBYTE *dirty_map[SIO_MAX_DRIVES];
+static THREAD_LOCAL ULONG dirty_map_size[SIO_MAX_DRIVES];
+/* Frames left until the written blocks are stored, or 0 if there are none */
+#define SIO_WRITE_BACK_FRAMES 50
+static THREAD_LOCAL int write_back_delay[SIO_MAX_DRIVES];
+static THREAD_LOCAL int sectorcount[SIO_MAX_DRIVES];
+static THREAD_LOCAL int sectorsize[SIO_MAX_DRIVES];
 /* these two are used by the 1450XLD parallel disk device */
-int SIO_format_sectorcount[SIO_MAX_DRIVES];
-int SIO_format_sectorsize[SIO_MAX_DRIVES];
-static int io_success[SIO_MAX_DRIVES];
+THREAD_LOCAL int SIO_format_sectorcount[SIO_MAX_DRIVES];
+THREAD_LOCAL int SIO_format_sectorsize[SIO_MAX_DRIVES];
+static THREAD_LOCAL int io_success[SIO_MAX_DRIVES];
 /* stores dup sector counter for PRO images */
 typedef struct tagpro_additional_info_t {
 	int max_sector;
@@ -148,18 +178,21 @@ typedef struct tagvapi_sector_header_t {
 #define VAPI_16(x) (x[0] + (x[1] << 8))
 
 /* Additional Info for all copy protected disk types */
-static void *additional_info[SIO_MAX_DRIVES];
+static THREAD_LOCAL void *additional_info[SIO_MAX_DRIVES];
+
+THREAD_LOCAL SIO_UnitStatus SIO_drive_status[SIO_MAX_DRIVES];
+THREAD_LOCAL char SIO_filename[SIO_MAX_DRIVES][FILENAME_MAX];
 
-SIO_UnitStatus SIO_drive_status[SIO_MAX_DRIVES];
-char SIO_filename[SIO_MAX_DRIVES][FILENAME_MAX];
+Util_tmpbufdef(static THREAD_LOCAL, sio_tmpbuf[SIO_MAX_DRIVES])
 
-Util_tmpbufdef(static, sio_tmpbuf[SIO_MAX_DRIVES])
+THREAD_LOCAL int SIO_last_op;
+THREAD_LOCAL int SIO_last_op_time = 0;
+THREAD_LOCAL int SIO_last_drive;
+THREAD_LOCAL int SIO_last_sector;
+THREAD_LOCAL char SIO_status[256];
 
-int SIO_last_op;
-int SIO_last_op_time = 0;
-int SIO_last_drive;
-int SIO_last_sector;
-char SIO_status[256];
+THREAD_LOCAL int SIO_turbo[SIO_MAX_DRIVES];
+THREAD_LOCAL int SIO_turbo_transfer = FALSE;
 
 /* Serial I/O emulation support */
 #define SIO_NoFrame         (0x00)
@@ -169,18 +202,54 @@ char SIO_status[256];
 #define SIO_WriteFrame      (0x04)
 #define SIO_FinalStatus     (0x05)
 #define SIO_FormatFrame     (0x06)
-static UBYTE CommandFrame[6];
-static int CommandIndex = 0;
-static UBYTE DataBuffer[256 + 3];
-static int DataIndex = 0;
-static int TransferStatus = SIO_NoFrame;
-static int ExpectedBytes = 0;
+static THREAD_LOCAL UBYTE CommandFrame[6];
+static THREAD_LOCAL int CommandIndex = 0;
+static THREAD_LOCAL UBYTE DataBuffer[256 + 3];
+static THREAD_LOCAL int DataIndex = 0;
+static THREAD_LOCAL int TransferStatus = SIO_NoFrame;
+static THREAD_LOCAL int ExpectedBytes = 0;
 
-int ignore_header_writeprotect = FALSE;
+THREAD_LOCAL int ignore_header_writeprotect = FALSE;
 
-int SIO_Initialise(int *argc, char *argv[])
+/* Sets SIO_turbo from a list of drive numbers, such as "12" */
+static int ParseTurboDrives(const char *drives)
+{
+	int turbo[SIO_MAX_DRIVES];
+	int i;
+	for (i = 0; i < SIO_MAX_DRIVES; i++)
+		turbo[i] = FALSE;
+	if (strcmp(drives, "none") != 0) {
+		for (; *drives != '\0'; drives++) {
+			if (*drives < '1' || *drives >= '1' + SIO_MAX_DRIVES)
+				return FALSE;
+			turbo[*drives - '1'] = TRUE;
+		}
+	}
+	for (i = 0; i < SIO_MAX_DRIVES; i++)
+		SIO_turbo[i] = turbo[i];
+	return TRUE;
+}
+
+int SIO_ReadConfig(char *string, char *ptr)
+{
+	if (strcmp(string, "TURBO_SIO") == 0)
+		return ParseTurboDrives(ptr);
+	return FALSE;
+}
+
+void SIO_WriteConfig(FILE *fp)
 {
 	int i;
+	fprintf(fp, "TURBO_SIO=");
+	for (i = 0; i < SIO_MAX_DRIVES; i++)
+		if (SIO_turbo[i])
+			fputc('1' + i, fp);
+	fputc('\n', fp);
+}
+
+int SIO_Initialise(int *argc, char *argv[])
+{
+	int i, j;
 	for (i = 0; i < SIO_MAX_DRIVES; i++) {
 		strcpy(SIO_filename[i], "Off");
 		SIO_drive_status[i] = SIO_OFF;
@@ -188,6 +257,36 @@ int SIO_Initialise(int *argc, char *argv[])
 		SIO_format_sectorcount[i] = 720;
 	}
 	TransferStatus = SIO_NoFrame;
+	SIO_turbo_transfer = FALSE;
+
+	for (i = j = 1; i < *argc; i++) {
+		int i_a = (i + 1 < *argc);		/* is argument available? */
+		int a_m = FALSE;			/* error, argument missing! */
+
+		if (strcmp(argv[i], "-turbo-sio") == 0) {
+			if (i_a) {
+				if (!ParseTurboDrives(argv[++i])) {
+					Log_print("Invalid drive list for -turbo-sio: %s", argv[i]);
+					return FALSE;
+				}
+			}
+			else a_m = TRUE;
+		}
+		else {
+			if (strcmp(argv[i], "-help") == 0) {
+				Log_print("\t-turbo-sio <drives>");
+				Log_print("\t                 Transfer data of the listed drives (e.g. 12) without");
+				Log_print("\t                 serial port delays, or none");
+			}
+			argv[j++] = argv[i];
+		}
+
+		if (a_m) {
+			Log_print("Missing argument for '%s'", argv[i]);
+			return FALSE;
+		}
+	}
+	*argc = j;
 
 	return TRUE;
 }
@@ -200,6 +299,174 @@ void SIO_Exit(void)
 		SIO_Dismount(i);
 }
 
+static void ClearDirty(int unit)
+{
+	free(dirty_map[unit]);
+	dirty_map[unit] = NULL;
+	dirty_map_size[unit] = 0;
+	write_back_delay[unit] = 0;
+}
+
+/* Marks SIZE bytes of the image at POS as written */
+static void MarkDirty(int unit, ULONG pos, int size)
+{
+	ULONG first = pos / DIRTY_BLOCK;
+	ULONG last = (pos + size - 1) / DIRTY_BLOCK;
+	ULONG map_size = (image_length[unit] + DIRTY_BLOCK * 8 - 1) / (DIRTY_BLOCK * 8);
+	if (map_size > dirty_map_size[unit]) {
+		dirty_map[unit] = (UBYTE *) Util_realloc(dirty_map[unit], map_size);
+		memset(dirty_map[unit] + dirty_map_size[unit], 0, map_size - dirty_map_size[unit]);
+		dirty_map_size[unit] = map_size;
+	}
+	for (; first <= last; first++)
+		dirty_map[unit][first >> 3] |= 1 << (first & 7);
+	write_back_delay[unit] = SIO_WRITE_BACK_FRAMES;
+}
+
+/* Reads the whole image of the unit into memory */
+static int LoadImage(int unit, FILE *f, int writable)
+{
+	int length = Util_flen(f);
+	if (length < 0)
+		return FALSE;
+	image_compressed[unit] = FALSE;
+	image_length[unit] = length;
+	image_pos[unit] = 0;
+	ClearDirty(unit);
+#ifdef SIO_MMAP
+	if (length > 0) {
+		void *data;
+		fflush(f);
+		data = mmap(NULL, length, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, fileno(f), 0);
+		if (data != MAP_FAILED) {
+			image_data[unit] = (UBYTE *) data;
+			image_storage[unit] = IMAGE_MAPPED;
+			return TRUE;
+		}
+	}
+#endif
+	image_data[unit] = (UBYTE *) Util_malloc(length > 0 ? length : 1);
+	image_storage[unit] = IMAGE_MALLOC;
+	Util_rewind(f);
+	if (fread(image_data[unit], 1, length, f) != (size_t) length) {
+		free(image_data[unit]);
+		image_data[unit] = NULL;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/* Decompresses the image of the unit into memory */
+static int LoadCompressedImage(int unit, FILE *f)
+{
+	const UBYTE *data = CompFile_LoadImage(f, &image_length[unit]);
+	if (data == NULL)
+		return FALSE;
+	image_data[unit] = (UBYTE *) data;
+	image_storage[unit] = IMAGE_CACHED;
+	image_compressed[unit] = TRUE;
+	image_pos[unit] = 0;
+	ClearDirty(unit);
+	return TRUE;
+}
+
+static void FreeImage(int unit)
+{
+	if (image_storage[unit] == IMAGE_CACHED)
+		CompFile_ReleaseImage(image_data[unit]);
+#ifdef SIO_MMAP
+	else if (image_storage[unit] == IMAGE_MAPPED)
+		munmap(image_data[unit], image_length[unit]);
+#endif
+	else
+		free(image_data[unit]);
+	image_data[unit] = NULL;
+	image_length[unit] = 0;
+}
+
+/* Stores the blocks written since the last call in the image file, each
+   run of consecutive blocks with one fwrite */
+static void FlushImage(int unit)
+{
+	ULONG blocks = dirty_map_size[unit] * 8;
+	ULONG block = 0;
+	int ok = TRUE;
+	write_back_delay[unit] = 0;
+	if (dirty_map[unit] == NULL)
+		return;
+	if (image_compressed[unit]) {
+		ClearDirty(unit);
+		return;
+	}
+	while (block < blocks) {
+		ULONG start, end;
+		if (dirty_map[unit][block >> 3] == 0) {
+			block = (block | 7) + 1;
+			continue;
+		}
+		if (!(dirty_map[unit][block >> 3] & (1 << (block & 7)))) {
+			block++;
+			continue;
+		}
+		start = block * DIRTY_BLOCK;
+		while (block < blocks && (dirty_map[unit][block >> 3] & (1 << (block & 7))))
+			block++;
+		end = block * DIRTY_BLOCK;
+		if (end > image_length[unit])
+			end = image_length[unit];
+		if (fseek(disk[unit], start, SEEK_SET) != 0
+		 || fwrite(image_data[unit] + start, 1, end - start, disk[unit]) != end - start)
+			ok = FALSE;
+	}
+	if (fflush(disk[unit]) != 0)
+		ok = FALSE;
+	if (!ok)
+		Log_print("Error writing disk image %s", SIO_filename[unit]);
+	memset(dirty_map[unit], 0, dirty_map_size[unit]);
+}
+
+/* Works like fread from the image of the unit, at image_pos */
+static int ReadImage(int unit, UBYTE *buffer, int size)
+{
+	ULONG pos = image_pos[unit];
+	if (pos >= image_length[unit])
+		return 0;
+	if ((ULONG) size > image_length[unit] - pos)
+		size = image_length[unit] - pos;
+	memcpy(buffer, image_data[unit] + pos, size);
+	image_pos[unit] = pos + size;
+	return size;
+}
+
+/* Works like fwrite to the image of the unit, at image_pos */
+static void WriteImage(int unit, const UBYTE *buffer, int size)
+{
+	ULONG pos = image_pos[unit];
+	if (pos + size > image_length[unit] || image_storage[unit] == IMAGE_CACHED) {
+		/* a sector past the end of a short image, so the file will grow,
+		   or the image is shared with other mounts */
+		ULONG length = pos + size > image_length[unit] ? pos + size : image_length[unit];
+		UBYTE *data = (UBYTE *) Util_malloc(length);
+		memcpy(data, image_data[unit], image_length[unit]);
+		memset(data + image_length[unit], 0, length - image_length[unit]);
+		FreeImage(unit);
+		image_data[unit] = data;
+		image_length[unit] = length;
+		image_storage[unit] = IMAGE_MALLOC;
+	}
+	memcpy(image_data[unit] + pos, buffer, size);
+	if (size > 0)
+		MarkDirty(unit, pos, size);
+	image_pos[unit] = pos + size;
+}
+
+static void CloseImage(int unit, FILE *f)
+{
+	FreeImage(unit);
+	ClearDirty(unit);
+	Util_fclose(f, sio_tmpbuf[unit]);
+}
+
 int SIO_Mount(int diskno, const char *filename, int b_open_readonly)
 {
 	FILE *f = NULL;
@@ -230,64 +497,34 @@ int SIO_Mount(int diskno, const char *filename, int b_open_readonly)
 	}
 
 	/* detect compressed image and uncompress */
-	switch (header.magic1) {
-	case 0xf9:
-	case 0xfa:
-		/* DCM */
-		{
-			FILE *f2 = Util_tmpopen(sio_tmpbuf[diskno - 1]);
-			if (f2 == NULL)
-				return FALSE;
-			Util_rewind(f);
-			if (!CompFile_DCMtoATR(f, f2)) {
-				Util_fclose(f2, sio_tmpbuf[diskno - 1]);
-				fclose(f);
-				return FALSE;
-			}
+	if (header.magic1 == 0xf9 || header.magic1 == 0xfa
+	 || (header.magic1 == 0x1f && header.magic2 == 0x8b)) {
+		/* DCM, ATZ/ATR.GZ, XFZ/XFD.GZ */
+		if (!LoadCompressedImage(diskno - 1, f)) {
 			fclose(f);
-			f = f2;
+			return FALSE;
 		}
-		Util_rewind(f);
-		if (fread(&header, 1, sizeof(struct AFILE_ATR_Header), f) != sizeof(struct AFILE_ATR_Header)) {
-			Util_fclose(f, sio_tmpbuf[diskno - 1]);
+		if (ReadImage(diskno - 1, (UBYTE *) &header, sizeof(struct AFILE_ATR_Header)) != sizeof(struct AFILE_ATR_Header)) {
+			CloseImage(diskno - 1, f);
 			return FALSE;
 		}
 		status = SIO_READ_ONLY;
 		/* XXX: status = b_open_readonly ? SIO_READ_ONLY : SIO_READ_WRITE; */
-		break;
-	case 0x1f:
-		if (header.magic2 == 0x8b) {
-			/* ATZ/ATR.GZ, XFZ/XFD.GZ */
-			fclose(f);
-			f = Util_tmpopen(sio_tmpbuf[diskno - 1]);
-			if (f == NULL)
-				return FALSE;
-			if (!CompFile_ExtractGZ(filename, f)) {
-				Util_fclose(f, sio_tmpbuf[diskno - 1]);
-				return FALSE;
-			}
-			Util_rewind(f);
-			if (fread(&header, 1, sizeof(struct AFILE_ATR_Header), f) != sizeof(struct AFILE_ATR_Header)) {
-				Util_fclose(f, sio_tmpbuf[diskno - 1]);
-				return FALSE;
-			}
-			status = SIO_READ_ONLY;
-			/* XXX: status = b_open_readonly ? SIO_READ_ONLY : SIO_READ_WRITE; */
-		}
-		break;
-	default:
-		break;
+	}
+	else if (!LoadImage(diskno - 1, f, status == SIO_READ_WRITE)) {
+		fclose(f);
+		return FALSE;
 	}
 
 	boot_sectors_type[diskno - 1] = BOOT_SECTORS_LOGICAL;
 
 	if (header.magic1 == AFILE_ATR_MAGIC1 && header.magic2 == AFILE_ATR_MAGIC2) {
-		/* ATR (may be temporary from DCM or ATR/ATR.GZ) */
+		/* ATR (may be decompressed from DCM or ATR/ATR.GZ) */
 		image_type[diskno - 1] = IMAGE_TYPE_ATR;
 
 		sectorsize[diskno - 1] = (header.secsizehi << 8) + header.secsizelo;
 		if (sectorsize[diskno - 1] != 128 && sectorsize[diskno - 1] != 256) {
-			Util_fclose(f, sio_tmpbuf[diskno - 1]);
+			CloseImage(diskno - 1, f);
 			return FALSE;
 		}
 
@@ -313,9 +550,9 @@ int SIO_Mount(int diskno, const char *filename, int b_open_readonly)
 				   a non-zero byte in bytes 0x190-0x30f of the ATR file */
 				UBYTE buffer[0x180];
 				int i;
-				fseek(f, 0x190, SEEK_SET);
-				if (fread(buffer, 1, 0x180, f) != 0x180) {
-					Util_fclose(f, sio_tmpbuf[diskno - 1]);
+				image_pos[diskno - 1] = 0x190;
+				if (ReadImage(diskno - 1, buffer, 0x180) != 0x180) {
+					CloseImage(diskno - 1, f);
 					return FALSE;
 				}
 				boot_sectors_type[diskno - 1] = BOOT_SECTORS_SIO2PC;
@@ -330,7 +567,7 @@ int SIO_Mount(int diskno, const char *filename, int b_open_readonly)
 	}
 	else if (header.magic1 == 'A' && header.magic2 == 'T' && header.seccountlo == '8' &&
 		 header.seccounthi == 'X') {
-		int file_length = Util_flen(f);
+		int file_length = image_length[diskno - 1];
 		vapi_additional_info_t *info;
 		vapi_file_header_t fileheader;
 		vapi_track_header_t trackheader;
@@ -341,8 +578,10 @@ int SIO_Mount(int diskno, const char *filename, int b_open_readonly)
 		if (!b_open_readonly) {
 			fclose(f);
 			f = Util_fopen(filename, "rb", sio_tmpbuf[diskno - 1]);
-			if (f == NULL)
+			if (f == NULL) {
+				FreeImage(diskno - 1);
 				return FALSE;
+			}
 			status = SIO_READ_ONLY;
 		}
 #endif
@@ -350,15 +589,15 @@ int SIO_Mount(int diskno, const char *filename, int b_open_readonly)
 		image_type[diskno - 1] = IMAGE_TYPE_VAPI;
 		sectorsize[diskno - 1] = 128;
 		sectorcount[diskno - 1] = 720;
-		fseek(f,0,SEEK_SET);
-		if (fread(&fileheader,1,sizeof(fileheader),f) != sizeof(fileheader)) {
-			Util_fclose(f, sio_tmpbuf[diskno - 1]);
+		image_pos[diskno - 1] = 0;
+		if (ReadImage(diskno - 1, (UBYTE *) &fileheader, sizeof(fileheader)) != sizeof(fileheader)) {
+			CloseImage(diskno - 1, f);
 			Log_print("VAPI: Bad File Header");
 			return(FALSE);
 			}
 		trackoffset = VAPI_32(fileheader.startdata);	
 		if (trackoffset > file_length) {
-			Util_fclose(f, sio_tmpbuf[diskno - 1]);
+			CloseImage(diskno - 1, f);
 			Log_print("VAPI: Bad Track Offset");
 			return(FALSE);
 			}
@@ -371,9 +610,9 @@ int SIO_Mount(int diskno, const char *filename, int b_open_readonly)
 			ULONG next;
 			UWORD tracktype;
 
-			fseek(f,trackoffset,SEEK_SET);
-			if (fread(&trackheader,1,sizeof(trackheader),f) != sizeof(trackheader)) {
-				Util_fclose(f, sio_tmpbuf[diskno - 1]);
+			image_pos[diskno - 1] = trackoffset;
+			if (ReadImage(diskno - 1, (UBYTE *) &trackheader, sizeof(trackheader)) != sizeof(trackheader)) {
+				CloseImage(diskno - 1, f);
 				Log_print("VAPI: Bad Track Header");
 				return(FALSE);
 				}
@@ -402,11 +641,11 @@ int SIO_Mount(int diskno, const char *filename, int b_open_readonly)
 			UWORD tracktype;
 			int j;
 
-			fseek(f,trackoffset,SEEK_SET);
-			if (fread(&trackheader,1,sizeof(trackheader),f) != sizeof(trackheader)) {
+			image_pos[diskno - 1] = trackoffset;
+			if (ReadImage(diskno - 1, (UBYTE *) &trackheader, sizeof(trackheader)) != sizeof(trackheader)) {
 				free(info->sectors);
 				free(info);
-				Util_fclose(f, sio_tmpbuf[diskno - 1]);
+				CloseImage(diskno - 1, f);
 				Log_print("VAPI: Bad Track Header while reading sectors");
 				return(FALSE);
 				}
@@ -422,15 +661,15 @@ int SIO_Mount(int diskno, const char *filename, int b_open_readonly)
 				if (seclistdata > file_length) {
 					free(info->sectors);
 					free(info);
-					Util_fclose(f, sio_tmpbuf[diskno - 1]);
+					CloseImage(diskno - 1, f);
 					Log_print("VAPI: Bad Sector List Offset");
 					return(FALSE);
 					}
-				fseek(f,seclistdata,SEEK_SET);
-				if (fread(&sectorlist,1,sizeof(sectorlist),f) != sizeof(sectorlist)) {
+				image_pos[diskno - 1] = seclistdata;
+				if (ReadImage(diskno - 1, (UBYTE *) &sectorlist, sizeof(sectorlist)) != sizeof(sectorlist)) {
 					free(info->sectors);
 					free(info);
-					Util_fclose(f, sio_tmpbuf[diskno - 1]);
+					CloseImage(diskno - 1, f);
 					Log_print("VAPI: Bad Sector List");
 					return(FALSE);
 					}
@@ -440,15 +679,15 @@ int SIO_Mount(int diskno, const char *filename, int b_open_readonly)
 				for (j=0;j<sectorcnt;j++) {
 					double percent_rot;
 
-					if (fread(&sectorheader,1,sizeof(sectorheader),f) != sizeof(sectorheader)) {
+					if (ReadImage(diskno - 1, (UBYTE *) &sectorheader, sizeof(sectorheader)) != sizeof(sectorheader)) {
 						free(info->sectors);
 						free(info);
-						Util_fclose(f, sio_tmpbuf[diskno - 1]);
+						CloseImage(diskno - 1, f);
 						Log_print("VAPI: Bad Sector Header");
 						return(FALSE);
 						}
 					if (sectorheader.sectornum > 18)  {
-						Util_fclose(f, sio_tmpbuf[diskno - 1]);
+						CloseImage(diskno - 1, f);
 						Log_print("VAPI: Bad Sector Index: Track %d Sec Num %d Index %d",
 								trackheader.tracknum,j,sectorheader.sectornum);
 						return(FALSE);
@@ -463,7 +702,7 @@ int SIO_Mount(int diskno, const char *filename, int b_open_readonly)
 					if (sector->sec_count > MAX_VAPI_PHANTOM_SEC) {
 						free(info->sectors);
 						free(info);
-						Util_fclose(f, sio_tmpbuf[diskno - 1]);
+						CloseImage(diskno - 1, f);
 						Log_print("VAPI: Too many Phantom Sectors");
 						return(FALSE);
 						}
@@ -485,7 +724,7 @@ int SIO_Mount(int diskno, const char *filename, int b_open_readonly)
 		}			
 	}
 	else {
-		int file_length = Util_flen(f);
+		int file_length = image_length[diskno - 1];
 		/* check for PRO */
 		if ((file_length-16)%(128+12) == 0 &&
 				(header.magic1*256 + header.magic2 == (file_length-16)/(128+12)) &&
@@ -495,8 +734,10 @@ int SIO_Mount(int diskno, const char *filename, int b_open_readonly)
 			if (!b_open_readonly) {
 				fclose(f);
 				f = Util_fopen(filename, "rb", sio_tmpbuf[diskno - 1]);
-				if (f == NULL)
+				if (f == NULL) {
+					FreeImage(diskno - 1);
 					return FALSE;
+				}
 				status = SIO_READ_ONLY;
 			}
 			image_type[diskno - 1] = IMAGE_TYPE_PRO;
@@ -517,7 +758,7 @@ int SIO_Mount(int diskno, const char *filename, int b_open_readonly)
 			info->max_sector = (file_length-16)/(128+12);
 		}
 		else {
-			/* XFD (may be temporary from XFZ/XFD.GZ) */
+			/* XFD (may be decompressed from XFZ/XFD.GZ) */
 
 			image_type[diskno - 1] = IMAGE_TYPE_XFD;
 
@@ -543,6 +784,7 @@ int SIO_Mount(int diskno, const char *filename, int b_open_readonly)
 	Log_print("sectorcount = %d, sectorsize = %d",
 		   sectorcount[diskno - 1], sectorsize[diskno - 1]);
 #endif
+	image_pos[diskno - 1] = 0;
 	SIO_format_sectorsize[diskno - 1] = sectorsize[diskno - 1];
 	SIO_format_sectorcount[diskno - 1] = sectorcount[diskno - 1];
 	strcpy(SIO_filename[diskno - 1], filename);
@@ -554,6 +796,9 @@ int SIO_Mount(int diskno, const char *filename, int b_open_readonly)
 void SIO_Dismount(int diskno)
 {
 	if (disk[diskno - 1] != NULL) {
+		FlushImage(diskno - 1);
+		ClearDirty(diskno - 1);
+		FreeImage(diskno - 1);
 		Util_fclose(disk[diskno - 1], sio_tmpbuf[diskno - 1]);
 		disk[diskno - 1] = NULL;
 		SIO_drive_status[diskno - 1] = SIO_NO_DISK;
@@ -569,6 +814,14 @@ void SIO_Dismount(int diskno)
 	}
 }
 
+void SIO_Frame(void)
+{
+	int i;
+	for (i = 0; i < SIO_MAX_DRIVES; i++)
+		if (write_back_delay[i] > 0 && --write_back_delay[i] == 0)
+			FlushImage(i);
+}
+
 void SIO_DisableDrive(int diskno)
 {
 	SIO_Dismount(diskno);
@@ -637,7 +890,7 @@ static int SeekSector(int unit, int sector)
 	SIO_last_sector = sector;
 	snprintf(SIO_status, sizeof(SIO_status), "%d: %d", unit + 1, sector);
 	SIO_SizeOfSector((UBYTE) unit, sector, &size, &offset);
-	fseek(disk[unit], offset, SEEK_SET);
+	image_pos[unit] = offset;
 
 	return size;
 }
@@ -666,7 +919,7 @@ int SIO_ReadSector(int unit, int sector, UBYTE *buffer)
 		unsigned char *count;
 		info = (pro_additional_info_t *)additional_info[unit];
 		count = info->count;
-		if (fread(buffer, 1, 12, disk[unit]) < 12) {
+		if (ReadImage(unit, buffer, 12) < 12) {
 			Log_print("Error in header of .pro image: sector:%d", sector);
 			return 'E';
 		}
@@ -686,7 +939,7 @@ int SIO_ReadSector(int unit, int sector, UBYTE *buffer)
 				}
 				size = SeekSector(unit, sector);
 				/* read sector header */
-				if (fread(buffer, 1, 12, disk[unit]) < 12) {
+				if (ReadImage(unit, buffer, 12) < 12) {
 					Log_print("Error in header2 of .pro image: sector:%d dupnum:%d", sector, dupnum);
 					return 'E';
 				}
@@ -694,7 +947,7 @@ int SIO_ReadSector(int unit, int sector, UBYTE *buffer)
 		}
 		/* bad sector */
 		if (buffer[1] != 0xff) {
-			if (fread(buffer, 1, size, disk[unit]) < size) {
+			if (ReadImage(unit, buffer, size) < size) {
 				Log_print("Error in bad sector of .pro image: sector:%d", sector);
 			}
 			io_success[unit] = sector;
@@ -708,7 +961,7 @@ int SIO_ReadSector(int unit, int sector, UBYTE *buffer)
 		vapi_additional_info_t *info;
 		vapi_sec_info_t *secinfo;
 		ULONG secindex = 0;
-		static int lasttrack = 0;
+		static THREAD_LOCAL int lasttrack = 0;
 		unsigned int currpos, time, delay, rotations, bestdelay;
 /*		unsigned char beststatus;*/
 		int fromtrack, trackstostep, j;
@@ -786,13 +1039,13 @@ int SIO_ReadSector(int unit, int sector, UBYTE *buffer)
 		if (secinfo->sec_count > 1)
 			Log_print("duplicate sector:%d dupnum:%d delay:%d",sector, secindex,info->vapi_delay_time);
 #endif
-		fseek(disk[unit],secinfo->sec_offset[secindex],SEEK_SET);
+		image_pos[unit] = secinfo->sec_offset[secindex];
 		info->sec_stat_buff[0] = 0x8 | ((secinfo->sec_status[secindex] == 0xFF) ? 0 : 0x04);
 		info->sec_stat_buff[1] = secinfo->sec_status[secindex];
 		info->sec_stat_buff[2] = 0xe0;
 		info->sec_stat_buff[3] = 0;
 		if (secinfo->sec_status[secindex] != 0xFF) {
-			if (fread(buffer, 1, size, disk[unit]) < size) {
+			if (ReadImage(unit, buffer, size) < size) {
 				Log_print("error reading sector:%d", sector);
 			}
 			io_success[unit] = sector;
@@ -816,7 +1069,7 @@ int SIO_ReadSector(int unit, int sector, UBYTE *buffer)
 		Log_flushlog();
 #endif		
 	}
-	if (fread(buffer, 1, size, disk[unit]) < size) {
+	if (ReadImage(unit, buffer, size) < size) {
 		Log_print("incomplete sector num:%d", sector);
 	}
 	io_success[unit] = 0;
@@ -855,8 +1108,8 @@ int SIO_WriteSector(int unit, int sector, const UBYTE *buffer)
 		}
 		
 		size = SeekSector(unit, sector);
-		fseek(disk[unit],secinfo->sec_offset[0],SEEK_SET);
-		fwrite(buffer, 1, size, disk[unit]);
+		image_pos[unit] = secinfo->sec_offset[0];
+		WriteImage(unit, buffer, size);
 		io_success[unit] = 0;
 		return 'C';
 #if 0		
@@ -878,7 +1131,7 @@ int SIO_WriteSector(int unit, int sector, const UBYTE *buffer)
 	} 
 #endif
 	size = SeekSector(unit, sector);
-	fwrite(buffer, 1, size, disk[unit]);
+	WriteImage(unit, buffer, size);
 	io_success[unit] = 0;
 	return 'C';
 }
@@ -1067,7 +1320,7 @@ int SIO_DriveStatus(int unit, UBYTE *buffer)
 	if (io_success[unit] != 0  && image_type[unit] == IMAGE_TYPE_PRO) {
 		int sector = io_success[unit];
 		SeekSector(unit, sector);
-		if (fread(buffer, 1, 4, disk[unit]) < 4) {
+		if (ReadImage(unit, buffer, 4) < 4) {
 			Log_print("SIO_DriveStatus: failed to read sector header");
 		}
 		return 'C';
@@ -1103,8 +1356,8 @@ int SIO_DriveStatus(int unit, UBYTE *buffer)
    faster than with a typical disk drive.  We introduce a delay
    of SECTOR_DELAY scanlines between successive reads of sector 1. */
 #define SECTOR_DELAY 3200
-static int delay_counter = 0;
-static int last_ypos = 0;
+static THREAD_LOCAL int delay_counter = 0;
+static THREAD_LOCAL int last_ypos = 0;
 #endif
 
 /* SIO patch emulation routine */
@@ -1118,6 +1371,7 @@ void SIO_Handler(void)
 	int realsize = 0;
 	int cmd = MEMORY_dGetByte(0x302);
 
+	PROFILE_SWITCH(PROFILE_SIO);
 	if ((unsigned int)MEMORY_dGetByte(0x300) + (unsigned int)MEMORY_dGetByte(0x301) > 0xff) {
 		/* carry */
 		unit++;
@@ -1187,6 +1441,7 @@ void SIO_Handler(void)
 						delay_counter--;
 					}
 					CPU_regPC = 0xe459;	/* stay at SIO patch */
+					PROFILE_SWITCH(PROFILE_CPU);
 					return;
 				}
 				delay_counter = SECTOR_DELAY;
@@ -1314,6 +1569,7 @@ void SIO_Handler(void)
 	POKEY_PutByte(POKEY_OFFSET_AUDC2, 0);
 	POKEY_PutByte(POKEY_OFFSET_AUDC3, 0);
 	POKEY_PutByte(POKEY_OFFSET_AUDC4, 0);
+	PROFILE_SWITCH(PROFILE_CPU);
 }
 
 UBYTE SIO_ChkSum(const UBYTE *buffer, int length)
@@ -1355,6 +1611,7 @@ static UBYTE Command_Frame(void)
 		TransferStatus = SIO_NoFrame;
 		return 0;
 	}
+	SIO_turbo_transfer = SIO_turbo[unit];
 	switch (CommandFrame[1]) {
 	case 0x4e:				/* Read Status */
 #ifdef DEBUG
@@ -1498,6 +1755,7 @@ void SIO_SwitchCommandFrame(int onoff)
 		DataIndex = 0;
 		ExpectedBytes = 5;
 		TransferStatus = SIO_CommandFrame;
+		SIO_turbo_transfer = FALSE;
 	}
 	else {
 		if (TransferStatus != SIO_StatusRead && TransferStatus != SIO_NoFrame &&
@@ -1559,7 +1817,10 @@ void SIO_PutByte(int byte)
 			if (DataIndex >= ExpectedBytes) {
 				UBYTE sum = SIO_ChkSum(DataBuffer, ExpectedBytes - 1);
 				if (sum == DataBuffer[ExpectedBytes - 1]) {
-					UBYTE result = WriteSectorBack();
+					UBYTE result;
+					PROFILE_SWITCH(PROFILE_SIO);
+					result = WriteSectorBack();
+					PROFILE_SWITCH(PROFILE_CPU);
 					if (result != 0) {
 						DataBuffer[0] = 'A';
 						DataBuffer[1] = result;
@@ -1568,8 +1829,10 @@ void SIO_PutByte(int byte)
 						POKEY_DELAYED_SERIN_IRQ = SIO_SERIN_INTERVAL + SIO_ACK_INTERVAL;
 						TransferStatus = SIO_FinalStatus;
 					}
-					else
+					else {
 						TransferStatus = SIO_NoFrame;
+						SIO_turbo_transfer = FALSE;
+					}
 				}
 				else {
 					DataBuffer[0] = 'E';
@@ -1596,7 +1859,9 @@ int SIO_GetByte(void)
 
 	switch (TransferStatus) {
 	case SIO_StatusRead:
+		PROFILE_SWITCH(PROFILE_SIO);
 		byte = Command_Frame();		/* Handle now the command */
+		PROFILE_SWITCH(PROFILE_CPU);
 		break;
 	case SIO_FormatFrame:
 		TransferStatus = SIO_ReadFrame;
@@ -1607,6 +1872,12 @@ int SIO_GetByte(void)
 			byte = DataBuffer[DataIndex++];
 			if (DataIndex >= ExpectedBytes) {
 				TransferStatus = SIO_NoFrame;
+				SIO_turbo_transfer = FALSE;
+			}
+			else if (DataIndex > 1 && SIO_turbo_transfer) {
+				/* POKEY_Scanline holds the byte until the previous
+				   one is serviced */
+				POKEY_DELAYED_SERIN_IRQ = SIO_TURBO_INTERVAL;
 			}
 			else {
 				/* set delay using the expected transfer speed */
@@ -1624,6 +1895,7 @@ int SIO_GetByte(void)
 			byte = DataBuffer[DataIndex++];
 			if (DataIndex >= ExpectedBytes) {
 				TransferStatus = SIO_NoFrame;
+				SIO_turbo_transfer = FALSE;
 			}
 			else {
 				if (DataIndex == 0)
@@ -1696,6 +1968,7 @@ void SIO_StateRead(void)
 	for (i = 0; i < 8; i++) {
 		int saved_drive_status;
 		char filename[FILENAME_MAX];
+		SIO_UnitStatus old_status = SIO_drive_status[i];
 
 		StateSav_ReadINT(&saved_drive_status, 1);
 		SIO_drive_status[i] = (SIO_UnitStatus)saved_drive_status;
@@ -1704,6 +1977,10 @@ void SIO_StateRead(void)
 		if (filename[0] == 0)
 			continue;
 
+		/* A rewind state keeps the disk that is still mounted */
+		if (STATESAV_REWIND && old_status == SIO_drive_status[i] && strcmp(SIO_filename[i], filename) == 0)
+			continue;
+
 		/* If the disk drive wasn't empty or off when saved,
 		   mount the disk */
 		switch (saved_drive_status) {
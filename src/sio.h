@@ -16,20 +16,23 @@ typedef enum SIO_tagUnitStatus {
 	SIO_READ_WRITE
 } SIO_UnitStatus;
 
-extern char SIO_status[256];
-extern SIO_UnitStatus SIO_drive_status[SIO_MAX_DRIVES];
-extern char SIO_filename[SIO_MAX_DRIVES][FILENAME_MAX];
+extern THREAD_LOCAL char SIO_status[256];
+extern THREAD_LOCAL SIO_UnitStatus SIO_drive_status[SIO_MAX_DRIVES];
+extern THREAD_LOCAL char SIO_filename[SIO_MAX_DRIVES][FILENAME_MAX];
 
 #define SIO_LAST_READ 0
 #define SIO_LAST_WRITE 1
-extern int SIO_last_op;
-extern int SIO_last_op_time;
-extern int SIO_last_drive; /* 1 .. 8 */
-extern int SIO_last_sector;
+extern THREAD_LOCAL int SIO_last_op;
+extern THREAD_LOCAL int SIO_last_op_time;
+extern THREAD_LOCAL int SIO_last_drive; /* 1 .. 8 */
+extern THREAD_LOCAL int SIO_last_sector;
 
 int SIO_Mount(int diskno, const char *filename, int b_open_readonly);
 void SIO_Dismount(int diskno);
 void SIO_DisableDrive(int diskno);
+/* Stores the sectors written to a drive in its image file, once the drive
+   has not been written for about a second */
+void SIO_Frame(void);
 int SIO_RotateDisks(void);
 void SIO_Handler(void);
 
@@ -39,16 +42,27 @@ void SIO_PutByte(int byte);
 int SIO_GetByte(void);
 int SIO_Initialise(int *argc, char *argv[]);
 void SIO_Exit(void);
+int SIO_ReadConfig(char *string, char *ptr);
+void SIO_WriteConfig(FILE *fp);
+
+/* Drives whose data frames are transferred without the serial port delays:
+   a byte comes every SIO_TURBO_INTERVAL scanlines, or later if the CPU has
+   not serviced the previous SERIN interrupt yet. Drive mechanics (VAPI timing, the
+   sector 1 delay) are still emulated. */
+extern THREAD_LOCAL int SIO_turbo[SIO_MAX_DRIVES];
+/* TRUE while a data frame of a turbo drive is being transferred */
+extern THREAD_LOCAL int SIO_turbo_transfer;
 
 /* Some defines about the serial I/O timing. Currently fixed! */
 #define SIO_XMTDONE_INTERVAL  15
 #define SIO_SERIN_INTERVAL     8
 #define SIO_SEROUT_INTERVAL    8
 #define SIO_ACK_INTERVAL      36
+#define SIO_TURBO_INTERVAL     2
 
 /* These functions are also used by the 1450XLD Parallel disk device */
-extern int SIO_format_sectorcount[SIO_MAX_DRIVES];
-extern int SIO_format_sectorsize[SIO_MAX_DRIVES];
+extern THREAD_LOCAL int SIO_format_sectorcount[SIO_MAX_DRIVES];
+extern THREAD_LOCAL int SIO_format_sectorsize[SIO_MAX_DRIVES];
 int SIO_ReadStatusBlock(int unit, UBYTE *buffer);
 int SIO_FormatDisk(int unit, UBYTE *buffer, int sectsize, int sectcount);
 void SIO_SizeOfSector(UBYTE unit, int sector, int *sz, ULONG *ofs);
@@ -29,42 +29,91 @@
 
 #include "atari.h"
 #include "log.h"
+#include "mzpokeysnd.h"
 #include "platform.h"
 #include "pokeysnd.h"
 #include "util.h"
 
 #define DEBUG 0
 
-int Sound_enabled = 1;
+THREAD_LOCAL int Sound_enabled = 1;
 
-Sound_setup_t Sound_desired = {
+THREAD_LOCAL Sound_setup_t Sound_desired = {
 	44100,
 	2,
 	1,
 	0
 };
 
-Sound_setup_t Sound_out;
+THREAD_LOCAL Sound_setup_t Sound_out;
 
-static int paused = TRUE;
+static THREAD_LOCAL int paused = TRUE;
 
 #ifndef SOUND_CALLBACK
-static UBYTE *process_buffer = NULL;
-static unsigned int process_buffer_size;
+static THREAD_LOCAL UBYTE *process_buffer = NULL;
+static THREAD_LOCAL unsigned int process_buffer_size;
 #endif /* !SOUND_CALLBACK */
 
 #ifdef SYNCHRONIZED_SOUND
+/* sync_buffer is a single-producer, single-consumer ring: only the
+   emulation (UpdateSyncBuffer) advances write_pos and only the audio
+   output (FillBuffer, possibly in the callback thread) advances read_pos,
+   so neither needs to lock the other out. The positions count bytes from
+   the start and wrap around at UINT_MAX; the ring is a power of 2 long so
+   that pos & sync_ring_mask stays continuous across that wrap. The fill
+   is write_pos - read_pos and never exceeds sync_buffer_size.
+
+   A position is published with release semantics after the data it
+   covers is copied, and read with acquire semantics before the data is
+   accessed. Without atomic operations the positions are protected by
+   PLATFORM_SoundLock instead. */
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))
+#define RING_LOAD(pos) __atomic_load_n(&(pos), __ATOMIC_ACQUIRE)
+#define RING_STORE(pos, val) __atomic_store_n(&(pos), (val), __ATOMIC_RELEASE)
+#define RING_LOCK()
+#define RING_UNLOCK()
+#elif defined(_MSC_VER)
+/* The interlocked operations are full barriers on every target, unlike
+   volatile accesses, whose ordering depends on /volatile:ms */
+#include <intrin.h>
+#define RING_LOAD(pos) ((unsigned int) _InterlockedCompareExchange((volatile long *) &(pos), 0, 0))
+#define RING_STORE(pos, val) ((void) _InterlockedExchange((volatile long *) &(pos), (long) (val)))
+#define RING_LOCK()
+#define RING_UNLOCK()
+#else
+#define RING_LOAD(pos) (pos)
+#define RING_STORE(pos, val) ((pos) = (val))
+#define RING_LOCK() PLATFORM_SoundLock()
+#define RING_UNLOCK() PLATFORM_SoundUnlock()
+#endif
+
+/* Keep the positions on separate cache lines, so that the two threads
+   don't invalidate each other's line with every update. */
+#define CACHE_LINE_SIZE 64
+static struct {
+	unsigned int write_pos;
+	UBYTE pad1[CACHE_LINE_SIZE - sizeof(unsigned int)];
+	unsigned int read_pos;
+	UBYTE pad2[CACHE_LINE_SIZE - sizeof(unsigned int)];
+} sync_ring;
+
 static UBYTE *sync_buffer = NULL;
+/* Maximum fill of sync_buffer */
 static unsigned int sync_buffer_size;
-/* Two invariants are held:
-   a) 0 <= sync_read_pos < sync_buffer_size
-   b) sync_read_pos <= sync_write_pos <= sync_buffer_size + sync_read_pos
-   sync_write_pos may be >= sync_buffer_size. In such case the actual write
-   position is sync_write_pos % sync_buffer_size. */
-static unsigned int sync_write_pos;
-static unsigned int sync_read_pos;
+static unsigned int sync_ring_mask;
+
+/* Fill level telemetry, see Sound_GetStats. stats_underflows is only
+   written by the audio output, through RING_STORE, and never reset;
+   the emulation counts from stats_underflows_base instead. Everything
+   else is only accessed by the emulation. */
+static unsigned int stats_min_fill;
+static unsigned int stats_max_fill;
+static unsigned long stats_overflows;
+static unsigned int stats_underflows;
+static unsigned int stats_underflows_base;
 
 unsigned int Sound_latency = 20;
+int Sound_drc = FALSE;
 /* Cumulative audio difference. */
 static double avg_fill;
 /* Estimated fill of sync_buffer */
@@ -72,6 +121,8 @@ static unsigned int sync_est_fill;
 /* If sync_est_fill goes outside this bounds, emulation speed is adjusted. */
 static unsigned int sync_min_fill;
 static unsigned int sync_max_fill;
+/* Integral term of the dynamic rate control */
+static double drc_integral;
 #ifdef SOUND_CALLBACK
 #endif /* SOUND_CALLBACK */
 /* Time of last write of sudio to output device (either by Sound_Callback or
@@ -96,7 +147,7 @@ int Sound_ReadConfig(char *option, char *ptr)
 		return (Sound_desired.freq = Util_sscandec(ptr)) != -1;
 	else if (strcmp(option, "SOUND_BITS") == 0) {
 		int bits = Util_sscandec(ptr);
-		if (bits != 8 && bits != 16)
+		if (bits != 8 && bits != 16 && bits != 32)
 			return FALSE;
 		Sound_desired.sample_size = bits / 8;
 	}
@@ -109,6 +160,8 @@ int Sound_ReadConfig(char *option, char *ptr)
 #ifdef SYNCHRONIZED_SOUND
 	else if (strcmp(option, "SOUND_LATENCY") == 0)
 		return (Sound_latency = Util_sscandec(ptr)) != -1;
+	else if (strcmp(option, "SOUND_DRC") == 0)
+		return (Sound_drc = Util_sscanbool(ptr)) != -1;
 #endif /* SYNCHRONIZED_SOUND */
 	else
 		return FALSE;
@@ -123,6 +176,7 @@ void Sound_WriteConfig(FILE *fp)
 	fprintf(fp, "SOUND_BUFFER_MS=%u\n", Sound_desired.buffer_ms);
 #ifdef SYNCHRONIZED_SOUND
 	fprintf(fp, "SOUND_LATENCY=%u\n", Sound_latency);
+	fprintf(fp, "SOUND_DRC=%d\n", Sound_drc);
 #endif /* SYNCHRONIZED_SOUND */
 }
 
@@ -159,6 +213,12 @@ int Sound_Initialise(int *argc, char *argv[])
 			Sound_desired.sample_size = 2;
 		else if (strcmp(argv[i], "-audio8") == 0)
 			Sound_desired.sample_size = 1;
+#ifdef LIBATARI800
+		else if (strcmp(argv[i], "-audiofloat") == 0)
+			Sound_desired.sample_size = 4;
+#endif
+		else if (strcmp(argv[i], "-nofiltercache") == 0)
+			MZPOKEYSND_save_filters = FALSE;
 		else if (strcmp(argv[i], "snd-buflen") == 0) {
 			if (i_a) {
 				int val = Util_sscandec(argv[++i]);
@@ -174,6 +234,10 @@ int Sound_Initialise(int *argc, char *argv[])
 			if (i_a)
 				Sound_latency = Util_sscandec(argv[++i]);
 			else a_m = TRUE;
+		else if (strcmp(argv[i], "-snddrc") == 0)
+			Sound_drc = TRUE;
+		else if (strcmp(argv[i], "-nosnddrc") == 0)
+			Sound_drc = FALSE;
 #endif /* SYNCHRONIZED_SOUND */
 		else {
 			if (strcmp(argv[i], "-help") == 0) {
@@ -184,9 +248,15 @@ int Sound_Initialise(int *argc, char *argv[])
 				Log_print("\t-volume <0 .. 100>   Set sound output volume");
 				Log_print("\t-audio16             Set sound output format to 16-bit");
 				Log_print("\t-audio8              Set sound output format to 8-bit");
+#ifdef LIBATARI800
+				Log_print("\t-audiofloat          Set sound output format to 32-bit float");
+#endif
+				Log_print("\t-nofiltercache       Don't save designed sound filters in the home directory");
 				Log_print("\t-snd-buflen <ms>     Set length of the hardware sound buffer in milliseconds");
 #ifdef SYNCHRONIZED_SOUND
 				Log_print("\t-snddelay <ms>       Set sound latency in milliseconds");
+				Log_print("\t-snddrc              Keep sound in sync by resampling");
+				Log_print("\t-nosnddrc            Keep sound in sync by adjusting emulation speed");
 #endif /* SYNCHRONIZED_SOUND */
 			}
 			argv[j++] = argv[i];
@@ -224,6 +294,11 @@ int Sound_Setup(void)
 	Sound_desired.buffer_frames = Sound_desired.freq * Sound_desired.buffer_ms / 1000;
 
 	Sound_out = Sound_desired;
+#ifndef LIBATARI800
+	/* no audio backend takes float samples */
+	if (Sound_out.sample_size == 4)
+		Sound_out.sample_size = 2;
+#endif
 	if (!(Sound_enabled = PLATFORM_SoundSetup(&Sound_out)))
 		return FALSE;
 
@@ -249,7 +324,7 @@ int Sound_Setup(void)
 	process_buffer = Util_malloc(process_buffer_size);
 #endif /* !SOUND_CALLBACK */
 
-	POKEYSND_Init(POKEYSND_FREQ_17_EXACT, Sound_out.freq, Sound_out.channels, Sound_out.sample_size == 2 ? POKEYSND_BIT16 : 0);
+	POKEYSND_Init(POKEYSND_FREQ_17_EXACT, Sound_out.freq, Sound_out.channels, Sound_PokeyFlags(Sound_out.sample_size));
 
 #ifdef SYNCHRONIZED_SOUND
 	Sound_SetLatency(Sound_latency);
@@ -298,7 +373,7 @@ void Sound_Continue(void)
 	if (Sound_enabled && paused) {
 		/* start audio output */
 #ifdef SYNCHRONIZED_SOUND
-/*		sync_write_pos = sync_read_pos + sync_min_fill;
+/*		sync_ring.write_pos = sync_ring.read_pos + sync_min_fill;
 		avg_fill = sync_min_fill;*/
 		last_audio_write_time = Util_time();
 #endif /* SYNCHRONIZED_SOUND */
@@ -311,36 +386,37 @@ void Sound_Continue(void)
 static void FillBuffer(UBYTE *buffer, unsigned int size)
 {
 #ifdef SYNCHRONIZED_SOUND
-	unsigned int new_read_pos;
 	static UBYTE last_frame[MAX_FRAME_SIZE];
 	unsigned int bytes_per_frame = Sound_out.channels * Sound_out.sample_size;
-	unsigned int to_write = sync_write_pos - sync_read_pos;
+	unsigned int read_pos;
+	unsigned int to_write;
+
+	RING_LOCK();
+	read_pos = sync_ring.read_pos;
+	to_write = RING_LOAD(sync_ring.write_pos) - read_pos;
 
 	if (to_write > 0) {
+		unsigned int offset = read_pos & sync_ring_mask;
 		if (to_write > size)
 			to_write = size;
 
-		new_read_pos = sync_read_pos + to_write;
-
-		if (new_read_pos <= sync_buffer_size)
+		if (offset + to_write <= sync_ring_mask + 1)
 			/* no wrap */
-			memcpy(buffer, sync_buffer + sync_read_pos, to_write);
+			memcpy(buffer, sync_buffer + offset, to_write);
 		else {
 			/* wraps */
-			unsigned int first_part_size = sync_buffer_size - sync_read_pos;
-			memcpy(buffer, sync_buffer + sync_read_pos, first_part_size);
+			unsigned int first_part_size = sync_ring_mask + 1 - offset;
+			memcpy(buffer, sync_buffer + offset, first_part_size);
 			memcpy(buffer + first_part_size, sync_buffer, to_write - first_part_size);
 		}
 
-		sync_read_pos = new_read_pos;
-		if (sync_read_pos > sync_buffer_size) {
-			sync_read_pos -= sync_buffer_size;
-			sync_write_pos -= sync_buffer_size;
-		}
+		RING_STORE(sync_ring.read_pos, read_pos + to_write);
 		/* Save the last frame as we may need it to fill underflow. */
 		memcpy(last_frame, buffer + to_write - bytes_per_frame, bytes_per_frame);
 	}
-
+	if (to_write < size)
+		RING_STORE(stats_underflows, stats_underflows + 1);
+	RING_UNLOCK();
 
 	/* Just repeat the last good frame if underflow. */
 	if (to_write < size) {
@@ -364,7 +440,7 @@ void Sound_Callback(UBYTE *buffer, unsigned int size)
 {
 #if DEBUG >= 2
 		Log_print("Callback: fill %u, needed %u",
-		          (sync_write_pos - sync_read_pos) / Sound_out.channels / Sound_out.sample_size,
+		          (RING_LOAD(sync_ring.write_pos) - RING_LOAD(sync_ring.read_pos)) / Sound_out.channels / Sound_out.sample_size,
 		          size / Sound_out.channels / Sound_out.sample_size);
 #endif
 	FillBuffer(buffer, size);
@@ -381,7 +457,7 @@ static void WriteOut(void)
 	if (avail > 0) {
 #if DEBUG >= 2
 		Log_print("WriteOut: fill %u, needed %u",
-		          (sync_write_pos - sync_read_pos) / Sound_out.channels / Sound_out.sample_size,
+		          (RING_LOAD(sync_ring.write_pos) - RING_LOAD(sync_ring.read_pos)) / Sound_out.channels / Sound_out.sample_size,
 		          avail / Sound_out.channels / Sound_out.sample_size);
 #endif
 		/* On some platforms (eg. NestedVM) avail may be larger than process_buffer_size. */
@@ -399,16 +475,51 @@ static void WriteOut(void)
 #endif /* !SOUND_CALLBACK */
 
 #ifdef SYNCHRONIZED_SOUND
+/* Dynamic rate control: instead of the emulation speed, the number of
+   samples generated per emulated frame is adjusted, by a PI controller on
+   the estimated fill. The proportional term reacts to the jitter of the
+   output, the integral term settles at the difference between the audio
+   output's clock and the emulation's frame rate. */
+static void UpdateResampleRatio(void)
+{
+	static double const kp = 0.002;
+	static double const ki = 0.00005;
+	double error;
+	double ratio;
+
+	/* relative to the latency; too full means too many samples, i.e.
+	   too few ticks per sample */
+	error = ((double)sync_est_fill - sync_min_fill) / (sync_min_fill > 0 ? sync_min_fill : sync_max_fill);
+	drc_integral += ki * error;
+	if (drc_integral > POKEYSND_RESAMPLE_MAX_ADJUST)
+		drc_integral = POKEYSND_RESAMPLE_MAX_ADJUST;
+	else if (drc_integral < -POKEYSND_RESAMPLE_MAX_ADJUST)
+		drc_integral = -POKEYSND_RESAMPLE_MAX_ADJUST;
+	ratio = 1.0 + kp * error + drc_integral;
+	if (ratio > 1.0 + POKEYSND_RESAMPLE_MAX_ADJUST)
+		ratio = 1.0 + POKEYSND_RESAMPLE_MAX_ADJUST;
+	else if (ratio < 1.0 - POKEYSND_RESAMPLE_MAX_ADJUST)
+		ratio = 1.0 - POKEYSND_RESAMPLE_MAX_ADJUST;
+	POKEYSND_resample_ratio = ratio;
+}
+
 static void UpdateSyncBuffer(void)
 {
 	unsigned int bytes_written;
 	unsigned int samples_written;
 	unsigned int fill;
-	unsigned int new_write_pos;
+	unsigned int write_pos;
+	unsigned int offset;
 
-	PLATFORM_SoundLock();
+	RING_LOCK();
+	write_pos = sync_ring.write_pos;
 	/* Current fill of the audio buffer. */
-	fill = sync_write_pos - sync_read_pos;
+	fill = write_pos - RING_LOAD(sync_ring.read_pos);
+	RING_UNLOCK();
+	if (fill < stats_min_fill)
+		stats_min_fill = fill;
+	if (fill > stats_max_fill)
+		stats_max_fill = fill;
 
 	/* Update sync_est_fill. */
 	{
@@ -420,10 +531,10 @@ static void UpdateSyncBuffer(void)
 			sync_est_fill = fill - est_gap;
 	}
 
-	if (Atari800_turbo && sync_est_fill > sync_max_fill) {
-		PLATFORM_SoundUnlock();
+	if (Atari800_turbo && sync_est_fill > sync_max_fill)
 		return;
-	}
+	if (Sound_drc && !Atari800_turbo)
+		UpdateResampleRatio();
 
 	/* produce samples from the sound emulation */
 	samples_written = POKEYSND_UpdateProcessBuffer();
@@ -437,22 +548,28 @@ static void UpdateSyncBuffer(void)
 				  (sync_buffer_size - fill)/Sound_out.channels/Sound_out.sample_size,
 				  bytes_written/Sound_out.channels/Sound_out.sample_size);
 #endif
+		stats_overflows++;
 		/* Wait until hardware buffer can be filled, or wait until callback
 		   makes place in the buffer. */
 		do {
-			PLATFORM_SoundUnlock();
+			double bytes_per_second = (double)Sound_out.freq * Sound_out.channels * Sound_out.sample_size;
+			double wait = (bytes_written - (sync_buffer_size - fill)) / bytes_per_second;
+			/* Sleep until the missing space has been played, but at most
+			   for the duration of one full HW buffer. */
+			if (wait > (double)Sound_out.buffer_frames / Sound_out.freq)
+				wait = (double)Sound_out.buffer_frames / Sound_out.freq;
 #ifndef __MINT__	/* this does more harm than good on Atari */
-			/* Sleep for the duration of one full HW buffer. */
-			Util_sleep((double)Sound_out.buffer_frames / Sound_out.freq);
+			Util_sleep(wait);
 #endif
-			PLATFORM_SoundLock();
 #ifndef SOUND_CALLBACK
 			WriteOut(); /* Write to audio buffer as much as possible. */
 #endif /* SOUND_CALLBACK */
-			fill = sync_write_pos - sync_read_pos;
+			RING_LOCK();
+			fill = write_pos - RING_LOAD(sync_ring.read_pos);
+			RING_UNLOCK();
 		} while (bytes_written > sync_buffer_size - fill);
 	}
-	/* Now bytes_written <= audio_buffer_size + dsp_read_pos - dsp_write_pos) */
+	/* Now bytes_written <= sync_buffer_size - fill */
 
 #if DEBUG >= 2
 	Log_print("UpdateSyncBuffer: est_gap: %f, fill %u, write %u",
@@ -460,22 +577,21 @@ static void UpdateSyncBuffer(void)
 	          fill / Sound_out.channels/Sound_out.sample_size,
 	          bytes_written / Sound_out.channels/Sound_out.sample_size);
 #endif
-	/* now we copy the data into the buffer and adjust the positions */
-	new_write_pos = sync_write_pos + bytes_written;
-	if (new_write_pos/sync_buffer_size == sync_write_pos/sync_buffer_size)
+	/* now we copy the data into the buffer and publish the new position */
+	offset = write_pos & sync_ring_mask;
+	if (offset + bytes_written <= sync_ring_mask + 1)
 		/* no wrap */
-		memcpy(sync_buffer + sync_write_pos%sync_buffer_size, POKEYSND_process_buffer, bytes_written);
+		memcpy(sync_buffer + offset, POKEYSND_process_buffer, bytes_written);
 	else {
 		/* wraps */
-		int first_part_size = sync_buffer_size - sync_write_pos%sync_buffer_size;
-		memcpy(sync_buffer + sync_write_pos%sync_buffer_size, POKEYSND_process_buffer, first_part_size);
+		unsigned int first_part_size = sync_ring_mask + 1 - offset;
+		memcpy(sync_buffer + offset, POKEYSND_process_buffer, first_part_size);
 		memcpy(sync_buffer, POKEYSND_process_buffer + first_part_size, bytes_written - first_part_size);
 	}
 
-	sync_write_pos = new_write_pos;
-	if (sync_write_pos > sync_read_pos + sync_buffer_size)
-		sync_write_pos -= sync_buffer_size;
-	PLATFORM_SoundUnlock();
+	RING_LOCK();
+	RING_STORE(sync_ring.write_pos, write_pos + bytes_written);
+	RING_UNLOCK();
 }
 #endif /* SYNCHRONIZED_SOUND */
 
@@ -500,16 +616,23 @@ void Sound_SetLatency(unsigned int latency)
 		enum { SYNC_BUFFER_FRAGS = 5 };
 		unsigned int bytes_per_frame = Sound_out.channels * Sound_out.sample_size;
 		unsigned int latency_frames = Sound_out.freq*Sound_latency/1000;
+		/* Keeps the audio output away while the ring is replaced */
 		PLATFORM_SoundLock();
 		sync_buffer_size = (latency_frames + SYNC_BUFFER_FRAGS*Sound_out.buffer_frames) * bytes_per_frame;
+		sync_ring_mask = Sound_NextPow2(sync_buffer_size - 1) - 1;
 		sync_min_fill = latency_frames * bytes_per_frame;
 		sync_max_fill = sync_min_fill + Sound_out.buffer_frames * bytes_per_frame;
 		avg_fill = sync_min_fill;
-		sync_read_pos = 0;
-		sync_write_pos = sync_min_fill;
+		sync_ring.read_pos = 0;
+		sync_ring.write_pos = sync_min_fill;
+		stats_min_fill = stats_max_fill = sync_min_fill;
+		stats_overflows = 0;
+		stats_underflows_base = RING_LOAD(stats_underflows);
+		drc_integral = 0.0;
+		POKEYSND_resample_ratio = 1.0;
 		free(sync_buffer);
-		sync_buffer = Util_malloc(sync_buffer_size);
-		memset(sync_buffer, 0, sync_buffer_size);
+		sync_buffer = Util_malloc(sync_ring_mask + 1);
+		memset(sync_buffer, 0, sync_ring_mask + 1);
 		PLATFORM_SoundUnlock();
 	}
 }
@@ -519,6 +642,12 @@ double Sound_AdjustSpeed(void)
 	double delay_mult = 1.0;
 	static double const alpha = 2.0/(1.0+40.0);
 
+	if (Sound_drc) {
+		/* the sample rate follows the emulation instead */
+		if (!Sound_enabled || paused)
+			POKEYSND_resample_ratio = 1.0;
+		return delay_mult;
+	}
 	if (Sound_enabled && !paused) {
 #if 1
 		avg_fill = avg_fill + alpha * (sync_est_fill - avg_fill);
@@ -545,6 +674,26 @@ double Sound_AdjustSpeed(void)
 	}
 	return delay_mult;
 }
+
+void Sound_GetStats(Sound_stats_t *stats)
+{
+	unsigned int bytes_per_frame = Sound_out.channels * Sound_out.sample_size;
+	memset(stats, 0, sizeof(Sound_stats_t));
+	if (!Sound_enabled)
+		return;
+	RING_LOCK();
+	stats->fill = RING_LOAD(sync_ring.write_pos) - RING_LOAD(sync_ring.read_pos);
+	stats->underflows = RING_LOAD(stats_underflows) - stats_underflows_base;
+	RING_UNLOCK();
+	stats->min_fill = stats_min_fill / bytes_per_frame;
+	stats->max_fill = stats_max_fill / bytes_per_frame;
+	stats->size = sync_buffer_size / bytes_per_frame;
+	stats->target_fill = sync_min_fill / bytes_per_frame;
+	stats->overflows = stats_overflows;
+	/* start the next period from the current fill */
+	stats_min_fill = stats_max_fill = stats->fill;
+	stats->fill /= bytes_per_frame;
+}
 #endif /* SYNCHRONIZED_SOUND */
 
 unsigned int Sound_NextPow2(unsigned int num)
@@ -29,7 +29,9 @@ typedef struct Sound_setup_t {
 	unsigned int freq;
 	/* Number of bytes per each sample, also determines sample format:
 	   1 = unsigned 8-bit format.
-	   2 = signed 16-bit system-endian format. */
+	   2 = signed 16-bit system-endian format.
+	   4 = 32-bit float system-endian format, full scale is +/-1.0. Only
+	       libatari800 outputs it; elsewhere 16-bit format is used instead. */
 	int sample_size;
 	/* Number of audio channels: 1 = mono, 2 = stereo. */
 	unsigned int channels;
@@ -48,15 +50,15 @@ typedef struct Sound_setup_t {
    Set Sound_desired.buffer_frames to 0 if you want the hardware to decide value of this
    parameter automatically.
  */
-extern Sound_setup_t Sound_desired;
+extern THREAD_LOCAL Sound_setup_t Sound_desired;
 
 /* Holds parameters of the currently-opened hardware audio output. Don't change
    it directly - use Sound_Setup instead. */
-extern Sound_setup_t Sound_out;
+extern THREAD_LOCAL Sound_setup_t Sound_out;
 
 /* Indicates whether sound output is enabled. Don't change it directly - use
    Sound_Setup to enable sound, and Sound_Exit to disable it. */
-extern int Sound_enabled;
+extern THREAD_LOCAL int Sound_enabled;
 
 /* Enables hardware audio output with parameters based on those stored in
    Sound_desired. Stores the parameters of the actual opened output in
@@ -85,10 +87,39 @@ extern unsigned int Sound_latency;
 
 void Sound_SetLatency(unsigned int latency);
 
+/* If TRUE, the emulation runs at its nominal speed and the sound is kept in
+   sync by tuning the resampling ratio (POKEYSND_resample_ratio) instead. */
+extern int Sound_drc;
+
 /* Returns a factor (1.0 by default) to adjust the speed of the emulation
  * so that if the sound buffer is too full or too empty. The emulation
- * slows down or speeds up to match the actual speed of sound output. */
+ * slows down or speeds up to match the actual speed of sound output.
+ * Always 1.0 with Sound_drc. */
 double Sound_AdjustSpeed(void);
+
+/* Fill level of the buffer between the emulation and the audio output.
+   All sizes are in frames. */
+typedef struct Sound_stats_t {
+	/* Current fill. */
+	unsigned int fill;
+	/* Lowest and highest fill seen by the emulation since the previous
+	   call to Sound_GetStats. */
+	unsigned int min_fill;
+	unsigned int max_fill;
+	/* Fill the emulation speed is adjusted to keep (the latency). */
+	unsigned int target_fill;
+	/* Maximum fill. */
+	unsigned int size;
+	/* Number of times the emulation had to wait for free space, and the
+	   audio output had to repeat a frame for lack of data, since
+	   Sound_SetLatency. */
+	unsigned long overflows;
+	unsigned long underflows;
+} Sound_stats_t;
+
+/* Stores the current Sound_stats_t in STATS. Call from the emulation
+   thread. All zero if sound is disabled. */
+void Sound_GetStats(Sound_stats_t *stats);
 #endif /* SYNCHRONIZED_SOUND */
 
 /* Helper function for use when hardware audio buffer size is required to
@@ -96,6 +127,11 @@ double Sound_AdjustSpeed(void);
    (0 <= NUM < UINT_MAX). */
 unsigned int Sound_NextPow2(unsigned int num);
 
+/* Returns the POKEYSND_Init flags for the sample format of SAMPLE_SIZE
+   (see Sound_setup_t). */
+#define Sound_PokeyFlags(sample_size) \
+	((sample_size) == 4 ? POKEYSND_FLOAT32 : (sample_size) == 2 ? POKEYSND_BIT16 : 0)
+
 #endif /* SOUND_THIN_API */
 
 #endif /* SOUND_H_ */
@@ -101,8 +101,8 @@ static size_t mem_write(const void *buf, size_t len, gzFile stream);
 #define Z_OK    0
 #endif
 
-static gzFile StateFile = NULL;
-static int nFileError = Z_OK;
+static THREAD_LOCAL gzFile StateFile = NULL;
+static THREAD_LOCAL int nFileError = Z_OK;
 
 static void GetGZErrorText(void)
 {
@@ -302,11 +302,14 @@ void StateSav_SaveFNAME(const char *filename)
 	char dirname[FILENAME_MAX]="";
 
 	/* Check to see if file is in application tree, if so, just save as
-	   relative path....*/
-	Util_getcwd(dirname, FILENAME_MAX);
-	if (strncmp(filename, dirname, strlen(dirname)) == 0) {
-		/* XXX: check if '/' or '\\' follows dirname in filename? */
-		filename += strlen(dirname) + 1;
+	   relative path.... Rewind states keep the name as it is, so that the
+	   media can be recognized when loading. */
+	if (!STATESAV_REWIND) {
+		Util_getcwd(dirname, FILENAME_MAX);
+		if (strncmp(filename, dirname, strlen(dirname)) == 0) {
+			/* XXX: check if '/' or '\\' follows dirname in filename? */
+			filename += strlen(dirname) + 1;
+		}
 	}
 
 	namelen = strlen(filename);
@@ -546,9 +549,9 @@ int StateSav_ReadAtariState(const char *filename, const char *mode)
 /* Common definitions for in-memory state save used for DREAMCAST and libatari800
  */
 #if defined(MEMCOMPR) || defined(LIBATARI800)
-static char * plainmembuf;
-static unsigned int plainmemoff;
-static unsigned int unclen;
+static THREAD_LOCAL char * plainmembuf;
+static THREAD_LOCAL unsigned int plainmemoff;
+static THREAD_LOCAL unsigned int unclen;
 
 /* hack to compress in memory before writing
  * - for DREAMCAST only
@@ -648,12 +651,21 @@ static int mem_close(gzFile stream)
 
 
 #ifdef LIBATARI800
+/* dummy stream returned when only counting the size of the state */
+static THREAD_LOCAL char count_only_stream;
+
 /* replacement for GZOPEN */
 static gzFile mem_open(const char *name, const char *mode)
 {
 	plainmembuf = (char *)LIBATARI800_StateSav_buffer;
 	plainmemoff = 0; /*HDR_LEN;*/
-	unclen = STATESAV_MAX_SIZE;
+	unclen = LIBATARI800_StateSav_buffer_size;
+	if (plainmembuf == NULL) {
+		/* no buffer: only count the bytes that would be written */
+		if (*mode != 'w')
+			return NULL;
+		return (gzFile) &count_only_stream;
+	}
 	return (gzFile) plainmembuf;
 }
 
@@ -682,6 +694,12 @@ static size_t mem_read(void *buf, size_t len, gzFile stream)
 /* replacement for GZWRITE */
 static size_t mem_write(const void *buf, size_t len, gzFile stream)
 {
+#ifdef LIBATARI800
+	if (plainmembuf == NULL) {
+		plainmemoff += len;
+		return len;
+	}
+#endif
 	if (plainmemoff + len > unclen) return 0;  /* shouldn't happen */
 	memcpy(plainmembuf + plainmemoff, buf, len);
 	plainmemoff += len;
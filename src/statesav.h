@@ -22,9 +22,13 @@ ULONG StateSav_Tell(void);
 #include "libatari800/statesav.h"
 /* STATESAV_MAX_SIZE defined in libatari800 include file */
 #define STATESAV_TAG(a) (LIBATARI800_StateSav_tags->a = StateSav_Tell())
+/* Set while saving or loading a state of the rewind buffer, which keeps the
+   memory blocks of the machine itself and doesn't reinsert media */
+#define STATESAV_REWIND LIBATARI800_StateSav_rewind
 #else /* LIBATARI800 */
 #define STATESAV_MAX_SIZE 210000 /* max size of state save data */
 #define STATESAV_TAG(a)
+#define STATESAV_REWIND FALSE
 #endif /* LIBATARI800 */
 
 #endif /* STATESAV_H_ */
@@ -3921,6 +3921,7 @@ static int SoundSettings(void)
 		UI_MENU_SUBMENU_SUFFIX(3, "Hardware buffer length:", hw_buflen_string),
 #ifdef SYNCHRONIZED_SOUND
 		UI_MENU_SUBMENU_SUFFIX(4, "Latency:", latency_string),
+		UI_MENU_ACTION(11, "Keep in sync by:"),
 #endif /* SYNCHRONIZED_SOUND */
 #endif /* SOUND_THIN_API */
 #ifdef DREAMCAST
@@ -3957,6 +3958,7 @@ static int SoundSettings(void)
 			snprintf(hw_buflen_string, sizeof(hw_buflen_string), "%u ms", setup.buffer_ms);
 #ifdef SYNCHRONIZED_SOUND
 		snprintf(latency_string, sizeof(latency_string), "%u ms", Sound_latency);
+		FindMenuItem(menu_array, 11)->suffix = Sound_drc ? "Resampling" : "Speed";
 #endif /* SYNCHRONIZED_SOUND */
 #endif /* SOUND_THIN_API */
 #ifdef DREAMCAST
@@ -4012,7 +4014,7 @@ static int SoundSettings(void)
 			}
 			break;
 		case 2:
-			setup.sample_size = 3 - setup.sample_size; /* Toggle 1<->2 */
+			setup.sample_size = setup.sample_size == 1 ? 2 : 1; /* Toggle 1<->2 */
 			break;
 		case 3:
 			{
@@ -4041,6 +4043,10 @@ static int SoundSettings(void)
 			if (UI_driver->fEditString("Enter sound latency", latency_string, sizeof(latency_string)-3))
 				Sound_SetLatency(atoi(latency_string));
 			break;
+		case 11:
+			Sound_drc = !Sound_drc;
+			Sound_SetLatency(Sound_latency);
+			break;
 #endif /* SYNCHRONIZED_SOUND */
 #endif /* SOUND_THIN_API */
 #ifdef DREAMCAST
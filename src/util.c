@@ -526,6 +526,26 @@ FILE *Util_uniqopen(char *filename, const char *mode)
 #endif
 }
 
+FILE *Util_uniqopen_beside(char *filename, const char *path, const char *mode)
+{
+#if defined(HAVE_MKSTEMP) && defined(HAVE_FDOPEN)
+	int fd;
+	snprintf(filename, FILENAME_MAX, "%s.XXXXXX", path);
+	fd = mkstemp(filename);
+	if (fd < 0)
+		return NULL;
+	return fdopen(fd, mode);
+#else
+	int no;
+	for (no = 0; no < 1000000; no++) {
+		snprintf(filename, FILENAME_MAX, "%s.%06d", path, no);
+		if (!Util_fileexists(filename))
+			return fopen(filename, mode);
+	}
+	return NULL;
+#endif
+}
+
 #if defined(HAVE_WINDOWS_H) && defined(UNICODE)
 int Util_unlink(const char *filename)
 {
@@ -188,6 +188,10 @@ int Util_unlink(const char *filename);
 /* Creates a file that does not exist and fills in filename with its name. */
 FILE *Util_uniqopen(char *filename, const char *mode);
 
+/* Like Util_uniqopen, but creates the file in the directory of path, with
+   a name made from path, so that it can be renamed over path. */
+FILE *Util_uniqopen_beside(char *filename, const char *path, const char *mode);
+
 /* Support for temporary files.
 
    Util_tmpbufdef() defines storage for names of temporary files, if necessary.
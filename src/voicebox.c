@@ -30,8 +30,8 @@
 #include "log.h"
 #include "pia.h"
 
-int VOICEBOX_enabled = FALSE;
-int VOICEBOX_ii = FALSE;
+THREAD_LOCAL int VOICEBOX_enabled = FALSE;
+THREAD_LOCAL int VOICEBOX_ii = FALSE;
 
 int VOICEBOX_Initialise(int *argc, char *argv[])
 {
@@ -63,10 +63,10 @@ int VOICEBOX_Initialise(int *argc, char *argv[])
 /* For Voice Box I */
 void VOICEBOX_SKCTLPutByte(int byte)
 {
-	static int prev_byte;
-	static int prev_prev_byte;
-	static int voice_box_byte;
-	static int voice_box_bit;
+	static THREAD_LOCAL int prev_byte;
+	static THREAD_LOCAL int prev_prev_byte;
+	static THREAD_LOCAL int voice_box_byte;
+	static THREAD_LOCAL int voice_box_bit;
 	if (!VOICEBOX_enabled || VOICEBOX_ii) return;
 	if (PIA_PACTL&0x08) return; /* Cassette motor line must be on */
 #ifdef DEBUG_VOICEBOX
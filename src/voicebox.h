@@ -1,11 +1,13 @@
 #ifndef VOICEBOX_H_
 #define VOICEBOX_H_
 
+#include "atari.h"
+
 int VOICEBOX_Initialise(int *argc, char *argv[]);
 void VOICEBOX_SKCTLPutByte(int byte);
 void VOICEBOX_SEROUTPutByte(int byte);
-extern int VOICEBOX_enabled;
-extern int VOICEBOX_ii;
+extern THREAD_LOCAL int VOICEBOX_enabled;
+extern THREAD_LOCAL int VOICEBOX_ii;
 #define VOICEBOX_BASEAUDF 0xa0
 
 #endif /* VOICEBOX_H_ */
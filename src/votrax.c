@@ -42,7 +42,7 @@ Votrax_GetStatus     - Return busy status (1 = busy)
 #include <string.h>
 #include "util.h"
 
-static struct {
+static THREAD_LOCAL struct {
 	int busy;
 
 	int actPhoneme;
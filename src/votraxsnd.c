@@ -40,21 +40,21 @@
 
 #define VTRX_RATE 24500
 
-static double ratio;
-static int bit16;
+static THREAD_LOCAL double ratio;
+static THREAD_LOCAL int bit16;
 #define VTRX_BLOCK_SIZE 1024
-SWORD *temp_votrax_buffer = NULL;
-SWORD *votrax_buffer = NULL;
-int VOTRAXSND_busy = FALSE;
-static int votrax_sync_samples;
-static int dsprate;
-static int num_pokeys;
-static int samples_per_frame;
+THREAD_LOCAL SWORD *temp_votrax_buffer = NULL;
+THREAD_LOCAL SWORD *votrax_buffer = NULL;
+THREAD_LOCAL int VOTRAXSND_busy = FALSE;
+static THREAD_LOCAL int votrax_sync_samples;
+static THREAD_LOCAL int dsprate;
+static THREAD_LOCAL int num_pokeys;
+static THREAD_LOCAL int samples_per_frame;
 /*if SYNCHRONIZED_SOUND is not used and the sound generation runs in a
  * separate thread, then these variables are accessed in two different
  * threads: */
-static int votrax_written = FALSE;
-static int votrax_written_byte = 0x3f;
+static THREAD_LOCAL int votrax_written = FALSE;
+static THREAD_LOCAL int votrax_written_byte = 0x3f;
 
 void VOTRAXSND_PutByte(UBYTE byte)
 {
@@ -95,7 +95,7 @@ static int votraxsnd_enabled(void)
 /* called from POKEYSND_Init */
 void VOTRAXSND_Init(int playback_freq, int n_pokeys, int b16)
 {
-	static struct Votrax_interface vi;
+	static THREAD_LOCAL struct Votrax_interface vi;
 	int temp_votrax_buffer_size;
 	bit16 = b16;
 	dsprate = playback_freq;
@@ -139,10 +139,10 @@ void VOTRAXSND_Reinit(void)
 /* process votrax and interpolate samples */
 static void votrax_process(SWORD *v_buffer, int len, SWORD *temp_v_buffer)
 {
-	static SWORD last_sample;
-	static SWORD last_sample2;
-	static double startpos;
-	static int have;
+	static THREAD_LOCAL SWORD last_sample;
+	static THREAD_LOCAL SWORD last_sample2;
+	static THREAD_LOCAL double startpos;
+	static THREAD_LOCAL int have;
 	int max_left_sample_index = (int)(startpos + (double)(len - 1)*ratio);
 	int pos = 0;
 	double fraction = 0;
@@ -194,45 +194,14 @@ static void votrax_process(SWORD *v_buffer, int len, SWORD *temp_v_buffer)
 	}
 }
 
-/* 16 bit mixing */
-static void mix(SWORD *dst, SWORD *src, int sndn, int volume)
+/* mix into the left channel of the mixing bus */
+static void mix(float *dst, SWORD *src, int sndn, int volume)
 {
-	SWORD s1, s2;
-	int val;
+	float gain = volume / 128.0f / 32768.0f;
 
 	while (sndn--) {
-		s1 = *src;
-		s1 = s1*volume/128;
-		s2 = *dst;
-		src++;
-		val = s1 + s2;
-		if (val > 32767) val = 32767;
-		if (val < -32768) val = -32768;
-		*dst++ = val;
-		if (num_pokeys == 2) {
-			dst++;
-		}
-	}
-}
-
-/* 8 bit mixing */
-static void mix8(UBYTE *dst, SWORD *src, int sndn, int volume)
-{
-	SWORD s1, s2;
-	int val;
-
-	while (sndn--) {
-		s1 = *src;
-		s1 = s1*volume/128;
-		s2 = ((int)(*dst) - 0x80)*256;
-		src++;
-		val = s1 + s2;
-		if (val > 32767) val = 32767;
-		if (val < -32768) val = -32768;
-		*dst++ = (UBYTE)((val/256) + 0x80);
-		if (num_pokeys == 2) {
-			dst++;
-		}
+		*dst += *src++ * gain;
+		dst += num_pokeys;
 	}
 }
 
@@ -256,7 +225,7 @@ void VOTRAXSND_Frame(void)
 	}
 }
 
-void VOTRAXSND_Process(void *sndbuffer, int sndn)
+void VOTRAXSND_Process(float *bus, int sndn)
 {
 	if (!votraxsnd_enabled()) return;
 
@@ -268,9 +237,8 @@ void VOTRAXSND_Process(void *sndbuffer, int sndn)
 	while (sndn > 0) {
 		int amount = ((sndn > VTRX_BLOCK_SIZE) ? VTRX_BLOCK_SIZE : sndn);
 		votrax_process(votrax_buffer, amount, temp_votrax_buffer);
-		if (bit16) mix((SWORD *)sndbuffer, votrax_buffer, amount, POKEYSND_volume >> 3);
-		else mix8((UBYTE *)sndbuffer, votrax_buffer, amount, POKEYSND_volume >> 3);
-		sndbuffer = (char *) sndbuffer + VTRX_BLOCK_SIZE*(bit16 ? 2 : 1)*((num_pokeys == 2) ? 2: 1);
+		mix(bus, votrax_buffer, amount, POKEYSND_volume >> 3);
+		bus += VTRX_BLOCK_SIZE*num_pokeys;
 		sndn -= VTRX_BLOCK_SIZE;
 	}
 }